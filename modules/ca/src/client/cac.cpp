@@ -50,6 +50,7 @@
 #include "net_convert.h"
 #include "autoPtrFreeList.h"
 #include "noopiiu.h"
+#include "tcpMux.h"
 
 static const char pVersionCAC[] =
     "@(#) " EPICS_VERSION_STRING
@@ -128,7 +129,7 @@ const cac::pExcepProtoStubTCP cac::tcpExcepJumpTableCAC [] =
 cac::cac (
     epicsMutex & mutualExclusionIn,
     epicsMutex & callbackControlIn,
-    cacContextNotify & notifyIn ) :
+    cacContextNotify & notifyIn, bool preemptiveCallbackEnabled ) :
     _refLocalHostName ( localHostNameCache.getReference () ),
     programBeginTime ( epicsTime::getCurrent() ),
     connTMO ( CA_CONN_VERIFY_PERIOD ),
@@ -139,6 +140,7 @@ cac::cac (
         lowestPriorityLevelAbove(epicsThreadGetPrioritySelf()) ) ),
     pUserName ( 0 ),
     pudpiiu ( 0 ),
+    pMux ( 0 ),
     tcpSmallRecvBufFreeList ( 0 ),
     tcpLargeRecvBufFreeList ( 0 ),
     notify ( notifyIn ),
@@ -147,6 +149,7 @@ cac::cac (
     maxRecvBytesTCP ( MAX_TCP ),
     maxContigFrames ( contiguousMsgCountWhichTriggersFlowControl ),
     beaconAnomalyCount ( 0u ),
+    nMuxThreads ( 0u ),
     iiuExistenceCount ( 0u ),
     cacShutdownInProgress ( false )
 {
@@ -229,6 +232,26 @@ cac::cac (
                 throw std::bad_alloc ();
             }
         }
+        long nThreads = 0;
+        if ( envGetConfigParamPtr ( &EPICS_CA_IO_THREADS ) ) {
+            status = envGetLongConfigParam ( &EPICS_CA_IO_THREADS, &nThreads );
+            if ( status || nThreads < 0 ) {
+                errlogPrintf ( "cac: EPICS_CA_IO_THREADS was not a positive integer\n" );
+                nThreads = 0;
+            }
+        }
+#ifdef __linux__
+        // the I/O threads must never wait for the callback lock of a
+        // context which has preemptive callback disabled
+        if ( preemptiveCallbackEnabled ) {
+            this->nMuxThreads = static_cast < unsigned > ( nThreads );
+        }
+#else
+        if ( nThreads > 0 ) {
+            errlogPrintf ( "cac: EPICS_CA_IO_THREADS is not supported on this target\n" );
+        }
+#endif
+
         unsigned bufsPerArray = this->maxRecvBytesTCP / comBuf::capacityBytes ();
         if ( bufsPerArray > 1u ) {
             maxContigFrames = bufsPerArray *
@@ -323,6 +346,8 @@ cac::~cac ()
         }
     }
 
+    delete this->pMux;
+
     if ( this->pudpiiu ) {
         delete this->pudpiiu;
     }
@@ -424,6 +449,9 @@ void cac::show (
         if ( this->pudpiiu ) {
             this->pudpiiu->show ( level - 2u );
         }
+        if ( this->pMux ) {
+            this->pMux->show ( level - 2u );
+        }
     }
 
     if ( level > 2u ) {
@@ -533,6 +561,27 @@ cacChannel & cac::createChannel (
     return *pNetChan;
 }
 
+// Returns the I/O thread for a new circuit, or zero if the circuit
+// should have its own threads. The I/O threads are started when the
+// first circuit is created, once the client context is complete.
+tcpMuxThread * cac::muxThreadAssign (
+    epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+
+    if ( ! this->pMux && this->nMuxThreads ) {
+        this->pMux = tcpMux::create ( *this, this->notify,
+            this->nMuxThreads, cac::highestPriorityLevelBelow (
+                this->initializingThreadsPriority ) );
+        // only try once
+        this->nMuxThreads = 0u;
+    }
+    if ( this->pMux ) {
+        return & this->pMux->assign ();
+    }
+    return 0;
+}
+
 bool cac::findOrCreateVirtCircuit (
     epicsGuard < epicsMutex > & guard, const osiSockAddr & addr,
     unsigned priority, tcpiiu *& piiu, unsigned minorVersionNumber,
@@ -553,7 +602,8 @@ bool cac::findOrCreateVirtCircuit (
                     new ( this->freeListVirtualCircuit ) tcpiiu (
                         *this, this->mutex, this->cbMutex, this->notify, this->connTMO,
                         this->timerQueue, addr, this->comBufMemMgr, minorVersionNumber,
-                        this->ipToAEngine, priority, pSearchDest ) );
+                        this->ipToAEngine, priority, pSearchDest,
+                        pSearchDest ? 0 : this->muxThreadAssign ( guard ) ) );
 
             bhe * pBHE = this->beaconTable.lookup ( addr.ia );
             if ( ! pBHE ) {
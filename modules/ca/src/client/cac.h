@@ -104,7 +104,7 @@ public:
     cac (
         epicsMutex & mutualExclusion,
         epicsMutex & callbackControl,
-        cacContextNotify & );
+        cacContextNotify &, bool preemptiveCallbackEnabled );
     virtual ~cac ();
 
     // beacon management
@@ -257,6 +257,7 @@ private:
     epicsTimerQueueActive & timerQueue;
     char * pUserName;
     class udpiiu * pudpiiu;
+    class tcpMux * pMux;
     void * tcpSmallRecvBufFreeList;
     void * tcpLargeRecvBufFreeList;
     cacContextNotify & notify;
@@ -265,10 +266,13 @@ private:
     unsigned maxRecvBytesTCP;
     unsigned maxContigFrames;
     unsigned beaconAnomalyCount;
+    unsigned nMuxThreads;
     unsigned short _serverPort;
     unsigned iiuExistenceCount;
     bool cacShutdownInProgress;
 
+    class tcpMuxThread * muxThreadAssign (
+        epicsGuard < epicsMutex > & );
     void recycleReadNotifyIO (
         epicsGuard < epicsMutex > &, netReadNotifyIO &io );
     void recycleWriteNotifyIO (
@@ -97,6 +97,109 @@ inline epicsUInt32 dbr_htonl ( const epicsUInt32 & host )
     return tmp;
 }
 
+
+/*
+ * Vectorized byte swapping of arrays on x86 when the host is little
+ * endian with IEEE floating point, where both directions of conversion
+ * of every numeric type are simply a reversal of the bytes of each
+ * element.  The kernel is selected once at load time from the
+ * instruction sets supported by the CPU.  Each kernel converts a
+ * prefix of the array, in place or not, and returns the number of
+ * elements converted, leaving any remainder to the scalar loops below.
+ */
+#if ( defined ( __x86_64__ ) || defined ( __i386__ ) ) && \
+    ( defined ( __clang__ ) || ( defined ( __GNUC__ ) && __GNUC__ >= 5 ) ) && \
+    EPICS_BYTE_ORDER == EPICS_ENDIAN_LITTLE && \
+    EPICS_FLOAT_WORD_ORDER == EPICS_ENDIAN_LITTLE
+#   define CA_CVRT_SIMD
+#endif
+
+typedef arrayElementCount ( * CACVRTSWAPPTR ) (
+    const void *pSrc, void *pDest, unsigned elemSize, arrayElementCount count );
+
+#ifdef CA_CVRT_SIMD
+
+#include <immintrin.h>
+
+/* pshufb masks reversing the bytes of each 2, 4 or 8 byte element */
+static const epicsUInt8 cvrt_swap_mask[3][16] = {
+    { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 },
+    { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 },
+    { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 },
+};
+
+static inline unsigned cvrt_swap_index ( unsigned elemSize )
+{
+    return elemSize == 2u ? 0u : elemSize == 4u ? 1u : 2u;
+}
+
+__attribute__ (( target ( "ssse3" ) ))
+static arrayElementCount cvrt_swap_ssse3 ( const void *s, void *d,
+    unsigned elemSize, arrayElementCount num )
+{
+    const epicsUInt8 *pSrc = (const epicsUInt8 *) s;
+    epicsUInt8 *pDest = (epicsUInt8 *) d;
+    const __m128i mask = _mm_loadu_si128 ( (const __m128i *)
+        cvrt_swap_mask[cvrt_swap_index ( elemSize )] );
+    const arrayElementCount nBytes = num * elemSize & ~(arrayElementCount) 15u;
+
+    for ( arrayElementCount i = 0; i < nBytes; i += 16u ) {
+        __m128i v = _mm_loadu_si128 ( (const __m128i *) ( pSrc + i ) );
+        _mm_storeu_si128 ( (__m128i *) ( pDest + i ),
+            _mm_shuffle_epi8 ( v, mask ) );
+    }
+    return nBytes / elemSize;
+}
+
+__attribute__ (( target ( "avx2" ) ))
+static arrayElementCount cvrt_swap_avx2 ( const void *s, void *d,
+    unsigned elemSize, arrayElementCount num )
+{
+    const epicsUInt8 *pSrc = (const epicsUInt8 *) s;
+    epicsUInt8 *pDest = (epicsUInt8 *) d;
+    const __m256i mask = _mm256_broadcastsi128_si256 ( _mm_loadu_si128 (
+        (const __m128i *) cvrt_swap_mask[cvrt_swap_index ( elemSize )] ) );
+    const arrayElementCount nBytes = num * elemSize & ~(arrayElementCount) 31u;
+
+    for ( arrayElementCount i = 0; i < nBytes; i += 32u ) {
+        __m256i v = _mm256_loadu_si256 ( (const __m256i *) ( pSrc + i ) );
+        _mm256_storeu_si256 ( (__m256i *) ( pDest + i ),
+            _mm256_shuffle_epi8 ( v, mask ) );
+    }
+    return nBytes / elemSize;
+}
+
+static CACVRTSWAPPTR cvrt_swap_select ()
+{
+    __builtin_cpu_init ();
+    if ( __builtin_cpu_supports ( "avx2" ) ) {
+        return cvrt_swap_avx2;
+    }
+    if ( __builtin_cpu_supports ( "ssse3" ) ) {
+        return cvrt_swap_ssse3;
+    }
+    return 0;
+}
+
+static const CACVRTSWAPPTR cvrt_swap_kernel = cvrt_swap_select ();
+
+#endif /* CA_CVRT_SIMD */
+
+/*
+ * Swap the bytes of a prefix of an array of 2, 4 or 8 byte elements,
+ * returning the number of elements converted.
+ */
+static inline arrayElementCount cvrt_swap (
+    const void *pSrc, void *pDest, unsigned elemSize, arrayElementCount num )
+{
+#ifdef CA_CVRT_SIMD
+    if ( cvrt_swap_kernel ) {
+        return ( * cvrt_swap_kernel ) ( pSrc, pDest, elemSize, num );
+    }
+#endif
+    return 0;
+}
+
 /*
  * if hton is true then it is a host to network conversion
  * otherwise vise-versa
@@ -137,13 +240,15 @@ arrayElementCount   num         /* number of values     */
     dbr_short_t         *pSrc = (dbr_short_t *) s;
     dbr_short_t         *pDest = (dbr_short_t *) d;
 
+    arrayElementCount first = cvrt_swap ( pSrc, pDest, 2, num );
+
     if(encode){
-        for(arrayElementCount i=0; i<num; i++){
+        for(arrayElementCount i=first; i<num; i++){
             pDest[i] = dbr_htons( pSrc[i] );
         }
     }
     else {
-        for(arrayElementCount i=0; i<num; i++){
+        for(arrayElementCount i=first; i<num; i++){
             pDest[i] = dbr_ntohs( pSrc[i] );
         }
     }
@@ -187,13 +292,15 @@ arrayElementCount   num         /* number of values     */
     dbr_long_t          *pSrc = (dbr_long_t *) s;
     dbr_long_t          *pDest = (dbr_long_t *) d;
 
+    arrayElementCount first = cvrt_swap ( pSrc, pDest, 4, num );
+
     if(encode){
-        for(arrayElementCount i=0; i<num; i++){
+        for(arrayElementCount i=first; i<num; i++){
             pDest[i] = dbr_htonl( pSrc[i] );
         }
     }
     else {
-        for(arrayElementCount i=0; i<num; i++){
+        for(arrayElementCount i=first; i<num; i++){
             pDest[i] = dbr_ntohl( pSrc[i] );
         }
     }
@@ -216,13 +323,15 @@ arrayElementCount   num         /* number of values     */
     dbr_enum_t          *pSrc = (dbr_enum_t *) s;
     dbr_enum_t          *pDest = (dbr_enum_t *) d;
 
+    arrayElementCount first = cvrt_swap ( pSrc, pDest, 2, num );
+
     if(encode){
-        for(arrayElementCount i=0; i<num; i++){
+        for(arrayElementCount i=first; i<num; i++){
             pDest[i] = dbr_htons ( pSrc[i] );
         }
     }
     else {
-        for(arrayElementCount i=0; i<num; i++){
+        for(arrayElementCount i=first; i<num; i++){
             pDest[i] = dbr_ntohs ( pSrc[i] );
         }
     }
@@ -247,13 +356,15 @@ arrayElementCount   num         /* number of values     */
     const dbr_float_t   *pSrc = (const dbr_float_t *) s;
     dbr_float_t         *pDest = (dbr_float_t *) d;
 
+    arrayElementCount first = cvrt_swap ( pSrc, pDest, 4, num );
+
     if(encode){
-        for(arrayElementCount i=0; i<num; i++){
+        for(arrayElementCount i=first; i<num; i++){
             dbr_htonf ( &pSrc[i], &pDest[i] );
         }
     }
     else{
-        for(arrayElementCount i=0; i<num; i++){
+        for(arrayElementCount i=first; i<num; i++){
             dbr_ntohf ( &pSrc[i], &pDest[i] );
         }
     }
@@ -272,13 +383,15 @@ arrayElementCount   num         /* number of values     */
     dbr_double_t        *pSrc = (dbr_double_t *) s;
     dbr_double_t        *pDest = (dbr_double_t *) d;
 
+    arrayElementCount first = cvrt_swap ( pSrc, pDest, 8, num );
+
     if(encode){
-        for(arrayElementCount i=0; i<num; i++){
+        for(arrayElementCount i=first; i<num; i++){
             dbr_htond ( &pSrc[i], &pDest[i] );
         }
     }
     else{
-        for(arrayElementCount i=0; i<num; i++){
+        for(arrayElementCount i=first; i<num; i++){
             dbr_ntohd( &pSrc[i], &pDest[i] );
         }
     }
@@ -1080,7 +1193,7 @@ arrayElementCount   num         /* number of values     */
         pDest->value = dbr_ntohl(pSrc->value);
     else        /* array chan-- multiple pts */
     {
-        cvrt_long(&pDest->value, &pSrc->value, encode, num);
+        cvrt_long(&pSrc->value, &pDest->value, encode, num);
     }
 }
 
@@ -1300,7 +1413,7 @@ arrayElementCount   num         /* number of values     */
         pDest->value = dbr_ntohl(pSrc->value);
     else        /* array chan-- multiple pts */
     {
-        cvrt_long(&pDest->value, &pSrc->value, encode, num);
+        cvrt_long(&pSrc->value, &pDest->value, encode, num);
     }
 }
 
@@ -0,0 +1,375 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Multiplexed TCP circuits (see tcpMux.h)
+ */
+
+#include <new>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+#  include <sys/epoll.h>
+#  include <sys/eventfd.h>
+#  include <unistd.h>
+#endif
+
+#include "errlog.h"
+
+#include "iocinf.h"
+#include "cac.h"
+#include "virtualCircuit.h"
+#include "tcpMux.h"
+
+#ifdef __linux__
+
+#define CA_MUX_MAX_EVENTS 64
+
+// how often circuits waiting to finish their shutdown are checked
+#define CA_MUX_RETRY_MS 100
+
+tcpMuxThread::tcpMuxThread ( cac & cacIn, cacContextNotify & ctxNotifyIn,
+        int epfdIn, int evfdIn, unsigned priority ) :
+    thread ( *this, "CAC-TCP-io",
+        epicsThreadGetStackSize ( epicsThreadStackBig ), priority ),
+    cacRef ( cacIn ), ctxNotify ( ctxNotifyIn ),
+    pLaborFirst ( 0 ), pLaborLast ( 0 ),
+    epfd ( epfdIn ), evfd ( evfdIn ),
+    nCircuits ( 0u ), exitCmd ( false )
+{
+    struct epoll_event evt;
+    memset ( & evt, 0, sizeof ( evt ) );
+    evt.events = EPOLLIN;
+    evt.data.ptr = 0;
+    if ( epoll_ctl ( this->epfd, EPOLL_CTL_ADD, this->evfd, & evt ) ) {
+        char sockErrBuf[64];
+        epicsSocketConvertErrnoToString (
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAC: epoll_ctl " ERL_ERROR ": %s\n",
+            sockErrBuf );
+    }
+}
+
+tcpMuxThread::~tcpMuxThread ()
+{
+    {
+        epicsGuard < epicsMutex > guard ( this->mutex );
+        this->exitCmd = true;
+    }
+    this->wakeup ();
+    this->thread.exitWait ();
+    close ( this->evfd );
+    close ( this->epfd );
+}
+
+void tcpMuxThread::start ()
+{
+    this->thread.start ();
+}
+
+void tcpMuxThread::wakeup ()
+{
+    epicsUInt64 one = 1u;
+    ssize_t status = write ( this->evfd, & one, sizeof ( one ) );
+    // EAGAIN means that the counter is already non-zero
+    if ( status < 0 && errno != EAGAIN ) {
+        char sockErrBuf[64];
+        epicsSocketConvertErrnoToString (
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAC: I/O thread wakeup " ERL_ERROR ": %s\n",
+            sockErrBuf );
+    }
+}
+
+// may be called by any thread, with or without the primary mutex
+void tcpMuxThread::laborRequest ( tcpiiu & iiu )
+{
+    bool wakeupNeeded = false;
+    {
+        epicsGuard < epicsMutex > guard ( this->mutex );
+        if ( ! iiu.muxQueued ) {
+            iiu.muxQueued = true;
+            iiu.pMuxNext = 0;
+            if ( this->pLaborLast ) {
+                this->pLaborLast->pMuxNext = & iiu;
+            }
+            else {
+                this->pLaborFirst = & iiu;
+                wakeupNeeded = true;
+            }
+            this->pLaborLast = & iiu;
+        }
+    }
+    if ( wakeupNeeded ) {
+        this->wakeup ();
+    }
+}
+
+// called with the primary mutex held
+void tcpMuxThread::watch ( tcpiiu & iiu, bool read, bool write )
+{
+    struct epoll_event evt;
+    memset ( & evt, 0, sizeof ( evt ) );
+    evt.events = ( read ? EPOLLIN : 0u ) | ( write ? EPOLLOUT : 0u );
+    evt.data.ptr = & iiu;
+
+    bool watching = iiu.muxWatchRead || iiu.muxWatchWrite;
+    int op;
+    if ( ! read && ! write ) {
+        op = EPOLL_CTL_DEL;
+    }
+    else if ( watching ) {
+        op = EPOLL_CTL_MOD;
+    }
+    else {
+        op = EPOLL_CTL_ADD;
+    }
+
+    if ( epoll_ctl ( this->epfd, op, iiu.sock, & evt ) ) {
+        char sockErrBuf[64];
+        epicsSocketConvertErrnoToString (
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAC: epoll_ctl " ERL_ERROR ": %s\n",
+            sockErrBuf );
+        return;
+    }
+
+    iiu.muxWatchRead = read;
+    iiu.muxWatchWrite = write;
+
+    epicsGuard < epicsMutex > guard ( this->mutex );
+    if ( op == EPOLL_CTL_ADD ) {
+        this->nCircuits++;
+    }
+    else if ( op == EPOLL_CTL_DEL ) {
+        this->nCircuits--;
+    }
+}
+
+// called by the circuit's destructor
+void tcpMuxThread::remove ( tcpiiu & iiu )
+{
+    if ( iiu.muxWatchRead || iiu.muxWatchWrite ) {
+        epoll_ctl ( this->epfd, EPOLL_CTL_DEL, iiu.sock, 0 );
+        iiu.muxWatchRead = false;
+        iiu.muxWatchWrite = false;
+        epicsGuard < epicsMutex > guard ( this->mutex );
+        this->nCircuits--;
+    }
+
+    epicsGuard < epicsMutex > guard ( this->mutex );
+    if ( iiu.muxQueued ) {
+        tcpiiu * pPrev = 0;
+        tcpiiu * pCur = this->pLaborFirst;
+        while ( pCur && pCur != & iiu ) {
+            pPrev = pCur;
+            pCur = pCur->pMuxNext;
+        }
+        if ( pCur ) {
+            if ( pPrev ) {
+                pPrev->pMuxNext = iiu.pMuxNext;
+            }
+            else {
+                this->pLaborFirst = iiu.pMuxNext;
+            }
+            if ( this->pLaborLast == & iiu ) {
+                this->pLaborLast = pPrev;
+            }
+        }
+        iiu.muxQueued = false;
+    }
+}
+
+void tcpMuxThread::run ()
+{
+    epicsThreadPrivateSet ( caClientCallbackThreadId, this );
+    this->cacRef.attachToClientCtx ();
+
+    struct epoll_event events[CA_MUX_MAX_EVENTS];
+    // circuits waiting to finish their shutdown, these
+    // stay marked as queued so they are not linked twice
+    tcpiiu * pRetry = 0;
+
+    while ( true ) {
+        int nevents = epoll_wait ( this->epfd, events, CA_MUX_MAX_EVENTS,
+            pRetry ? CA_MUX_RETRY_MS : -1 );
+        if ( nevents < 0 ) {
+            if ( errno != EINTR ) {
+                char sockErrBuf[64];
+                epicsSocketConvertErrnoToString (
+                    sockErrBuf, sizeof ( sockErrBuf ) );
+                errlogPrintf ( "CAC: epoll_wait " ERL_ERROR ": %s\n",
+                    sockErrBuf );
+                epicsThreadSleep ( 1.0 );
+            }
+            nevents = 0;
+        }
+
+        // the socket events never destroy a circuit, that
+        // happens only below in muxLabor()
+        for ( int i = 0; i < nevents; i++ ) {
+            tcpiiu * piiu = static_cast < tcpiiu * > ( events[i].data.ptr );
+            if ( ! piiu ) {
+                epicsUInt64 count;
+                if ( read ( this->evfd, & count, sizeof ( count ) ) < 0 &&
+                        errno != EAGAIN ) {
+                    char sockErrBuf[64];
+                    epicsSocketConvertErrnoToString (
+                        sockErrBuf, sizeof ( sockErrBuf ) );
+                    errlogPrintf ( "CAC: I/O thread wakeup " ERL_ERROR ": %s\n",
+                        sockErrBuf );
+                }
+                continue;
+            }
+            unsigned revents = events[i].events;
+            if ( revents & ( EPOLLIN | EPOLLERR | EPOLLHUP ) &&
+                    piiu->muxWatchRead ) {
+                piiu->muxReadable ( this->ctxNotify );
+            }
+            if ( revents & ( EPOLLOUT | EPOLLERR | EPOLLHUP ) &&
+                    piiu->muxWatchWrite ) {
+                piiu->muxWritable ();
+            }
+        }
+
+        tcpiiu * pWork;
+        {
+            epicsGuard < epicsMutex > guard ( this->mutex );
+            if ( this->exitCmd ) {
+                break;
+            }
+            pWork = this->pLaborFirst;
+            this->pLaborFirst = 0;
+            this->pLaborLast = 0;
+            if ( pRetry ) {
+                tcpiiu * pLast = pRetry;
+                while ( pLast->pMuxNext ) {
+                    pLast = pLast->pMuxNext;
+                }
+                pLast->pMuxNext = pWork;
+                pWork = pRetry;
+                pRetry = 0;
+            }
+            for ( tcpiiu * p = pWork; p; p = p->pMuxNext ) {
+                p->muxQueued = false;
+            }
+        }
+
+        while ( pWork ) {
+            tcpiiu & iiu = *pWork;
+            pWork = pWork->pMuxNext;
+            if ( iiu.muxLabor () ) {
+                epicsGuard < epicsMutex > guard ( this->mutex );
+                // unless it was queued again in the meantime
+                if ( ! iiu.muxQueued ) {
+                    iiu.muxQueued = true;
+                    iiu.pMuxNext = pRetry;
+                    pRetry = & iiu;
+                }
+            }
+        }
+    }
+}
+
+void tcpMuxThread::show ( unsigned level ) const
+{
+    epicsGuard < epicsMutex > guard ( this->mutex );
+    char name[64];
+    this->thread.getName ( name, sizeof ( name ) );
+    ::printf ( "I/O thread \"%s\" serving %u circuits\n",
+        name, this->nCircuits );
+    if ( level > 0u ) {
+        ::printf ( "\tepoll fd %d, wakeup fd %d, labor pending %s\n",
+            this->epfd, this->evfd, this->pLaborFirst ? "yes" : "no" );
+    }
+}
+
+tcpMux * tcpMux::create ( cac & cacIn, cacContextNotify & ctxNotifyIn,
+    unsigned nThreadsIn, unsigned priority )
+{
+    tcpMuxThread ** pThreadsIn = new tcpMuxThread * [ nThreadsIn ];
+    unsigned i;
+    for ( i = 0u; i < nThreadsIn; i++ ) {
+        int epfd = epoll_create1 ( EPOLL_CLOEXEC );
+        int evfd = eventfd ( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+        if ( epfd < 0 || evfd < 0 ) {
+            char sockErrBuf[64];
+            epicsSocketConvertErrnoToString (
+                sockErrBuf, sizeof ( sockErrBuf ) );
+            errlogPrintf ( "CAC: unable to create I/O thread because \"%s\"\n",
+                sockErrBuf );
+            if ( epfd >= 0 ) {
+                close ( epfd );
+            }
+            if ( evfd >= 0 ) {
+                close ( evfd );
+            }
+            break;
+        }
+        try {
+            pThreadsIn[i] = new tcpMuxThread ( cacIn, ctxNotifyIn,
+                epfd, evfd, priority );
+        }
+        catch ( ... ) {
+            close ( epfd );
+            close ( evfd );
+            break;
+        }
+        pThreadsIn[i]->start ();
+    }
+
+    if ( i == 0u ) {
+        delete [] pThreadsIn;
+        return 0;
+    }
+    return new tcpMux ( pThreadsIn, i );
+}
+
+#else /* __linux__ */
+
+tcpMuxThread::~tcpMuxThread () {}
+void tcpMuxThread::laborRequest ( tcpiiu & ) {}
+void tcpMuxThread::watch ( tcpiiu &, bool, bool ) {}
+void tcpMuxThread::remove ( tcpiiu & ) {}
+void tcpMuxThread::run () {}
+void tcpMuxThread::show ( unsigned ) const {}
+
+tcpMux * tcpMux::create ( cac &, cacContextNotify &, unsigned, unsigned )
+{
+    return 0;
+}
+
+#endif /* __linux__ */
+
+tcpMux::tcpMux ( tcpMuxThread ** pThreadsIn, unsigned nThreadsIn ) :
+    pThreads ( pThreadsIn ), nThreads ( nThreadsIn ), nextThread ( 0u )
+{
+}
+
+tcpMux::~tcpMux ()
+{
+    for ( unsigned i = 0u; i < this->nThreads; i++ ) {
+        delete this->pThreads[i];
+    }
+    delete [] this->pThreads;
+}
+
+// called with the primary mutex held
+tcpMuxThread & tcpMux::assign ()
+{
+    tcpMuxThread & thr = *this->pThreads[this->nextThread];
+    this->nextThread = ( this->nextThread + 1u ) % this->nThreads;
+    return thr;
+}
+
+void tcpMux::show ( unsigned level ) const
+{
+    for ( unsigned i = 0u; i < this->nThreads; i++ ) {
+        this->pThreads[i]->show ( level );
+    }
+}
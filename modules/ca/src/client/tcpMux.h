@@ -0,0 +1,83 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Multiplexed TCP circuits.
+ *
+ *  Instead of a send and a receive thread for each circuit, a small
+ *  fixed pool of I/O threads each wait with epoll() on the sockets of
+ *  the circuits assigned to them. The sockets are non-blocking. When
+ *  the socket becomes readable the I/O thread receives and processes
+ *  one buffer of messages, exactly as the receive thread would. Send
+ *  labor requested by other threads is queued to the I/O thread which
+ *  flushes the send queue until the socket is full, and then waits for
+ *  it to become writable again.
+ *
+ *  The I/O threads take the callback lock while processing messages,
+ *  so they are only used when preemptive callback is enabled. Name
+ *  server circuits keep their own threads.
+ *
+ *  Enabled by setting EPICS_CA_IO_THREADS to the number of I/O threads.
+ *  Only available on Linux.
+ */
+
+#ifndef INC_tcpMux_H
+#define INC_tcpMux_H
+
+#include "epicsThread.h"
+#include "epicsMutex.h"
+#include "epicsGuard.h"
+
+class cac;
+class cacContextNotify;
+class tcpiiu;
+
+class tcpMuxThread : private epicsThreadRunable {
+public:
+    tcpMuxThread ( cac &, cacContextNotify &,
+        int epfd, int evfd, unsigned priority );
+    ~tcpMuxThread ();
+    void start ();
+    void laborRequest ( tcpiiu & );
+    void watch ( tcpiiu &, bool read, bool write );
+    void remove ( tcpiiu & );
+    void show ( unsigned level ) const;
+private:
+    epicsThread thread;
+    mutable epicsMutex mutex;
+    cac & cacRef;
+    cacContextNotify & ctxNotify;
+    // circuits with send labor pending, linked through tcpiiu::pMuxNext
+    tcpiiu * pLaborFirst;
+    tcpiiu * pLaborLast;
+    int epfd;
+    int evfd;
+    unsigned nCircuits;
+    bool exitCmd;
+    void run ();
+    void wakeup ();
+    tcpMuxThread ( const tcpMuxThread & );
+    tcpMuxThread & operator = ( const tcpMuxThread & );
+};
+
+class tcpMux {
+public:
+    // returns zero if I/O threads are not available on this target
+    static tcpMux * create ( cac &, cacContextNotify &,
+        unsigned nThreads, unsigned priority );
+    ~tcpMux ();
+    tcpMuxThread & assign ();
+    void show ( unsigned level ) const;
+private:
+    tcpMuxThread ** pThreads;
+    unsigned nThreads;
+    unsigned nextThread;
+    tcpMux ( tcpMuxThread ** pThreadsIn, unsigned nThreadsIn );
+    tcpMux ( const tcpMux & );
+    tcpMux & operator = ( const tcpMux & );
+};
+
+#endif // ifndef INC_tcpMux_H
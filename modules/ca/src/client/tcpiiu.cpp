@@ -44,6 +44,7 @@
 #include "epicsSignal.h"
 #include "caerr.h"
 #include "udpiiu.h"
+#include "tcpMux.h"
 
 using namespace std;
 
@@ -91,79 +92,7 @@ void tcpSendThread::run ()
                 break;
             }
 
-            laborPending = false;
-            bool flowControlLaborNeeded =
-                this->iiu.busyStateDetected != this->iiu.flowControlActive;
-            bool echoLaborNeeded = this->iiu.echoRequestPending;
-            this->iiu.echoRequestPending = false;
-
-            if ( flowControlLaborNeeded ) {
-                if ( this->iiu.flowControlActive ) {
-                    this->iiu.disableFlowControlRequest ( guard );
-                    this->iiu.flowControlActive = false;
-                    debugPrintf ( ( "fc off\n" ) );
-                }
-                else {
-                    this->iiu.enableFlowControlRequest ( guard );
-                    this->iiu.flowControlActive = true;
-                    debugPrintf ( ( "fc on\n" ) );
-                }
-            }
-
-            if ( echoLaborNeeded ) {
-                this->iiu.echoRequest ( guard );
-            }
-
-            while ( nciu * pChan = this->iiu.createReqPend.get () ) {
-                this->iiu.createChannelRequest ( *pChan, guard );
-
-                if ( CA_V42 ( this->iiu.minorProtocolVersion ) ) {
-                    this->iiu.createRespPend.add ( *pChan );
-                    pChan->channelNode::listMember =
-                        channelNode::cs_createRespPend;
-                }
-                else {
-                    // This wakes up the resp thread so that it can call
-                    // the connect callback. This isn't maximally efficient
-                    // but it has the excellent side effect of not requiring
-                    // that the UDP thread take the callback lock. There are
-                    // almost no V42 servers left at this point.
-                    this->iiu.v42ConnCallbackPend.add ( *pChan );
-                    pChan->channelNode::listMember =
-                        channelNode::cs_v42ConnCallbackPend;
-                    this->iiu.echoRequestPending = true;
-                    laborPending = true;
-                }
-
-                if ( this->iiu.sendQue.flushBlockThreshold () ) {
-                    laborPending = true;
-                    break;
-                }
-            }
-
-            while ( nciu * pChan = this->iiu.subscripReqPend.get () ) {
-                // this installs any subscriptions as needed
-                pChan->resubscribe ( guard );
-                this->iiu.connectedList.add ( *pChan );
-                pChan->channelNode::listMember =
-                    channelNode::cs_connected;
-                if ( this->iiu.sendQue.flushBlockThreshold () ) {
-                    laborPending = true;
-                    break;
-                }
-            }
-
-            while ( nciu * pChan = this->iiu.subscripUpdateReqPend.get () ) {
-                // this updates any subscriptions as needed
-                pChan->sendSubscriptionUpdateRequests ( guard );
-                this->iiu.connectedList.add ( *pChan );
-                pChan->channelNode::listMember =
-                    channelNode::cs_connected;
-                if ( this->iiu.sendQue.flushBlockThreshold () ) {
-                    laborPending = true;
-                    break;
-                }
-            }
+            this->iiu.sendLabor ( guard, laborPending );
 
             if ( ! this->iiu.sendThreadFlush ( guard ) ) {
                 break;
@@ -202,7 +131,7 @@ void tcpSendThread::run ()
     this->iiu.sendDog.cancel ();
     this->iiu.recvDog.shutdown ();
 
-    while ( ! this->iiu.recvThread.exitWait ( 30.0 ) ) {
+    while ( ! this->iiu.pRecvThread->exitWait ( 30.0 ) ) {
         // it is possible to get stuck here if the user calls
         // ca_context_destroy() when a circuit isn't known to
         // be unresponsive, but is. That situation is probably
@@ -229,6 +158,88 @@ void tcpSendThread::run ()
     this->iiu.cacRef.destroyIIU ( this->iiu );
 }
 
+// send requests for channels and subscriptions waiting
+// for them, shared by the send thread and the I/O threads
+void tcpiiu::sendLabor (
+    epicsGuard < epicsMutex > & guard, bool & laborPending )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+
+    laborPending = false;
+    bool flowControlLaborNeeded =
+        this->busyStateDetected != this->flowControlActive;
+    bool echoLaborNeeded = this->echoRequestPending;
+    this->echoRequestPending = false;
+
+    if ( flowControlLaborNeeded ) {
+        if ( this->flowControlActive ) {
+            this->disableFlowControlRequest ( guard );
+            this->flowControlActive = false;
+            debugPrintf ( ( "fc off\n" ) );
+        }
+        else {
+            this->enableFlowControlRequest ( guard );
+            this->flowControlActive = true;
+            debugPrintf ( ( "fc on\n" ) );
+        }
+    }
+
+    if ( echoLaborNeeded ) {
+        this->echoRequest ( guard );
+    }
+
+    while ( nciu * pChan = this->createReqPend.get () ) {
+        this->createChannelRequest ( *pChan, guard );
+
+        if ( CA_V42 ( this->minorProtocolVersion ) ) {
+            this->createRespPend.add ( *pChan );
+            pChan->channelNode::listMember =
+                channelNode::cs_createRespPend;
+        }
+        else {
+            // This wakes up the resp thread so that it can call
+            // the connect callback. This isn't maximally efficient
+            // but it has the excellent side effect of not requiring
+            // that the UDP thread take the callback lock. There are
+            // almost no V42 servers left at this point.
+            this->v42ConnCallbackPend.add ( *pChan );
+            pChan->channelNode::listMember =
+                channelNode::cs_v42ConnCallbackPend;
+            this->echoRequestPending = true;
+            laborPending = true;
+        }
+
+        if ( this->sendQue.flushBlockThreshold () ) {
+            laborPending = true;
+            break;
+        }
+    }
+
+    while ( nciu * pChan = this->subscripReqPend.get () ) {
+        // this installs any subscriptions as needed
+        pChan->resubscribe ( guard );
+        this->connectedList.add ( *pChan );
+        pChan->channelNode::listMember =
+            channelNode::cs_connected;
+        if ( this->sendQue.flushBlockThreshold () ) {
+            laborPending = true;
+            break;
+        }
+    }
+
+    while ( nciu * pChan = this->subscripUpdateReqPend.get () ) {
+        // this updates any subscriptions as needed
+        pChan->sendSubscriptionUpdateRequests ( guard );
+        this->connectedList.add ( *pChan );
+        pChan->channelNode::listMember =
+            channelNode::cs_connected;
+        if ( this->sendQue.flushBlockThreshold () ) {
+            laborPending = true;
+            break;
+        }
+    }
+}
+
 unsigned tcpiiu::sendBytes ( const void *pBuf,
     unsigned nBytesInBuf, const epicsTime & currentTime )
 {
@@ -263,6 +274,13 @@ unsigned tcpiiu::sendBytes ( const void *pBuf,
                 continue;
             }
 
+            // only the I/O threads use non-blocking sockets, the
+            // watchdog stays armed until the socket is writable again
+            if ( localError == SOCK_EWOULDBLOCK ) {
+                this->muxSendBlocked = true;
+                return 0u;
+            }
+
             if ( localError == SOCK_ENOBUFS ) {
                 errlogPrintf (
                     "CAC: system low on network buffers "
@@ -343,6 +361,14 @@ void tcpiiu::recvBytes (
                 continue;
             }
 
+            // nothing more to read on the non-blocking
+            // socket of an I/O thread
+            if ( localErrno == SOCK_EWOULDBLOCK ) {
+                stat.bytesCopied = 0u;
+                stat.circuitState = swioConnected;
+                return;
+            }
+
             if ( localErrno == SOCK_ENOBUFS ) {
                 errlogPrintf (
                     "CAC: system low on network buffers "
@@ -407,11 +433,11 @@ void tcpRecvThread::exitWait ()
     this->thread.exitWait ();
 }
 
-bool tcpRecvThread::validFillStatus (
+bool tcpiiu::validFillStatus (
     epicsGuard < epicsMutex > & guard, const statusWireIO & stat )
 {
-    if ( this->iiu.state != tcpiiu::iiucs_connected &&
-        this->iiu.state != tcpiiu::iiucs_clean_shutdown ) {
+    if ( this->state != iiucs_connected &&
+        this->state != iiucs_clean_shutdown ) {
         return false;
     }
     if ( stat.circuitState == swioConnected ) {
@@ -419,17 +445,17 @@ bool tcpRecvThread::validFillStatus (
     }
     if ( stat.circuitState == swioPeerHangup ||
         stat.circuitState == swioPeerAbort ) {
-        this->iiu.disconnectNotify ( guard );
+        this->disconnectNotify ( guard );
     }
     else if ( stat.circuitState == swioLinkFailure ) {
-        this->iiu.initiateAbortShutdown ( guard );
+        this->initiateAbortShutdown ( guard );
     }
     else if ( stat.circuitState == swioLocalAbort ) {
         // state change already occurred
     }
     else {
         errlogMessage ( "cac: invalid fill status - disconnecting" );
-        this->iiu.disconnectNotify ( guard );
+        this->disconnectNotify ( guard );
     }
     return false;
 }
@@ -455,121 +481,12 @@ void tcpRecvThread::run ()
             }
         }
 
-        this->iiu.sendThread.start ();
+        this->iiu.pSendThread->start ();
         epicsThreadPrivateSet ( caClientCallbackThreadId, &this->iiu );
         this->iiu.cacRef.attachToClientCtx ();
 
         comBuf * pComBuf = 0;
-        while ( true ) {
-
-            //
-            // We leave the bytes pending and fetch them after
-            // callbacks are enabled when running in the old preemptive
-            // call back disabled mode so that asynchronous wakeup via
-            // file manager call backs works correctly. This does not
-            // appear to impact performance.
-            //
-            if ( ! pComBuf ) {
-                pComBuf = new ( this->iiu.comBufMemMgr ) comBuf;
-            }
-
-            statusWireIO stat;
-            pComBuf->fillFromWire ( this->iiu, stat );
-
-            epicsTime currentTime = epicsTime::getCurrent ();
-
-            {
-                epicsGuard < epicsMutex > guard ( this->iiu.mutex );
-
-                if ( ! this->validFillStatus ( guard, stat ) ) {
-                    break;
-                }
-                if ( stat.bytesCopied == 0u ) {
-                    continue;
-                }
-
-                this->iiu.recvQue.pushLastComBufReceived ( *pComBuf );
-                pComBuf = 0;
-
-                this->iiu._receiveThreadIsBusy = true;
-            }
-
-            bool sendWakeupNeeded = false;
-            {
-                // only one recv thread at a time may call callbacks
-                // - pendEvent() blocks until threads waiting for
-                // this lock get a chance to run
-                callbackManager mgr ( this->ctxNotify, this->cbMutex );
-
-                epicsGuard < epicsMutex > guard ( this->iiu.mutex );
-
-                // route legacy V42 channel connect through the recv thread -
-                // the only thread that should be taking the callback lock
-                while ( nciu * pChan = this->iiu.v42ConnCallbackPend.first () ) {
-                    this->iiu.connectNotify ( guard, *pChan );
-                    pChan->connect ( mgr.cbGuard, guard );
-                }
-
-                this->iiu.unacknowledgedSendBytes = 0u;
-
-                bool protocolOK = false;
-                {
-                    epicsGuardRelease < epicsMutex > unguard ( guard );
-                    // execute receive labor
-                    protocolOK = this->iiu.processIncoming ( currentTime, mgr );
-                }
-
-                if ( ! protocolOK ) {
-                    this->iiu.initiateAbortShutdown ( guard );
-                    break;
-                }
-                this->iiu._receiveThreadIsBusy = false;
-                // reschedule connection activity watchdog
-                this->iiu.recvDog.messageArrivalNotify ( guard );
-                //
-                // if this thread has connected channels with subscriptions
-                // that need to be sent then wakeup the send thread
-                if ( this->iiu.subscripReqPend.count() ) {
-                    sendWakeupNeeded = true;
-                }
-            }
-
-            //
-            // we don't feel comfortable calling this with a lock applied
-            // (it might block for longer than we like)
-            //
-            // we would prefer to improve efficiency by trying, first, a
-            // recv with the new MSG_DONTWAIT flag set, but there isn't
-            // universal support
-            //
-            bool bytesArePending = this->iiu.bytesArePendingInOS ();
-            {
-                epicsGuard < epicsMutex > guard ( this->iiu.mutex );
-                if ( bytesArePending ) {
-                    if ( ! this->iiu.busyStateDetected ) {
-                        this->iiu.contigRecvMsgCount++;
-                        if ( this->iiu.contigRecvMsgCount >=
-                            this->iiu.cacRef.maxContiguousFrames ( guard ) ) {
-                            this->iiu.busyStateDetected = true;
-                            sendWakeupNeeded = true;
-                        }
-                    }
-                }
-                else {
-                    // if no bytes are pending then we must immediately
-                    // switch off flow control w/o waiting for more
-                    // data to arrive
-                    this->iiu.contigRecvMsgCount = 0u;
-                    if ( this->iiu.busyStateDetected ) {
-                        sendWakeupNeeded = true;
-                        this->iiu.busyStateDetected = false;
-                    }
-                }
-            }
-
-            if ( sendWakeupNeeded ) {
-                this->iiu.sendThreadFlushEvent.signal ();
-            }
+        while ( this->iiu.recvLabor ( this->ctxNotify, pComBuf ) ) {
         }
 
         if ( pComBuf ) {
@@ -602,6 +519,124 @@ void tcpRecvThread::run ()
     }
 }
 
+// receive and process one buffer of messages, shared by the receive
+// thread and the I/O threads. Returns false when the circuit stops
+// receiving.
+bool tcpiiu::recvLabor (
+    cacContextNotify & ctxNotify, comBuf * & pComBuf )
+{
+    //
+    // We leave the bytes pending and fetch them after
+    // callbacks are enabled when running in the old preemptive
+    // call back disabled mode so that asynchronous wakeup via
+    // file manager call backs works correctly. This does not
+    // appear to impact performance.
+    //
+    if ( ! pComBuf ) {
+        pComBuf = new ( this->comBufMemMgr ) comBuf;
+    }
+
+    statusWireIO stat;
+    pComBuf->fillFromWire ( *this, stat );
+
+    epicsTime currentTime = epicsTime::getCurrent ();
+
+    {
+        epicsGuard < epicsMutex > guard ( this->mutex );
+
+        if ( ! this->validFillStatus ( guard, stat ) ) {
+            return false;
+        }
+        if ( stat.bytesCopied == 0u ) {
+            return true;
+        }
+
+        this->recvQue.pushLastComBufReceived ( *pComBuf );
+        pComBuf = 0;
+
+        this->_receiveThreadIsBusy = true;
+    }
+
+    bool sendWakeupNeeded = false;
+    {
+        // only one recv thread at a time may call callbacks
+        // - pendEvent() blocks until threads waiting for
+        // this lock get a chance to run
+        callbackManager mgr ( ctxNotify, this->cbMutex );
+
+        epicsGuard < epicsMutex > guard ( this->mutex );
+
+        // route legacy V42 channel connect through the recv thread -
+        // the only thread that should be taking the callback lock
+        while ( nciu * pChan = this->v42ConnCallbackPend.first () ) {
+            this->connectNotify ( guard, *pChan );
+            pChan->connect ( mgr.cbGuard, guard );
+        }
+
+        this->unacknowledgedSendBytes = 0u;
+
+        bool protocolOK = false;
+        {
+            epicsGuardRelease < epicsMutex > unguard ( guard );
+            // execute receive labor
+            protocolOK = this->processIncoming ( currentTime, mgr );
+        }
+
+        if ( ! protocolOK ) {
+            this->initiateAbortShutdown ( guard );
+            return false;
+        }
+        this->_receiveThreadIsBusy = false;
+        // reschedule connection activity watchdog
+        this->recvDog.messageArrivalNotify ( guard );
+        //
+        // if this thread has connected channels with subscriptions
+        // that need to be sent then wakeup the send thread
+        if ( this->subscripReqPend.count() ) {
+            sendWakeupNeeded = true;
+        }
+    }
+
+    //
+    // we don't feel comfortable calling this with a lock applied
+    // (it might block for longer than we like)
+    //
+    // we would prefer to improve efficiency by trying, first, a
+    // recv with the new MSG_DONTWAIT flag set, but there isn't
+    // universal support
+    //
+    bool bytesArePending = this->bytesArePendingInOS ();
+    {
+        epicsGuard < epicsMutex > guard ( this->mutex );
+        if ( bytesArePending ) {
+            if ( ! this->busyStateDetected ) {
+                this->contigRecvMsgCount++;
+                if ( this->contigRecvMsgCount >=
+                    this->cacRef.maxContiguousFrames ( guard ) ) {
+                    this->busyStateDetected = true;
+                    sendWakeupNeeded = true;
+                }
+            }
+        }
+        else {
+            // if no bytes are pending then we must immediately
+            // switch off flow control w/o waiting for more
+            // data to arrive
+            this->contigRecvMsgCount = 0u;
+            if ( this->busyStateDetected ) {
+                sendWakeupNeeded = true;
+                this->busyStateDetected = false;
+            }
+        }
+    }
+
+    if ( sendWakeupNeeded ) {
+        this->sendLaborRequest ();
+    }
+
+    return true;
+}
+
 /*
  * tcpRecvThread::connect ()
  */
@@ -670,16 +705,15 @@ tcpiiu::tcpiiu (
         comBufMemoryManager & comBufMemMgrIn,
         unsigned minorVersion, ipAddrToAsciiEngine & engineIn,
         const cacChannel::priLev & priorityIn,
-        SearchDestTCP * pSearchDestIn ) :
+        SearchDestTCP * pSearchDestIn, tcpMuxThread * pMuxThreadIn ) :
     caServerID ( addrIn.ia, priorityIn ),
     hostNameCacheInstance ( addrIn, engineIn ),
-    recvThread ( *this, cbMutexIn, ctxNotifyIn, "CAC-TCP-recv",
-        epicsThreadGetStackSize ( epicsThreadStackBig ),
-        cac::highestPriorityLevelBelow ( cac.getInitializingThreadsPriority() ) ),
-    sendThread ( *this, "CAC-TCP-send",
-        epicsThreadGetStackSize ( epicsThreadStackMedium ),
-        cac::lowestPriorityLevelAbove (
-            cac.getInitializingThreadsPriority() ) ),
+    pRecvThread ( 0 ),
+    pSendThread ( 0 ),
+    pMuxThread ( pMuxThreadIn ),
+    pMuxNext ( 0 ),
+    pMuxSendBuf ( 0 ),
+    pMuxRecvBuf ( 0 ),
     recvDog ( cbMutexIn, ctxNotifyIn, mutexIn,
         *this, connectionTimeout, timerQueue ),
     sendDog ( cbMutexIn, ctxNotifyIn, mutexIn,
@@ -712,7 +746,15 @@ tcpiiu::tcpiiu (
     recvProcessPostponedFlush ( false ),
     discardingPendingData ( false ),
     socketHasBeenClosed ( false ),
-    unresponsiveCircuit ( false )
+    unresponsiveCircuit ( false ),
+    muxQueued ( false ),
+    muxConnectStarted ( false ),
+    muxWatchRead ( false ),
+    muxWatchWrite ( false ),
+    muxWantWrite ( false ),
+    muxSendBlocked ( false ),
+    muxWriteShut ( false ),
+    muxRecvDone ( false )
 {
     if(!pCurData)
         throw std::bad_alloc();
@@ -813,6 +855,27 @@ tcpiiu::tcpiiu (
     }
 
     memset ( (void *) &this->curMsg, '\0', sizeof ( this->curMsg ) );
+
+    if ( ! this->pMuxThread ) {
+        try {
+            this->pRecvThread = new tcpRecvThread (
+                *this, cbMutexIn, ctxNotifyIn, "CAC-TCP-recv",
+                epicsThreadGetStackSize ( epicsThreadStackBig ),
+                cac::highestPriorityLevelBelow (
+                    cac.getInitializingThreadsPriority() ) );
+            this->pSendThread = new tcpSendThread (
+                *this, "CAC-TCP-send",
+                epicsThreadGetStackSize ( epicsThreadStackMedium ),
+                cac::lowestPriorityLevelAbove (
+                    cac.getInitializingThreadsPriority() ) );
+        }
+        catch ( ... ) {
+            delete this->pRecvThread;
+            epicsSocketDestroy ( this->sock );
+            freeListFree ( this->cacRef.tcpSmallRecvBufFreeList, this->pCurData );
+            throw;
+        }
+    }
 }
 
 // this must always be called by the udp thread when it holds
@@ -821,7 +884,12 @@ void tcpiiu::start (
     epicsGuard < epicsMutex > & guard )
 {
     guard.assertIdenticalMutex ( this->mutex );
-    this->recvThread.start ();
+    if ( this->pMuxThread ) {
+        this->pMuxThread->laborRequest ( *this );
+    }
+    else {
+        this->pRecvThread->start ();
+    }
 }
 
 void tcpiiu::initiateCleanShutdown (
@@ -835,7 +903,7 @@ void tcpiiu::initiateCleanShutdown (
         }
         else {
             this->state = iiucs_clean_shutdown;
-            this->sendThreadFlushEvent.signal ();
+            this->sendLaborRequest ();
             this->flushBlockEvent.signal ();
         }
     }
@@ -854,7 +922,7 @@ void tcpiiu::disconnectNotify (
 {
     guard.assertIdenticalMutex ( this->mutex );
     this->state = iiucs_disconnected;
-    this->sendThreadFlushEvent.signal ();
+    this->sendLaborRequest ();
     this->flushBlockEvent.signal ();
 }
 
@@ -872,7 +940,7 @@ void tcpiiu::responsiveCircuitNotify (
                 channelNode::cs_subscripUpdateReqPend;
             pChan->connect ( cbGuard, guard );
         }
-        this->sendThreadFlushEvent.signal ();
+        this->sendLaborRequest ();
     }
 }
 
@@ -906,7 +974,7 @@ void tcpiiu::unresponsiveCircuitNotify (
     if ( ! this->unresponsiveCircuit ) {
         this->unresponsiveCircuit = true;
         this->echoRequestPending = true;
-        this->sendThreadFlushEvent.signal ();
+        this->sendLaborRequest ();
         this->flushBlockEvent.signal ();
 
         // must not hold lock when canceling timer
@@ -994,8 +1062,10 @@ void tcpiiu::initiateAbortShutdown (
             }
             break;
         case esscimqi_socketSigAlarmRequired:
-            this->recvThread.interruptSocketRecv ();
-            this->sendThread.interruptSocketSend ();
+            if ( this->pRecvThread ) {
+                this->pRecvThread->interruptSocketRecv ();
+                this->pSendThread->interruptSocketSend ();
+            }
             break;
         default:
             break;
@@ -1004,7 +1074,7 @@ void tcpiiu::initiateAbortShutdown (
         //
         // wake up the send thread if it isn't blocking in send()
         //
-        this->sendThreadFlushEvent.signal ();
+        this->sendLaborRequest ();
         this->flushBlockEvent.signal ();
     }
 }
@@ -1018,8 +1088,23 @@ tcpiiu :: ~tcpiiu ()
         this->pSearchDest->disable ();
     }
 
-    this->sendThread.exitWait ();
-    this->recvThread.exitWait ();
+    if ( this->pMuxThread ) {
+        this->pMuxThread->remove ( *this );
+        if ( this->pMuxSendBuf ) {
+            this->pMuxSendBuf->~comBuf ();
+            this->comBufMemMgr.release ( this->pMuxSendBuf );
+        }
+        if ( this->pMuxRecvBuf ) {
+            this->pMuxRecvBuf->~comBuf ();
+            this->comBufMemMgr.release ( this->pMuxRecvBuf );
+        }
+    }
+    else {
+        this->pSendThread->exitWait ();
+        this->pRecvThread->exitWait ();
+        delete this->pSendThread;
+        delete this->pRecvThread;
+    }
     this->sendDog.cancel ();
     this->recvDog.shutdown ();
 
@@ -1059,12 +1144,18 @@ void tcpiiu::show ( unsigned level ) const
     }
     if ( level > 2u ) {
         ::printf ( "\tvirtual circuit socket identifier %d\n", (int)this->sock );
-        ::printf ( "\tsend thread flush signal:\n" );
-        this->sendThreadFlushEvent.show ( level-2u );
-        ::printf ( "\tsend thread:\n" );
-        this->sendThread.show ( level-2u );
-        ::printf ( "\trecv thread:\n" );
-        this->recvThread.show ( level-2u );
+        if ( this->pMuxThread ) {
+            ::printf ( "\tserved by an I/O thread, want write bool=%u\n",
+                this->muxWantWrite );
+        }
+        else {
+            ::printf ( "\tsend thread flush signal:\n" );
+            this->sendThreadFlushEvent.show ( level-2u );
+            ::printf ( "\tsend thread:\n" );
+            this->pSendThread->show ( level-2u );
+            ::printf ( "\trecv thread:\n" );
+            this->pRecvThread->show ( level-2u );
+        }
         ::printf ("\techo pending bool = %u\n", this->echoRequestPending );
         ::printf ( "IO identifier hash table:\n" );
 
@@ -1124,7 +1215,7 @@ bool tcpiiu::setEchoRequestPending ( epicsGuard < epicsMutex > & guard )
     guard.assertIdenticalMutex ( this->mutex );
 
     this->echoRequestPending = true;
-    this->sendThreadFlushEvent.signal ();
+    this->sendLaborRequest ();
     if ( CA_V43 ( this->minorProtocolVersion ) ) {
         // we send an echo
         return true;
@@ -1750,7 +1841,7 @@ unsigned tcpiiu::requestMessageBytesPending (
 #if 0
     if ( ! this->earlyFlush && this->sendQue.flushEarlyThreshold(0u) ) {
         this->earlyFlush = true;
-        this->sendThreadFlushEvent.signal ();
+        this->sendLaborRequest ();
     }
 #endif
     return sendQue.occupiedBytes ();
@@ -1953,7 +2044,7 @@ void tcpiiu::installChannel (
     chan.searchReplySetUp ( *this, sidIn, typeIn, countIn, guard );
     // The tcp send thread runs at a priority below the udp thread
     // so that this will not send small packets
-    this->sendThreadFlushEvent.signal ();
+    this->sendLaborRequest ();
 }
 
 bool tcpiiu :: connectNotify (
@@ -2039,7 +2130,7 @@ int tcpiiu :: printFormated (
 void tcpiiu::flushRequest ( epicsGuard < epicsMutex > & )
 {
     if ( this->sendQue.occupiedBytes () > 0 ) {
-        this->sendThreadFlushEvent.signal ();
+        this->sendLaborRequest ();
     }
 }
 
@@ -2099,6 +2190,321 @@ void tcpSendThread::interruptSocketSend ()
     }
 }
 
+void tcpiiu::sendLaborRequest ()
+{
+    if ( this->pMuxThread ) {
+        this->pMuxThread->laborRequest ( *this );
+    }
+    else {
+        this->sendThreadFlushEvent.signal ();
+    }
+}
+
+//
+// The remainder of the circuit's life cycle when it is served by an
+// I/O thread (see tcpMux.h). The I/O thread calls muxLabor() when the
+// send labor is requested, muxReadable() and muxWritable() when the
+// socket is ready. Only the I/O thread calls these.
+//
+void tcpiiu::muxConnect (
+    epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+
+    this->muxConnectStarted = true;
+
+    osiSockIoctl_t yes = true;
+    if ( socket_ioctl ( this->sock, FIONBIO, & yes ) < 0 ) {
+        char sockErrBuf[64];
+        epicsSocketConvertErrnoToString (
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAC: unable to make socket non-blocking because \"%s\"\n",
+            sockErrBuf );
+        this->disconnectNotify ( guard );
+        return;
+    }
+
+    int status;
+    {
+        epicsGuardRelease < epicsMutex > unguard ( guard );
+        osiSockAddr tmp = this->address ();
+        status = ::connect ( this->sock, & tmp.sa, sizeof ( tmp.sa ) );
+    }
+
+    if ( this->state != iiucs_connecting ) {
+        return;
+    }
+    if ( status >= 0 ) {
+        this->muxConnectNotify ( guard );
+        return;
+    }
+
+    int errnoCpy = SOCKERRNO;
+    if ( errnoCpy == SOCK_EINPROGRESS || errnoCpy == SOCK_EINTR ) {
+        // finished when the socket becomes writable
+        this->muxWatchUpdate ( guard );
+    }
+    else if ( errnoCpy != SOCK_SHUTDOWN ) {
+        char sockErrBuf[64];
+        epicsSocketConvertErrnoToString (
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAC: Unable to connect because \"%s\"\n",
+            sockErrBuf );
+        this->disconnectNotify ( guard );
+    }
+}
+
+void tcpiiu::muxConnectNotify (
+    epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+
+    // put the iiu into the connected state
+    this->state = iiucs_connected;
+    this->recvDog.connectNotify ( guard );
+    this->muxWatchUpdate ( guard );
+}
+
+void tcpiiu::muxWatchUpdate (
+    epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+
+    bool read = false;
+    bool write = false;
+    if ( this->state == iiucs_connecting ) {
+        write = this->muxConnectStarted;
+    }
+    else if ( this->state == iiucs_connected ||
+            this->state == iiucs_clean_shutdown ) {
+        read = ! this->muxRecvDone;
+        write = this->muxWantWrite;
+    }
+    if ( read != this->muxWatchRead || write != this->muxWatchWrite ) {
+        this->pMuxThread->watch ( *this, read, write );
+    }
+}
+
+// like sendThreadFlush(), but a buffer which does not fit into
+// the socket is kept until the socket becomes writable again
+bool tcpiiu::muxFlush ( epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+
+    while ( true ) {
+        comBuf * pBuf = this->pMuxSendBuf;
+        this->pMuxSendBuf = 0;
+        if ( ! pBuf ) {
+            pBuf = this->sendQue.popNextComBufToSend ();
+            if ( ! pBuf ) {
+                break;
+            }
+        }
+
+        unsigned bytesToBeSent = pBuf->occupiedBytes ();
+        bool success = false;
+        {
+            epicsGuardRelease < epicsMutex > unguard ( guard );
+            epicsTime current = epicsTime::getCurrent ();
+            this->muxSendBlocked = false;
+            success = pBuf->flushToWire ( *this, current );
+        }
+
+        if ( ! success && this->muxSendBlocked ) {
+            bytesToBeSent -= pBuf->occupiedBytes ();
+            this->pMuxSendBuf = pBuf;
+            this->muxWantWrite = true;
+        }
+        else {
+            pBuf->~comBuf ();
+            this->comBufMemMgr.release ( pBuf );
+        }
+
+        if ( ! success && ! this->muxSendBlocked ) {
+            while ( ( pBuf = this->sendQue.popNextComBufToSend () ) ) {
+                pBuf->~comBuf ();
+                this->comBufMemMgr.release ( pBuf );
+            }
+            return false;
+        }
+
+        this->unacknowledgedSendBytes += bytesToBeSent;
+        if ( this->unacknowledgedSendBytes >
+            this->socketLibrarySendBufferSize ) {
+            this->recvDog.sendBacklogProgressNotify ( guard );
+        }
+
+        if ( this->muxWantWrite ) {
+            this->muxWatchUpdate ( guard );
+            return true;
+        }
+    }
+
+    this->earlyFlush = false;
+    if ( this->blockingForFlush ) {
+        this->flushBlockEvent.signal ();
+    }
+
+    return true;
+}
+
+void tcpiiu::muxReadable ( cacContextNotify & ctxNotify )
+{
+    bool receiving = false;
+    try {
+        receiving = this->recvLabor ( ctxNotify, this->pMuxRecvBuf );
+    }
+    catch ( std::bad_alloc & ) {
+        errlogPrintf (
+            "CA client library tcp I/O thread "
+            "stopped receiving due to no space in pool "
+            "C++ exception\n" );
+        epicsGuard < epicsMutex > guard ( this->mutex );
+        this->initiateCleanShutdown ( guard );
+    }
+    catch ( std::exception & except ) {
+        errlogPrintf (
+            "CA client library tcp I/O thread "
+            "stopped receiving due to C++ exception \"%s\"\n",
+            except.what () );
+        epicsGuard < epicsMutex > guard ( this->mutex );
+        this->initiateCleanShutdown ( guard );
+    }
+    catch ( ... ) {
+        errlogPrintf (
+            "CA client library tcp I/O thread "
+            "stopped receiving due to a non-standard C++ exception\n" );
+        epicsGuard < epicsMutex > guard ( this->mutex );
+        this->initiateCleanShutdown ( guard );
+    }
+
+    if ( ! receiving ) {
+        epicsGuard < epicsMutex > guard ( this->mutex );
+        this->muxRecvDone = true;
+        this->muxWatchUpdate ( guard );
+        this->sendLaborRequest ();
+    }
+}
+
+void tcpiiu::muxWritable ()
+{
+    epicsGuard < epicsMutex > guard ( this->mutex );
+
+    if ( this->state == iiucs_connecting ) {
+        int errnoCpy = 0;
+        osiSocklen_t len = sizeof ( errnoCpy );
+        int status = getsockopt ( this->sock, SOL_SOCKET, SO_ERROR,
+            reinterpret_cast < char * > ( & errnoCpy ), & len );
+        if ( status < 0 ) {
+            errnoCpy = SOCKERRNO;
+        }
+        if ( errnoCpy == 0 ) {
+            this->muxConnectNotify ( guard );
+        }
+        else {
+            char sockErrBuf[64];
+            epicsSocketConvertErrorToString (
+                sockErrBuf, sizeof ( sockErrBuf ), errnoCpy );
+            errlogPrintf ( "CAC: Unable to connect because \"%s\"\n",
+                sockErrBuf );
+            this->disconnectNotify ( guard );
+        }
+    }
+    else {
+        this->muxWantWrite = false;
+        this->muxWatchUpdate ( guard );
+    }
+    this->sendLaborRequest ();
+}
+
+// Returns true when the I/O thread must call again after a
+// short delay. The circuit is destroyed when it has shut down.
+bool tcpiiu::muxLabor ()
+{
+    {
+        epicsGuard < epicsMutex > guard ( this->mutex );
+
+        if ( this->state == iiucs_connecting ) {
+            if ( ! this->muxConnectStarted ) {
+                this->muxConnect ( guard );
+            }
+            if ( this->state == iiucs_connecting ) {
+                return false;
+            }
+        }
+
+        if ( this->state == iiucs_connected ) {
+            try {
+                bool laborPending = true;
+                while ( laborPending && ! this->muxWantWrite &&
+                        this->state == iiucs_connected ) {
+                    this->sendLabor ( guard, laborPending );
+                    if ( ! this->muxFlush ( guard ) ) {
+                        break;
+                    }
+                }
+            }
+            catch ( ... ) {
+                errlogPrintf (
+                    "cac: tcp I/O thread received an unexpected exception "
+                    "- disconnecting\n");
+                this->initiateAbortShutdown ( guard );
+            }
+            if ( this->state == iiucs_connected ) {
+                return false;
+            }
+        }
+
+        if ( this->state == iiucs_clean_shutdown && ! this->muxWriteShut ) {
+            if ( this->muxWantWrite ) {
+                return false;
+            }
+            if ( this->muxFlush ( guard ) ) {
+                if ( this->muxWantWrite ) {
+                    return false;
+                }
+                // this should cause the server to disconnect from
+                // the client
+                int status = ::shutdown ( this->sock, SHUT_WR );
+                if ( status ) {
+                    char sockErrBuf[64];
+                    epicsSocketConvertErrnoToString (
+                        sockErrBuf, sizeof ( sockErrBuf ) );
+                    errlogPrintf ("CAC TCP clean socket shutdown " ERL_ERROR " was %s\n",
+                        sockErrBuf );
+                }
+                this->muxWriteShut = true;
+                this->muxCloseDeadline = epicsTime::getCurrent () + 30.0;
+            }
+        }
+
+        if ( this->state == iiucs_clean_shutdown && ! this->muxRecvDone ) {
+            // see the comment in tcpSendThread::run()
+            if ( epicsTime::getCurrent () < this->muxCloseDeadline ) {
+                return true;
+            }
+            this->initiateAbortShutdown ( guard );
+        }
+
+        this->muxRecvDone = true;
+        this->muxWatchUpdate ( guard );
+
+        // user threads blocking for send backlog to be reduced
+        // will abort their attempt to get space if
+        // the state of the tcpiiu changes from connected to a
+        // disconnecting state. Nevertheless, we need to wait
+        // for them to finish prior to destroying the IIU.
+        if ( this->blockingForFlush ) {
+            return true;
+        }
+    }
+
+    this->sendDog.cancel ();
+    this->recvDog.shutdown ();
+    this->cacRef.destroyIIU ( *this );
+    return false;
+}
+
 void tcpiiu::operator delete ( void * /* pCadaver */ )
 {
     // Visual C++ .net appears to require operator delete if
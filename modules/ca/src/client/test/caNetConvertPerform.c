@@ -0,0 +1,75 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS Base is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/*
+ *  Measure caNetConvert() of large arrays in both directions.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbDefs.h"
+#include "epicsTime.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#include "db_access.h"
+#include "net_convert.h"
+
+#define NELEM 1000000
+#define NREP 20
+
+static void runBench(unsigned type, void *src, void *dest)
+{
+    size_t size = dbr_size_n(type, NELEM);
+    double best[2][2];
+    int hton, inPlace, rep;
+
+    memset(src, 0x11, size);
+    for (hton = 0; hton < 2; hton++) {
+        for (inPlace = 0; inPlace < 2; inPlace++) {
+            best[hton][inPlace] = 1e9;
+            for (rep = 0; rep < NREP; rep++) {
+                epicsTimeStamp start, stop;
+                double elapsed;
+
+                epicsTimeGetMonotonic(&start);
+                caNetConvert(type, src, inPlace ? src : dest, hton, NELEM);
+                epicsTimeGetMonotonic(&stop);
+                elapsed = epicsTimeDiffInSeconds(&stop, &start);
+                if (elapsed < best[hton][inPlace])
+                    best[hton][inPlace] = elapsed;
+            }
+        }
+    }
+    testDiag("%-16s hton %7.1f / %7.1f, ntoh %7.1f / %7.1f M elements/s",
+        dbr_type_to_text(type),
+        NELEM / best[1][0] * 1e-6, NELEM / best[1][1] * 1e-6,
+        NELEM / best[0][0] * 1e-6, NELEM / best[0][1] * 1e-6);
+}
+
+MAIN(caNetConvertPerform)
+{
+    static const unsigned types[] = {
+        DBR_SHORT, DBR_LONG, DBR_FLOAT, DBR_DOUBLE,
+        DBR_TIME_SHORT, DBR_TIME_LONG, DBR_TIME_FLOAT, DBR_TIME_DOUBLE,
+    };
+    size_t maxSize = dbr_size_n(DBR_TIME_DOUBLE, NELEM);
+    void *src = malloc(maxSize);
+    void *dest = malloc(maxSize);
+    unsigned i;
+
+    testPlan(0);
+
+    if (!src || !dest)
+        testAbort("Out of memory");
+
+    testDiag("%d elements, best of %d, copy / in place", NELEM, NREP);
+    for (i = 0; i < NELEMENTS(types); i++)
+        runBench(types[i], src, dest);
+
+    free(src);
+    free(dest);
+    return testDone();
+}
@@ -0,0 +1,151 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS Base is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/*
+ *  Check caNetConvert() of arrays, which may use vectorized byte
+ *  swapping, against conversion of one element at a time.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbDefs.h"
+#include "epicsEndian.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#include "db_access.h"
+#include "net_convert.h"
+
+static const arrayElementCount counts[] = {
+    1, 2, 3, 7, 8, 9, 15, 16, 17, 33, 1000, 1001
+};
+#define MAX_COUNT 1001
+
+/* No byte is 0x7f or above, so no float value is a NaN */
+static void fillRandom(epicsUInt8 *buf, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++)
+        buf[i] = (epicsUInt8) (rand() % 0x70);
+}
+
+/* The first element with the rest of the structure,
+ * then each further element on its own.
+ */
+static void convertEach(unsigned type, const epicsUInt8 *src,
+    epicsUInt8 *dest, int hton, arrayElementCount count)
+{
+    unsigned basic = type % (LAST_TYPE + 1);
+    size_t offset = dbr_value_offset[type];
+    size_t size = dbr_value_size[type];
+    arrayElementCount i;
+
+    caNetConvert(type, src, dest, hton, 1);
+    for (i = 1; i < count; i++)
+        caNetConvert(basic, src + offset + i * size,
+            dest + offset + i * size, hton, 1);
+}
+
+static void testType(unsigned type, epicsUInt8 *src, epicsUInt8 *expect,
+    epicsUInt8 *actual)
+{
+    unsigned i, nfail = 0;
+    int hton, inPlace;
+
+    for (i = 0; i < NELEMENTS(counts); i++) {
+        arrayElementCount count = counts[i];
+        size_t size = dbr_size_n(type, count);
+
+        for (hton = 0; hton < 2; hton++) {
+            for (inPlace = 0; inPlace < 2; inPlace++) {
+                fillRandom(src, size);
+                if (inPlace) {
+                    memcpy(expect, src, size);
+                    memcpy(actual, src, size);
+                    convertEach(type, expect, expect, hton, count);
+                    caNetConvert(type, actual, actual, hton, count);
+                }
+                else {
+                    memset(expect, 0xaa, size);
+                    memset(actual, 0xaa, size);
+                    convertEach(type, src, expect, hton, count);
+                    caNetConvert(type, src, actual, hton, count);
+                }
+                if (memcmp(expect, actual, size)) {
+                    testDiag("%s count %lu %s %s differs",
+                        dbr_type_to_text(type), count,
+                        hton ? "hton" : "ntoh",
+                        inPlace ? "in place" : "copy");
+                    nfail++;
+                }
+            }
+        }
+    }
+    testOk(nfail == 0, "%s", dbr_type_to_text(type));
+}
+
+static void testWireFormat(void)
+{
+    dbr_double_t dbl[MAX_COUNT];
+    dbr_long_t lng[MAX_COUNT];
+    dbr_short_t shrt[MAX_COUNT];
+    static const epicsUInt8 one[8] = {0x3f, 0xf0, 0, 0, 0, 0, 0, 0};
+    static const epicsUInt8 lngBytes[4] = {0x01, 0x02, 0x03, 0x04};
+    static const epicsUInt8 shrtBytes[2] = {0x01, 0x02};
+    unsigned i, nbad = 0;
+
+    testDiag("Network byte order of arrays");
+
+    for (i = 0; i < MAX_COUNT; i++) {
+        dbl[i] = 1.0;
+        lng[i] = 0x01020304;
+        shrt[i] = 0x0102;
+    }
+    caNetConvert(DBR_DOUBLE, dbl, dbl, 1, MAX_COUNT);
+    caNetConvert(DBR_LONG, lng, lng, 1, MAX_COUNT);
+    caNetConvert(DBR_SHORT, shrt, shrt, 1, MAX_COUNT);
+    for (i = 0; i < MAX_COUNT; i++)
+        nbad += memcmp(&dbl[i], one, sizeof(one)) != 0;
+    testOk(nbad == 0, "DBR_DOUBLE 1.0 is 3ff0000000000000 (%u wrong)", nbad);
+    for (i = 0, nbad = 0; i < MAX_COUNT; i++)
+        nbad += memcmp(&lng[i], lngBytes, sizeof(lngBytes)) != 0;
+    testOk(nbad == 0, "DBR_LONG 0x01020304 is 01020304 (%u wrong)", nbad);
+    for (i = 0, nbad = 0; i < MAX_COUNT; i++)
+        nbad += memcmp(&shrt[i], shrtBytes, sizeof(shrtBytes)) != 0;
+    testOk(nbad == 0, "DBR_SHORT 0x0102 is 0102 (%u wrong)", nbad);
+
+    caNetConvert(DBR_DOUBLE, dbl, dbl, 0, MAX_COUNT);
+    for (i = 0, nbad = 0; i < MAX_COUNT; i++)
+        nbad += dbl[i] != 1.0;
+    testOk(nbad == 0, "DBR_DOUBLE round trip (%u wrong)", nbad);
+}
+
+MAIN(caNetConvertTest)
+{
+    size_t maxSize = dbr_size_n(DBR_CTRL_DOUBLE, MAX_COUNT) +
+        MAX_STRING_SIZE * MAX_COUNT;
+    epicsUInt8 *src = malloc(maxSize);
+    epicsUInt8 *expect = malloc(maxSize);
+    epicsUInt8 *actual = malloc(maxSize);
+    unsigned type;
+
+    testPlan(DBR_CTRL_DOUBLE + 1 + 4);
+
+    if (!src || !expect || !actual)
+        testAbort("Out of memory");
+    srand(1);
+
+    testDiag("Arrays against one element at a time");
+    for (type = DBR_STRING; type <= DBR_CTRL_DOUBLE; type++)
+        testType(type, src, expect, actual);
+
+    testWireFormat();
+
+    free(src);
+    free(expect);
+    free(actual);
+    return testDone();
+}
@@ -0,0 +1,173 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS Base is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/*
+ *  Flood a CA server on this host with UDP search requests and
+ *  measure how many replies per second it returns.
+ *
+ *  Start an IOC on the loopback interface first, and give the name
+ *  of one of its records as the argument. The server does not reply
+ *  to UDP searches for names it does not have. The requests are sent from several sockets as the server combines
+ *  consecutive replies to the same address into one datagram.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbDefs.h"
+#include "envDefs.h"
+#include "epicsTime.h"
+#include "epicsUnitTest.h"
+#include "osiSock.h"
+#include "testMain.h"
+
+#include "caProto.h"
+
+#define NCLIENTS 16     /* sockets, so that replies go to several addresses */
+#define WINDOW 8        /* requests in flight per socket */
+#define DURATION 5.0    /* sec */
+#define MINOR_VERSION 13u /* CA_MINOR_PROTOCOL_REVISION from nciu.h */
+
+typedef struct {
+    caHdr version;
+    caHdr search;
+    char name[64];
+} searchRequest;
+
+static void sendSearch(SOCKET sock, const osiSockAddr *pAddr,
+    searchRequest *pReq, epicsUInt32 id)
+{
+    int size = 2 * sizeof(caHdr) + ntohs(pReq->search.m_postsize);
+
+    pReq->search.m_cid = htonl(id);
+    pReq->search.m_available = htonl(id);
+    if (sendto(sock, (char *) pReq, size, 0,
+            &pAddr->sa, sizeof(pAddr->sa)) != size)
+        testDiag("sendto() failed");
+}
+
+/* returns the number of search or not found replies in the datagram */
+static unsigned countReplies(const char *pBuf, int size)
+{
+    unsigned n = 0u;
+
+    while (size >= (int) sizeof(caHdr)) {
+        const caHdr *pHdr = (const caHdr *) pBuf;
+        unsigned cmd = ntohs(pHdr->m_cmmd);
+        int msgSize = sizeof(caHdr) + ntohs(pHdr->m_postsize);
+
+        if (cmd == CA_PROTO_SEARCH || cmd == CA_PROTO_NOT_FOUND)
+            n++;
+        pBuf += msgSize;
+        size -= msgSize;
+    }
+    return n;
+}
+
+MAIN(caSearchPerform)
+{
+    searchRequest req;
+    osiSockAddr addr;
+    SOCKET sock[NCLIENTS];
+    SOCKET maxSock = 0;
+    epicsTimeStamp start, now;
+    epicsUInt32 id = 0u;
+    unsigned long nSent = 0u, nReplies = 0u, nDatagrams = 0u, nStalls = 0u;
+    double elapsed = 0.0;
+    char buf[MAX_UDP_RECV];
+    unsigned i, j;
+
+    testPlan(0);
+
+    if (argc != 2 || strlen(argv[1]) >= sizeof(req.name)) {
+        testDiag("Usage: caSearchPerform <record name>");
+        return testDone();
+    }
+
+    osiSockAttach();
+
+    memset(&addr, 0, sizeof(addr));
+    addr.ia.sin_family = AF_INET;
+    addr.ia.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.ia.sin_port = htons(envGetInetPortConfigParam(
+        &EPICS_CA_SERVER_PORT, (unsigned short) CA_SERVER_PORT));
+
+    for (j = 0; j < NCLIENTS; j++) {
+        sock[j] = epicsSocketCreate(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sock[j] == INVALID_SOCKET)
+            testAbort("Can't create UDP socket");
+        if (sock[j] > maxSock)
+            maxSock = sock[j];
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.version.m_cmmd = htons(CA_PROTO_VERSION);
+    req.version.m_count = htons(MINOR_VERSION);
+    req.search.m_cmmd = htons(CA_PROTO_SEARCH);
+    req.search.m_postsize = htons((strlen(argv[1]) + 8u) & ~7u);
+    req.search.m_dataType = htons(DOREPLY);
+    req.search.m_count = htons(MINOR_VERSION);
+    strcpy(req.name, argv[1]);
+
+    testDiag("Searching port %u of 127.0.0.1 for '%s' for %.0f sec, "
+        "%d sockets with %d in flight each",
+        ntohs(addr.ia.sin_port), req.name, DURATION, NCLIENTS, WINDOW);
+
+    epicsTimeGetMonotonic(&start);
+    for (j = 0; j < NCLIENTS; j++)
+        for (i = 0; i < WINDOW; i++, nSent++)
+            sendSearch(sock[j], &addr, &req, id++);
+
+    while (elapsed < DURATION) {
+        struct timeval timeout;
+        fd_set readable;
+        int status;
+
+        FD_ZERO(&readable);
+        for (j = 0; j < NCLIENTS; j++)
+            FD_SET(sock[j], &readable);
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 100000;
+        status = select(maxSock + 1, &readable, NULL, NULL, &timeout);
+        if (status > 0) {
+            unsigned n[NCLIENTS];
+
+            for (j = 0; j < NCLIENTS; j++) {
+                n[j] = 0u;
+                if (!FD_ISSET(sock[j], &readable))
+                    continue;
+                status = recv(sock[j], buf, sizeof(buf), 0);
+                if (status <= 0)
+                    continue;
+                nDatagrams++;
+                n[j] = countReplies(buf, status);
+                nReplies += n[j];
+            }
+            /* one new request for each reply keeps the windows full */
+            for (j = 0; j < NCLIENTS; j++)
+                for (i = 0; i < n[j]; i++, nSent++)
+                    sendSearch(sock[j], &addr, &req, id++);
+        }
+        else if (status == 0) {
+            /* requests or replies were dropped, refill the windows */
+            nStalls++;
+            for (j = 0; j < NCLIENTS; j++)
+                for (i = 0; i < WINDOW; i++, nSent++)
+                    sendSearch(sock[j], &addr, &req, id++);
+        }
+        epicsTimeGetMonotonic(&now);
+        elapsed = epicsTimeDiffInSeconds(&now, &start);
+    }
+
+    testDiag("%lu requests, %lu replies in %lu datagrams, %lu stalls",
+        nSent, nReplies, nDatagrams, nStalls);
+    testDiag("%.0f replies/s", nReplies / elapsed);
+    if (nReplies == 0u)
+        testDiag("No replies, is an IOC with that record running on this host?");
+
+    for (j = 0; j < NCLIENTS; j++)
+        epicsSocketDestroy(sock[j]);
+    osiSockRelease();
+    return testDone();
+}
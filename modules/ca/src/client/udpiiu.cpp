@@ -25,6 +25,11 @@
 
 #define epicsAssertAuthor "Jeff Hill johill@lanl.gov"
 
+#ifdef __linux__
+#   include <sys/mman.h>
+#   include <sys/socket.h>
+#endif
+
 #include "envDefs.h"
 #include "dbDefs.h"
 #include "osiProcess.h"
@@ -147,6 +152,10 @@ udpiiu::udpiiu (
     repeaterPort ( 0 ),
     serverPort ( port ),
     localPort ( 0 ),
+    nRecvCalls ( 0u ),
+    nRecvDatagrams ( 0u ),
+    nSendCalls ( 0u ),
+    nSendDatagrams ( 0u ),
     shutdownCmd ( false ),
     lastReceivedSeqNoIsValid ( false )
 {
@@ -403,12 +412,49 @@ void udpRecvThread::run ()
             this->iiu.cacRef, ECA_NOSEARCHADDR, NULL );
     }
 
+#ifdef __linux__
+    // Receive all of the datagrams already queued to the socket with one
+    // system call.  Each of them may be as large as MAX_UDP_RECV.  The
+    // buffers for the 2nd and later ones are mapped rather than allocated,
+    // so only the pages which datagrams are received into take up memory.
+    const size_t batchBufSize = ( udpBatchSize - 1u ) * MAX_UDP_RECV;
+    void * pBatchBuf = mmap ( NULL, batchBufSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    // one at a time without them
+    const unsigned batchSize = pBatchBuf != MAP_FAILED ? udpBatchSize : 1u;
+    osiSockAddr src [udpBatchSize];
+    struct iovec iov [udpBatchSize];
+    struct mmsghdr msgs [udpBatchSize];
+    for ( unsigned i = 0u; i < batchSize; i++ ) {
+        if ( i == 0u ) {
+            iov[i].iov_base = this->iiu.recvBuf;
+        }
+        else {
+            iov[i].iov_base = static_cast < char * > ( pBatchBuf ) +
+                ( i - 1u ) * MAX_UDP_RECV;
+        }
+        iov[i].iov_len = MAX_UDP_RECV;
+    }
+#endif
+
     do {
+#ifdef __linux__
+        for ( unsigned i = 0u; i < batchSize; i++ ) {
+            memset ( & msgs[i], 0, sizeof ( msgs[i] ) );
+            msgs[i].msg_hdr.msg_name = & src[i].sa;
+            msgs[i].msg_hdr.msg_namelen = sizeof ( src[i] );
+            msgs[i].msg_hdr.msg_iov = & iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int status = recvmmsg ( this->iiu.sock, msgs, batchSize,
+            MSG_WAITFORONE, 0 );
+#else
         osiSockAddr src;
         osiSocklen_t src_size = sizeof ( src );
         int status = recvfrom ( this->iiu.sock,
             this->iiu.recvBuf, sizeof ( this->iiu.recvBuf ), 0,
             & src.sa, & src_size );
+#endif
 
         if ( status <= 0 ) {
 
@@ -434,11 +480,43 @@ void udpRecvThread::run ()
             }
         }
         else if ( status > 0 ) {
+#ifdef __linux__
+            {
+                epicsGuard < epicsMutex > guard ( this->iiu.cacMutex );
+                this->iiu.nRecvCalls++;
+                this->iiu.nRecvDatagrams += status;
+            }
+            epicsTime currentTime = epicsTime::getCurrent();
+            for ( int i = 0; i < status; i++ ) {
+                if ( msgs[i].msg_hdr.msg_flags & MSG_TRUNC ) {
+                    char buf[64];
+                    sockAddrToDottedIP ( &src[i].sa, buf, sizeof ( buf ) );
+                    errlogPrintf ( "CAC: oversize UDP datagram from %s ignored\n",
+                        buf );
+                    continue;
+                }
+                this->iiu.postMsg ( src[i],
+                    static_cast < char * > ( iov[i].iov_base ),
+                    (arrayElementCount) msgs[i].msg_len, currentTime );
+            }
+#else
+            {
+                epicsGuard < epicsMutex > guard ( this->iiu.cacMutex );
+                this->iiu.nRecvCalls++;
+                this->iiu.nRecvDatagrams++;
+            }
             this->iiu.postMsg ( src, this->iiu.recvBuf,
                 (arrayElementCount) status, epicsTime::getCurrent() );
+#endif
         }
 
     } while ( ! this->iiu.shutdownCmd );
+
+#ifdef __linux__
+    if ( pBatchBuf != MAP_FAILED ) {
+        munmap ( pBatchBuf, batchBufSize );
+    }
+#endif
 }
 
 /* for sunpro compiler */
@@ -973,13 +1051,9 @@ void udpiiu :: SearchDestUDP :: searchRequest (
         int status = sendto ( _udpiiu.sock, const_cast<char *>(pBuf), bufSizeAsInt, 0,
                 & _destAddr.sa, sizeof ( _destAddr.sa ) );
         if ( status == bufSizeAsInt ) {
-            if ( _lastError ) {
-                char buf[64];
-                sockAddrToDottedIP ( &_destAddr.sa, buf, sizeof ( buf ) );
-                errlogPrintf (
-                    "CAC: ok sending UDP msg to %s\n", buf);
-            }
-            _lastError = 0;
+            _udpiiu.nSendCalls++;
+            _udpiiu.nSendDatagrams++;
+            this->searchRequestSent ( guard );
             break;
         }
         if ( status >= 0 ) {
@@ -1025,6 +1099,24 @@ void udpiiu :: SearchDestUDP :: searchRequest (
     }
 }
 
+void udpiiu :: SearchDestUDP :: searchRequestSent (
+            epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( _udpiiu.cacMutex );
+    if ( _lastError ) {
+        char buf[64];
+        sockAddrToDottedIP ( &_destAddr.sa, buf, sizeof ( buf ) );
+        errlogPrintf (
+            "CAC: ok sending UDP msg to %s\n", buf);
+    }
+    _lastError = 0;
+}
+
+const osiSockAddr & udpiiu :: SearchDestUDP :: destAddr () const
+{
+    return _destAddr;
+}
+
 void udpiiu :: SearchDestUDP :: show (
     epicsGuard < epicsMutex > & guard, unsigned level ) const
 {
@@ -1124,12 +1216,29 @@ bool udpiiu :: datagramFlush (
         return false;
     }
 
+    // UDP destinations are sent the same datagram in batches
+    SearchDestUDP * pBatch [udpBatchSize];
+    unsigned nBatch = 0u;
     tsDLIter < SearchDest > iter ( _searchDestList.firstIter () );
     while ( iter.valid () )
     {
-        iter->searchRequest ( guard, this->xmitBuf, this->nBytesInXmitBuf );
+        SearchDestUDP * pUDP =
+            dynamic_cast < SearchDestUDP * > ( iter.pointer () );
+        if ( pUDP ) {
+            pBatch[nBatch++] = pUDP;
+            if ( nBatch >= udpBatchSize ) {
+                this->searchBatchSend ( guard, pBatch, nBatch );
+                nBatch = 0u;
+            }
+        }
+        else {
+            iter->searchRequest ( guard, this->xmitBuf, this->nBytesInXmitBuf );
+        }
         iter++;
     }
+    if ( nBatch ) {
+        this->searchBatchSend ( guard, pBatch, nBatch );
+    }
 
     this->nBytesInXmitBuf = 0u;
 
@@ -1138,6 +1247,48 @@ bool udpiiu :: datagramFlush (
     return true;
 }
 
+/*
+ * Send the search datagram to several UDP destinations. On Linux this
+ * is one sendmmsg () call, and any destinations which it did not reach
+ * are retried one at a time so that errors are reported as usual.
+ */
+void udpiiu :: searchBatchSend (
+    epicsGuard < epicsMutex > & guard, SearchDestUDP * pDest [],
+    unsigned nDest )
+{
+    guard.assertIdenticalMutex ( cacMutex );
+    unsigned nSent = 0u;
+#ifdef __linux__
+    if ( nDest > 1u ) {
+        struct iovec iov;
+        iov.iov_base = this->xmitBuf;
+        iov.iov_len = this->nBytesInXmitBuf;
+        struct mmsghdr msgs [udpBatchSize];
+        for ( unsigned i = 0u; i < nDest; i++ ) {
+            memset ( & msgs[i], 0, sizeof ( msgs[i] ) );
+            msgs[i].msg_hdr.msg_name = const_cast < sockaddr * >
+                ( & pDest[i]->destAddr ().sa );
+            msgs[i].msg_hdr.msg_namelen = sizeof ( pDest[i]->destAddr ().sa );
+            msgs[i].msg_hdr.msg_iov = & iov;
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int status = sendmmsg ( this->sock, msgs, nDest, 0 );
+        if ( status > 0 ) {
+            this->nSendCalls++;
+            this->nSendDatagrams += status;
+            while ( nSent < static_cast < unsigned > ( status ) &&
+                    msgs[nSent].msg_len == this->nBytesInXmitBuf ) {
+                pDest[nSent]->searchRequestSent ( guard );
+                nSent++;
+            }
+        }
+    }
+#endif
+    for ( unsigned i = nSent; i < nDest; i++ ) {
+        pDest[i]->searchRequest ( guard, this->xmitBuf, this->nBytesInXmitBuf );
+    }
+}
+
 void udpiiu :: show ( unsigned level ) const
 {
     epicsGuard < epicsMutex > guard ( this->cacMutex );
@@ -1146,6 +1297,10 @@ void udpiiu :: show ( unsigned level ) const
     if ( level > 1u ) {
         ::printf ("\trepeater port %u\n", this->repeaterPort );
         ::printf ("\tdefault server port %u\n", this->serverPort );
+        ::printf ("\t%lu datagrams received by %lu calls, "
+            "%lu sent by %lu calls\n",
+            this->nRecvDatagrams, this->nRecvCalls,
+            this->nSendDatagrams, this->nSendCalls );
         ::printf ( "Search Destination List with %u items\n",
             _searchDestList.count () );
         if ( level > 2u ) {
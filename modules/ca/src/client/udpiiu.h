@@ -88,6 +88,9 @@ static const double maxSearchPeriodDefault = 5.0 * 60.0; // seconds
 static const double maxSearchPeriodLowerLimit = 60.0; // seconds
 static const double beaconAnomalySearchPeriod = 5.0; // seconds
 
+// maximum datagrams moved by one recvmmsg () or sendmmsg () call
+static const unsigned udpBatchSize = 16u;
+
 class udpiiu :
     private netiiu,
     private searchTimerNotify,
@@ -123,6 +126,8 @@ private:
         SearchDestUDP ( const osiSockAddr &, udpiiu & );
         void searchRequest (
             epicsGuard < epicsMutex > &, const char * pBuf, size_t bufLen );
+        void searchRequestSent ( epicsGuard < epicsMutex > & );
+        const osiSockAddr & destAddr () const;
         void show (
             epicsGuard < epicsMutex > &, unsigned level ) const;
     private:
@@ -189,6 +194,11 @@ private:
     ca_uint16_t repeaterPort;
     ca_uint16_t serverPort;
     ca_uint16_t localPort;
+    // datagrams per system call statistics, guarded by cacMutex
+    unsigned long nRecvCalls;
+    unsigned long nRecvDatagrams;
+    unsigned long nSendCalls;
+    unsigned long nSendDatagrams;
     bool shutdownCmd;
     bool lastReceivedSeqNoIsValid;
 
@@ -299,6 +309,9 @@ private:
         epicsGuard < epicsMutex > &, nciu & chan, unsigned index );
     bool datagramFlush (
         epicsGuard < epicsMutex > &, const epicsTime & currentTime );
+    void searchBatchSend (
+        epicsGuard < epicsMutex > &, SearchDestUDP * pDest [],
+        unsigned nDest );
     ca_uint32_t datagramSeqNumber (
         epicsGuard < epicsMutex > & ) const;
 
@@ -40,6 +40,7 @@
 #include "compilerDependencies.h"
 
 class callbackManager;
+class tcpMuxThread;
 
 // a modified ca header with capacity for large arrays
 struct caHdrLargeArray {
@@ -72,9 +73,6 @@ private:
     void run ();
     void connect (
         epicsGuard < epicsMutex > & guard );
-    bool validFillStatus (
-        epicsGuard < epicsMutex > & guard,
-        const statusWireIO & stat );
 };
 
 class tcpSendThread : private epicsThreadRunable {
@@ -120,7 +118,8 @@ public:
         cacContextNotify &, double connectionTimeout, epicsTimerQueue & timerQueue,
         const osiSockAddr & addrIn, comBufMemoryManager &, unsigned minorVersion,
         ipAddrToAsciiEngine & engineIn, const cacChannel::priLev & priorityIn,
-        SearchDestTCP * pSearchDestIn = NULL);
+        SearchDestTCP * pSearchDestIn = NULL,
+        tcpMuxThread * pMuxThreadIn = NULL );
     ~tcpiiu ();
     void start (
         epicsGuard < epicsMutex > & );
@@ -206,8 +205,15 @@ public:
 
 private:
     hostNameCache hostNameCacheInstance;
-    tcpRecvThread recvThread;
-    tcpSendThread sendThread;
+    // zero when the circuit is served by an I/O thread
+    tcpRecvThread * pRecvThread;
+    tcpSendThread * pSendThread;
+    // zero when the circuit has its own send and receive threads
+    tcpMuxThread * pMuxThread;
+    tcpiiu * pMuxNext; // protected by the I/O thread's mutex
+    comBuf * pMuxSendBuf; // partially sent when the socket filled up
+    comBuf * pMuxRecvBuf;
+    epicsTime muxCloseDeadline;
     tcpRecvWatchdog recvDog;
     tcpSendWatchdog sendDog;
     comQueSend sendQue;
@@ -257,6 +263,15 @@ private:
     bool discardingPendingData;
     bool socketHasBeenClosed;
     bool unresponsiveCircuit;
+    // only modified by the I/O thread
+    bool muxQueued; // protected by the I/O thread's mutex
+    bool muxConnectStarted;
+    bool muxWatchRead;
+    bool muxWatchWrite;
+    bool muxWantWrite;
+    bool muxSendBlocked;
+    bool muxWriteShut;
+    bool muxRecvDone;
 
     bool processIncoming (
         const epicsTime & currentTime, callbackManager & );
@@ -278,6 +293,14 @@ private:
     void disconnectNotify (
         epicsGuard < epicsMutex > & );
     bool bytesArePendingInOS () const;
+    void sendLaborRequest ();
+    void sendLabor (
+        epicsGuard < epicsMutex > &, bool & laborPending );
+    bool recvLabor (
+        cacContextNotify &, comBuf * & pComBuf );
+    bool validFillStatus (
+        epicsGuard < epicsMutex > & guard,
+        const statusWireIO & stat );
     void decrementBlockingForFlushCount (
         epicsGuard < epicsMutex > & guard );
     bool isNameService () const;
@@ -322,6 +345,19 @@ private:
     bool sendThreadFlush (
         epicsGuard < epicsMutex > & );
 
+    // I/O thread labor (see tcpMux.h)
+    void muxConnect (
+        epicsGuard < epicsMutex > & );
+    void muxConnectNotify (
+        epicsGuard < epicsMutex > & );
+    bool muxFlush (
+        epicsGuard < epicsMutex > & );
+    void muxWatchUpdate (
+        epicsGuard < epicsMutex > & );
+    void muxReadable ( cacContextNotify & );
+    void muxWritable ();
+    bool muxLabor ();
+
     // netiiu stubs
     void uninstallChanDueToSuccessfulSearchResponse (
         epicsGuard < epicsMutex > &, nciu &, const class epicsTime & );
@@ -331,6 +367,7 @@ private:
 
     friend class tcpRecvThread;
     friend class tcpSendThread;
+    friend class tcpMuxThread;
 
     tcpiiu ( const tcpiiu & );
     tcpiiu & operator = ( const tcpiiu & );
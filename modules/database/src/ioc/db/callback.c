@@ -26,7 +26,6 @@
 #include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsInterrupt.h"
-#include "epicsRingPointer.h"
 #include "epicsString.h"
 #include "epicsThread.h"
 #include "epicsTimer.h"
@@ -50,9 +49,44 @@
 
 static int callbackQueueSize = 2000;
 
+/* callbackRequest() may be called from an ISR, which the queue allows only
+ * if epicsAtomicCmpAndSwapSizeT() is native or falls back to an interrupt
+ * lock (vxWorks, RTEMS before 5).  The POSIX fallback that RTEMS 5 and later
+ * would use takes a mutex, so there requests from an ISR are refused.
+ */
+#if !defined(EPICS_ATOMIC_CAS_SIZET) && \
+    defined(__RTEMS_MAJOR__) && __RTEMS_MAJOR__ >= 5
+#  define CB_REQUEST_ISR_SAFE 0
+#else
+#  define CB_REQUEST_ISR_SAFE 1
+#endif
+
+/* Callbacks dequeued by a worker per claim */
+#define CB_BATCH 8
+/* Queue polls by an idle worker before it sleeps, on SMP only */
+#define CB_SPIN 1000
+
+/* Bounded multi-producer/multi-consumer queue (D. Vyukov).
+ * Each cell carries a sequence number which tells producers and
+ * consumers whose turn it is, so the positions are the only shared
+ * state needing compare-and-swap.
+ */
+typedef struct cbQueueCell {
+    size_t seq; // use atomic
+    epicsCallback *pcallback;
+} cbQueueCell;
+
 typedef struct cbQueueSet {
+    size_t enqueuePos; // use atomic
+    char pad1[64 - sizeof(size_t)];
+    size_t dequeuePos; // use atomic
+    char pad2[64 - sizeof(size_t)];
+    cbQueueCell *cells;
+    size_t mask;        /* number of cells - 1, a power of 2 - 1 */
+    size_t capacity;    /* callbackQueueSize, enforced by cbQueuePush() */
     epicsEventId semWakeUp;
-    epicsRingPointerId queue;
+    int threadsIdle; // use atomic
+    int highWaterMark;
     int queueOverflow;
     int queueOverflows;
     int shutdown; // use atomic
@@ -96,6 +130,135 @@ static unsigned int threadPriority[NUM_CALLBACK_PRIORITIES] = {
     epicsThreadPriorityScanHigh + 1
 };
 static int priorityValue[NUM_CALLBACK_PRIORITIES] = {0, 1, 2};
+static int spinCount;
+
+/* This routine can be called from interrupt context */
+static int cbQueuePush(cbQueueSet *mySet, epicsCallback *pcallback)
+{
+    size_t pos = epicsAtomicGetSizeT(&mySet->enqueuePos);
+    size_t deq = epicsAtomicGetSizeT(&mySet->dequeuePos);
+    cbQueueCell *cell;
+    size_t used;
+
+    for (;;) {
+        size_t seq;
+
+        cell = &mySet->cells[pos & mySet->mask];
+        seq = epicsAtomicGetSizeT(&cell->seq);
+        if (seq == pos) {
+            size_t prev;
+
+            if ((ptrdiff_t)(pos - deq) >= (ptrdiff_t)mySet->capacity) {
+                deq = epicsAtomicGetSizeT(&mySet->dequeuePos);
+                if ((ptrdiff_t)(pos - deq) >= (ptrdiff_t)mySet->capacity)
+                    return FALSE;   /* full, callbackQueueSize reached */
+            }
+            prev = epicsAtomicCmpAndSwapSizeT(&mySet->enqueuePos,
+                pos, pos + 1);
+            if (prev == pos)
+                break;
+            pos = prev;
+        }
+        else if ((ptrdiff_t)(seq - pos) < 0) {
+            return FALSE;   /* full, cell not yet consumed */
+        }
+        else {
+            pos = epicsAtomicGetSizeT(&mySet->enqueuePos);
+        }
+    }
+    cell->pcallback = pcallback;
+    /* publish the callback before the sequence number that hands it over */
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetSizeT(&cell->seq, pos + 1);
+
+    /* statistics only, races are harmless */
+    used = pos + 1 - deq;
+    if ((ptrdiff_t)used > mySet->highWaterMark)
+        mySet->highWaterMark = (int)used;
+    return TRUE;
+}
+
+/* Claim up to max consecutive callbacks with a single compare-and-swap.
+ * Returns the number stored in batch[].
+ */
+static unsigned cbQueuePop(cbQueueSet *mySet, epicsCallback **batch,
+    unsigned max)
+{
+    size_t pos = epicsAtomicGetSizeT(&mySet->dequeuePos);
+
+    for (;;) {
+        unsigned i, n = 0;
+        size_t prev;
+
+        while (n < max && epicsAtomicGetSizeT(
+                &mySet->cells[(pos + n) & mySet->mask].seq) == pos + n + 1)
+            n++;
+
+        if (n == 0) {
+            size_t seq = epicsAtomicGetSizeT(
+                &mySet->cells[pos & mySet->mask].seq);
+
+            if ((ptrdiff_t)(seq - (pos + 1)) < 0)
+                return 0;   /* empty */
+            pos = epicsAtomicGetSizeT(&mySet->dequeuePos);
+            continue;
+        }
+
+        prev = epicsAtomicCmpAndSwapSizeT(&mySet->dequeuePos, pos, pos + n);
+        if (prev != pos) {
+            pos = prev;
+            continue;
+        }
+        /* don't read a callback before its sequence number */
+        epicsAtomicReadMemoryBarrier();
+
+        for (i = 0; i < n; i++) {
+            cbQueueCell *cell = &mySet->cells[(pos + i) & mySet->mask];
+
+            batch[i] = cell->pcallback;
+            /* finish the read before a producer may overwrite the cell,
+             * then hand it back for the next lap */
+            epicsAtomicReadMemoryBarrier();
+            epicsAtomicWriteMemoryBarrier();
+            epicsAtomicSetSizeT(&cell->seq, pos + i + mySet->mask + 1);
+        }
+        return n;
+    }
+}
+
+static int cbQueueIsEmpty(cbQueueSet *mySet)
+{
+    size_t pos = epicsAtomicGetSizeT(&mySet->dequeuePos);
+
+    return epicsAtomicGetSizeT(&mySet->cells[pos & mySet->mask].seq) != pos + 1;
+}
+
+static int cbQueueUsed(cbQueueSet *mySet)
+{
+    size_t deq = epicsAtomicGetSizeT(&mySet->dequeuePos);
+    size_t enq = epicsAtomicGetSizeT(&mySet->enqueuePos);
+
+    return (ptrdiff_t)(enq - deq) > 0 ? (int)(enq - deq) : 0;
+}
+
+/* Park an idle worker.  Spin briefly first, as another request is often
+ * only microseconds away and a sleep/wake costs two system calls.
+ * Requesters only signal semWakeUp while threadsIdle is non-zero.
+ */
+static void cbQueueWait(cbQueueSet *mySet)
+{
+    int i;
+
+    for (i = 0; i < spinCount; i++) {
+        if (!cbQueueIsEmpty(mySet) || epicsAtomicGetIntT(&mySet->shutdown))
+            return;
+    }
+
+    epicsAtomicIncrIntT(&mySet->threadsIdle);
+    if (cbQueueIsEmpty(mySet) && !epicsAtomicGetIntT(&mySet->shutdown))
+        epicsEventMustWait(mySet->semWakeUp);
+    epicsAtomicDecrIntT(&mySet->threadsIdle);
+}
 
 
 int callbackSetQueueSize(int size)
@@ -116,9 +279,9 @@ int callbackQueueStatus(const int reset, callbackQueueStats *result)
         int prio;
         result->size = callbackQueueSize;
         for(prio = 0; prio < NUM_CALLBACK_PRIORITIES; prio++) {
-            epicsRingPointerId qId = callbackQueue[prio].queue;
-            result->numUsed[prio] = epicsRingPointerGetUsed(qId);
-            result->maxUsed[prio] = epicsRingPointerGetHighWaterMark(qId);
+            cbQueueSet *mySet = &callbackQueue[prio];
+            result->numUsed[prio] = cbQueueUsed(mySet);
+            result->maxUsed[prio] = mySet->highWaterMark;
             result->numOverflow[prio] = epicsAtomicGetIntT(&callbackQueue[prio].queueOverflows);
         }
         ret = 0;
@@ -128,7 +291,7 @@ int callbackQueueStatus(const int reset, callbackQueueStats *result)
     if (reset) {
         int prio;
         for(prio = 0; prio < NUM_CALLBACK_PRIORITIES; prio++) {
-            epicsRingPointerResetHighWaterMark(callbackQueue[prio].queue);
+            callbackQueue[prio].highWaterMark = cbQueueUsed(&callbackQueue[prio]);
         }
     }
     return ret;
@@ -212,17 +375,22 @@ static void callbackTask(void *arg)
     epicsEventSignal(startStopEvent);
 
     while(!epicsAtomicGetIntT(&mySet->shutdown)) {
-        void *ptr;
-        if (epicsRingPointerIsEmpty(mySet->queue))
-            epicsEventMustWait(mySet->semWakeUp);
-
-        while ((ptr = epicsRingPointerPop(mySet->queue))) {
-            epicsCallback *pcallback = (epicsCallback *)ptr;
-            if(!epicsRingPointerIsEmpty(mySet->queue))
-                epicsEventMustTrigger(mySet->semWakeUp);
-            mySet->queueOverflow = FALSE;
-            (*pcallback->callback)(pcallback);
+        epicsCallback *batch[CB_BATCH];
+        unsigned i, n;
+
+        n = cbQueuePop(mySet, batch, CB_BATCH);
+        if (n == 0) {
+            cbQueueWait(mySet);
+            continue;
         }
+
+        /* share the rest with any sleeping sibling */
+        if (epicsAtomicGetIntT(&mySet->threadsIdle) && !cbQueueIsEmpty(mySet))
+            epicsEventMustTrigger(mySet->semWakeUp);
+        mySet->queueOverflow = FALSE;
+
+        for (i = 0; i < n; i++)
+            (*batch[i]->callback)(batch[i]);
     }
 
     if(!epicsAtomicDecrIntT(&mySet->threadsRunning))
@@ -269,8 +437,8 @@ void callbackCleanup(void)
         assert(epicsAtomicGetIntT(&mySet->threadsRunning)==0);
         epicsEventDestroy(mySet->semWakeUp);
         mySet->semWakeUp = NULL;
-        epicsRingPointerDelete(mySet->queue);
-        mySet->queue = NULL;
+        free(mySet->cells);
+        mySet->cells = NULL;
         free(mySet->threads);
         mySet->threads = NULL;
     }
@@ -283,6 +451,7 @@ void callbackInit(void)
 {
     int i;
     int j;
+    int ncells;
     char threadName[32];
 
     if (epicsAtomicCmpAndSwapIntT(&cbState, cbInit, cbRun)!=cbInit) {
@@ -295,14 +464,28 @@ void callbackInit(void)
 
     timerQueue = epicsTimerQueueAllocate(0, epicsThreadPriorityScanHigh);
 
+    spinCount = epicsThreadGetCPUs() > 1 ? CB_SPIN : 0;
+
+    /* The number of cells must be a power of 2, callbackQueueSize stays
+     * the capacity that is reported and enforced. */
+    if (callbackQueueSize < 1)
+        callbackQueueSize = 1;
+    for (ncells = 2; ncells < callbackQueueSize && ncells < (1 << 30);
+         ncells <<= 1) {}
+
     for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
         epicsThreadId tid;
+        cbQueueCell *cells;
 
         callbackQueue[i].semWakeUp = epicsEventMustCreate(epicsEventEmpty);
-        callbackQueue[i].queue = epicsRingPointerLockedCreate(callbackQueueSize);
-        if (callbackQueue[i].queue == 0)
-            cantProceed("epicsRingPointerLockedCreate failed for %s\n",
-                threadNamePrefix[i]);
+        cells = callocMustSucceed(ncells, sizeof(*cells), "callbackInit");
+        for (j = 0; j < ncells; j++)
+            cells[j].seq = j;
+        callbackQueue[i].mask = ncells - 1;
+        callbackQueue[i].capacity = callbackQueueSize < ncells ?
+            callbackQueueSize : ncells;
+        callbackQueue[i].enqueuePos = callbackQueue[i].dequeuePos = 0;
+        callbackQueue[i].cells = cells;
         callbackQueue[i].queueOverflow = FALSE;
 
         if (callbackQueue[i].threadsConfigured == 0)
@@ -353,14 +536,20 @@ int callbackRequest(epicsCallback *pcallback)
         epicsInterruptContextMessage("callbackRequest: " ERL_ERROR " Bad priority\n");
         return S_db_badChoice;
     }
+#if !CB_REQUEST_ISR_SAFE
+    if (epicsInterruptIsInterruptContext()) {
+        epicsInterruptContextMessage("callbackRequest: " ERL_ERROR " not ISR-safe on this target\n");
+        return S_db_notInit;
+    }
+#endif
     mySet = &callbackQueue[priority];
-    if (!mySet->queue) {
+    if (!mySet->cells) {
         epicsInterruptContextMessage("callbackRequest: " ERL_ERROR " Callbacks not initialized\n");
         return S_db_notInit;
     }
     if (mySet->queueOverflow) return S_db_bufFull;
 
-    pushOK = epicsRingPointerPush(mySet->queue, pcallback);
+    pushOK = cbQueuePush(mySet, pcallback);
 
     if (!pushOK) {
         epicsInterruptContextMessage(fullMessage[priority]);
@@ -368,7 +557,9 @@ int callbackRequest(epicsCallback *pcallback)
         epicsAtomicIncrIntT(&mySet->queueOverflows);
         return S_db_bufFull;
     }
-    epicsEventSignal(mySet->semWakeUp);
+    /* pairs with threadsIdle increment in cbQueueWait() */
+    if (epicsAtomicGetIntT(&mySet->threadsIdle))
+        epicsEventSignal(mySet->semWakeUp);
     return 0;
 }
 
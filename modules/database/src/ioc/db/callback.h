@@ -72,6 +72,9 @@ typedef struct callbackQueueStats {
 DBCORE_API void callbackInit(void);
 DBCORE_API void callbackStop(void);
 DBCORE_API void callbackCleanup(void);
+/* May be called from interrupt context, except on RTEMS 5 and later
+ * targets without a native compare-and-swap, where it fails from an ISR.
+ */
 DBCORE_API int callbackRequest(epicsCallback *pCallback);
 DBCORE_API void callbackSetProcess(
     epicsCallback *pcallback, int Priority, void *pRec);
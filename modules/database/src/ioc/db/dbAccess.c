@@ -41,9 +41,11 @@
 #include "callback.h"
 #include "dbAccessDefs.h"
 #include "dbAddr.h"
+#include "dbArrayBuf.h"
 #include "dbBase.h"
 #include "dbBkpt.h"
 #include "dbCommonPvt.h"
+#include "dbProfilePvt.h"
 #include "dbConvertFast.h"
 #include "dbConvert.h"
 #include "dbEvent.h"
@@ -491,6 +493,11 @@ long dbProcess(dbCommon *precord)
     int set_trace = FALSE;
     dbFldDes *pdbFldDes;
     int callNotifyCompletion = FALSE;
+    int profile = dbProfileActive;
+    dbProfileFrame profileFrame;
+
+    if (profile)
+        dbProfileStart(&profileFrame);
 
     ptrace = dbLockSetAddrTrace(precord);
     /*
@@ -619,6 +626,8 @@ all_done:
         *ptrace = 0;
     if (callNotifyCompletion && precord->ppn)
         dbNotifyCompletion(precord);
+    if (profile)
+        dbProfileEnd(precord, &profileFrame);
 
     return status;
 }
@@ -815,6 +824,24 @@ int dbLoadRecords(const char* file, const char* subs)
     return status;
 }
 
+/* As dbLoadRecords() does after each file, and in the same order */
+static void loadRecordsDone(const dbReadListItem *pitem)
+{
+    if (pitem->status == 0) {
+        if (dbLoadRecordsHook)
+            dbLoadRecordsHook(pitem->filename, pitem->substitutions);
+    } else {
+        fprintf(stderr, ERL_ERROR " failed to load '%s'\n", pitem->filename);
+        if (pitem->status == -2)
+            fprintf(stderr, "    Records cannot be loaded after iocInit!\n");
+    }
+}
+
+int dbLoadRecordsList(dbReadListItem *items, size_t count)
+{
+    return dbReadDatabaseList(&pdbbase, items, count, 0, loadRecordsDone);
+}
+
 
 static long getLinkValue(DBADDR *paddr, short dbrType,
     char *pbuf, long *nRequest)
@@ -1369,6 +1396,10 @@ long dbPut(DBADDR *paddr, short dbrType,
             prset && prset->get_array_info) {
             long dummy;
 
+            /* unshare the buffer from monitors, keeping all of it
+             * as the put may only change part of the array */
+            dbArrayBufPrepareWrite(precord, (size_t) -1);
+
             status = prset->get_array_info(paddr, &dummy, &offset);
             /* paddr->pfield may be modified */
             if (status) goto done;
@@ -274,6 +274,12 @@ DBCORE_API int  dbLoadDatabase(
     const char *filename, const char *path, const char *substitutions);
 DBCORE_API int dbLoadRecords(
     const char* filename, const char* substitutions);
+struct dbReadListItem;
+/* Load several files as dbLoadRecords() would, stopping at the first
+ * failure.  See dbReadDatabaseList() for the dbLoadRecordsThreads mode.
+ */
+DBCORE_API int dbLoadRecordsList(
+    struct dbReadListItem *items, size_t count);
 
 #ifdef __cplusplus
 }
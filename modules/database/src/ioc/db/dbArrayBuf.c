@@ -0,0 +1,174 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/*
+ * Reference counted array snapshots for monitors
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsAtomic.h"
+#include "errlog.h"
+
+#include "dbArrayBuf.h"
+#include "dbChannel.h"
+#include "dbCommonPvt.h"
+#include "dbExtractArray.h"
+#include "db_field_log.h"
+#include "epicsExport.h"
+
+/* An array buffer and the number of owners: the record while it is the
+ * record's current buffer, plus one for each field log and post using
+ * it as a snapshot.  The data may only change while the record is the
+ * only owner.
+ */
+typedef struct dbArrayBuf {
+    int refs;
+    size_t size;
+    void *data;
+} dbArrayBuf;
+
+int dbArraySnapshots = 0;
+epicsExportAddress(int, dbArraySnapshots);
+
+static dbArrayBuf* newBuf(void *data, size_t size)
+{
+    dbArrayBuf *pbuf = malloc(sizeof(*pbuf));
+
+    if (pbuf) {
+        pbuf->refs = 1;
+        pbuf->size = size;
+        pbuf->data = data;
+    }
+    return pbuf;
+}
+
+void dbArrayBufRelease(dbArrayBuf *pbuf)
+{
+    if (epicsAtomicDecrIntT(&pbuf->refs) == 0) {
+        free(pbuf->data);
+        free(pbuf);
+    }
+}
+
+void dbArrayBufAttach(struct dbCommon *prec, void **pbptr, size_t size)
+{
+    dbCommonPvt *ppvt = dbRec2Pvt(prec);
+
+    if (!dbArraySnapshots || ppvt->arrayBuf || !*pbptr)
+        return;
+
+    ppvt->arrayBuf = newBuf(*pbptr, size);
+    if (ppvt->arrayBuf)
+        ppvt->arrayField = pbptr;
+}
+
+/* The attached buffer, or NULL.  Device support may have replaced the
+ * buffer we were given, in which case the record no longer shares it.
+ */
+static dbArrayBuf* attached(dbCommonPvt *ppvt)
+{
+    dbArrayBuf *pbuf = ppvt->arrayBuf;
+
+    if (pbuf && *ppvt->arrayField != pbuf->data) {
+        errlogPrintf("dbArrayBuf: %s buffer replaced, snapshots disabled\n",
+            ppvt->common.name);
+        ppvt->arrayBuf = NULL;
+        /* The data is no longer ours to free, not even by the last
+         * field log which refers to it.  Those keep their own pointer.
+         */
+        pbuf->data = NULL;
+        dbArrayBufRelease(pbuf);
+        pbuf = NULL;
+    }
+    return pbuf;
+}
+
+void dbArrayBufPrepareWrite(struct dbCommon *prec, size_t nkeep)
+{
+    dbCommonPvt *ppvt = dbRec2Pvt(prec);
+    dbArrayBuf *pbuf = attached(ppvt);
+    dbArrayBuf *pnew;
+    void *data;
+
+    /* References are only added with the record locked, so once we are
+     * the only owner nobody else can start using the buffer.
+     */
+    if (!pbuf || epicsAtomicGetIntT(&pbuf->refs) == 1)
+        return;
+
+    if (nkeep > pbuf->size)
+        nkeep = pbuf->size;
+    data = malloc(pbuf->size);
+    pnew = data ? newBuf(data, pbuf->size) : NULL;
+    if (!pnew) {
+        /* Out of memory, keep using the shared buffer. Monitors which
+         * have not been sent yet may see part of the next value.
+         */
+        free(data);
+        return;
+    }
+    memcpy(data, pbuf->data, nkeep);
+    memset((char *) data + nkeep, 0, pbuf->size - nkeep);
+
+    *ppvt->arrayField = data;
+    ppvt->arrayBuf = pnew;
+    dbArrayBufRelease(pbuf);
+}
+
+dbArrayBuf* dbArrayBufSnapshot(struct dbChannel *chan, long *pnelements)
+{
+    dbCommonPvt *ppvt = dbRec2Pvt(dbChannelRecord(chan));
+    dbArrayBuf *pbuf = attached(ppvt);
+    dbArrayBuf *pcopy;
+    void *pfield = NULL, *data;
+    long nelements = 0, offset = 0;
+    size_t size;
+
+    if (!pbuf)
+        return NULL;
+
+    dbChannelGetArrayInfo(chan, &pfield, &nelements, &offset);
+    if (pfield != pbuf->data)
+        return NULL;
+
+    *pnelements = nelements;
+    if (offset == 0 || nelements == 0) {
+        epicsAtomicIncrIntT(&pbuf->refs);
+        return pbuf;
+    }
+
+    /* A circular buffer which has wrapped around.  Its next write would
+     * change the start of the value, so make one linear copy for all
+     * subscribers of this post.
+     */
+    size = (size_t) nelements * dbChannelFieldSize(chan);
+    data = malloc(size);
+    pcopy = data ? newBuf(data, size) : NULL;
+    if (!pcopy) {
+        free(data);
+        return NULL;
+    }
+    /* the value wraps around at the capacity of the field */
+    dbExtractArray(pfield, data, dbChannelFieldSize(chan),
+        nelements, dbChannelElements(chan), offset, 1);
+    return pcopy;
+}
+
+void dbArrayBufSetLog(dbArrayBuf *pbuf, long nelements, db_field_log *pfl)
+{
+    epicsAtomicIncrIntT(&pbuf->refs);
+    pfl->u.r.pvt = pbuf;
+    pfl->u.r.field = pbuf->data;
+    pfl->no_elements = nelements;
+    pfl->dtor = dbArrayBufFreeLog;
+}
+
+void dbArrayBufFreeLog(db_field_log *pfl)
+{
+    if (pfl->type == dbfl_type_ref)
+        dbArrayBufRelease((dbArrayBuf *) pfl->u.r.pvt);
+}
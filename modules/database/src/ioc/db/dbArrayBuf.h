@@ -0,0 +1,102 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/** @file dbArrayBuf.h
+ * @brief Reference counted array snapshots for monitors
+ *
+ * Normally a monitor update of an array field refers to the live record
+ * buffer, and every subscriber or filter which needs the value later
+ * makes its own copy.  When dbArraySnapshots is set before iocInit, a
+ * record which attaches its array buffer instead lets db_post_events()
+ * hand each subscriber a reference to the buffer itself.  The buffer
+ * is then immutable for as long as any field log refers to it: before
+ * changing the array the record calls dbArrayBufPrepareWrite(), which
+ * swaps in a private copy if a snapshot still holds the old buffer.
+ *
+ * Device support which keeps its own pointer to the record buffer can
+ * not see such a swap, so snapshots are off by default.
+ */
+
+#ifndef INC_dbArrayBuf_H
+#define INC_dbArrayBuf_H
+
+#include <stddef.h>
+
+#include "dbCoreAPI.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct dbCommon;
+struct dbChannel;
+struct db_field_log;
+struct dbArrayBuf;
+
+/** @brief Non-zero to let records attach their array buffers.
+ *
+ * Only read by dbArrayBufAttach(), so it must be set before iocInit.
+ */
+DBCORE_API extern int dbArraySnapshots;
+
+/** @brief Share the array buffer of a record with its monitors.
+ *
+ * Called by record support once *pbptr points to a buffer of size bytes
+ * allocated with malloc() or calloc(), which the record support owns.
+ * Does nothing unless dbArraySnapshots is set.  A record has at most
+ * one attached buffer.
+ *
+ * @param prec   The record.
+ * @param pbptr  Address of the record's buffer pointer, which is
+ *               changed by dbArrayBufPrepareWrite().
+ * @param size   Size of the buffer in bytes.
+ */
+DBCORE_API void dbArrayBufAttach(struct dbCommon *prec, void **pbptr,
+    size_t size);
+
+/** @brief Make the attached buffer safe to change.
+ *
+ * Must be called with the record locked before anything writes into
+ * the buffer.  If a monitor still refers to the current buffer, a new
+ * one is allocated and stored through the pbptr given to
+ * dbArrayBufAttach().  Its first nkeep bytes are copied from the old
+ * buffer, the rest is zeroed.
+ *
+ * @param prec   The record.
+ * @param nkeep  Number of bytes of the current value to keep, which is
+ *               limited to the buffer size.
+ */
+DBCORE_API void dbArrayBufPrepareWrite(struct dbCommon *prec, size_t nkeep);
+
+/** @brief Field log destructor of array snapshots.
+ *
+ * Filters may compare a dtor against this.  Such a field log refers to
+ * immutable data, so a filter which only narrows the array may move
+ * db_field_log::u.r.field within it instead of copying the data.
+ */
+DBCORE_API void dbArrayBufFreeLog(struct db_field_log *pfl);
+
+/* The following are used by dbEvent.c */
+
+/* Return a new reference to the attached buffer if chan is the attached
+ * field, else NULL.  A circular array is copied into a new buffer.
+ * The record must be locked.
+ */
+struct dbArrayBuf* dbArrayBufSnapshot(struct dbChannel *chan,
+    long *pnelements);
+
+/* Make pfl refer to nelements of a snapshot, taking another reference */
+void dbArrayBufSetLog(struct dbArrayBuf *pbuf, long nelements,
+    struct db_field_log *pfl);
+
+/* Drop a reference from dbArrayBufSnapshot() */
+void dbArrayBufRelease(struct dbArrayBuf *pbuf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_dbArrayBuf_H */
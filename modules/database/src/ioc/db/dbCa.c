@@ -27,6 +27,7 @@
 #include "epicsExit.h"
 #include "epicsMutex.h"
 #include "epicsPrint.h"
+#include "epicsStdio.h"
 #include "epicsString.h"
 #include "epicsThread.h"
 #include "epicsAtomic.h"
@@ -37,6 +38,8 @@
 
 #include "cadef.h"
 
+#include "epicsExport.h"
+
 /* We can't include dbStaticLib.h here */
 #define dbCalloc(nobj,size) callocMustSucceed(nobj,size,"dbCalloc")
 
@@ -61,17 +64,36 @@
 extern void dbServiceIOInit();
 extern int dbServiceIsolate;
 
-static ELLLIST workList = ELLLIST_INIT;    /* Work list for dbCaTask */
-static epicsMutexId workListLock; /*Mutual exclusions semaphores for workList*/
-static epicsEventId workListEvent; /*wakeup event for dbCaTask*/
-static int removesOutstanding = 0;
+/* Links are spread over dbCaLinkThreads worker threads by a hash of
+ * their PV name.  Each worker has its own work list and CA client
+ * context, so all links to one PV are handled by the same worker.
+ * Every link still creates its own channel.  CA clients only share a
+ * TCP circuit to a server within one context, so with N workers the IOC
+ * may open up to N circuits to each server it links to.
+ */
+typedef struct dbCaShard {
+    ELLLIST         workList;       /* Work list for dbCaTask */
+    epicsMutexId    workListLock;   /* Guards workList and removesOutstanding */
+    epicsEventId    workListEvent;  /* wakeup event for dbCaTask */
+    int             removesOutstanding;
+    int             chanCount;
+    int             index;
+    epicsThreadId   worker;
+    struct ca_client_context *context;
+} dbCaShard;
 #define removesOutstandingWarning 10000
 
+int dbCaLinkThreads = 1;
+epicsExportAddress(int, dbCaLinkThreads);
+
+static dbCaShard **dbCaShards;  /* never freed, links point to them */
+static int dbCaMaxShards;       /* allocated */
+static int dbCaNShards;         /* running */
+
 static volatile enum dbCaCtl_t {
     ctlInit, ctlRun, ctlPause, ctlExit
 } dbCaCtl;
 static epicsEventId startStopEvent;
-static epicsThreadId dbCaWorker;
 
 struct ca_client_context * dbCaClientContext;
 
@@ -84,15 +106,15 @@ static lset dbCa_lset;
     errlogPrintf("%s has DB CA link to %s\n",\
         pcaLink->plink->precord->name, pcaLink->pvname)
 
-static int dbca_chan_count;
-
 /* caLink locking
  *
  * Lock ordering:
  *  dbScanLock -> caLink.lock -> workListLock
  *
  * workListLock:
- *   Guards access to workList.
+ *   Guards access to the workList of one dbCaShard.  A caLink only ever
+ *   uses the shard it was created for, and no thread holds the
+ *   workListLock of more than one shard.
  *
  * dbScanLock:
  *   All dbCa* functions operating on a single link may only be called when
@@ -110,12 +132,12 @@ static int dbca_chan_count;
  * caLink.lock:
  *   Guards the caLink structure (but not the struct DBLINK)
  *
- * The dbCaTask only locks caLink, and must not lock the record (a violation of lock order).
+ * A dbCaTask only locks caLink, and must not lock the record (a violation of lock order).
  *
  * During link modification or IOC shutdown the pca->plink pointer (guarded by caLink.lock)
  * is used as a flag to indicate that a link is no longer active.
  *
- * References to the struct caLink are owned by the dbCaTask, and any scanOnceCallback()
+ * References to the struct caLink are owned by its dbCaTask, and any scanOnceCallback()
  * which is in progress.
  *
  * The libca and scanOnceCallback callbacks take no action if pca->plink==NULL.
@@ -128,11 +150,17 @@ static int dbca_chan_count;
  *   Thus the user's callback will get called exactly once.
  */
 
+static dbCaShard *shardFor(const char *pvname)
+{
+    return dbCaShards[epicsStrHash(pvname, 0) % dbCaNShards];
+}
+
 static void addAction(caLink *pca, short link_action)
 {
+    dbCaShard *pshard = pca->shard;
     int callAdd;
 
-    epicsMutexMustLock(workListLock);
+    epicsMutexMustLock(pshard->workListLock);
     callAdd = (pca->link_action == 0);
     if (pca->link_action & CA_CLEAR_CHANNEL) {
         errlogPrintf("dbCa::addAction %d with CA_CLEAR_CHANNEL set\n",
@@ -141,22 +169,22 @@ static void addAction(caLink *pca, short link_action)
         link_action = 0;
     }
     if (link_action & CA_CLEAR_CHANNEL) {
-        if (++removesOutstanding >= removesOutstandingWarning) {
+        if (++pshard->removesOutstanding >= removesOutstandingWarning) {
             errlogPrintf("dbCa::addAction pausing, %d channels to clear\n",
-                removesOutstanding);
+                pshard->removesOutstanding);
         }
-        while (removesOutstanding >= removesOutstandingWarning) {
-            epicsMutexUnlock(workListLock);
+        while (pshard->removesOutstanding >= removesOutstandingWarning) {
+            epicsMutexUnlock(pshard->workListLock);
             epicsThreadSleep(1.0);
-            epicsMutexMustLock(workListLock);
+            epicsMutexMustLock(pshard->workListLock);
         }
     }
     pca->link_action |= link_action;
     if (callAdd)
-        ellAdd(&workList, &pca->node);
-    epicsMutexUnlock(workListLock);
+        ellAdd(&pshard->workList, &pca->node);
+    epicsMutexUnlock(pshard->workListLock);
     if (callAdd)
-        epicsEventSignal(workListEvent);
+        epicsEventSignal(pshard->workListEvent);
 }
 
 static void caLinkInc(caLink *pca)
@@ -178,7 +206,7 @@ static void caLinkDec(caLink *pca)
 
     if (pca->chid) {
         ca_clear_channel(pca->chid);
-        --dbca_chan_count;
+        epicsAtomicDecrIntT(&pca->shard->chanCount);
     }
     callback = pca->putCallback;
     if (callback) {
@@ -263,10 +291,7 @@ void testdbCaWaitForUpdateCount(DBLINK *plink, unsigned long cnt)
     testdbCaWaitForEvent(plink, cnt, testEventCount);
 }
 
-/* Block until worker thread has processed all previously queued actions.
- * Does not prevent additional actions from being queued.
- */
-void dbCaSync(void)
+static void syncShard(dbCaShard *pshard)
 {
     epicsEventId wake;
     caLink templink;
@@ -277,6 +302,7 @@ void dbCaSync(void)
      */
     memset(&templink, 0, sizeof(templink));
     templink.refcount = 1;
+    templink.shard = pshard;
 
     wake = epicsEventMustCreate(epicsEventEmpty);
     templink.lock = epicsMutexMustCreate();
@@ -290,8 +316,8 @@ void dbCaSync(void)
      * we cycle through workListLock to ensure worker call to
      * epicsEventMustTrigger() returns before we destroy the event.
      */
-    epicsMutexMustLock(workListLock);
-    epicsMutexUnlock(workListLock);
+    epicsMutexMustLock(pshard->workListLock);
+    epicsMutexUnlock(pshard->workListLock);
 
     assert(templink.refcount==1);
 
@@ -299,6 +325,33 @@ void dbCaSync(void)
     epicsEventDestroy(wake);
 }
 
+/* Block until worker threads have processed all previously queued actions.
+ * Does not prevent additional actions from being queued.
+ */
+void dbCaSync(void)
+{
+    int i;
+
+    for (i = 0; i < dbCaNShards; i++)
+        syncShard(dbCaShards[i]);
+}
+
+int dbCaWorkerStatus(int index, int *pqueued, int *pchans,
+    struct ca_client_context **pcontext)
+{
+    dbCaShard *pshard;
+
+    if (index < 0 || index >= dbCaNShards)
+        return -1;
+    pshard = dbCaShards[index];
+    epicsMutexMustLock(pshard->workListLock);
+    *pqueued = ellCount(&pshard->workList);
+    epicsMutexUnlock(pshard->workListLock);
+    *pchans = epicsAtomicGetIntT(&pshard->chanCount);
+    *pcontext = pshard->context;
+    return 0;
+}
+
 void dbCaCallbackProcess(void *userPvt)
 {
     struct link *plink = (struct link *)userPvt;
@@ -306,20 +359,33 @@ void dbCaCallbackProcess(void *userPvt)
     dbLinkAsyncComplete(plink);
 }
 
+static void signalShards(void)
+{
+    int i;
+
+    for (i = 0; i < dbCaNShards; i++)
+        epicsEventSignal(dbCaShards[i]->workListEvent);
+}
+
 void dbCaShutdown(void)
 {
     enum dbCaCtl_t cur = dbCaCtl;
+    int i;
+
     assert(cur == ctlRun || cur == ctlPause);
     dbCaCtl = ctlExit;
-    epicsEventSignal(workListEvent);
-    epicsEventMustWait(startStopEvent);
-    if(dbCaWorker)
-        epicsThreadMustJoin(dbCaWorker);
+    signalShards();
+    for (i = 0; i < dbCaNShards; i++) {
+        if (dbCaShards[i]->worker)
+            epicsThreadMustJoin(dbCaShards[i]->worker);
+        dbCaShards[i]->worker = NULL;
+    }
 }
 
 static void dbCaLinkInitImpl(int isolate)
 {
     epicsThreadOpts opts = EPICS_THREAD_OPTS_INIT;
+    int i, nShards = dbCaLinkThreads;
 
     opts.stackSize = epicsThreadGetStackSize(epicsThreadStackBig);
     opts.priority = epicsThreadPriorityMedium;
@@ -328,18 +394,47 @@ static void dbCaLinkInitImpl(int isolate)
     dbServiceIsolate = isolate;
     dbServiceIOInit();
 
-    if (!workListLock)
-        workListLock = epicsMutexMustCreate();
-    if (!workListEvent)
-        workListEvent = epicsEventMustCreate(epicsEventEmpty);
+    if (nShards < 1)
+        nShards = 1;
+    if (nShards > dbCaMaxShards) {
+        dbCaShard **pold = dbCaShards;
+
+        dbCaShards = dbCalloc(nShards, sizeof(dbCaShard *));
+        for (i = 0; i < nShards; i++) {
+            dbCaShard *pshard;
+
+            if (i < dbCaMaxShards) {
+                dbCaShards[i] = pold[i];
+                continue;
+            }
+            pshard = dbCalloc(1, sizeof(dbCaShard));
+            ellInit(&pshard->workList);
+            pshard->workListLock = epicsMutexMustCreate();
+            pshard->workListEvent = epicsEventMustCreate(epicsEventEmpty);
+            pshard->index = i;
+            dbCaShards[i] = pshard;
+        }
+        free(pold);
+        dbCaMaxShards = nShards;
+    }
+    dbCaNShards = nShards;
 
     if(!startStopEvent)
         startStopEvent = epicsEventMustCreate(epicsEventEmpty);
     dbCaCtl = ctlPause;
 
-    dbCaWorker = epicsThreadCreateOpt("dbCaLink", dbCaTask, NULL, &opts);
-    /* wait for worker to startup and initialize dbCaClientContext */
-    epicsEventMustWait(startStopEvent);
+    for (i = 0; i < nShards; i++) {
+        char name[20];
+
+        if (i == 0)
+            strcpy(name, "dbCaLink");
+        else
+            epicsSnprintf(name, sizeof(name), "dbCaLink-%d", i);
+        dbCaShards[i]->worker = epicsThreadCreateOpt(name, dbCaTask,
+            dbCaShards[i], &opts);
+        /* wait for worker to startup and initialize its context */
+        epicsEventMustWait(startStopEvent);
+    }
 }
 
 void dbCaLinkInitIsolated(void)
@@ -356,7 +451,7 @@ void dbCaRun(void)
 {
     if (dbCaCtl == ctlPause) {
         dbCaCtl = ctlRun;
-        epicsEventSignal(workListEvent);
+        signalShards();
     }
 }
 
@@ -364,7 +459,7 @@ void dbCaPause(void)
 {
     if (dbCaCtl == ctlRun) {
         dbCaCtl = ctlPause;
-        epicsEventSignal(workListEvent);
+        signalShards();
     }
 }
 
@@ -380,6 +475,7 @@ void dbCaAddLinkCallback(struct link *plink,
     pca->lock = epicsMutexMustCreate();
     pca->plink = plink;
     pca->pvname = epicsStrDup(plink->value.pv_link.pvname);
+    pca->shard = shardFor(pca->pvname);
     pca->connect = connect;
     pca->monitor = monitor;
     pca->userPvt = userPvt;
@@ -1116,11 +1212,14 @@ static void getAttribEventCallback(struct event_handler_args arg)
 
 static void dbCaTask(void *arg)
 {
+    dbCaShard *pshard = (dbCaShard *)arg;
     epicsEventId requestSync = NULL;
     taskwdInsert(0, NULL, NULL);
     SEVCHK(ca_context_create(ca_enable_preemptive_callback),
         "dbCaTask calling ca_context_create");
-    dbCaClientContext = ca_current_context ();
+    pshard->context = ca_current_context ();
+    if (pshard->index == 0)
+        dbCaClientContext = pshard->context;
     SEVCHK(ca_add_exception_event(exceptionCallback,NULL),
         "ca_add_exception_event");
     epicsEventSignal(startStopEvent);
@@ -1128,21 +1227,21 @@ static void dbCaTask(void *arg)
     /* channel access event loop */
     while (TRUE){
         do {
-            epicsEventMustWait(workListEvent);
+            epicsEventMustWait(pshard->workListEvent);
         } while (dbCaCtl == ctlPause);
         while (TRUE) { /* process all requests in workList*/
             caLink *pca;
             short  link_action;
             int    status;
 
-            epicsMutexMustLock(workListLock);
-            if (!(pca = (caLink *)ellGet(&workList))){  /* Take off list head */
+            epicsMutexMustLock(pshard->workListLock);
+            if (!(pca = (caLink *)ellGet(&pshard->workList))){  /* Take off list head */
                 if(requestSync) {
                     /* dbCaSync() requires workListLock to be held here */
                     epicsEventMustTrigger(requestSync);
                     requestSync = NULL;
                 }
-                epicsMutexUnlock(workListLock);
+                epicsMutexUnlock(pshard->workListLock);
                 if (dbCaCtl == ctlExit) goto shutdown;
                 break; /* workList is empty */
             }
@@ -1152,8 +1251,8 @@ static void dbCaTask(void *arg)
                 requestSync = pca->userPvt;
             }
             pca->link_action = 0;
-            if (link_action & CA_CLEAR_CHANNEL) --removesOutstanding;
-            epicsMutexUnlock(workListLock);         /* Give back immediately */
+            if (link_action & CA_CLEAR_CHANNEL) --pshard->removesOutstanding;
+            epicsMutexUnlock(pshard->workListLock); /* Give back immediately */
             if (link_action&CA_SYNC)
                 continue;
             if (link_action & CA_CLEAR_CHANNEL) {   /* This must be first */
@@ -1171,7 +1270,7 @@ static void dbCaTask(void *arg)
                     printLinks(pca);
                     continue;
                 }
-                dbca_chan_count++;
+                epicsAtomicIncrIntT(&pshard->chanCount);
                 status = ca_replace_access_rights_event(pca->chid,
                     accessRightsCallback);
                 if (status != ECA_NORMAL) {
@@ -1275,9 +1374,12 @@ static void dbCaTask(void *arg)
     }
 shutdown:
     taskwdRemove(0);
-    if (dbca_chan_count == 0)
+    if (epicsAtomicGetIntT(&pshard->chanCount) == 0)
         ca_context_destroy();
     else
-        fprintf(stderr, "dbCa: chan_count = %d at shutdown\n", dbca_chan_count);
-    epicsEventSignal(startStopEvent);
+        fprintf(stderr, "dbCa: chan_count = %d at shutdown\n",
+            epicsAtomicGetIntT(&pshard->chanCount));
+    pshard->context = NULL;
+    if (pshard->index == 0)
+        dbCaClientContext = NULL;
 }
@@ -45,7 +45,10 @@ DBCORE_API long dbCaPutLinkCallback(struct link *plink,
 DBCORE_API long dbCaPutLink(struct link *plink,short dbrType,
     const void *pbuffer,long nRequest);
 
+/* The CA client context of the first dbCa worker thread */
 extern struct ca_client_context * dbCaClientContext;
+/* Number of dbCa worker threads, set before iocInit */
+DBCORE_API extern int dbCaLinkThreads;
 
 #ifdef EPICS_DBCA_PRIVATE_API
 /* Wait CA link work queue to become empty.  eg. after from dbPut() to OUT */
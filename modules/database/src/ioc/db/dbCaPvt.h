@@ -35,11 +35,14 @@
 #define CA_PUT          0x1
 #define CA_PUT_CALLBACK 0x2
 
+struct dbCaShard;
+
 typedef struct caLink
 {
     ELLNODE         node;
     int             refcount;
     epicsMutexId    lock;
+    struct dbCaShard *shard;    /* worker servicing this link */
     struct link     *plink;
     char            *pvname;
     chid            chid;
@@ -96,4 +99,10 @@ typedef struct caLink
     unsigned long   nUpdate;
 }caLink;
 
+/* For dbcar, the state of dbCa worker thread index.
+ * Returns -1 if there is no such worker.
+ */
+DBCORE_API int dbCaWorkerStatus(int index, int *pqueued, int *pchans,
+    struct ca_client_context **pcontext);
+
 #endif /* INC_dbCaPvt_H */
@@ -154,8 +154,18 @@ done:
            nDisconnect, nNoWrite);
     dbFinishEntry(pdbentry);
 
-    if ( level > 2  && dbCaClientContext != 0 ) {
-        ca_context_status ( dbCaClientContext, level - 2 );
+    for (j = 0; ; j++) {
+        struct ca_client_context *context;
+        int queued, nchans;
+
+        if (dbCaWorkerStatus(j, &queued, &nchans, &context))
+            break;
+        printf("dbCa worker %d: %d channel%s, %d link%s queued\n",
+            j, nchans, (nchans != 1) ? "s" : "",
+            queued, (queued != 1) ? "s" : "");
+        if ( level > 2  && context != 0 ) {
+            ca_context_status ( context, level - 2 );
+        }
     }
 
     return(0);
@@ -64,8 +64,10 @@ void dbChannelInit (void)
     if(dbChannelFreeList)
         return;
 
-    freeListInitPvt(&dbChannelFreeList,  sizeof(dbChannel), 128);
-    freeListInitPvt(&chFilterFreeList,  sizeof(chFilter), 64);
+    freeListInitFlags(&dbChannelFreeList,  sizeof(dbChannel), 128,
+        FREELIST_THREAD_CACHE);
+    freeListInitFlags(&chFilterFreeList,  sizeof(chFilter), 64,
+        FREELIST_THREAD_CACHE);
     db_init_event_freelists();
 }
 
@@ -52,6 +52,10 @@ struct evSubscrip {
     /* user_sub==NULL used to indicate db_cancel_event() */
     EVENTFUNC         * user_sub;
     void              * user_arg;
+    /* entry in the per-field index of dbCommon::mlis */
+    ELLNODE             fieldNode;
+    /* field index entry, NULL unless enabled */
+    struct evField    * pfield;
     /* associated queue, may be shared with other evSubscrip */
     struct event_que  * ev_que;
     /* NULL if !npend.  if npend!=0, pointer to last event added to event_que::valque */
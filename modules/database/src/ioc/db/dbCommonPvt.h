@@ -15,6 +15,20 @@ typedef struct dbCommonPvt {
     /* Thread which is currently processing this record */
     struct epicsThreadOSD* procThread;
 
+    /* Index of dbCommon::mlis by field, list of struct evField.
+     * Guarded by dbCommon::mlok
+     */
+    ELLLIST evFields;
+
+    /* Profile counters, NULL until dbProfileEnable(). Guarded by the lock set */
+    struct dbProfileData *prof;
+
+    /* Array buffer shared with monitors and the record field pointing to
+     * it, NULL unless attached by dbArrayBufAttach(). Guarded by the lock set
+     */
+    struct dbArrayBuf *arrayBuf;
+    void **arrayField;
+
     struct dbCommon common;
 } dbCommonPvt;
 
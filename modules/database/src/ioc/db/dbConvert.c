@@ -60,22 +60,65 @@ static void copyNoConvert(const void *pfrom,
 #define COPYNOCONVERT(N, FROM, TO, NREQ, NO_ELEM, OFFSET) \
     copyNoConvert(FROM, TO, (N)*(NREQ), (N)*(NO_ELEM), (N)*(OFFSET))
 
+/* Helpers for converting arrays element by element.
+ * The ring buffer wraps at most once, at no_elements, so the copy is split
+ * into two straight loops without the per-element wrap test, which lets
+ * the compiler vectorize the numeric conversions.
+ * nRequest, no_elements and offset are given in elements.
+ */
+static long wrapSplit(long nRequest, long no_elements, long offset)
+{
+    if (offset < no_elements && offset + nRequest > no_elements)
+        return no_elements - offset;
+    return nRequest;
+}
+#define CONVERT(typea, typeb, PFROM, PTO, N) \
+{ \
+    const typea *pcfrom = (PFROM); \
+    typeb *pcto = (PTO); \
+    long icvt, ncvt = (N); \
+    \
+    for (icvt = 0; icvt < ncvt; icvt++) \
+        pcto[icvt] = (typeb) pcfrom[icvt]; \
+}
+
+/* Array version of epicsConvertDoubleToFloat(), with the same results */
+static void convertDoubleToFloat(const epicsFloat64 *pfrom,
+    epicsFloat32 *pto, long n)
+{
+    long i;
+
+    /* Each case selects a result rather than branching, in order of
+     * increasing priority, so the loop can be vectorized.
+     */
+    for (i = 0; i < n; i++) {
+        epicsFloat64 value = pfrom[i];
+        epicsFloat64 abs = fabs(value);
+        epicsFloat64 sign = (value < 0) ? -1.0 : 1.0;
+        epicsFloat64 result = value;
+
+        result = (abs >= FLT_MAX) ? sign * FLT_MAX : result;
+        result = (abs > DBL_MAX) ? value : result;      /* infinite */
+        result = (abs <= FLT_MIN) ? sign * FLT_MIN : result;
+        result = (value == 0) ? value : result;
+        pto[i] = (epicsFloat32) result;
+    }
+}
+
 #define GET(typea, typeb) (const dbAddr *paddr, \
     void *pto, long nRequest, long no_elements, long offset) \
 { \
-    typea *psrc = (typea *) paddr->pfield; \
+    const typea *psrc = (const typea *) paddr->pfield; \
     typeb *pdst = (typeb *) pto; \
+    long n; \
     \
     if (nRequest==1 && offset==0) { \
         *pdst = (typeb) *psrc; \
         return 0; \
     } \
-    psrc += offset; \
-    while (nRequest--) { \
-        *pdst++ = (typeb) *psrc++; \
-        if (++offset == no_elements) \
-            psrc = (typea *) paddr->pfield; \
-    } \
+    n = wrapSplit(nRequest, no_elements, offset); \
+    CONVERT(typea, typeb, psrc + offset, pdst, n); \
+    CONVERT(typea, typeb, psrc, pdst + n, nRequest - n); \
     return 0; \
 }
 
@@ -98,17 +141,15 @@ static void copyNoConvert(const void *pfrom,
 { \
     const typea *psrc = (const typea *) pfrom; \
     typeb *pdst = (typeb *) paddr->pfield; \
+    long n; \
     \
     if (nRequest==1 && offset==0) { \
         *pdst = (typeb) *psrc; \
         return 0; \
     } \
-    pdst += offset; \
-    while (nRequest--) { \
-        *pdst++ = (typeb) *psrc++; \
-        if (++offset == no_elements) \
-            pdst = (typeb *) paddr->pfield; \
-    } \
+    n = wrapSplit(nRequest, no_elements, offset); \
+    CONVERT(typea, typeb, psrc, pdst + offset, n); \
+    CONVERT(typea, typeb, psrc + n, pdst, nRequest - n); \
     return 0; \
 }
 
@@ -810,20 +851,17 @@ static long getDoubleUInt64 GET(epicsFloat64, epicsUInt64)
 static long getDoubleFloat(const dbAddr *paddr,
     void *pto, long nRequest, long no_elements, long offset)
 {
-    epicsFloat64 *psrc = (epicsFloat64 *) paddr->pfield;
+    const epicsFloat64 *psrc = (const epicsFloat64 *) paddr->pfield;
     epicsFloat32 *pdst = (epicsFloat32 *) pto;
+    long n;
 
     if (nRequest==1 && offset==0) {
         *pdst = epicsConvertDoubleToFloat(*psrc);
         return 0;
     }
-    psrc += offset;
-    while (nRequest--) {
-        *pdst = epicsConvertDoubleToFloat(*psrc);
-        ++psrc; ++pdst;
-        if (++offset == no_elements)
-            psrc = (epicsFloat64 *) paddr->pfield;
-    }
+    n = wrapSplit(nRequest, no_elements, offset);
+    convertDoubleToFloat(psrc + offset, pdst, n);
+    convertDoubleToFloat(psrc, pdst + n, nRequest - n);
     return 0;
 }
 
@@ -1641,17 +1679,15 @@ static long putDoubleFloat(dbAddr *paddr,
 {
     const epicsFloat64 *psrc = (const epicsFloat64 *) pfrom;
     epicsFloat32 *pdst = (epicsFloat32 *) paddr->pfield;
+    long n;
 
     if (nRequest==1 && offset==0) {
         *pdst = epicsConvertDoubleToFloat(*psrc);
         return 0;
     }
-    pdst += offset;
-    while (nRequest--) {
-        *pdst++ = epicsConvertDoubleToFloat(*psrc++);
-        if (++offset == no_elements)
-            pdst = (epicsFloat32 *) paddr->pfield;
-    }
+    n = wrapSplit(nRequest, no_elements, offset);
+    convertDoubleToFloat(psrc, pdst + offset, n);
+    convertDoubleToFloat(psrc + n, pdst, nRequest - n);
     return 0;
 }
 
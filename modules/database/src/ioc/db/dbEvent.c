@@ -31,6 +31,7 @@
 #include "cantProceed.h"
 #include "dbDefs.h"
 #include "epicsAssert.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsThread.h"
@@ -42,9 +43,11 @@
 
 #include "dbAccessDefs.h"
 #include "dbAddr.h"
+#include "dbArrayBuf.h"
 #include "dbBase.h"
 #include "dbChannel.h"
 #include "dbCommon.h"
+#include "dbCommonPvt.h"
 #include "dbEvent.h"
 #include "db_field_log.h"
 #include "dbFldTypes.h"
@@ -109,6 +112,18 @@ typedef struct {
     epicsEventId wake;
 } event_waiter;
 
+/*
+ * One entry per distinct field with enabled subscriptions
+ * so that db_post_events() need only visit the subscribers
+ * of the field being posted.
+ */
+struct evField {
+    ELLNODE             node;           /* dbCommonPvt::evFields */
+    ELLLIST             subs;           /* evSubscrip::fieldNode */
+    void                *pfield;        /* dbAddr::compare */
+    unsigned            select;         /* union of evSubscrip::select */
+};
+
 /*
  * Reliable intertask communication requires copying the current value of the
  * channel for later queuing so 3 stepper motor steps of 10 each do not turn
@@ -127,9 +142,13 @@ static void *dbevEventUserFreeList;
 static void *dbevEventQueueFreeList;
 static void *dbevEventSubscriptionFreeList;
 static void *dbevFieldLogFreeList;
+static void *dbevFieldIndexFreeList;
 
 static char *EVENT_PEND_NAME = "eventTask";
 
+/* source of db_field_log::post_id */
+static size_t dbevPostId;
+
 static epicsMutexId stopSync;
 
 /* unused space in queue (EVENTQUESIZE when empty) */
@@ -273,12 +292,16 @@ void db_init_event_freelists (void)
             sizeof(struct event_que),8);
     }
     if (!dbevEventSubscriptionFreeList) {
-        freeListInitPvt(&dbevEventSubscriptionFreeList,
-            sizeof(struct evSubscrip),256);
+        freeListInitFlags(&dbevEventSubscriptionFreeList,
+            sizeof(struct evSubscrip),256,FREELIST_THREAD_CACHE);
     }
     if (!dbevFieldLogFreeList) {
-        freeListInitPvt(&dbevFieldLogFreeList,
-            sizeof(struct db_field_log),2048);
+        freeListInitFlags(&dbevFieldLogFreeList,
+            sizeof(struct db_field_log),2048,FREELIST_THREAD_CACHE);
+    }
+    if (!dbevFieldIndexFreeList) {
+        freeListInitPvt(&dbevFieldIndexFreeList,
+            sizeof(struct evField),256);
     }
 }
 
@@ -351,6 +374,9 @@ DBCORE_API void db_cleanup_events(void)
 
     if(dbevFieldLogFreeList) freeListCleanup(dbevFieldLogFreeList);
     dbevFieldLogFreeList = NULL;
+
+    if(dbevFieldIndexFreeList) freeListCleanup(dbevFieldIndexFreeList);
+    dbevFieldIndexFreeList = NULL;
 }
 
     /* intentionally leak stopSync to avoid possible shutdown races */
@@ -502,6 +528,71 @@ dbEventSubscription db_add_event (
     return pevent;
 }
 
+/*
+ * field_index_find()
+ * record mlok _must_ be applied
+ */
+static struct evField * field_index_find ( struct dbCommon *precord,
+    void *pfield )
+{
+    struct evField *pfi;
+
+    for ( pfi = (struct evField *) ellFirst ( &dbRec2Pvt(precord)->evFields );
+        pfi; pfi = (struct evField *) ellNext ( &pfi->node ) ) {
+        if ( pfi->pfield == pfield ) break;
+    }
+    return pfi;
+}
+
+/*
+ * field_index_add()
+ * record mlok _must_ be applied
+ */
+static int field_index_add ( struct dbCommon *precord,
+    struct evSubscrip *pevent )
+{
+    struct evField *pfi = field_index_find ( precord,
+        pevent->chan->addr.compare );
+
+    if ( ! pfi ) {
+        pfi = freeListCalloc ( dbevFieldIndexFreeList );
+        if ( ! pfi ) {
+            return FALSE;
+        }
+        pfi->pfield = pevent->chan->addr.compare;
+        ellAdd ( &dbRec2Pvt(precord)->evFields, &pfi->node );
+    }
+    ellAdd ( &pfi->subs, &pevent->fieldNode );
+    pfi->select |= pevent->select;
+    pevent->pfield = pfi;
+    return TRUE;
+}
+
+/*
+ * field_index_remove()
+ * record mlok _must_ be applied
+ */
+static void field_index_remove ( struct dbCommon *precord,
+    struct evSubscrip *pevent )
+{
+    struct evField * const pfi = pevent->pfield;
+    ELLNODE *cur;
+
+    ellDelete ( &pfi->subs, &pevent->fieldNode );
+    pevent->pfield = NULL;
+
+    if ( ellCount ( &pfi->subs ) == 0 ) {
+        ellDelete ( &dbRec2Pvt(precord)->evFields, &pfi->node );
+        freeListFree ( dbevFieldIndexFreeList, pfi );
+        return;
+    }
+
+    pfi->select = 0u;
+    for ( cur = ellFirst ( &pfi->subs ); cur; cur = ellNext ( cur ) ) {
+        pfi->select |= CONTAINER ( cur, struct evSubscrip, fieldNode )->select;
+    }
+}
+
 /*
  * db_event_enable()
  */
@@ -512,8 +603,13 @@ void db_event_enable (dbEventSubscription event)
 
     LOCKREC (precord);
     if ( ! pevent->enabled ) {
-        ellAdd (&precord->mlis, &pevent->node);
-        pevent->enabled = TRUE;
+        if ( field_index_add ( precord, pevent ) ) {
+            ellAdd (&precord->mlis, &pevent->node);
+            pevent->enabled = TRUE;
+        }
+        else {
+            errlogPrintf ( ERL_ERROR " db_event_enable: no memory for field index\n" );
+        }
     }
     UNLOCKREC (precord);
 }
@@ -529,6 +625,7 @@ void db_event_disable (dbEventSubscription event)
     LOCKREC (precord);
     if ( pevent->enabled ) {
         ellDelete(&precord->mlis, &pevent->node);
+        field_index_remove ( precord, pevent );
         pevent->enabled = FALSE;
     }
     UNLOCKREC (precord);
@@ -858,6 +955,54 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
     }
 }
 
+/*
+ *  next_post_id()
+ */
+static size_t next_post_id (void)
+{
+    size_t id;
+
+    /* zero is reserved to mean "not from a post" */
+    while ( ( id = epicsAtomicIncrSizeT ( &dbevPostId ) ) == 0u ) {}
+    return id;
+}
+
+/* Array snapshot shared by the subscriptions updated by one post */
+struct post_snapshot {
+    struct dbArrayBuf *pbuf;
+    const dbFldDes *pfldDes;
+    long nelements;
+};
+
+/*
+ *  DB_POST_ONE_EVENT()
+ *
+ *  record mlok _must_ be applied
+ */
+static void db_post_one_event (evSubscrip *pevent, unsigned int caEventMask,
+    size_t postId, struct post_snapshot *psnap)
+{
+    db_field_log *pLog = db_create_event_log(pevent);
+    if(pLog) {
+        pLog->mask = caEventMask & pevent->select;
+        pLog->post_id = postId;
+
+        if (pLog->type == dbfl_type_ref) {
+            const dbFldDes *pfldDes = dbChannelFldDes(pevent->chan);
+
+            if (!psnap->pbuf) {
+                psnap->pbuf = dbArrayBufSnapshot(pevent->chan,
+                    &psnap->nelements);
+                psnap->pfldDes = pfldDes;
+            }
+            if (psnap->pbuf && psnap->pfldDes == pfldDes)
+                dbArrayBufSetLog(psnap->pbuf, psnap->nelements, pLog);
+        }
+    }
+    pLog = dbChannelRunPreChain(pevent->chan, pLog);
+    if (pLog) db_queue_event_log(pevent, pLog);
+}
+
 /*
  *  DB_POST_EVENTS()
  *
@@ -872,29 +1017,66 @@ unsigned int    caEventMask
 {
     struct dbCommon   * const prec = (struct dbCommon *) pRecord;
     struct evSubscrip *pevent;
+    struct post_snapshot snap = {NULL, NULL, 0};
+    size_t postId = 0u;
 
 //    if (prec->mlis.count == 0) return DB_EVENT_OK;       /* no monitors set */
 
     LOCKREC (prec);
 
-    for (pevent = (struct evSubscrip *) prec->mlis.node.next;
-        pevent; pevent = (struct evSubscrip *) pevent->node.next){
+    /*
+     * Only send event msg if they are waiting on the field which
+     * changed or pval==NULL, and are waiting on matching event
+     */
+    if (pField == NULL) {
+        int nsubs = 0;
+
+        /* only a post seen by several subscriptions gets a post_id */
+        for (pevent = (struct evSubscrip *) prec->mlis.node.next;
+            pevent && nsubs < 2;
+            pevent = (struct evSubscrip *) pevent->node.next) {
+            if (caEventMask & pevent->select)
+                nsubs++;
+        }
+        if (nsubs > 1)
+            postId = next_post_id();
+
+        for (pevent = (struct evSubscrip *) prec->mlis.node.next;
+            pevent; pevent = (struct evSubscrip *) pevent->node.next){
 
-        /*
-         * Only send event msg if they are waiting on the field which
-         * changed or pval==NULL, and are waiting on matching event
-         */
-        if ( (pevent->chan->addr.compare == (void *)pField || pField==NULL) &&
-            (caEventMask & pevent->select)) {
-            db_field_log *pLog = db_create_event_log(pevent);
-            if(pLog)
-                pLog->mask = caEventMask & pevent->select;
-            pLog = dbChannelRunPreChain(pevent->chan, pLog);
-            if (pLog) db_queue_event_log(pevent, pLog);
+            if (caEventMask & pevent->select)
+                db_post_one_event(pevent, caEventMask, postId, &snap);
+        }
+    }
+    else {
+        struct evField *pfi = field_index_find(prec, pField);
+
+        if (pfi && (caEventMask & pfi->select)) {
+            ELLNODE *cur;
+            int nsubs = 0;
+
+            for (cur = ellFirst(&pfi->subs); cur && nsubs < 2;
+                cur = ellNext(cur)) {
+                pevent = CONTAINER(cur, struct evSubscrip, fieldNode);
+                if (caEventMask & pevent->select)
+                    nsubs++;
+            }
+            if (nsubs > 1)
+                postId = next_post_id();
+
+            for (cur = ellFirst(&pfi->subs); cur; cur = ellNext(cur)) {
+                pevent = CONTAINER(cur, struct evSubscrip, fieldNode);
+
+                if (caEventMask & pevent->select)
+                    db_post_one_event(pevent, caEventMask, postId, &snap);
+            }
         }
     }
 
     UNLOCKREC (prec);
+
+    if (snap.pbuf)
+        dbArrayBufRelease(snap.pbuf);
     return DB_EVENT_OK;
 
 }
@@ -911,6 +1093,20 @@ void db_post_single_event (dbEventSubscription event)
     dbScanLock (prec);
 
     pLog = db_create_event_log(pevent);
+    if(pLog) {
+        pLog->post_id = 0u; /* nothing to share with */
+
+        if (pLog->type == dbfl_type_ref) {
+            long nelements;
+            struct dbArrayBuf *pbuf = dbArrayBufSnapshot(pevent->chan,
+                &nelements);
+
+            if (pbuf) {
+                dbArrayBufSetLog(pbuf, nelements, pLog);
+                dbArrayBufRelease(pbuf);
+            }
+        }
+    }
     pLog = dbChannelRunPreChain(pevent->chan, pLog);
     if(pLog) db_queue_event_log(pevent, pLog);
 
@@ -22,6 +22,7 @@
 #include "dbJLink.h"
 #include "dbLock.h"
 #include "dbNotify.h"
+#include "dbProfile.h"
 #include "dbScan.h"
 #include "dbServer.h"
 #include "dbState.h"
@@ -44,6 +45,8 @@ static const iocshFuncDef dbLoadDatabaseFuncDef = {
     dbLoadDatabaseArgs,
     "Load the given .dbd file, with 'path' added as a search path, with the given substitutions.\n\n"
     "Substitutions are usually not needed for .dbd files.\n\n"
+    "A .dbdi image made from a .dbd file by dbdToImage.pl is restored\n"
+    "without parsing, which is faster.\n\n"
     "Example: dbLoadDatabase dbd/my.dbd\n",
 };
 static void dbLoadDatabaseCallFunc(const iocshArgBuf *args)
@@ -414,6 +417,39 @@ static const iocshFuncDef dbLockShowLockedFuncDef = {
 static void dbLockShowLockedCallFunc(const iocshArgBuf *args)
 { dbLockShowLocked(args[0].ival);}
 
+/* dbProfileEnable */
+static const iocshArg dbProfileEnableArg0 = { "enable",iocshArgInt};
+static const iocshArg * const dbProfileEnableArgs[1] = {&dbProfileEnableArg0};
+static const iocshFuncDef dbProfileEnableFuncDef = {
+    "dbProfileEnable",1,dbProfileEnableArgs,
+    "Start (1) or stop (0) measuring the processing time of each record\n"
+    "and its waits for the lock set.\n\n"
+    "Example: dbProfileEnable 1\n"
+};
+static void dbProfileEnableCallFunc(const iocshArgBuf *args)
+{ iocshSetError(dbProfileEnable(args[0].ival));}
+
+/* dbProfileReset */
+static const iocshFuncDef dbProfileResetFuncDef = {
+    "dbProfileReset",0,NULL,
+    "Clear the record processing time counters.\n"
+};
+static void dbProfileResetCallFunc(const iocshArgBuf *args)
+{ iocshSetError(dbProfileReset());}
+
+/* dbProfileReport */
+static const iocshArg dbProfileReportArg0 = { "top N",iocshArgInt};
+static const iocshArg * const dbProfileReportArgs[1] = {&dbProfileReportArg0};
+static const iocshFuncDef dbProfileReportFuncDef = {
+    "dbProfileReport",1,dbProfileReportArgs,
+    "Show the records which took the most processing time overall,\n"
+    "on each scan list, and of each record type, with top N records each.\n"
+    "Self time excludes records processed from a record, e.g. by FLNK.\n\n"
+    "Example: dbProfileReport 10\n"
+};
+static void dbProfileReportCallFunc(const iocshArgBuf *args)
+{ iocshSetError(dbProfileReport(args[0].ival));}
+
 /* scanOnceSetQueueSize */
 static const iocshArg scanOnceSetQueueSizeArg0 = { "size",iocshArgInt};
 static const iocshArg * const scanOnceSetQueueSizeArgs[1] =
@@ -446,6 +482,20 @@ static const iocshFuncDef scanpplFuncDef = {"scanppl",1,scanpplArgs,
 static void scanpplCallFunc(const iocshArgBuf *args)
 { scanppl(args[0].dval);}
 
+/* scanPeriodicThreads */
+static const iocshArg scanPeriodicThreadsArg0 = { "no of threads",iocshArgInt};
+static const iocshArg scanPeriodicThreadsArg1 = { "rate",iocshArgDouble};
+static const iocshArg * const scanPeriodicThreadsArgs[2] =
+    {&scanPeriodicThreadsArg0,&scanPeriodicThreadsArg1};
+static const iocshFuncDef scanPeriodicThreadsFuncDef = {"scanPeriodicThreads",2,scanPeriodicThreadsArgs,
+                                                        "Process a periodic scan list with several threads.\n"
+                                                        "Records sharing a lock set are processed by the same thread.\n"
+                                                        "If rate == 0.0, all periodic scan lists are configured.\n"
+                                                        "no of threads <= 0 is relative to the number of CPUs.\n"
+                                                        "Must be called before iocInit.\n"};
+static void scanPeriodicThreadsCallFunc(const iocshArgBuf *args)
+{ scanPeriodicThreads(args[0].ival, args[1].dval);}
+
 /* scanpel */
 static const iocshArg scanpelArg0 = { "event name",iocshArgString};
 static const iocshArg * const scanpelArgs[1] = {&scanpelArg0};
@@ -606,10 +656,14 @@ void dbIocRegister(void)
     iocshRegister(&tpnFuncDef,tpnCallFunc);
     iocshRegister(&dblsrFuncDef,dblsrCallFunc);
     iocshRegister(&dbLockShowLockedFuncDef,dbLockShowLockedCallFunc);
+    iocshRegister(&dbProfileEnableFuncDef,dbProfileEnableCallFunc);
+    iocshRegister(&dbProfileResetFuncDef,dbProfileResetCallFunc);
+    iocshRegister(&dbProfileReportFuncDef,dbProfileReportCallFunc);
 
     iocshRegister(&scanOnceSetQueueSizeFuncDef,scanOnceSetQueueSizeCallFunc);
     iocshRegister(&scanOnceQueueShowFuncDef,scanOnceQueueShowCallFunc);
     iocshRegister(&scanpplFuncDef,scanpplCallFunc);
+    iocshRegister(&scanPeriodicThreadsFuncDef,scanPeriodicThreadsCallFunc);
     iocshRegister(&scanpelFuncDef,scanpelCallFunc);
     iocshRegister(&postEventFuncDef,postEventCallFunc);
     iocshRegister(&scanpiolFuncDef,scanpiolCallFunc);
@@ -23,6 +23,7 @@
 #include "epicsSpin.h"
 #include "epicsStdio.h"
 #include "epicsThread.h"
+#include "epicsTime.h"
 #include "errMdef.h"
 
 #include "dbAccessDefs.h"
@@ -32,6 +33,7 @@
 #include "dbCommon.h"
 #include "dbFldTypes.h"
 #include "dbLockPvt.h"
+#include "dbProfilePvt.h"
 #include "dbStaticPvt.h"
 #include "link.h"
 
@@ -186,6 +188,8 @@ void dbScanLock(dbCommon *precord)
     int cnt;
     lockRecord * const lr = precord->lset;
     lockSet *ls;
+    int profile = dbProfileActive;
+    epicsUInt64 waited = 0;
 
     assert(lr);
 
@@ -193,7 +197,15 @@ void dbScanLock(dbCommon *precord)
     assert(epicsAtomicGetIntT(&ls->refcount)>0);
 
 retry:
-    epicsMutexMustLock(ls->lock);
+    if (!profile) {
+        epicsMutexMustLock(ls->lock);
+    }
+    else if (epicsMutexTryLock(ls->lock) != epicsMutexLockOK) {
+        epicsUInt64 start = epicsMonotonicGet();
+
+        epicsMutexMustLock(ls->lock);
+        waited += epicsMonotonicGet() - start;
+    }
 
     epicsSpinLock(lr->spin);
     if(ls!=lr->plockSet) {
@@ -232,6 +244,9 @@ retry:
         ls->ownercount = 1;
     }
 #endif
+
+    if (waited)
+        dbProfileLockWait(precord, waited);
 }
 
 void dbScanUnlock(dbCommon *precord)
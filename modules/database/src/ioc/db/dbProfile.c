@@ -0,0 +1,341 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/* Record processing time profiler, see dbProfile.h
+ *
+ * The counters of each record are kept in a dbProfileData allocated when
+ * profiling is first enabled and found through dbCommonPvt.  Records
+ * processed from another record are tracked with a stack of frames per
+ * thread so that their time can be taken out of the caller's self time.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dbDefs.h"
+#include "epicsAtomic.h"
+#include "epicsStdio.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+
+#include "dbAccessDefs.h"
+#include "dbBase.h"
+#include "dbCommon.h"
+#include "dbCommonPvt.h"
+#include "dbStaticLib.h"
+#include "dbProfilePvt.h"
+
+int dbProfileActive;
+
+static epicsThreadOnceId profileOnce = EPICS_THREAD_ONCE_INIT;
+static epicsThreadPrivateId profileFrame;
+
+/* when the counters were last reset */
+static epicsUInt64 profileSince;
+
+static void profileInit(void *junk)
+{
+    profileFrame = epicsThreadPrivateCreate();
+}
+
+static dbProfileData *recProfile(dbCommon *precord)
+{
+    return (dbProfileData *) epicsAtomicGetPtrT(
+        (EpicsAtomicPtrT *) &dbRec2Pvt(precord)->prof);
+}
+
+void dbProfileStart(dbProfileFrame *pframe)
+{
+    pframe->outer = epicsThreadPrivateGet(profileFrame);
+    pframe->child = 0;
+    epicsThreadPrivateSet(profileFrame, pframe);
+    pframe->start = epicsMonotonicGet();
+}
+
+void dbProfileEnd(dbCommon *precord, dbProfileFrame *pframe)
+{
+    epicsUInt64 total = epicsMonotonicGet() - pframe->start;
+    dbProfileData *prof = recProfile(precord);
+
+    epicsThreadPrivateSet(profileFrame, pframe->outer);
+    if (pframe->outer)
+        pframe->outer->child += total;
+
+    if (!prof)
+        return;
+    if (!prof->count || total < prof->min)
+        prof->min = total;
+    if (total > prof->max)
+        prof->max = total;
+    prof->count++;
+    prof->total += total;
+    prof->self += total - pframe->child;
+}
+
+void dbProfileLockWait(dbCommon *precord, epicsUInt64 wait)
+{
+    dbProfileData *prof = recProfile(precord);
+
+    if (prof) {
+        prof->lockCount++;
+        prof->lockWait += wait;
+    }
+}
+
+/* Call func for each record, not for aliases */
+static void forEachRecord(void (*func)(dbCommon *precord, void *arg),
+    void *arg)
+{
+    DBENTRY entry;
+    long status;
+
+    dbInitEntry(pdbbase, &entry);
+    for (status = dbFirstRecordType(&entry); !status;
+         status = dbNextRecordType(&entry)) {
+        for (status = dbFirstRecord(&entry); !status;
+             status = dbNextRecord(&entry)) {
+            if (!dbIsAlias(&entry))
+                func(entry.precnode->precord, arg);
+        }
+    }
+    dbFinishEntry(&entry);
+}
+
+static void allocProfile(dbCommon *precord, void *arg)
+{
+    dbCommonPvt *ppvt = dbRec2Pvt(precord);
+
+    if (!ppvt->prof)
+        epicsAtomicSetPtrT((EpicsAtomicPtrT *) &ppvt->prof,
+            dbCalloc(1, sizeof(dbProfileData)));
+}
+
+long dbProfileEnable(int enable)
+{
+    if (!pdbbase) {
+        printf("dbProfileEnable: No database loaded\n");
+        return -1;
+    }
+    epicsThreadOnce(&profileOnce, profileInit, NULL);
+
+    if (enable) {
+        if (!profileSince)
+            profileSince = epicsMonotonicGet();
+        forEachRecord(allocProfile, NULL);
+    }
+    epicsAtomicSetIntT(&dbProfileActive, enable != 0);
+    return 0;
+}
+
+static void resetProfile(dbCommon *precord, void *arg)
+{
+    dbProfileData *prof = recProfile(precord);
+
+    /* not locked, an update at the same time may survive the reset */
+    if (prof)
+        memset(prof, 0, sizeof(*prof));
+}
+
+long dbProfileReset(void)
+{
+    if (!pdbbase) {
+        printf("dbProfileReset: No database loaded\n");
+        return -1;
+    }
+    forEachRecord(resetProfile, NULL);
+    profileSince = epicsMonotonicGet();
+    return 0;
+}
+
+long dbProfileGet(const char *recordName, dbProfileData *pdata)
+{
+    DBENTRY entry;
+    dbProfileData *prof = NULL;
+
+    if (!pdbbase)
+        return -1;
+    dbInitEntry(pdbbase, &entry);
+    if (!dbFindRecord(&entry, recordName))
+        prof = recProfile(entry.precnode->precord);
+    dbFinishEntry(&entry);
+
+    if (!prof)
+        return -1;
+    *pdata = *prof;
+    return 0;
+}
+
+typedef struct {
+    dbCommon *precord;
+    dbProfileData data;
+} profileEntry;
+
+typedef struct {
+    profileEntry *entries;
+    size_t count;
+    size_t alloc;
+} profileList;
+
+static void collectProfile(dbCommon *precord, void *arg)
+{
+    profileList *plist = arg;
+    dbProfileData *prof = recProfile(precord);
+
+    if (!prof || !prof->count || plist->count >= plist->alloc)
+        return;
+    plist->entries[plist->count].precord = precord;
+    plist->entries[plist->count].data = *prof;
+    plist->count++;
+}
+
+static void countRecord(dbCommon *precord, void *arg)
+{
+    (*(size_t *) arg)++;
+}
+
+static int cmpSelf(const void *a, const void *b)
+{
+    const profileEntry *pa = a, *pb = b;
+
+    if (pa->data.self != pb->data.self)
+        return pa->data.self < pb->data.self ? 1 : -1;
+    return strcmp(pa->precord->name, pb->precord->name);
+}
+
+#define MS(ns) ((double) (ns) * 1e-6)
+#define US(ns) ((double) (ns) * 1e-3)
+
+static void printHeader(void)
+{
+    printf("    self ms   total ms      count   avg us   min us   max us"
+        "  waits  wait ms  record\n");
+}
+
+static void printEntry(const profileEntry *pentry)
+{
+    const dbProfileData *p = &pentry->data;
+
+    printf(" %10.3f %10.3f %10llu %8.1f %8.1f %8.1f %6llu %8.3f  %s (%s)\n",
+        MS(p->self), MS(p->total), (unsigned long long) p->count,
+        US(p->total) / p->count, US(p->min), US(p->max),
+        (unsigned long long) p->lockCount, MS(p->lockWait),
+        pentry->precord->name, pentry->precord->rdes->name);
+}
+
+/* Print a summary of the entries for which select() is true, and the
+ * first topN of them.
+ */
+static void printGroup(const profileList *plist, int topN, double elapsed,
+    int (*select)(const profileEntry *, const void *), const void *arg,
+    const char *title)
+{
+    epicsUInt64 count = 0, self = 0, wait = 0;
+    size_t i, n = 0;
+    int shown = 0;
+
+    for (i = 0; i < plist->count; i++) {
+        const profileEntry *pentry = &plist->entries[i];
+
+        if (select(pentry, arg)) {
+            n++;
+            count += pentry->data.count;
+            self += pentry->data.self;
+            wait += pentry->data.lockWait;
+        }
+    }
+    if (!n)
+        return;
+
+    printf("%s: %lu records processed %llu times, "
+        "%.3f ms self (%.2f%%), %.3f ms lock wait\n",
+        title, (unsigned long) n, (unsigned long long) count,
+        MS(self), elapsed > 0 ? 100.0 * self / elapsed : 0.0, MS(wait));
+    if (topN <= 0)
+        return;
+
+    printHeader();
+    for (i = 0; i < plist->count && shown < topN; i++) {
+        const profileEntry *pentry = &plist->entries[i];
+
+        if (select(pentry, arg)) {
+            printEntry(pentry);
+            shown++;
+        }
+    }
+}
+
+static int selectAll(const profileEntry *pentry, const void *arg)
+{
+    return 1;
+}
+
+static int selectScan(const profileEntry *pentry, const void *arg)
+{
+    return pentry->precord->scan == *(const int *) arg;
+}
+
+static int selectType(const profileEntry *pentry, const void *arg)
+{
+    return pentry->precord->rdes == arg;
+}
+
+long dbProfileReport(int topN)
+{
+    profileList list;
+    dbMenu *pmenu;
+    ELLNODE *node;
+    double elapsed;
+    int scan;
+
+    if (!pdbbase) {
+        printf("dbProfileReport: No database loaded\n");
+        return -1;
+    }
+    if (!profileSince) {
+        printf("dbProfileReport: Profiling was never enabled\n");
+        return -1;
+    }
+
+    list.count = list.alloc = 0;
+    forEachRecord(countRecord, &list.alloc);
+    list.entries = calloc(list.alloc ? list.alloc : 1, sizeof(profileEntry));
+    if (!list.entries) {
+        printf("dbProfileReport: Out of memory\n");
+        return -1;
+    }
+    forEachRecord(collectProfile, &list);
+    qsort(list.entries, list.count, sizeof(profileEntry), cmpSelf);
+
+    elapsed = (double) (epicsMonotonicGet() - profileSince);
+    printf("Record processing profile, %s, over %.3f s\n",
+        epicsAtomicGetIntT(&dbProfileActive) ? "active" : "stopped",
+        elapsed * 1e-9);
+    printGroup(&list, topN, elapsed, selectAll, NULL, "All");
+
+    printf("\nBy scan list\n");
+    pmenu = dbFindMenu(pdbbase, "menuScan");
+    for (scan = 0; pmenu && scan < pmenu->nChoice; scan++) {
+        char title[64];
+
+        epicsSnprintf(title, sizeof(title), "SCAN \"%s\"",
+            pmenu->papChoiceValue[scan]);
+        printGroup(&list, topN, elapsed, selectScan, &scan, title);
+    }
+
+    printf("\nBy record type\n");
+    for (node = ellFirst(&pdbbase->recordTypeList); node;
+         node = ellNext(node)) {
+        dbRecordType *pdbRecordType = CONTAINER(node, dbRecordType, node);
+
+        printGroup(&list, topN, elapsed, selectType, pdbRecordType,
+            pdbRecordType->name);
+    }
+
+    free(list.entries);
+    return 0;
+}
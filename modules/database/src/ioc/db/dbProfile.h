@@ -0,0 +1,67 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/** @file dbProfile.h
+ * @brief Record processing time profiler
+ *
+ * When enabled, dbProcess() measures how long each record takes to
+ * process and dbScanLock() how long it waits for the lock set.  The
+ * counters of a record are guarded by its lock set.  Times are in
+ * nanoseconds from epicsMonotonicGet().
+ *
+ * The total time of a record includes the records processed from it,
+ * for example through its forward link, while the self time excludes
+ * them.  Only the first phase of asynchronous processing is measured.
+ */
+
+#ifndef INC_dbProfile_H
+#define INC_dbProfile_H
+
+#include "epicsTypes.h"
+#include "dbCoreAPI.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Profile counters of one record */
+typedef struct dbProfileData {
+    epicsUInt64 count;      /**< @brief dbProcess() calls */
+    epicsUInt64 total;      /**< @brief including records processed from it */
+    epicsUInt64 self;       /**< @brief excluding records processed from it */
+    epicsUInt64 min;        /**< @brief of total, per call */
+    epicsUInt64 max;        /**< @brief of total, per call */
+    epicsUInt64 lockCount;  /**< @brief dbScanLock() calls which had to wait */
+    epicsUInt64 lockWait;   /**< @brief time those calls waited */
+} dbProfileData;
+
+/** @brief Start (non-zero) or stop (zero) profiling.
+ *
+ * Starting allocates counters for all records which do not have them yet.
+ * Stopping keeps the counters.
+ */
+DBCORE_API long dbProfileEnable(int enable);
+
+/** @brief Clear the counters of all records. */
+DBCORE_API long dbProfileReset(void);
+
+/** @brief Print the topN records with the most self time overall, for
+ * each scan list, and for each record type.
+ */
+DBCORE_API long dbProfileReport(int topN);
+
+/** @brief Copy the counters of the named record.
+ *
+ * @return 0, or non-zero if there is no such record or it was never
+ * profiled.
+ */
+DBCORE_API long dbProfileGet(const char *recordName, dbProfileData *pdata);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_dbProfile_H */
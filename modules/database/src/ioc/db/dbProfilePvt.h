@@ -0,0 +1,32 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+#ifndef INC_dbProfilePvt_H
+#define INC_dbProfilePvt_H
+
+#include "epicsTypes.h"
+#include "dbProfile.h"
+
+struct dbCommon;
+
+/* One dbProcess() call being measured, on the stack of its thread */
+typedef struct dbProfileFrame {
+    struct dbProfileFrame *outer;
+    epicsUInt64 start;
+    epicsUInt64 child;      /* total of dbProcess() calls made from it */
+} dbProfileFrame;
+
+/* Non-zero while profiling.  Checked before calling the functions below. */
+extern int dbProfileActive;
+
+/* Called by dbProcess() with the record's lock set held */
+void dbProfileStart(dbProfileFrame *pframe);
+void dbProfileEnd(struct dbCommon *precord, dbProfileFrame *pframe);
+
+/* Called by dbScanLock() once it has the lock */
+void dbProfileLockWait(struct dbCommon *precord, epicsUInt64 wait);
+
+#endif /* INC_dbProfilePvt_H */
@@ -87,6 +87,17 @@ typedef struct scan_element{
 
 #define OVERRUN_REPORT_DELAY 10.0   /* Time between initial reports */
 #define OVERRUN_REPORT_MAX 3600.0   /* Maximum time between reports */
+
+struct periodic_scan_list;
+
+/* Helper thread processing part of a periodic scan list */
+typedef struct periodic_worker {
+    struct periodic_scan_list *ppsl;
+    epicsThreadId       tid;
+    epicsEventId        startEvent;
+    int                 index;
+} periodic_worker;
+
 typedef struct periodic_scan_list {
     scan_list           scan_list;
     double              period;
@@ -94,12 +105,38 @@ typedef struct periodic_scan_list {
     unsigned long       overruns;
     volatile enum ctl   scanCtl;
     epicsEventId        loopEvent;
+
+    /* Parallel processing, only used when nThreads > 1.
+     * The scan thread copies scan_list into snapshot[] when it changes,
+     * and splits each run of records with equal PHAS between itself and
+     * nThreads-1 workers, by lock set.  Runs are processed in order.
+     */
+    int                 nThreads;
+    periodic_worker     *workers;
+    scan_element        **snapshot;
+    int                 *partition;     /* lock set id % nThreads */
+    int                 *phaseEnd;      /* end index of each PHAS run */
+    int                 nSnapshot;
+    int                 nPhases;
+    int                 maxSnapshot;
+    int                 first, end;     /* current PHAS run */
+    int                 pending;        /* use atomic */
+    int                 workersExit;
+    epicsEventId        doneEvent;
 } periodic_scan_list;
 
 static int nPeriodic = 0;
 static periodic_scan_list **papPeriodic; /* pointer to array of pointers */
 static epicsThreadId *periodicTaskId;    /* array of thread ids */
 
+/* Requests from scanPeriodicThreads(), applied by initPeriodic() */
+typedef struct periodic_threads_req {
+    ELLNODE             node;
+    double              period;         /* 0.0 for all */
+    int                 count;
+} periodic_threads_req;
+static ELLLIST periodicThreadsReq = ELLLIST_INIT;
+
 
 static char *priorityName[NUM_CALLBACK_PRIORITIES] = {
     "Low", "Medium", "High"
@@ -141,6 +178,7 @@ static void periodicTask(void *arg);
 static void initPeriodic(void);
 static void deletePeriodic(void);
 static void spawnPeriodic(int ind);
+static void scanListParallel(periodic_scan_list *ppsl);
 static void eventCallback(epicsCallback *pcallback);
 static void ioscanInit(void);
 static void ioscanCallback(epicsCallback *pcallback);
@@ -188,6 +226,8 @@ void scanCleanup(void)
     free(periodicTaskId);
     papPeriodic = NULL;
     periodicTaskId = NULL;
+
+    ellFree(&periodicThreadsReq);
 }
 
 long scanInit(void)
@@ -401,13 +441,44 @@ int scanppl(double period)      /* print periodic scan list(s) */
             (fabs(period - ppsl->period) > 0.05))
             continue;
 
-        sprintf(message, "Records with SCAN = '%s' (%lu over-runs):",
-            ppsl->name, ppsl->overruns);
+        if (ppsl->nThreads > 1)
+            epicsSnprintf(message, sizeof(message),
+                "Records with SCAN = '%s' (%lu over-runs, %d threads):",
+                ppsl->name, ppsl->overruns, ppsl->nThreads);
+        else
+            sprintf(message, "Records with SCAN = '%s' (%lu over-runs):",
+                ppsl->name, ppsl->overruns);
         printList(&ppsl->scan_list, message);
     }
     return 0;
 }
 
+int scanPeriodicThreads(int count, double period)
+{
+    periodic_threads_req *preq;
+
+    if (papPeriodic) {
+        fprintf(stderr, "scanPeriodicThreads: dbScan already initialized\n");
+        return -1;
+    }
+    if (period < 0.0) {
+        fprintf(stderr, "scanPeriodicThreads: Bad period %g\n", period);
+        return -1;
+    }
+
+    if (count < 0)
+        count = epicsThreadGetCPUs() + count;
+    else if (count == 0)
+        count = epicsThreadGetCPUs();
+    if (count < 1) count = 1;
+
+    preq = dbCalloc(1, sizeof(periodic_threads_req));
+    preq->period = period;
+    preq->count = count;
+    ellAdd(&periodicThreadsReq, &preq->node);
+    return 0;
+}
+
 int scanpel(const char* eventname)   /* print event list */
 {
     char message[80];
@@ -800,8 +871,12 @@ static void periodicTask(void *arg)
         double delay;
         epicsTimeStamp now;
 
-        if (ppsl->scanCtl == ctlRun)
-            scanList(&ppsl->scan_list);
+        if (ppsl->scanCtl == ctlRun) {
+            if (ppsl->nThreads > 1)
+                scanListParallel(ppsl);
+            else
+                scanList(&ppsl->scan_list);
+        }
 
         epicsTimeAddSeconds(&next, ppsl->period);
         epicsTimeGetMonotonic(&now);
@@ -826,9 +901,11 @@ static void periodicTask(void *arg)
                 errlogPrintf("\ndbScan " ERL_WARNING " from '%s' scan thread:\n"
                     "\tScan processing averages %.3f seconds (%.3f .. %.3f).\n"
                     "\tOver-runs have now happened %u times in a row.\n"
-                    "\tTo fix this, move some records to a slower scan rate.\n",
+                    "\tTo fix this, move some records to a slower scan rate%s.\n",
                     ppsl->name, ppsl->period + overtime / overruns,
-                    ppsl->period + over_min, ppsl->period + over_max, overruns);
+                    ppsl->period + over_min, ppsl->period + over_max, overruns,
+                    ppsl->nThreads > 1 ? "" :
+                        ",\n\tor spread them over threads with scanPeriodicThreads");
 
                 reported = now;
                 if (report_delay < (OVERRUN_REPORT_MAX / 2))
@@ -846,15 +923,132 @@ static void periodicTask(void *arg)
         epicsEventWaitWithTimeout(ppsl->loopEvent, delay);
     }
 
+    if (ppsl->nThreads > 1) {
+        int i;
+
+        ppsl->workersExit = TRUE;
+        for (i = 0; i < ppsl->nThreads - 1; i++)
+            epicsEventMustTrigger(ppsl->workers[i].startEvent);
+        for (i = 0; i < ppsl->nThreads - 1; i++)
+            epicsThreadMustJoin(ppsl->workers[i].tid);
+    }
+
     taskwdRemove(0);
     epicsEventSignal(startStopEvent);
 }
 
+/* Process this thread's share of the current PHAS run.
+ * Whether a record is still in this list is checked with it locked,
+ * as SCAN and PHAS are only changed with the record locked.
+ */
+static void scanPartition(periodic_scan_list *ppsl, int index)
+{
+    int i;
+
+    for (i = ppsl->first; i < ppsl->end; i++) {
+        scan_element *pse = ppsl->snapshot[i];
+        struct dbCommon *precord = pse->precord;
+
+        if (ppsl->partition[i] != index)
+            continue;
+
+        dbScanLock(precord);
+        if (pse->pscan_list == &ppsl->scan_list)
+            dbProcess(precord);
+        dbScanUnlock(precord);
+    }
+}
+
+static void periodicWorker(void *arg)
+{
+    periodic_worker *pw = (periodic_worker *)arg;
+    periodic_scan_list *ppsl = pw->ppsl;
+
+    taskwdInsert(0, NULL, NULL);
+    epicsEventSignal(startStopEvent);
+
+    for (;;) {
+        epicsEventMustWait(pw->startEvent);
+        if (ppsl->workersExit)
+            break;
+
+        scanPartition(ppsl, pw->index);
+
+        if (!epicsAtomicDecrIntT(&ppsl->pending))
+            epicsEventMustTrigger(ppsl->doneEvent);
+    }
+
+    taskwdRemove(0);
+}
+
+static void buildSnapshot(periodic_scan_list *ppsl)
+{
+    scan_list *psl = &ppsl->scan_list;
+    scan_element *pse;
+    int n = ellCount(&psl->list);
+
+    if (n > ppsl->maxSnapshot) {
+        free(ppsl->snapshot);
+        free(ppsl->partition);
+        free(ppsl->phaseEnd);
+        ppsl->maxSnapshot = n + n / 4;
+        ppsl->snapshot = dbCalloc(ppsl->maxSnapshot, sizeof(scan_element *));
+        ppsl->partition = dbCalloc(ppsl->maxSnapshot, sizeof(int));
+        ppsl->phaseEnd = dbCalloc(ppsl->maxSnapshot, sizeof(int));
+    }
+
+    ppsl->nSnapshot = ppsl->nPhases = 0;
+    for (pse = (scan_element *)ellFirst(&psl->list); pse;
+         pse = (scan_element *)ellNext(&pse->node)) {
+        if (ppsl->nSnapshot &&
+            pse->precord->phas !=
+                ppsl->snapshot[ppsl->nSnapshot - 1]->precord->phas)
+            ppsl->phaseEnd[ppsl->nPhases++] = ppsl->nSnapshot;
+        ppsl->snapshot[ppsl->nSnapshot++] = pse;
+    }
+    if (ppsl->nSnapshot)
+        ppsl->phaseEnd[ppsl->nPhases++] = ppsl->nSnapshot;
+}
+
+static void scanListParallel(periodic_scan_list *ppsl)
+{
+    scan_list *psl = &ppsl->scan_list;
+    int i, phase;
+
+    epicsMutexMustLock(psl->lock);
+    if (psl->modified || !ppsl->snapshot) {
+        psl->modified = FALSE;
+        buildSnapshot(ppsl);
+    }
+    epicsMutexUnlock(psl->lock);
+
+    /* lock sets may merge or split at any time */
+    for (i = 0; i < ppsl->nSnapshot; i++)
+        ppsl->partition[i] = (int)(dbLockGetLockId(
+            ppsl->snapshot[i]->precord) % ppsl->nThreads);
+
+    ppsl->end = 0;
+    for (phase = 0; phase < ppsl->nPhases; phase++) {
+        ppsl->first = ppsl->end;
+        ppsl->end = ppsl->phaseEnd[phase];
+
+        epicsAtomicSetIntT(&ppsl->pending, ppsl->nThreads);
+        for (i = 0; i < ppsl->nThreads - 1; i++)
+            epicsEventMustTrigger(ppsl->workers[i].startEvent);
+
+        scanPartition(ppsl, ppsl->nThreads - 1);
+
+        if (epicsAtomicDecrIntT(&ppsl->pending))
+            epicsEventMustWait(ppsl->doneEvent);
+    }
+}
+
 
 static void initPeriodic(void)
 {
     dbMenu *pmenu = dbFindMenu(pdbbase, "menuScan");
     double quantum = epicsThreadSleepQuantum();
+    periodic_threads_req *preq;
     int i;
 
     if (!pmenu) {
@@ -905,6 +1099,16 @@ static void initPeriodic(void)
         ppsl->scanCtl = ctlPause;
         ppsl->loopEvent = epicsEventMustCreate(epicsEventEmpty);
 
+        ppsl->nThreads = 1;
+        for (preq = (periodic_threads_req *)ellFirst(&periodicThreadsReq);
+             preq; preq = (periodic_threads_req *)ellNext(&preq->node)) {
+            if (preq->period == 0.0 ||
+                fabs(preq->period - ppsl->period) <= 0.05)
+                ppsl->nThreads = preq->count;
+        }
+        if (ppsl->nThreads > 1)
+            ppsl->doneEvent = epicsEventMustCreate(epicsEventEmpty);
+
         number = ppsl->period / quantum;
         if ((ppsl->period < 2 * quantum) ||
             (number / floor(number) > 1.1)) {
@@ -927,6 +1131,17 @@ static void deletePeriodic(void)
         ellFree(&ppsl->scan_list.list);
         epicsEventDestroy(ppsl->loopEvent);
         epicsMutexDestroy(ppsl->scan_list.lock);
+        if (ppsl->nThreads > 1) {
+            int j;
+
+            for (j = 0; j < ppsl->nThreads - 1; j++)
+                epicsEventDestroy(ppsl->workers[j].startEvent);
+            epicsEventDestroy(ppsl->doneEvent);
+        }
+        free(ppsl->workers);
+        free(ppsl->snapshot);
+        free(ppsl->partition);
+        free(ppsl->phaseEnd);
         free(ppsl);
     }
 
@@ -945,6 +1160,26 @@ static void spawnPeriodic(int ind)
 
     if (!ppsl) return;
 
+    if (ppsl->nThreads > 1) {
+        int i;
+
+        ppsl->workers = dbCalloc(ppsl->nThreads - 1, sizeof(periodic_worker));
+        for (i = 0; i < ppsl->nThreads - 1; i++) {
+            periodic_worker *pw = &ppsl->workers[i];
+
+            pw->ppsl = ppsl;
+            pw->index = i;
+            pw->startEvent = epicsEventMustCreate(epicsEventEmpty);
+            epicsSnprintf(taskName, sizeof(taskName), "scan-%g-%d",
+                ppsl->period, i + 1);
+            pw->tid = epicsThreadCreateOpt(taskName, periodicWorker,
+                (void *)pw, &opts);
+            if (!pw->tid)
+                cantProceed("Failed to spawn scan thread %s\n", taskName);
+            epicsEventWait(startStopEvent);
+        }
+    }
+
     sprintf(taskName, "scan-%g", ppsl->period);
     periodicTaskId[ind] = epicsThreadCreateOpt(
         taskName, periodicTask, (void *)ppsl, &opts);
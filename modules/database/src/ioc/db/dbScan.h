@@ -71,6 +71,9 @@ DBCORE_API void scanOnceQueueShow(const int reset);
 /*print periodic lists*/
 DBCORE_API int scanppl(double rate);
 
+/*process periodic list(s) in parallel, call before iocInit*/
+DBCORE_API int scanPeriodicThreads(int count, double period);
+
 /*print event lists*/
 DBCORE_API int scanpel(const char *event_name);
 
@@ -19,6 +19,8 @@
 #ifndef INCLdb_field_logh
 #define INCLdb_field_logh
 
+#include <stddef.h>
+
 #include <epicsTime.h>
 #include <epicsTypes.h>
 
@@ -115,6 +117,13 @@ typedef struct db_field_log {
     unsigned int      ctx:1;  /* context (operation type) */
     /* only for dbfl_context_event */
     unsigned char      mask;  /* DBE_* mask */
+    /* Identifies the db_post_events() call which created this log,
+     * shared by all subscriptions updated by that call.
+     * 0 if not created by a post, if the post updated only one
+     * subscription, or if a filter has replaced the data with something
+     * which is not a function of the posted value.
+     */
+    size_t          post_id;
     /* the following are used for value and reference types */
     epicsTimeStamp     time;  /* Time stamp */
     epicsUTag          utag;
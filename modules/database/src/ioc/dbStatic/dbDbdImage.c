@@ -0,0 +1,624 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/* Restore DBD definitions from a binary image made by dbdToImage.pl
+ *
+ * The image holds the same definitions as the expanded DBD file, with
+ * the strings in one table and the field sort order already computed,
+ * so nothing has to be read line by line, macro expanded or lexed.
+ * Definitions which already exist are skipped, as the parser does.
+ */
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbDefs.h"
+#include "ellLib.h"
+#include "epicsPrint.h"
+#include "epicsStdlib.h"
+#include "epicsString.h"
+#include "epicsTypes.h"
+#include "gpHash.h"
+
+#include "dbBase.h"
+#include "dbFldTypes.h"
+#include "dbStaticLib.h"
+#include "dbStaticPvt.h"
+#include "link.h"
+#include "special.h"
+
+#define IMAGE_MAGIC "DBDIMAGE"
+#define IMAGE_VERSION 1
+#define IMAGE_HEADER_SIZE 16
+#define IMAGE_NONE 0xFFFFFFFFu
+
+/* Words per field in a recordtype, not counting its sort index */
+#define IMAGE_FIELD_WORDS 14
+
+extern int dbBptNotMonotonic;
+
+typedef struct imageReader {
+    const unsigned char *buf;
+    size_t size;
+    size_t pos;
+    const char *strtab;
+    epicsUInt32 strsize;
+    const char *error;
+} imageReader;
+
+static void imageError(imageReader *prd, const char *error)
+{
+    if (!prd->error)
+        prd->error = error;
+}
+
+static epicsUInt32 getWord(imageReader *prd)
+{
+    const unsigned char *p;
+
+    if (prd->error || prd->size - prd->pos < 4) {
+        imageError(prd, "Image is truncated");
+        return 0;
+    }
+    p = prd->buf + prd->pos;
+    prd->pos += 4;
+    return p[0] | p[1] << 8 | p[2] << 16 | (epicsUInt32) p[3] << 24;
+}
+
+/* A number of items, each at least one word long */
+static epicsUInt32 getCount(imageReader *prd)
+{
+    epicsUInt32 count = getWord(prd);
+
+    if (count > (prd->size - prd->pos) / 4) {
+        imageError(prd, "Bad item count");
+        return 0;
+    }
+    return count;
+}
+
+static void skipWords(imageReader *prd, size_t count)
+{
+    if (count > (prd->size - prd->pos) / 4)
+        imageError(prd, "Image is truncated");
+    else
+        prd->pos += 4 * count;
+}
+
+/* Returns NULL for a missing string */
+static const char *getString(imageReader *prd)
+{
+    epicsUInt32 offset = getWord(prd);
+
+    if (offset == IMAGE_NONE || prd->error)
+        return NULL;
+    if (offset >= prd->strsize) {
+        imageError(prd, "Bad string offset");
+        return NULL;
+    }
+    return prd->strtab + offset;
+}
+
+/* A string which must be present, never returns NULL */
+static const char *getName(imageReader *prd)
+{
+    const char *name = getString(prd);
+
+    if (!name) {
+        imageError(prd, "Missing name");
+        return "";
+    }
+    return name;
+}
+
+static char *dupString(const char *str)
+{
+    return str ? epicsStrDup(str) : NULL;
+}
+
+static void readMenus(imageReader *prd, DBBASE *pdbbase)
+{
+    epicsUInt32 nMenus = getCount(prd);
+
+    while (nMenus-- && !prd->error) {
+        const char *name = getName(prd);
+        epicsUInt32 i, nChoice = getCount(prd);
+        dbMenu *pnewMenu, *pMenu;
+        GPHENTRY *pgphentry;
+
+        if (prd->error)
+            return;
+        if (gphFind(pdbbase->pgpHash, name, &pdbbase->menuList)) {
+            skipWords(prd, 2 * nChoice);
+            continue;
+        }
+        pnewMenu = dbCalloc(1, sizeof(dbMenu));
+        pnewMenu->name = epicsStrDup(name);
+        pnewMenu->nChoice = nChoice;
+        pnewMenu->papChoiceName = dbCalloc(nChoice, sizeof(char *));
+        pnewMenu->papChoiceValue = dbCalloc(nChoice, sizeof(char *));
+        for (i = 0; i < nChoice; i++) {
+            pnewMenu->papChoiceName[i] = epicsStrDup(getName(prd));
+            pnewMenu->papChoiceValue[i] = epicsStrDup(getName(prd));
+        }
+        if (prd->error)
+            return;
+
+        /* Add menu in sorted order */
+        pMenu = (dbMenu *) ellFirst(&pdbbase->menuList);
+        while (pMenu && strcmp(pMenu->name, pnewMenu->name) > 0)
+            pMenu = (dbMenu *) ellNext(&pMenu->node);
+        if (pMenu)
+            ellInsert(&pdbbase->menuList, ellPrevious(&pMenu->node),
+                &pnewMenu->node);
+        else
+            ellAdd(&pdbbase->menuList, &pnewMenu->node);
+        pgphentry = gphAdd(pdbbase->pgpHash, pnewMenu->name,
+            &pdbbase->menuList);
+        if (!pgphentry) {
+            imageError(prd, "gphAdd failed");
+            return;
+        }
+        pgphentry->userPvt = pnewMenu;
+    }
+}
+
+static void readField(imageReader *prd, DBBASE *pdbbase, dbFldDes *pdbFldDes)
+{
+    const char *name = getName(prd);
+    const char *type = getName(prd);
+    const char *prompt = getString(prd);
+    const char *promptgroup = getString(prd);
+    const char *special = getString(prd);
+    const char *extra = getString(prd);
+    const char *menu = getString(prd);
+    const char *initial = getString(prd);
+    int i;
+
+    pdbFldDes->process_passive = getWord(prd) != 0;
+    pdbFldDes->base = getWord(prd) ? CT_HEX : CT_DECIMAL;
+    pdbFldDes->as_level = getWord(prd) ? ASL1 : ASL0;
+    pdbFldDes->prop = getWord(prd) != 0;
+    pdbFldDes->interest = (short) getWord(prd);
+    pdbFldDes->size = (short) getWord(prd);
+    if (prd->error)
+        return;
+
+    pdbFldDes->name = epicsStrDup(name);
+    pdbFldDes->isDevLink = strcmp(name, "INP") == 0 ||
+        strcmp(name, "OUT") == 0;
+    i = dbFindFieldType(type);
+    if (i < 0) {
+        imageError(prd, "Illegal field type");
+        return;
+    }
+    pdbFldDes->field_type = i;
+
+    /* if prompt is null make it a null string */
+    pdbFldDes->prompt = prompt ? epicsStrDup(prompt) : dbCalloc(1, 1);
+    if (promptgroup)
+        pdbFldDes->promptgroup = dbFindOrAddGuiGroup(pdbbase, promptgroup);
+    if (special) {
+        for (i = 0; i < SPC_NTYPES; i++) {
+            if (strcmp(special, pamapspcType[i].strvalue) == 0) {
+                pdbFldDes->special = pamapspcType[i].value;
+                break;
+            }
+        }
+        if (i == SPC_NTYPES &&
+            sscanf(special, "%hd", &pdbFldDes->special) != 1) {
+            imageError(prd, "Illegal 'special' value");
+            return;
+        }
+    }
+    pdbFldDes->extra = dupString(extra);
+    pdbFldDes->initial = dupString(initial);
+    if (menu) {
+        pdbFldDes->ftPvt = dbFindMenu(pdbbase, menu);
+        if (!pdbbase->ignoreMissingMenus && !pdbFldDes->ftPvt) {
+            epicsPrintf("dbReadDbdImage: Menu \"%s\" not found\n", menu);
+            imageError(prd, "menu not found");
+        }
+    }
+}
+
+static void readDevices(imageReader *prd, DBBASE *pdbbase,
+    dbRecordType *pdbRecordType)
+{
+    epicsUInt32 nDevices = getCount(prd);
+
+    while (nDevices-- && !prd->error) {
+        const char *linktype = getName(prd);
+        const char *dsetname = getName(prd);
+        const char *choice = getName(prd);
+        devSup *pdevSup;
+        GPHENTRY *pgphentry;
+        int i, link_type = -1;
+
+        if (prd->error)
+            return;
+        for (i = 0; i < LINK_NTYPES; i++) {
+            if (strcmp(pamaplinkType[i].strvalue, linktype) == 0) {
+                link_type = pamaplinkType[i].value;
+                break;
+            }
+        }
+        if (link_type == -1) {
+            epicsPrintf("dbReadDbdImage: Bad link type \"%s\" "
+                "for device \"%s\"\n", linktype, choice);
+            imageError(prd, "Bad link type");
+            return;
+        }
+        if (gphFind(pdbbase->pgpHash, choice, &pdbRecordType->devList))
+            continue;
+        pdevSup = dbCalloc(1, sizeof(devSup));
+        pdevSup->name = epicsStrDup(dsetname);
+        pdevSup->choice = epicsStrDup(choice);
+        pdevSup->link_type = link_type;
+        pgphentry = gphAdd(pdbbase->pgpHash, pdevSup->choice,
+            &pdbRecordType->devList);
+        if (!pgphentry) {
+            imageError(prd, "gphAdd failed");
+            return;
+        }
+        pgphentry->userPvt = pdevSup;
+        ellAdd(&pdbRecordType->devList, &pdevSup->node);
+    }
+}
+
+static void readRecordtypes(imageReader *prd, DBBASE *pdbbase)
+{
+    epicsUInt32 nTypes = getCount(prd);
+
+    while (nTypes-- && !prd->error) {
+        const char *name = getName(prd);
+        epicsUInt32 i, no_fields = getCount(prd);
+        dbRecordType *pdbRecordType;
+        GPHENTRY *pgphentry;
+        int no_prompt = 0, no_links = 0, ilink = 0;
+
+        if (prd->error)
+            return;
+        if (no_fields > SHRT_MAX) {
+            imageError(prd, "Too many fields");
+            return;
+        }
+        pgphentry = gphFind(pdbbase->pgpHash, name,
+            &pdbbase->recordTypeList);
+        if (pgphentry) {
+            /* Keep the existing definition, but add its devices */
+            skipWords(prd, (size_t) no_fields * (IMAGE_FIELD_WORDS + 1));
+            readDevices(prd, pdbbase, pgphentry->userPvt);
+            continue;
+        }
+
+        pdbRecordType = dbCalloc(1, sizeof(dbRecordType));
+        pdbRecordType->name = epicsStrDup(name);
+        pdbRecordType->no_fields = no_fields;
+        pdbRecordType->papFldDes = dbCalloc(no_fields, sizeof(dbFldDes *));
+        pdbRecordType->papsortFldName = dbCalloc(no_fields, sizeof(char *));
+        pdbRecordType->sortFldInd = dbCalloc(no_fields, sizeof(short));
+        for (i = 0; i < no_fields && !prd->error; i++) {
+            dbFldDes *pdbFldDes = dbCalloc(1, sizeof(dbFldDes));
+
+            pdbRecordType->papFldDes[i] = pdbFldDes;
+            pdbFldDes->pdbRecordType = pdbRecordType;
+            pdbFldDes->indRecordType = i;
+            readField(prd, pdbbase, pdbFldDes);
+            if (pdbFldDes->promptgroup)
+                no_prompt++;
+            if (pdbFldDes->field_type >= DBF_INLINK &&
+                pdbFldDes->field_type <= DBF_FWDLINK)
+                no_links++;
+        }
+        if (prd->error)
+            return;
+
+        pdbRecordType->no_prompt = no_prompt;
+        pdbRecordType->no_links = no_links;
+        pdbRecordType->link_ind = dbCalloc(no_links, sizeof(short));
+        for (i = 0; i < no_fields; i++) {
+            dbFldDes *pdbFldDes = pdbRecordType->papFldDes[i];
+            epicsUInt32 isort = getWord(prd);
+
+            if (pdbFldDes->field_type >= DBF_INLINK &&
+                pdbFldDes->field_type <= DBF_FWDLINK)
+                pdbRecordType->link_ind[ilink++] = i;
+            if (strcmp(pdbFldDes->name, "VAL") == 0) {
+                pdbRecordType->pvalFldDes = pdbFldDes;
+                pdbRecordType->indvalFlddes = i;
+            }
+            if (isort >= no_fields) {
+                imageError(prd, "Bad field sort index");
+                return;
+            }
+            pdbRecordType->sortFldInd[i] = isort;
+            pdbRecordType->papsortFldName[i] =
+                pdbRecordType->papFldDes[isort]->name;
+        }
+
+        ellInit(&pdbRecordType->attributeList);
+        ellInit(&pdbRecordType->recList);
+        ellInit(&pdbRecordType->devList);
+        pgphentry = gphAdd(pdbbase->pgpHash, pdbRecordType->name,
+            &pdbbase->recordTypeList);
+        if (!pgphentry) {
+            imageError(prd, "gphAdd failed");
+            return;
+        }
+        pgphentry->userPvt = pdbRecordType;
+        ellAdd(&pdbbase->recordTypeList, &pdbRecordType->node);
+
+        readDevices(prd, pdbbase, pdbRecordType);
+    }
+}
+
+/* drivers, registrars and functions */
+static void readTexts(imageReader *prd, DBBASE *pdbbase, ELLLIST *plist,
+    int isDriver)
+{
+    epicsUInt32 nTexts = getCount(prd);
+
+    while (nTexts-- && !prd->error) {
+        const char *name = getName(prd);
+        GPHENTRY *pgphentry;
+        ELLNODE *pnode;
+        void *pitem;
+        char *key;
+
+        if (prd->error || gphFind(pdbbase->pgpHash, name, plist))
+            continue;
+        if (isDriver) {
+            drvSup *pdrvSup = dbCalloc(1, sizeof(drvSup));
+
+            key = pdrvSup->name = epicsStrDup(name);
+            pnode = &pdrvSup->node;
+            pitem = pdrvSup;
+        }
+        else {
+            dbText *ptext = dbCalloc(1, sizeof(dbText));
+
+            key = ptext->text = epicsStrDup(name);
+            pnode = &ptext->node;
+            pitem = ptext;
+        }
+        pgphentry = gphAdd(pdbbase->pgpHash, key, plist);
+        if (!pgphentry) {
+            imageError(prd, "gphAdd failed");
+            return;
+        }
+        pgphentry->userPvt = pitem;
+        ellAdd(plist, pnode);
+    }
+}
+
+static void readLinks(imageReader *prd, DBBASE *pdbbase)
+{
+    epicsUInt32 nLinks = getCount(prd);
+
+    while (nLinks-- && !prd->error) {
+        const char *name = getName(prd);
+        const char *jlif_name = getName(prd);
+        linkSup *pLinkSup;
+        GPHENTRY *pgphentry;
+
+        if (prd->error ||
+            gphFind(pdbbase->pgpHash, name, &pdbbase->linkList))
+            continue;
+        pLinkSup = dbCalloc(1, sizeof(linkSup));
+        pLinkSup->name = epicsStrDup(name);
+        pLinkSup->jlif_name = epicsStrDup(jlif_name);
+        pgphentry = gphAdd(pdbbase->pgpHash, pLinkSup->name,
+            &pdbbase->linkList);
+        if (!pgphentry) {
+            imageError(prd, "gphAdd failed");
+            return;
+        }
+        pgphentry->userPvt = pLinkSup;
+        ellAdd(&pdbbase->linkList, &pLinkSup->node);
+    }
+}
+
+static void readVariables(imageReader *prd, DBBASE *pdbbase)
+{
+    epicsUInt32 nVars = getCount(prd);
+
+    while (nVars-- && !prd->error) {
+        const char *name = getName(prd);
+        const char *type = getName(prd);
+        dbVariableDef *pvar;
+        GPHENTRY *pgphentry;
+
+        if (prd->error ||
+            gphFind(pdbbase->pgpHash, name, &pdbbase->variableList))
+            continue;
+        pvar = dbCalloc(1, sizeof(dbVariableDef));
+        pvar->name = epicsStrDup(name);
+        pvar->type = epicsStrDup(type);
+        pgphentry = gphAdd(pdbbase->pgpHash, pvar->name,
+            &pdbbase->variableList);
+        if (!pgphentry) {
+            imageError(prd, "gphAdd failed");
+            return;
+        }
+        pgphentry->userPvt = pvar;
+        ellAdd(&pdbbase->variableList, &pvar->node);
+    }
+}
+
+static void readBreaktables(imageReader *prd, DBBASE *pdbbase)
+{
+    epicsUInt32 nTables = getCount(prd);
+
+    while (nTables-- && !prd->error) {
+        const char *name = getName(prd);
+        epicsUInt32 i, number = getCount(prd);
+        brkTable *pnewbrkTable, *pbrkTable;
+        brkInt *paBrkInt;
+        GPHENTRY *pgphentry;
+        int down = 0;
+
+        if (prd->error)
+            return;
+        if (gphFind(pdbbase->pgpHash, name, &pdbbase->bptList)) {
+            skipWords(prd, 2 * number);
+            continue;
+        }
+        if (number < 2) {
+            imageError(prd, "breaktable: Must have at least two points!");
+            return;
+        }
+        paBrkInt = dbCalloc(number, sizeof(brkInt));
+        for (i = 0; i < number; i++) {
+            const char *raw = getName(prd);
+            const char *eng = getName(prd);
+
+            if (epicsScanDouble(raw, &paBrkInt[i].raw) != 1 ||
+                epicsScanDouble(eng, &paBrkInt[i].eng) != 1) {
+                imageError(prd, "Non-numeric value in breaktable");
+                free(paBrkInt);
+                return;
+            }
+        }
+        /* Compute slopes, as dbBreakBody() does */
+        for (i = 0; i < number - 1; i++) {
+            double slope = (paBrkInt[i+1].eng - paBrkInt[i].eng) /
+                (paBrkInt[i+1].raw - paBrkInt[i].raw);
+
+            if (!dbBptNotMonotonic && slope == 0) {
+                imageError(prd, "breaktable slope is zero");
+                free(paBrkInt);
+                return;
+            }
+            if (i == 0) {
+                down = (slope < 0);
+            }
+            else if (!dbBptNotMonotonic && down != (slope < 0)) {
+                imageError(prd, "breaktable slope changes sign");
+                free(paBrkInt);
+                return;
+            }
+            paBrkInt[i].slope = slope;
+        }
+        paBrkInt[number-1].slope = paBrkInt[number-2].slope;
+
+        pnewbrkTable = dbCalloc(1, sizeof(brkTable));
+        pnewbrkTable->name = epicsStrDup(name);
+        pnewbrkTable->number = number;
+        pnewbrkTable->paBrkInt = paBrkInt;
+
+        /* Add brkTable in sorted order */
+        pbrkTable = (brkTable *) ellFirst(&pdbbase->bptList);
+        while (pbrkTable) {
+            if (strcmp(pbrkTable->name, pnewbrkTable->name) > 0) {
+                ellInsert(&pdbbase->bptList, ellPrevious(&pbrkTable->node),
+                    &pnewbrkTable->node);
+                break;
+            }
+            pbrkTable = (brkTable *) ellNext(&pbrkTable->node);
+        }
+        if (!pbrkTable)
+            ellAdd(&pdbbase->bptList, &pnewbrkTable->node);
+        pgphentry = gphAdd(pdbbase->pgpHash, pnewbrkTable->name,
+            &pdbbase->bptList);
+        if (!pgphentry) {
+            imageError(prd, "gphAdd failed");
+            return;
+        }
+        pgphentry->userPvt = pnewbrkTable;
+    }
+}
+
+/* Read the whole of fp into an allocated buffer */
+static unsigned char *readAll(FILE *fp, size_t *psize)
+{
+    size_t size = 0, alloc = 64 * 1024;
+    unsigned char *buf = malloc(alloc);
+
+    while (buf) {
+        size_t n = fread(buf + size, 1, alloc - size, fp);
+
+        size += n;
+        if (size < alloc) {
+            if (ferror(fp))
+                break;
+            *psize = size;
+            return buf;
+        }
+        alloc *= 2;
+        {
+            unsigned char *nbuf = realloc(buf, alloc);
+
+            if (!nbuf)
+                break;
+            buf = nbuf;
+        }
+    }
+    free(buf);
+    return NULL;
+}
+
+int dbIsDbdImageName(const char *filename)
+{
+    size_t len = filename ? strlen(filename) : 0;
+
+    return len > 5 && strcmp(filename + len - 5, ".dbdi") == 0;
+}
+
+long dbReadDbdImage(DBBASE *pdbbase, FILE *fp)
+{
+    imageReader rd;
+    unsigned char *buf;
+    size_t size;
+
+    memset(&rd, 0, sizeof(rd));
+    buf = readAll(fp, &size);
+    if (!buf) {
+        epicsPrintf("dbReadDbdImage: Can't read image\n");
+        return -1;
+    }
+    rd.buf = buf;
+    rd.size = size;
+
+    if (size < IMAGE_HEADER_SIZE ||
+        memcmp(buf, IMAGE_MAGIC, strlen(IMAGE_MAGIC)) != 0) {
+        imageError(&rd, "Not a DBD image");
+    }
+    else {
+        rd.pos = strlen(IMAGE_MAGIC);
+        if (getWord(&rd) != IMAGE_VERSION)
+            imageError(&rd, "Unsupported image version");
+        rd.strsize = getWord(&rd);
+        rd.strtab = (const char *) buf + rd.pos;
+        if (!rd.error && (rd.strsize % 4 || rd.strsize > size - rd.pos ||
+            (rd.strsize && rd.strtab[rd.strsize - 1] != '\0')))
+            imageError(&rd, "Bad string table");
+        rd.pos += rd.strsize;
+    }
+
+    if (!rd.error) {
+        readMenus(&rd, pdbbase);
+        readRecordtypes(&rd, pdbbase);
+        readTexts(&rd, pdbbase, &pdbbase->drvList, 1);
+        readTexts(&rd, pdbbase, &pdbbase->registrarList, 0);
+        readTexts(&rd, pdbbase, &pdbbase->functionList, 0);
+        readLinks(&rd, pdbbase);
+        readVariables(&rd, pdbbase);
+        readBreaktables(&rd, pdbbase);
+        if (!rd.error && rd.pos != rd.size)
+            imageError(&rd, "Unexpected data after the definitions");
+    }
+    free(buf);
+
+    if (rd.error) {
+        epicsPrintf("dbReadDbdImage: %s\n", rd.error);
+        return -1;
+    }
+    return 0;
+}
@@ -96,6 +96,9 @@ static void dbBreakBody(void);
 
 static void dbRecordHead(char *recordType,char*name,int visible);
 static void dbRecordField(char *name,char *value);
+static void dbRecordInfo(char *name, char *value);
+static void dbRecordAlias(char *name);
+static void dbAlias(char *name, char *alias);
 static void dbRecordBody(void);
 
 /*private declarations*/
@@ -126,6 +129,8 @@ typedef struct tempListNode {
 static ELLLIST tempList = ELLLIST_INIT;
 static void *freeListPvt = NULL;
 static int duplicate = FALSE;
+/* Set while dbReadParsed() is adding records, yytext is meaningless */
+static int replayParsed = FALSE;
 
 static void yyerrorAbort(char *str)
 {
@@ -164,7 +169,8 @@ static void *getLastTemp(void)
     return(ptempListNode->item);
 }
 
-const char *dbOpenFile(DBBASE *pdbbase,const char *filename,FILE **fp)
+static const char *openFile(DBBASE *pdbbase, const char *filename,
+    const char *mode, FILE **fp)
 {
     ELLLIST     *ppathList = (ELLLIST *)pdbbase->pathPvt;
     dbPathNode  *pdbPathNode;
@@ -174,7 +180,7 @@ const char *dbOpenFile(DBBASE *pdbbase,const char *filename,FILE **fp)
     if (!filename) return 0;
     if (!ppathList || ellCount(ppathList) == 0 ||
         strchr(filename, '/') || strchr(filename, '\\')) {
-        *fp = epicsFOpen(filename, "r");
+        *fp = epicsFOpen(filename, mode);
         if (*fp && makeDbdDepends)
             fprintf(stdout, "%s:%s \n", makeDbdDepends, filename);
         return 0;
@@ -186,7 +192,7 @@ const char *dbOpenFile(DBBASE *pdbbase,const char *filename,FILE **fp)
         strcpy(fullfilename, pdbPathNode->directory);
         strcat(fullfilename, "/");
         strcat(fullfilename, filename);
-        *fp = epicsFOpen(fullfilename, "r");
+        *fp = epicsFOpen(fullfilename, mode);
         if (*fp && makeDbdDepends)
             fprintf(stdout, "%s:%s \n", makeDbdDepends, fullfilename);
         free((void *)fullfilename);
@@ -196,6 +202,10 @@ const char *dbOpenFile(DBBASE *pdbbase,const char *filename,FILE **fp)
     return 0;
 }
 
+const char *dbOpenFile(DBBASE *pdbbase,const char *filename,FILE **fp)
+{
+    return openFile(pdbbase, filename, "r", fp);
+}
 
 static void freeInputFileList(void)
 {
@@ -220,6 +230,41 @@ int cmp_dbRecordNode(const ELLNODE *lhs, const ELLNODE *rhs)
     return strcmp(LHS->recordname, RHS->recordname);
 }
 
+static void addRecordTypeAttributes(void)
+{   /*add RTYP and VERS as an attribute */
+    DBENTRY dbEntry;
+    DBENTRY *pdbEntry = &dbEntry;
+    long    localStatus;
+
+    dbInitEntry(savedPdbbase,pdbEntry);
+    localStatus = dbFirstRecordType(pdbEntry);
+    while(!localStatus) {
+        localStatus = dbPutRecordAttribute(pdbEntry,"RTYP",
+            dbGetRecordTypeName(pdbEntry));
+        if(!localStatus)  {
+            localStatus = dbPutRecordAttribute(pdbEntry,"VERS",
+                "none specified");
+        }
+        if(localStatus) {
+            fprintf(stderr,"dbPutRecordAttribute status %ld\n",localStatus);
+        } else {
+            localStatus = dbNextRecordType(pdbEntry);
+        }
+    }
+    dbFinishEntry(pdbEntry);
+}
+
+static void sortRecords(void)
+{
+    ELLNODE *cur;
+    for(cur = ellFirst(&savedPdbbase->recordTypeList); cur; cur=ellNext(cur))
+    {
+        dbRecordType *rtype = CONTAINER(cur, dbRecordType, node);
+
+        ellSortStable(&rtype->recList, &cmp_dbRecordNode);
+    }
+}
+
 static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
         const char *path,const char *substitutions)
 {
@@ -227,6 +272,7 @@ static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
     inputFile   *pinputFile = NULL;
     char        *penv;
     char        **macPairs;
+    int         image = FALSE;
 
     if (ellCount(&tempList)) {
         epicsPrintf("dbReadCOM: Parser stack dirty %d\n", ellCount(&tempList));
@@ -275,8 +321,12 @@ static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
     if (!fp) {
         FILE *fp1 = 0;
 
-        if (pinputFile->filename)
-            pinputFile->path = dbOpenFile(savedPdbbase, pinputFile->filename, &fp1);
+        if (pinputFile->filename) {
+            /* DBD images made by dbdToImage.pl are restored, not parsed */
+            image = dbIsDbdImageName(pinputFile->filename);
+            pinputFile->path = openFile(savedPdbbase, pinputFile->filename,
+                image ? "rb" : "r", &fp1);
+        }
         if (!pinputFile->filename || !fp1) {
             errPrintf(0, __FILE__, __LINE__,
                 "dbRead opening file %s\n",pinputFile->filename);
@@ -296,7 +346,10 @@ static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
     my_buffer[0] = '\0';
     my_buffer_ptr = my_buffer;
     ellAdd(&inputFileList,&pinputFile->node);
-    status = pvt_yy_parse();
+    if (image)
+        status = dbReadDbdImage(savedPdbbase, pinputFile->fp);
+    else
+        status = pvt_yy_parse();
 
     if (ellCount(&tempList) && !yyAbort)
         epicsPrintf("dbReadCOM: Parser stack dirty w/o error. %d\n", ellCount(&tempList));
@@ -304,38 +357,9 @@ static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
         popFirstTemp(); /* Memory leak on parser failure */
 
     dbFreePath(savedPdbbase);
-    if(!status) { /*add RTYP and VERS as an attribute */
-        DBENTRY dbEntry;
-        DBENTRY *pdbEntry = &dbEntry;
-        long    localStatus;
-
-        dbInitEntry(savedPdbbase,pdbEntry);
-        localStatus = dbFirstRecordType(pdbEntry);
-        while(!localStatus) {
-            localStatus = dbPutRecordAttribute(pdbEntry,"RTYP",
-                dbGetRecordTypeName(pdbEntry));
-            if(!localStatus)  {
-                localStatus = dbPutRecordAttribute(pdbEntry,"VERS",
-                    "none specified");
-            }
-            if(localStatus) {
-                fprintf(stderr,"dbPutRecordAttribute status %ld\n",status);
-            } else {
-                localStatus = dbNextRecordType(pdbEntry);
-            }
-        }
-        dbFinishEntry(pdbEntry);
-    }
+    if(!status) addRecordTypeAttributes();
 cleanup:
-    if(dbRecordsAbcSorted) {
-        ELLNODE *cur;
-        for(cur = ellFirst(&savedPdbbase->recordTypeList); cur; cur=ellNext(cur))
-        {
-            dbRecordType *rtype = CONTAINER(cur, dbRecordType, node);
-
-            ellSortStable(&rtype->recList, &cmp_dbRecordNode);
-        }
-    }
+    if(dbRecordsAbcSorted) sortRecords();
     if(macHandle) macDeleteHandle(macHandle);
     macHandle = NULL;
     if(mac_input_buffer) free((void *)mac_input_buffer);
@@ -357,6 +381,77 @@ long dbReadDatabase(DBBASE **ppdbbase,const char *filename,
 long dbReadDatabaseFP(DBBASE **ppdbbase,FILE *fp,
         const char *path,const char *substitutions)
 {return (dbReadCOM(ppdbbase,0,fp,path,substitutions));}
+
+long dbReadParsed(DBBASE **ppdbbase, dbParsedFile *pparsed)
+{
+    inputFile   parsedFile;
+    size_t      i;
+    long        status;
+
+    if (ellCount(&tempList)) {
+        epicsPrintf("dbReadParsed: Parser stack dirty %d\n", ellCount(&tempList));
+    }
+    if (getIocState() != iocVoid)
+        return -2;
+
+    if(*ppdbbase == 0) *ppdbbase = dbAllocBase();
+    savedPdbbase = *ppdbbase;
+    freeListInitPvt(&freeListPvt,sizeof(tempListNode),100);
+
+    /* Error messages and link scope come from the current input file */
+    memset(&parsedFile, 0, sizeof(parsedFile));
+    parsedFile.path = pparsed->path;
+    parsedFile.filename = pparsed->filename;
+    parsedFile.linkDefLoc = pvlOptSrcExt;
+    pinputFileNow = &parsedFile;
+    yyAbort = FALSE;
+    yyFailed = FALSE;
+    replayParsed = TRUE;
+
+    for (i = 0; i < pparsed->nItems && !yyAbort; i++) {
+        dbParsedItem *pitem = &pparsed->items[i];
+        char *arg0 = pparsed->strings + pitem->arg[0];
+        char *arg1 = pparsed->strings + pitem->arg[1];
+
+        parsedFile.line_num = pitem->line_num;
+        switch (pitem->op) {
+        case dbParsedRecord:
+            dbRecordHead(arg0, arg1, 0);
+            break;
+        case dbParsedGrecord:
+            dbRecordHead(arg0, arg1, 1);
+            break;
+        case dbParsedField:
+            dbRecordField(arg0, arg1);
+            break;
+        case dbParsedInfo:
+            dbRecordInfo(arg0, arg1);
+            break;
+        case dbParsedAlias:
+            dbRecordAlias(arg0);
+            break;
+        case dbParsedBody:
+            dbRecordBody();
+            break;
+        case dbParsedDbAlias:
+            dbAlias(arg0, arg1);
+            break;
+        }
+    }
+    status = yyFailed ? -1 : 0;
+
+    replayParsed = FALSE;
+    pinputFileNow = NULL;
+    duplicate = FALSE;
+    while (ellCount(&tempList))
+        dbFreeEntry(popFirstTemp());
+
+    if (!status) addRecordTypeAttributes();
+    if (dbRecordsAbcSorted) sortRecords();
+    freeListCleanup(freeListPvt);
+    freeListPvt = NULL;
+    return status;
+}
 
 static int db_yyinput(char *buf, int max_size)
 {
@@ -568,18 +663,7 @@ static void dbRecordtypeFieldHead(char *name,char *type)
 
 static short findOrAddGuiGroup(const char *name)
 {
-    dbGuiGroup *pdbGuiGroup;
-    GPHENTRY   *pgphentry;
-    pgphentry = gphFind(savedPdbbase->pgpHash, name, &savedPdbbase->guiGroupList);
-    if (!pgphentry) {
-        pdbGuiGroup = dbCalloc(1,sizeof(dbGuiGroup));
-        pdbGuiGroup->name = epicsStrDup(name);
-        ellAdd(&savedPdbbase->guiGroupList, &pdbGuiGroup->node);
-        pdbGuiGroup->key = ellCount(&savedPdbbase->guiGroupList);
-        pgphentry = gphAdd(savedPdbbase->pgpHash, pdbGuiGroup->name, &savedPdbbase->guiGroupList);
-        pgphentry->userPvt = pdbGuiGroup;
-    }
-    return ((dbGuiGroup *)pgphentry->userPvt)->key;
+    return dbFindOrAddGuiGroup(savedPdbbase, name);
 }
 
 static void dbRecordtypeFieldItem(char *name,char *value)
@@ -10,6 +10,28 @@
 
 /* dbPvdLib.c */
 
+/*
+ * The process variable directory is an open addressing hash table with
+ * linear probing.  Each slot holds the full hash of the record name next
+ * to the entry pointer, so most probes which do not match never touch
+ * the record name.
+ *
+ * Adding and deleting entries is serialized by a mutex.  Lookups take no
+ * lock.  A slot only ever changes from empty to an entry, or from an entry
+ * to a tombstone, and the hash is written before the entry is published.
+ * When the table needs to grow a new table is filled and then published,
+ * the old one is kept until dbPvdFreeMem() since a lookup may still be
+ * searching it.  Deleted entries are kept until then too, since a lookup
+ * may still be comparing their names.
+ *
+ * Each table also has a blocked Bloom filter of all names added to it,
+ * so that most lookups of names which are not in the table, such as CA
+ * searches for records on other IOCs, are rejected by testing a few bits
+ * of one word without probing the slots.  A name sets 4 bits in the word
+ * selected by its hash.  Bits are never cleared when an entry is deleted,
+ * the filter is rebuilt when the table grows.
+ */
+
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -17,6 +39,8 @@
 
 #include "dbDefs.h"
 #include "ellLib.h"
+#include "epicsAtomic.h"
+#include "epicsTypes.h"
 #include "epicsMutex.h"
 #include "epicsStdio.h"
 #include "epicsString.h"
@@ -26,22 +50,42 @@
 #include "dbStaticPvt.h"
 
 typedef struct {
-    ELLLIST      list;
-    epicsMutexId lock;
-} dbPvdBucket;
-
-typedef struct dbPvd {
+    unsigned int hash;
+    PVDENTRY     *ppvdNode;     /* NULL if never used */
+} dbPvdSlot;
+
+typedef struct dbPvdTable {
+    struct dbPvdTable *prev;    /* retired tables */
+    epicsUInt64  *bloom;        /* size / BLOOM_SLOTS_PER_WORD words */
+    unsigned int bloomShift;    /* hash >> bloomShift selects the word */
     unsigned int size;
     unsigned int mask;
-    dbPvdBucket **buckets;
+    dbPvdSlot    slots[1];
+} dbPvdTable;
+
+typedef struct dbPvd {
+    dbPvdTable   *table;        /* use atomic */
+    unsigned int count;         /* live entries */
+    unsigned int used;          /* live entries plus tombstones */
+    ELLLIST      retired;       /* deleted entries */
+    epicsMutexId lock;
 } dbPvd;
 
+/* Marks a slot whose entry was deleted */
+static PVDENTRY tombstone;
+
 unsigned int dbPvdHashTableSize = 0;
 
 #define MIN_SIZE 256
 #define DEFAULT_SIZE 512
 #define MAX_SIZE 65536
 
+/* Grow when more than 2/3 of the slots are in use */
+#define PVD_FULL(used, size) (3 * (size_t)(used) > 2 * (size_t)(size))
+
+/* 16 Bloom filter bits per slot, at least 24 per entry */
+#define BLOOM_SLOTS_PER_WORD 4
+
 
 int dbPvdTableSize(int size)
 {
@@ -60,6 +104,115 @@ int dbPvdTableSize(int size)
     return 0;
 }
 
+static dbPvdTable *pvdTableCreate(unsigned int size)
+{
+    dbPvdTable *ptable = dbCalloc(1, sizeof(dbPvdTable) +
+        (size - 1) * sizeof(dbPvdSlot));
+    unsigned int nwords = size / BLOOM_SLOTS_PER_WORD;
+
+    ptable->bloom = dbCalloc(nwords, sizeof(epicsUInt64));
+    ptable->bloomShift = 32;
+    while (nwords > 1) {
+        ptable->bloomShift--;
+        nwords >>= 1;
+    }
+    ptable->size = size;
+    ptable->mask = size - 1;
+    return ptable;
+}
+
+static void pvdTableFree(dbPvdTable *ptable)
+{
+    free(ptable->bloom);
+    free(ptable);
+}
+
+/* The word of the Bloom filter for hash */
+static epicsUInt64 *bloomWord(const dbPvdTable *ptable, unsigned int hash)
+{
+    /* a shift by 32 is undefined */
+    return &ptable->bloom[(hash >> 1) >> (ptable->bloomShift - 1)];
+}
+
+/* The Bloom filter bits for hash.  The multiply mixes the low bits of
+ * the hash, which bloomWord() does not use, into the top of the word.
+ */
+static epicsUInt64 bloomBits(unsigned int hash)
+{
+    epicsUInt32 x = (epicsUInt32) hash * 0x9E3779B1u;
+
+    return ((epicsUInt64) 1 << (x >> 26)) |
+        ((epicsUInt64) 1 << ((x >> 20) & 63)) |
+        ((epicsUInt64) 1 << ((x >> 14) & 63)) |
+        ((epicsUInt64) 1 << ((x >> 8) & 63));
+}
+
+/* Acquire load of the current table.  The barrier pairs with the one
+ * in pvdGrow(), so everything filled in before the table was published,
+ * its Bloom words and slots, is visible to the caller.  Entries added to
+ * a table after that need no further barriers: a slot's hash never
+ * changes once set and is only compared, so a lookup which sees a new
+ * entry with a stale hash, or Bloom bits which are not yet set, just
+ * misses a name added concurrently.  Names are read through the entry.
+ */
+static dbPvdTable *pvdTableAcquire(dbPvd *ppvd)
+{
+    dbPvdTable *ptable = *(dbPvdTable * volatile *) &ppvd->table;
+
+    epicsAtomicReadMemoryBarrier();
+    return ptable;
+}
+
+/* Caller holds ppvd->lock */
+static void pvdInsert(dbPvdTable *ptable, unsigned int hash,
+    PVDENTRY *ppvdNode)
+{
+    unsigned int h = hash & ptable->mask;
+
+    /* Set before the entry is published, so lookups never miss it.
+     * The write barrier below orders this store before the publish.
+     * This is a plain read-modify-write, only made under ppvd->lock.
+     * A lookup reading the word while it changes (even one torn in two
+     * halves) still sees all bits of the names added before, it can only
+     * miss the name being added, as if the lookup had come first.
+     */
+    *bloomWord(ptable, hash) |= bloomBits(hash);
+
+    while (ptable->slots[h].ppvdNode)
+        h = (h + 1) & ptable->mask;
+
+    ptable->slots[h].hash = hash;
+    /* publish the hash before the node, see pvdTableAcquire() */
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *) &ptable->slots[h].ppvdNode,
+        ppvdNode);
+}
+
+/* Caller holds ppvd->lock.  Also drops any tombstones. */
+static void pvdGrow(dbPvd *ppvd)
+{
+    dbPvdTable *pold = ppvd->table;
+    dbPvdTable *pnew;
+    unsigned int size = pold->size;
+    unsigned int h;
+
+    while (PVD_FULL(2 * (ppvd->count + 1), size))
+        size *= 2;
+
+    pnew = pvdTableCreate(size);
+    for (h = 0; h < pold->size; h++) {
+        PVDENTRY *ppvdNode = pold->slots[h].ppvdNode;
+
+        if (ppvdNode && ppvdNode != &tombstone)
+            pvdInsert(pnew, pold->slots[h].hash, ppvdNode);
+    }
+    pnew->prev = pold;
+    ppvd->used = ppvd->count;
+    /* and the filled slots before the new table */
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *) &ppvd->table, pnew);
+}
+
 void dbPvdInitPvt(dbBase *pdbbase)
 {
     dbPvd *ppvd;
@@ -70,10 +223,10 @@ void dbPvdInitPvt(dbBase *pdbbase)
         dbPvdHashTableSize = DEFAULT_SIZE;
     }
 
-    ppvd = (dbPvd *)dbMalloc(sizeof(dbPvd));
-    ppvd->size    = dbPvdHashTableSize;
-    ppvd->mask    = dbPvdHashTableSize - 1;
-    ppvd->buckets = dbCalloc(ppvd->size, sizeof(dbPvdBucket *));
+    ppvd = (dbPvd *)dbCalloc(1, sizeof(dbPvd));
+    ppvd->table = pvdTableCreate(dbPvdHashTableSize);
+    ellInit(&ppvd->retired);
+    ppvd->lock  = epicsMutexMustCreate();
 
     pdbbase->ppvd = ppvd;
     return;
@@ -81,119 +234,128 @@ void dbPvdInitPvt(dbBase *pdbbase)
 
 PVDENTRY *dbPvdFind(dbBase *pdbbase, const char *name, size_t lenName)
 {
-    dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
+    dbPvdTable *ptable = pvdTableAcquire(pdbbase->ppvd);
+    unsigned int hash = epicsMemHash(name, lenName, 0);
+    unsigned int h = hash & ptable->mask;
+    epicsUInt64 bits = bloomBits(hash);
     PVDENTRY *ppvdNode;
 
-    pbucket = ppvd->buckets[epicsMemHash(name, lenName, 0) & ppvd->mask];
-    if (pbucket == NULL) return NULL;
+    if ((*(volatile epicsUInt64 *) bloomWord(ptable, hash) & bits) != bits)
+        return NULL;
 
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        const char *recordname = ppvdNode->precnode->recordname;
+    while ((ppvdNode = *(PVDENTRY * volatile *) &ptable->slots[h].ppvdNode)) {
+        if (ptable->slots[h].hash == hash && ppvdNode != &tombstone) {
+            const char *recordname = ppvdNode->precnode->recordname;
 
-        if (strncmp(name, recordname, lenName) == 0 &&
-            strlen(recordname) == lenName)
-            break;
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
+            if (strncmp(name, recordname, lenName) == 0 &&
+                recordname[lenName] == '\0')
+                return ppvdNode;
+        }
+        h = (h + 1) & ptable->mask;
     }
-    epicsMutexUnlock(pbucket->lock);
-    return ppvdNode;
+    return NULL;
 }
-
+
 PVDENTRY *dbPvdAdd(dbBase *pdbbase, dbRecordType *precordType,
     dbRecordNode *precnode)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
+    dbPvdTable *ptable;
     PVDENTRY *ppvdNode;
     char *name = precnode->recordname;
+    unsigned int hash = epicsStrHash(name, 0);
     unsigned int h;
 
-    h = epicsStrHash(name, 0) & ppvd->mask;
-    pbucket = ppvd->buckets[h];
-    if (pbucket == NULL) {
-        pbucket = dbCalloc(1, sizeof(dbPvdBucket));
-        ellInit(&pbucket->list);
-        pbucket->lock = epicsMutexCreate();
-        ppvd->buckets[h] = pbucket;
-    }
-
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        if (strcmp(name, ppvdNode->precnode->recordname) == 0) {
-            epicsMutexUnlock(pbucket->lock);
+    epicsMutexMustLock(ppvd->lock);
+    ptable = ppvd->table;
+    for (h = hash & ptable->mask; (ppvdNode = ptable->slots[h].ppvdNode);
+         h = (h + 1) & ptable->mask) {
+        if (ptable->slots[h].hash == hash && ppvdNode != &tombstone &&
+            strcmp(name, ppvdNode->precnode->recordname) == 0) {
+            epicsMutexUnlock(ppvd->lock);
             return NULL;
         }
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
     }
+
+    if (PVD_FULL(ppvd->used + 1, ptable->size)) {
+        pvdGrow(ppvd);
+        ptable = ppvd->table;
+    }
+
     ppvdNode = dbCalloc(1, sizeof(PVDENTRY));
     ppvdNode->precordType = precordType;
     ppvdNode->precnode = precnode;
-    ellAdd(&pbucket->list, (ELLNODE *)ppvdNode);
-    epicsMutexUnlock(pbucket->lock);
+    pvdInsert(ptable, hash, ppvdNode);
+    ppvd->count++;
+    ppvd->used++;
+    epicsMutexUnlock(ppvd->lock);
     return ppvdNode;
 }
 
 void dbPvdDelete(dbBase *pdbbase, dbRecordNode *precnode)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
+    dbPvdTable *ptable;
     PVDENTRY *ppvdNode;
     char *name = precnode->recordname;
+    unsigned int hash = epicsStrHash(name, 0);
+    unsigned int h;
 
-    pbucket = ppvd->buckets[epicsStrHash(name, 0) & ppvd->mask];
-    if (pbucket == NULL) return;
-
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        if (ppvdNode->precnode &&
+    epicsMutexMustLock(ppvd->lock);
+    ptable = ppvd->table;
+    for (h = hash & ptable->mask; (ppvdNode = ptable->slots[h].ppvdNode);
+         h = (h + 1) & ptable->mask) {
+        if (ptable->slots[h].hash == hash && ppvdNode != &tombstone &&
+            ppvdNode->precnode &&
             ppvdNode->precnode->recordname &&
             strcmp(name, ppvdNode->precnode->recordname) == 0) {
-            ellDelete(&pbucket->list, (ELLNODE *)ppvdNode);
-            free(ppvdNode);
+            epicsAtomicWriteMemoryBarrier();
+            epicsAtomicSetPtrT((EpicsAtomicPtrT *) &ptable->slots[h].ppvdNode,
+                &tombstone);
+            ellAdd(&ppvd->retired, &ppvdNode->node);
+            ppvd->count--;
             break;
         }
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
     }
-    epicsMutexUnlock(pbucket->lock);
+    epicsMutexUnlock(ppvd->lock);
     return;
 }
 
 void dbPvdFreeMem(dbBase *pdbbase)
 {
     dbPvd *ppvd = pdbbase->ppvd;
+    dbPvdTable *ptable;
     unsigned int h;
 
     if (ppvd == NULL) return;
     pdbbase->ppvd = NULL;
 
-    for (h = 0; h < ppvd->size; h++) {
-        dbPvdBucket *pbucket = ppvd->buckets[h];
-        PVDENTRY *ppvdNode;
+    epicsMutexMustLock(ppvd->lock);
+    ptable = ppvd->table;
+    for (h = 0; h < ptable->size; h++) {
+        PVDENTRY *ppvdNode = ptable->slots[h].ppvdNode;
 
-        if (pbucket == NULL) continue;
-        epicsMutexMustLock(pbucket->lock);
-        ppvd->buckets[h] = NULL;
-        while ((ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list))) {
-            ellDelete(&pbucket->list, (ELLNODE *)ppvdNode);
+        if (ppvdNode && ppvdNode != &tombstone)
             free(ppvdNode);
-        }
-        epicsMutexUnlock(pbucket->lock);
-        epicsMutexDestroy(pbucket->lock);
-        free(pbucket);
     }
-    free(ppvd->buckets);
+    ellFree(&ppvd->retired);
+    while (ptable) {
+        dbPvdTable *prev = ptable->prev;
+
+        pvdTableFree(ptable);
+        ptable = prev;
+    }
+    epicsMutexUnlock(ppvd->lock);
+    epicsMutexDestroy(ppvd->lock);
     free(ppvd);
 }
 
 void dbPvdDump(dbBase *pdbbase, int verbose)
 {
-    unsigned int empty = 0;
+    unsigned int empty = 0, deleted = 0, maxProbe = 0, bloomSet = 0;
+    double totalProbe = 0.0;
     dbPvd *ppvd;
+    dbPvdTable *ptable;
     unsigned int h;
 
     if (!pdbbase) {
@@ -203,27 +365,43 @@ void dbPvdDump(dbBase *pdbbase, int verbose)
     ppvd = pdbbase->ppvd;
     if (ppvd == NULL) return;
 
-    printf("Process Variable Directory has %u buckets", ppvd->size);
+    epicsMutexMustLock(ppvd->lock);
+    ptable = ppvd->table;
+    printf("Process Variable Directory has %u slots, %u entries\n",
+        ptable->size, ppvd->count);
 
-    for (h = 0; h < ppvd->size; h++) {
-        dbPvdBucket *pbucket = ppvd->buckets[h];
-        PVDENTRY *ppvdNode;
-        int i = 1;
+    for (h = 0; h < ptable->size; h++) {
+        PVDENTRY *ppvdNode = ptable->slots[h].ppvdNode;
+        unsigned int probe;
 
-        if (pbucket == NULL) {
+        if (ppvdNode == NULL) {
             empty++;
             continue;
         }
-        epicsMutexMustLock(pbucket->lock);
-        ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-        printf("\n [%4u] %4d  ", h, ellCount(&pbucket->list));
-        while (ppvdNode && verbose) {
-            if (!(++i % 4))
-                printf("\n         ");
-            printf("  %s", ppvdNode->precnode->recordname);
-            ppvdNode = (PVDENTRY *) ellNext((ELLNODE*)ppvdNode);
+        if (ppvdNode == &tombstone) {
+            deleted++;
+            continue;
         }
-        epicsMutexUnlock(pbucket->lock);
+        /* number of slots searched to find this entry */
+        probe = ((h - ptable->slots[h].hash) & ptable->mask) + 1;
+        totalProbe += probe;
+        if (probe > maxProbe)
+            maxProbe = probe;
+        if (verbose)
+            printf(" [%6u] %3u  %s\n", h, probe,
+                ppvdNode->precnode->recordname);
+    }
+    printf("%u slots empty, %u deleted.\n", empty, deleted);
+    for (h = 0; h < ptable->size / BLOOM_SLOTS_PER_WORD; h++) {
+        epicsUInt64 word = ptable->bloom[h];
+
+        for (; word; word &= word - 1)
+            bloomSet++;
     }
-    printf("\n%u buckets empty.\n", empty);
+    printf("Bloom filter has %u of %u bits set.\n", bloomSet,
+        ptable->size / BLOOM_SLOTS_PER_WORD * 64);
+    if (ppvd->count)
+        printf("Probes per lookup: %.2f average, %u maximum.\n",
+            totalProbe / ppvd->count, maxProbe);
+    epicsMutexUnlock(ppvd->lock);
 }
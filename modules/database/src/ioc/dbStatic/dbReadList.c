@@ -0,0 +1,597 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/* Read a list of .db files using several threads, see dbReadDatabaseList()
+ *
+ * The parser in dbLexRoutines.c can only be used by one thread at a time,
+ * so the worker threads here read, macro-expand and tokenize whole files
+ * into a list of record statements instead.  The calling thread takes the
+ * files in list order and has dbReadParsed() add their records with the
+ * same routines the parser uses, so duplicates, aliases and errors are
+ * handled just as if the files were read one after the other.
+ *
+ * Anything the tokenizer doesn't recognize, including syntax errors and
+ * undefined macros, makes the file be read by the parser in its turn
+ * instead, which reports any problems in the usual way.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbDefs.h"
+#include "epicsAtomic.h"
+#include "epicsEvent.h"
+#include "epicsExport.h"
+#include "epicsMutex.h"
+#include "epicsStdio.h"
+#include "epicsString.h"
+#include "epicsThread.h"
+#include "macLib.h"
+
+#include "dbBase.h"
+#include "dbStaticLib.h"
+#include "dbStaticPvt.h"
+#include "iocInit.h"
+
+int dbLoadRecordsThreads = 0;
+epicsExportAddress(int, dbLoadRecordsThreads);
+
+/* The parser reads and expands lines in pieces of this size */
+#define READ_BUFFER_SIZE 1024
+
+/* Files each thread may have read ahead of the one being added */
+#define READ_AHEAD 4
+
+typedef struct readJob {
+    dbReadListItem  *pitem;
+    dbParsedFile    parsed;
+    int             ok;         /* parsed holds the whole file */
+    epicsEventId    start;      /* may be read now */
+    epicsEventId    done;
+} readJob;
+
+typedef struct readList {
+    readJob         *jobs;
+    size_t          count;
+    size_t          next;       /* next job to take, guarded by lock */
+    epicsMutexId    lock;
+    int             abort;
+    DBBASE          pathBase;   /* only holds the search path */
+} readList;
+
+
+/* Storage of the tokenized statements */
+
+static int addString(dbParsedFile *pparsed, const char *str, size_t len,
+    size_t *poffset)
+{
+    if (pparsed->nStrings + len + 1 > pparsed->maxStrings) {
+        size_t size = pparsed->maxStrings ? 2 * pparsed->maxStrings : 4096;
+        char *strings;
+
+        while (size < pparsed->nStrings + len + 1)
+            size *= 2;
+        strings = realloc(pparsed->strings, size);
+        if (!strings)
+            return 0;
+        pparsed->strings = strings;
+        pparsed->maxStrings = size;
+    }
+    *poffset = pparsed->nStrings;
+    memcpy(pparsed->strings + pparsed->nStrings, str, len);
+    pparsed->strings[pparsed->nStrings + len] = 0;
+    pparsed->nStrings += len + 1;
+    return 1;
+}
+
+static int addItem(dbParsedFile *pparsed, dbParsedOp op, int line_num,
+    size_t arg0, size_t arg1)
+{
+    dbParsedItem *pitem;
+
+    if (pparsed->nItems == pparsed->maxItems) {
+        size_t size = pparsed->maxItems ? 2 * pparsed->maxItems : 256;
+        dbParsedItem *items = realloc(pparsed->items, size * sizeof(*items));
+
+        if (!items)
+            return 0;
+        pparsed->items = items;
+        pparsed->maxItems = size;
+    }
+    pitem = &pparsed->items[pparsed->nItems++];
+    pitem->op = op;
+    pitem->line_num = line_num;
+    pitem->arg[0] = arg0;
+    pitem->arg[1] = arg1;
+    return 1;
+}
+
+static void freeParsed(dbParsedFile *pparsed)
+{
+    free(pparsed->filename);
+    free(pparsed->items);
+    free(pparsed->strings);
+    memset(pparsed, 0, sizeof(*pparsed));
+}
+
+
+/* Tokenizer for the record statements of dbLex.l and dbYacc.y
+ *
+ * Each routine returns 0 for anything it doesn't handle.
+ */
+
+typedef struct scanner {
+    const char      *pos;
+    int             line_num;
+    dbParsedFile    *pparsed;
+} scanner;
+
+static const char * const keywords[] = {
+    "include", "path", "addpath", "menu", "choice", "recordtype", "field",
+    "device", "driver", "link", "breaktable", "record", "grecord", "alias",
+    "info", "registrar", "function", "variable", "set"
+};
+
+/* {bareword} of dbLex.l */
+static int isBareChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+        (c >= '0' && c <= '9') || (c && strchr("_-+:.[]<>;", c));
+}
+
+/* {barechar} of dbLex.l, also covers the JSON numbers and keywords */
+static int isJsonBareChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+        (c >= '0' && c <= '9') || (c && strchr("_-+.", c));
+}
+
+static int isHex(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+        (c >= 'A' && c <= 'F');
+}
+
+static void skipSpace(scanner *ps)
+{
+    for (;;) {
+        switch (*ps->pos) {
+        case '\n':
+            ps->line_num++;
+            /* fall through */
+        case ' ': case '\t': case '\r':
+            ps->pos++;
+            break;
+        case '#':
+            while (*ps->pos && *ps->pos != '\n')
+                ps->pos++;
+            break;
+        default:
+            return;
+        }
+    }
+}
+
+static int getPunct(scanner *ps, char punct)
+{
+    skipSpace(ps);
+    if (*ps->pos != punct)
+        return 0;
+    ps->pos++;
+    return 1;
+}
+
+/* A bare word, which may be a keyword */
+static int getBare(scanner *ps, const char **pstart, size_t *plen)
+{
+    const char *end;
+
+    skipSpace(ps);
+    for (end = ps->pos; isBareChar(*end); end++);
+    *pstart = ps->pos;
+    *plen = end - ps->pos;
+    ps->pos = end;
+    return *plen > 0;
+}
+
+static int isKeyword(const char *str, size_t len)
+{
+    unsigned i;
+
+    for (i = 0; i < NELEMENTS(keywords); i++) {
+        if (strlen(keywords[i]) == len && !strncmp(keywords[i], str, len))
+            return 1;
+    }
+    return 0;
+}
+
+/* tokenSTRING, without the quotes */
+static int getString(scanner *ps, size_t *poffset)
+{
+    const char *start, *end;
+    size_t len;
+
+    skipSpace(ps);
+    if (*ps->pos != '"') {
+        if (!getBare(ps, &start, &len) || isKeyword(start, len))
+            return 0;
+        return addString(ps->pparsed, start, len, poffset);
+    }
+
+    start = ps->pos + 1;
+    for (end = start; *end != '"'; end++) {
+        if (!*end || *end == '\n')
+            return 0;
+        if (*end == '\\' && (!end[1] || end[1] == '\n'))
+            return 0;
+        if (*end == '\\')
+            end++;
+    }
+    ps->pos = end + 1;
+    return addString(ps->pparsed, start, end - start, poffset);
+}
+
+/* A JSON string or bare value, as dbRecordField() wants it.  Quoted
+ * strings keep their quotes, bare values don't need them.
+ */
+static int getValue(scanner *ps, size_t *poffset)
+{
+    const char *start, *end;
+    char quote;
+
+    skipSpace(ps);
+    start = ps->pos;
+    quote = *start;
+    if (quote != '"' && quote != '\'') {
+        for (end = start; isJsonBareChar(*end); end++);
+        if (end == start)
+            return 0;   /* arrays, objects and errors */
+        ps->pos = end;
+        return addString(ps->pparsed, start, end - start, poffset);
+    }
+
+    for (end = start + 1; *end != quote; ) {
+        unsigned char c = *end;
+
+        if (c < ' ')
+            return 0;
+        if (c != '\\') {
+            end++;
+        } else if (end[1] == 'u') {
+            if (!isHex(end[2]) || !isHex(end[3]) ||
+                !isHex(end[4]) || !isHex(end[5]))
+                return 0;
+            end += 6;
+        } else if (end[1] == 'x') {
+            if (!isHex(end[2]) || !isHex(end[3]))
+                return 0;
+            end += 4;
+        } else if ((unsigned char) end[1] < ' ' ||
+                   (end[1] >= '1' && end[1] <= '9')) {
+            return 0;
+        } else {
+            end += 2;
+        }
+    }
+    ps->pos = end + 1;
+    return addString(ps->pparsed, start, ps->pos - start, poffset);
+}
+
+/* '(' tokenSTRING ',' tokenSTRING ')' */
+static int getPair(scanner *ps, size_t *parg0, size_t *parg1)
+{
+    return getPunct(ps, '(') && getString(ps, parg0) &&
+        getPunct(ps, ',') && getString(ps, parg1) && getPunct(ps, ')');
+}
+
+static int scanRecord(scanner *ps, dbParsedOp op)
+{
+    dbParsedFile *pparsed = ps->pparsed;
+    size_t arg0, arg1;
+
+    if (!getPair(ps, &arg0, &arg1) ||
+        !addItem(pparsed, op, ps->line_num, arg0, arg1))
+        return 0;
+
+    if (!getPunct(ps, '{'))
+        return addItem(pparsed, dbParsedBody, ps->line_num, 0, 0);
+
+    for (;;) {
+        const char *word;
+        size_t len;
+
+        if (getPunct(ps, '}'))
+            return addItem(pparsed, dbParsedBody, ps->line_num, 0, 0);
+        if (!getBare(ps, &word, &len))
+            return 0;
+
+        if ((len == 5 && !strncmp(word, "field", 5)) ||
+            (len == 4 && !strncmp(word, "info", 4))) {
+            if (!getPunct(ps, '(') || !getString(ps, &arg0) ||
+                !getPunct(ps, ',') || !getValue(ps, &arg1) ||
+                !getPunct(ps, ')') ||
+                !addItem(pparsed, len == 5 ? dbParsedField : dbParsedInfo,
+                    ps->line_num, arg0, arg1))
+                return 0;
+        }
+        else if (len == 5 && !strncmp(word, "alias", 5)) {
+            if (!getPunct(ps, '(') || !getString(ps, &arg0) ||
+                !getPunct(ps, ')') ||
+                !addItem(pparsed, dbParsedAlias, ps->line_num, arg0, 0))
+                return 0;
+        }
+        else
+            return 0;
+    }
+}
+
+static int scanText(dbParsedFile *pparsed, const char *text)
+{
+    scanner scan;
+
+    scan.pos = text;
+    scan.line_num = 1;
+    scan.pparsed = pparsed;
+
+    for (;;) {
+        const char *word;
+        size_t len, arg0, arg1;
+
+        skipSpace(&scan);
+        if (!*scan.pos)
+            return 1;
+        if (!getBare(&scan, &word, &len))
+            return 0;
+
+        if (len == 6 && !strncmp(word, "record", 6)) {
+            if (!scanRecord(&scan, dbParsedRecord))
+                return 0;
+        }
+        else if (len == 7 && !strncmp(word, "grecord", 7)) {
+            if (!scanRecord(&scan, dbParsedGrecord))
+                return 0;
+        }
+        else if (len == 5 && !strncmp(word, "alias", 5)) {
+            if (!getPair(&scan, &arg0, &arg1) ||
+                !addItem(pparsed, dbParsedDbAlias, scan.line_num, arg0, arg1))
+                return 0;
+        }
+        else
+            return 0;
+    }
+}
+
+
+/* Read a file and expand macros as db_yyinput() does.  Returns NULL when
+ * a macro is undefined, so the parser can report it.
+ */
+static char *readExpanded(FILE *fp, const char *substitutions)
+{
+    MAC_HANDLE *handle = NULL;
+    char line[READ_BUFFER_SIZE];
+    char expanded[READ_BUFFER_SIZE];
+    char *text = NULL;
+    size_t len = 0, size = 0;
+    int ok = 1;
+
+    if (substitutions) {
+        char **pairs;
+
+        if (macCreateHandle(&handle, NULL))
+            return NULL;
+        macParseDefns(handle, substitutions, &pairs);
+        if (pairs) {
+            macInstallMacros(handle, pairs);
+            free(pairs);
+            macSuppressWarning(handle, TRUE);
+        } else {
+            macDeleteHandle(handle);
+            handle = NULL;
+        }
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        const char *piece = line;
+        size_t n;
+
+        if (handle) {
+            if (macExpandString(handle, line, expanded, sizeof(expanded)) < 0) {
+                ok = 0;
+                break;
+            }
+            piece = expanded;
+        }
+        n = strlen(piece);
+        if (len + n + 1 > size) {
+            char *bigger;
+
+            size = size ? 2 * size : 16384;
+            while (size < len + n + 1)
+                size *= 2;
+            bigger = realloc(text, size);
+            if (!bigger) {
+                ok = 0;
+                break;
+            }
+            text = bigger;
+        }
+        memcpy(text + len, piece, n);
+        len += n;
+    }
+    if (handle)
+        macDeleteHandle(handle);
+
+    if (!ok || !text) {
+        free(text);
+        return NULL;
+    }
+    text[len] = 0;
+    return text;
+}
+
+static void readJobFile(readList *plist, readJob *pjob)
+{
+    dbReadListItem *pitem = pjob->pitem;
+    dbParsedFile *pparsed = &pjob->parsed;
+    FILE *fp;
+    char *text;
+
+    if (!pitem->filename)
+        return;
+    pparsed->filename = macEnvExpand(pitem->filename);
+    if (!pparsed->filename || dbIsDbdImageName(pparsed->filename))
+        return;
+    pparsed->path = dbOpenFile(&plist->pathBase, pparsed->filename, &fp);
+    if (!fp)
+        return;
+
+    text = readExpanded(fp, pitem->substitutions);
+    fclose(fp);
+    if (text) {
+        pjob->ok = scanText(pparsed, text);
+        free(text);
+    }
+}
+
+static void readWorker(void *arg)
+{
+    readList *plist = arg;
+
+    for (;;) {
+        readJob *pjob = NULL;
+
+        epicsMutexMustLock(plist->lock);
+        if (plist->next < plist->count)
+            pjob = &plist->jobs[plist->next++];
+        epicsMutexUnlock(plist->lock);
+        if (!pjob)
+            break;
+
+        epicsEventMustWait(pjob->start);
+        if (!epicsAtomicGetIntT(&plist->abort))
+            readJobFile(plist, pjob);
+        epicsEventMustTrigger(pjob->done);
+    }
+}
+
+
+static long readSerial(DBBASE **ppdbbase, dbReadListItem *items,
+    size_t count, const char *path, DB_READ_LIST_DONE done)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        items[i].status = dbReadDatabase(ppdbbase, items[i].filename, path,
+            items[i].substitutions);
+        if (done)
+            done(&items[i]);
+        if (items[i].status)
+            return items[i].status;
+    }
+    return 0;
+}
+
+long dbReadDatabaseList(DBBASE **ppdbbase, dbReadListItem *items,
+    size_t count, const char *path, DB_READ_LIST_DONE done)
+{
+    epicsThreadOpts opts = EPICS_THREAD_OPTS_INIT;
+    epicsThreadId *workers;
+    readList list;
+    size_t i, ahead;
+    int nThreads = dbLoadRecordsThreads;
+    int nWorkers = 0;
+    long status = 0;
+
+    for (i = 0; i < count; i++)
+        items[i].status = -1;
+
+    if (nThreads < 2 || count < 2 || getIocState() != iocVoid)
+        return readSerial(ppdbbase, items, count, path, done);
+    if ((size_t) nThreads > count)
+        nThreads = (int) count;
+
+    memset(&list, 0, sizeof(list));
+    list.jobs = calloc(count, sizeof(readJob));
+    workers = calloc(nThreads, sizeof(epicsThreadId));
+    if (!list.jobs || !workers) {
+        free(list.jobs);
+        free(workers);
+        return readSerial(ppdbbase, items, count, path, done);
+    }
+    list.count = count;
+    list.lock = epicsMutexMustCreate();
+    for (i = 0; i < count; i++) {
+        list.jobs[i].pitem = &items[i];
+        list.jobs[i].start = epicsEventMustCreate(epicsEventEmpty);
+        list.jobs[i].done = epicsEventMustCreate(epicsEventEmpty);
+    }
+
+    /* Search the same path that dbReadDatabase() would */
+    if (path && *path) {
+        dbPath(&list.pathBase, path);
+    } else {
+        const char *penv = getenv("EPICS_DB_INCLUDE_PATH");
+
+        dbPath(&list.pathBase, penv ? penv : ".");
+    }
+
+    opts.joinable = 1;
+    opts.priority = epicsThreadGetPrioritySelf();
+    opts.stackSize = epicsThreadStackBig;
+    for (nWorkers = 0; nWorkers < nThreads; nWorkers++) {
+        char name[20];
+
+        epicsSnprintf(name, sizeof(name), "dbReadList-%d", nWorkers);
+        workers[nWorkers] = epicsThreadCreateOpt(name, readWorker, &list,
+            &opts);
+        if (!workers[nWorkers])
+            break;
+    }
+
+    if (nWorkers) {
+        ahead = (size_t) nWorkers * READ_AHEAD;
+        for (i = 0; i < count && i < ahead; i++)
+            epicsEventMustTrigger(list.jobs[i].start);
+
+        for (i = 0; i < count; i++) {
+            readJob *pjob = &list.jobs[i];
+
+            epicsEventMustWait(pjob->done);
+            if (!status) {
+                if (pjob->ok)
+                    status = dbReadParsed(ppdbbase, &pjob->parsed);
+                else
+                    status = dbReadDatabase(ppdbbase, items[i].filename,
+                        path, items[i].substitutions);
+                items[i].status = status;
+                if (done)
+                    done(&items[i]);
+                if (status)
+                    epicsAtomicSetIntT(&list.abort, TRUE);
+            }
+            freeParsed(&pjob->parsed);
+            if (i + ahead < count)
+                epicsEventMustTrigger(list.jobs[i + ahead].start);
+        }
+        for (i = 0; i < (size_t) nWorkers; i++)
+            epicsThreadMustJoin(workers[i]);
+    }
+
+    for (i = 0; i < count; i++) {
+        epicsEventDestroy(list.jobs[i].start);
+        epicsEventDestroy(list.jobs[i].done);
+    }
+    dbFreePath(&list.pathBase);
+    epicsMutexDestroy(list.lock);
+    free(list.jobs);
+    free(workers);
+
+    if (!nWorkers)
+        return readSerial(ppdbbase, items, count, path, done);
+    return status;
+}
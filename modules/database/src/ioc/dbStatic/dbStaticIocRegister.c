@@ -199,10 +199,10 @@ static const iocshFuncDef dbPvdTableSizeFuncDef = {
     "dbPvdTableSize",
     1,
     dbPvdTableSizeArgs,
-    "Change the number of buckets in the process variable directory.\n\n"
+    "Change the initial number of slots in the process variable directory.\n\n"
     "The process variable directory size should be set before loading the database.\n"
-    "The size of the process variable directory can automatically grow.\n"
-    "The size must be a power of 2.\n\n"
+    "The process variable directory grows automatically as records are added.\n"
+    "The size must be a power of 2 from 256 to 65536.\n\n"
     "Example: dbPvdTableSize 1024\n",
 };
 static void dbPvdTableSizeCallFunc(const iocshArgBuf *args)
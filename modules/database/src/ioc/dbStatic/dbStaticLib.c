@@ -796,6 +796,22 @@ short dbGetPromptGroupKeyFromName(DBBASE *pdbbase, const char *name)
     }
 }
 
+short dbFindOrAddGuiGroup(DBBASE *pdbbase, const char *name)
+{
+    dbGuiGroup *pdbGuiGroup;
+    GPHENTRY   *pgphentry;
+    pgphentry = gphFind(pdbbase->pgpHash, name, &pdbbase->guiGroupList);
+    if (!pgphentry) {
+        pdbGuiGroup = dbCalloc(1,sizeof(dbGuiGroup));
+        pdbGuiGroup->name = epicsStrDup(name);
+        ellAdd(&pdbbase->guiGroupList, &pdbGuiGroup->node);
+        pdbGuiGroup->key = ellCount(&pdbbase->guiGroupList);
+        pgphentry = gphAdd(pdbbase->pgpHash, pdbGuiGroup->name, &pdbbase->guiGroupList);
+        pgphentry->userPvt = pdbGuiGroup;
+    }
+    return ((dbGuiGroup *)pgphentry->userPvt)->key;
+}
+
 
 long dbWriteRecord(DBBASE *ppdbbase,const char *filename,
     const char *precordTypename,int level)
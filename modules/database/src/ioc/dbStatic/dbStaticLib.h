@@ -56,6 +56,9 @@ DBCORE_API void dbCopyEntryContents(const DBENTRY *pfrom,
                                     DBENTRY *pto);
 
 DBCORE_API extern int dbBptNotMonotonic;
+/** Number of threads dbReadDatabaseList() uses to read files, <2 to read
+ *  them one after the other */
+DBCORE_API extern int dbLoadRecordsThreads;
 
 /** \brief Open .dbd or .db file and read definitions.
  *  \param ppdbbase The database.  Typically the "pdbbase" global
@@ -64,6 +67,9 @@ DBCORE_API extern int dbBptNotMonotonic;
  *         Split by ':' or ';' (cf. OSI_PATH_LIST_SEPARATOR)
  *  \param substitutions If !NULL, macro definitions like "NAME=VAL,OTHER=SOME"
  *  \return 0 on success
+ *
+ *  \note A filename ending in ".dbdi" names a DBD image made by dbdToImage.pl,
+ *  which is restored without parsing.  Substitutions don't apply to images.
  */
 DBCORE_API long dbReadDatabase(DBBASE **ppdbbase,
     const char *filename, const char *path, const char *substitutions);
@@ -79,6 +85,36 @@ DBCORE_API long dbReadDatabase(DBBASE **ppdbbase,
  */
 DBCORE_API long dbReadDatabaseFP(DBBASE **ppdbbase,
     FILE *fp, const char *path, const char *substitutions);
+
+/** \brief One file to be read by dbReadDatabaseList() */
+typedef struct dbReadListItem {
+    const char *filename;
+    const char *substitutions;
+    long status;    /**< Set to the result of reading this file */
+} dbReadListItem;
+
+/** \brief Called by dbReadDatabaseList() when it has finished with a file */
+typedef void (*DB_READ_LIST_DONE)(const dbReadListItem *pitem);
+
+/** \brief Read several .db files, as if by dbReadDatabase() for each in turn.
+ *  \param ppdbbase The database.  Typically the "pdbbase" global
+ *  \param items Files to read, in order.  The status of each is filled in.
+ *  \param count Number of items
+ *  \param path As for dbReadDatabase()
+ *  \param done If !NULL, called with each file that was read, successfully
+ *         or not, in list order and before the next file is added
+ *  \return 0 if all files were read successfully
+ *
+ *  \note When dbLoadRecordsThreads is 2 or more, that many threads read,
+ *  macro-expand and tokenize the files in parallel.  Record instances are
+ *  still added to the database by the calling thread in list order, so the
+ *  result is the same as reading the files one after the other.  Files
+ *  using anything but record, grecord, field, info and alias statements
+ *  with plain values are read by the normal parser in their turn.
+ */
+DBCORE_API long dbReadDatabaseList(DBBASE **ppdbbase,
+    dbReadListItem *items, size_t count, const char *path,
+    DB_READ_LIST_DONE done);
 DBCORE_API long dbPath(DBBASE *pdbbase, const char *path);
 DBCORE_API long dbAddPath(DBBASE *pdbbase, const char *path);
 DBCORE_API char * dbGetPromptGroupNameFromKey(DBBASE *pdbbase,
@@ -107,6 +107,49 @@ typedef struct dbGuiGroup {
     char        *name;
 } dbGuiGroup;
 
+/* Returns the key of a gui group, adding it if it doesn't exist */
+short dbFindOrAddGuiGroup(DBBASE *pdbbase, const char *name);
+
+/*The following are in dbDbdImage.c*/
+/* True for the name of a DBD image, which ends with ".dbdi" */
+int dbIsDbdImageName(const char *filename);
+/* Restore the definitions of a DBD image made by dbdToImage.pl */
+long dbReadDbdImage(DBBASE *pdbbase, FILE *fp);
+
+/*The following are in dbReadList.c and dbLexRoutines.c*/
+/* Statements of a .db file tokenized by dbReadDatabaseList(), in order.
+ * The arguments are offsets into the strings of the dbParsedFile.
+ */
+typedef enum {
+    dbParsedRecord,     /* type, name */
+    dbParsedGrecord,    /* type, name */
+    dbParsedField,      /* name, value */
+    dbParsedInfo,       /* name, value */
+    dbParsedAlias,      /* alias, in a record body */
+    dbParsedBody,       /* end of a record */
+    dbParsedDbAlias     /* name, alias */
+} dbParsedOp;
+
+typedef struct dbParsedItem {
+    dbParsedOp  op;
+    int         line_num;
+    size_t      arg[2];
+} dbParsedItem;
+
+typedef struct dbParsedFile {
+    char            *filename;
+    const char      *path;
+    dbParsedItem    *items;
+    size_t          nItems;
+    size_t          maxItems;
+    char            *strings;
+    size_t          nStrings;
+    size_t          maxStrings;
+} dbParsedFile;
+
+/* Add the record instances of a tokenized file, as dbReadDatabase() would */
+long dbReadParsed(DBBASE **ppdbbase, dbParsedFile *pparsed);
+
 /*The following are in dbPvdLib.c*/
 /*directory*/
 typedef struct{
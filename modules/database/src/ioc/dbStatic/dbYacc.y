@@ -395,7 +395,8 @@ static int yyerror(char *str)
     else
         epicsPrintf(ERL_ERROR "");
     if (!yyFailed) {    /* Only print this stuff once */
-        epicsPrintf(" at or before '%s'", yytext);
+        if (!replayParsed)
+            epicsPrintf(" at or before '%s'", yytext);
         dbIncludePrint();
         yyFailed = TRUE;
     }
@@ -17,6 +17,7 @@
 #define epicsStdioStdStreams
 
 #include "epicsStdio.h"
+#include "epicsString.h"
 #include "osiUnistd.h"
 #include "macLib.h"
 #include "dbmf.h"
@@ -24,6 +25,7 @@
 
 #include "epicsExport.h"
 #include "dbAccess.h"
+#include "dbStaticLib.h"
 #include "dbLoadTemplate.h"
 
 static int line_num;
@@ -45,10 +47,78 @@ static int var_count, sub_count;
 int dbTemplateMaxVars = 100;
 epicsExportAddress(int, dbTemplateMaxVars);
 
+/* With dbLoadRecordsThreads set the instances are collected while the
+ * substitution file is parsed, then loaded by dbLoadRecordsList().
+ */
+static dbReadListItem *load_items = NULL;
+static int *load_lines = NULL;
+static size_t load_count, load_max;
+
+static
+int msiQueueRecords(const char *fname, const char *subs)
+{
+    if (load_count == load_max) {
+        size_t max = load_max ? 2 * load_max : 64;
+        dbReadListItem *items = realloc(load_items, max * sizeof(*items));
+        int *lines;
+
+        if (items)
+            load_items = items;
+        lines = realloc(load_lines, max * sizeof(*lines));
+        if (lines)
+            load_lines = lines;
+        if (!items || !lines) {
+            yyerror("Out of memory");
+            return -1;
+        }
+        load_max = max;
+    }
+    load_items[load_count].filename = epicsStrDup(fname);
+    load_items[load_count].substitutions = epicsStrDup(subs);
+    load_lines[load_count] = line_num;
+    load_count++;
+    return 0;
+}
+
+static
+int msiLoadQueued(void)
+{
+    size_t i;
+    int ret = dbLoadRecordsList(load_items, load_count);
+    int reported = 0;
+
+    for (i = 0; i < load_count; i++) {
+        dbReadListItem *pitem = &load_items[i];
+
+        /* Files after the one which failed weren't read */
+        if (pitem->status && !reported) {
+            fprintf(stderr, "dbLoadRecords(\"%s\", %s)\n",
+                pitem->filename, pitem->substitutions);
+            fprintf(stderr, "Substitution file error: "
+                "Error while reading included file\n");
+            fprintf(stderr, "line %d\n", load_lines[i]);
+            reported = 1;
+        }
+        free((char *) pitem->filename);
+        free((char *) pitem->substitutions);
+    }
+    free(load_items);
+    free(load_lines);
+    load_items = NULL;
+    load_lines = NULL;
+    load_count = load_max = 0;
+    return ret;
+}
+
 static
 int msiLoadRecords(const char *fname, const char *subs)
 {
-    int ret = dbLoadRecords(fname, subs);
+    int ret;
+
+    if (dbLoadRecordsThreads > 1)
+        return msiQueueRecords(fname, subs);
+
+    ret = dbLoadRecords(fname, subs);
     if(ret) {
         fprintf(stderr, "dbLoadRecords(\"%s\", %s)\n", fname, subs);
         yyerror("Error while reading included file");
@@ -394,6 +464,8 @@ int dbLoadTemplate(const char *sub_file, const char *cmd_collect)
     }
 
     err = yyparse();
+    if (load_count && msiLoadQueued())
+        err = 1;
 
     for (i = 0; i < var_count; i++) {
         dbmfFree(vars[i]);
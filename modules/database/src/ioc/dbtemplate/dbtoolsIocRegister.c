@@ -26,6 +26,8 @@ static const iocshFuncDef dbLoadTemplateFuncDef = {
     "for each template in the substitution file, and load them using 'dbLoadRecords'.\n\n"
     "The second argument provides extra variables to substitute in the\n"
     "template files (not the substitution file).\n\n"
+    "Set 'var dbLoadRecordsThreads 4' first to read the template files\n"
+    "with 4 threads in parallel.\n\n"
     "See 'help dbLoadRecords' for more information.\n\n"
     "Example: dbLoadTemplate db/my.substitutions 'user=myself,host=myhost'\n",
 };
@@ -30,9 +30,13 @@
 #include "envDefs.h"
 #include "epicsExit.h"
 #include "epicsGeneralTime.h"
+#include "epicsMutex.h"
 #include "epicsPrint.h"
 #include "epicsSignal.h"
+#include "epicsStdio.h"
+#include "epicsString.h"
 #include "epicsThread.h"
+#include "epicsTime.h"
 #include "errMdef.h"
 #include "iocsh.h"
 #include "taskwd.h"
@@ -100,6 +104,39 @@ static long iterateRecords(recIterFunc func, void *user);
 int dbThreadRealtimeLock = 1;
 epicsExportAddress(int, dbThreadRealtimeLock);
 
+int dbInitRecordThreads = 0;
+epicsExportAddress(int, dbInitRecordThreads);
+
+/* Requests from dbInitRecordParallel(), applied by initDatabase() */
+typedef struct init_parallel_req {
+    ELLNODE             node;
+    char                *recordType;
+    char                *dtyp;          /* NULL for any device support */
+} init_parallel_req;
+static ELLLIST initParallelReq = ELLLIST_INIT;
+
+/* Timing of the initDatabase() passes, for dbInitRecordReport() */
+#define INIT_PASSES 3
+
+static const char * const initPassName[INIT_PASSES] = {
+    "init_record(0)", "links", "init_record(1)"
+};
+
+typedef struct init_type_stats {
+    dbRecordType        *rtyp;
+    unsigned long       count;
+    unsigned long       nParallel;
+    double              total[INIT_PASSES];
+    double              max;            /* slowest record, any pass */
+} init_type_stats;
+
+static struct {
+    int                 nThreads;
+    double              elapsed[INIT_PASSES];
+    int                 nTypes;
+    init_type_stats     *types;
+} initStats;
+
 enum iocStateEnum getIocState(void)
 {
     return iocState;
@@ -576,25 +613,323 @@ static long doInitRecord1(dbRecordType *pdbRecordType, dbCommon *precord, void *
     return 0;
 }
 
+/*
+ * The records of an initDatabase() pass.  Records whose record type or
+ * device support was named by dbInitRecordParallel() may run their second
+ * init_record() pass on dbInitRecordThreads threads, after the others
+ * have been initialized in the usual order.  Records of the same lock
+ * set stay on one thread and in order.  The first pass and the link
+ * resolution are always done by the calling thread, as the lock sets
+ * are only known once the links have been resolved.
+ */
+typedef struct init_job {
+    dbRecordType        *rtyp;
+    dbCommon            *prec;
+    int                 itype;
+    int                 parallel;
+    unsigned long       lockId;
+    long                status;
+    double              time;
+} init_job;
+
+typedef struct init_pass {
+    recIterFunc         func;
+    init_job            *jobs;
+    size_t              nJobs;
+    init_job            **par;          /* parallel jobs, by lock set */
+    size_t              nPar;
+    size_t              next;
+    epicsMutexId        lock;
+} init_pass;
+
+static int initParallelWanted(dbRecordType *rtyp, dbCommon *prec)
+{
+    init_parallel_req *preq;
+    devSup *pdevSup = NULL;
+
+    for (preq = (init_parallel_req *)ellFirst(&initParallelReq);
+         preq; preq = (init_parallel_req *)ellNext(&preq->node)) {
+        if (strcmp(preq->recordType, rtyp->name) != 0)
+            continue;
+        if (!preq->dtyp)
+            return TRUE;
+        if (!pdevSup)
+            pdevSup = dbDTYPtoDevSup(rtyp, prec->dtyp);
+        if (pdevSup && strcmp(preq->dtyp, pdevSup->choice) == 0)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static void initJobList(init_pass *ppass)
+{
+    dbRecordType *pdbRecordType;
+    size_t n = 0;
+    int itype = 0;
+
+    initStats.nTypes = ellCount(&pdbbase->recordTypeList);
+    initStats.types = dbCalloc(initStats.nTypes ? initStats.nTypes : 1,
+        sizeof(init_type_stats));
+
+    for (pdbRecordType = (dbRecordType *)ellFirst(&pdbbase->recordTypeList);
+         pdbRecordType;
+         pdbRecordType = (dbRecordType *)ellNext(&pdbRecordType->node))
+        n += ellCount(&pdbRecordType->recList);
+    ppass->jobs = dbCalloc(n ? n : 1, sizeof(init_job));
+    ppass->par = dbCalloc(n ? n : 1, sizeof(init_job *));
+
+    for (pdbRecordType = (dbRecordType *)ellFirst(&pdbbase->recordTypeList);
+         pdbRecordType;
+         pdbRecordType = (dbRecordType *)ellNext(&pdbRecordType->node),
+         itype++) {
+        init_type_stats *pstats = &initStats.types[itype];
+        dbRecordNode *pdbRecordNode;
+
+        pstats->rtyp = pdbRecordType;
+        for (pdbRecordNode = (dbRecordNode *)ellFirst(&pdbRecordType->recList);
+             pdbRecordNode;
+             pdbRecordNode = (dbRecordNode *)ellNext(&pdbRecordNode->node)) {
+            dbCommon *precord = pdbRecordNode->precord;
+            init_job *pjob;
+
+            if (!precord->name[0] ||
+                pdbRecordNode->flags & DBRN_FLAGS_ISALIAS)
+                continue;
+
+            pjob = &ppass->jobs[ppass->nJobs++];
+            pjob->rtyp = pdbRecordType;
+            pjob->prec = precord;
+            pjob->itype = itype;
+            pjob->parallel = initStats.nThreads > 1 &&
+                initParallelWanted(pdbRecordType, precord);
+            pstats->count++;
+            if (pjob->parallel)
+                pstats->nParallel++;
+        }
+    }
+}
+
+static void initJob(init_pass *ppass, init_job *pjob)
+{
+    epicsTimeStamp start, stop;
+
+    epicsTimeGetMonotonic(&start);
+    pjob->status = ppass->func(pjob->rtyp, pjob->prec, NULL);
+    epicsTimeGetMonotonic(&stop);
+    pjob->time = epicsTimeDiffInSeconds(&stop, &start);
+}
+
+static void initWorker(void *arg)
+{
+    init_pass *ppass = (init_pass *)arg;
+
+    for (;;) {
+        size_t first, end;
+
+        /* Take all records of the next lock set */
+        epicsMutexMustLock(ppass->lock);
+        first = end = ppass->next;
+        if (first < ppass->nPar) {
+            unsigned long lockId = ppass->par[first]->lockId;
+
+            while (end < ppass->nPar && ppass->par[end]->lockId == lockId)
+                end++;
+        }
+        ppass->next = end;
+        epicsMutexUnlock(ppass->lock);
+
+        if (first == end)
+            break;
+        for (; first < end; first++)
+            initJob(ppass, ppass->par[first]);
+    }
+}
+
+static int initJobCompare(const void *a, const void *b)
+{
+    const init_job *pa = *(const init_job * const *)a;
+    const init_job *pb = *(const init_job * const *)b;
+
+    if (pa->lockId != pb->lockId)
+        return pa->lockId < pb->lockId ? -1 : 1;
+    return pa < pb ? -1 : pa > pb;
+}
+
+static void initParallel(init_pass *ppass)
+{
+    epicsThreadOpts opts = EPICS_THREAD_OPTS_INIT;
+    epicsThreadId *workers;
+    int nWorkers = initStats.nThreads - 1;
+    int i;
+
+    if ((size_t)nWorkers > ppass->nPar - 1)
+        nWorkers = (int)(ppass->nPar - 1);
+
+    /* Lock sets have merged since the last pass */
+    for (i = 0; (size_t)i < ppass->nPar; i++)
+        ppass->par[i]->lockId = dbLockGetLockId(ppass->par[i]->prec);
+    qsort(ppass->par, ppass->nPar, sizeof(init_job *), initJobCompare);
+
+    ppass->next = 0;
+    ppass->lock = epicsMutexMustCreate();
+    workers = dbCalloc(nWorkers ? nWorkers : 1, sizeof(epicsThreadId));
+
+    opts.joinable = 1;
+    opts.priority = epicsThreadGetPrioritySelf();
+    opts.stackSize = epicsThreadStackBig;
+    for (i = 0; i < nWorkers; i++) {
+        char name[20];
+
+        epicsSnprintf(name, sizeof(name), "initRecord-%d", i);
+        workers[i] = epicsThreadCreateOpt(name, initWorker, ppass, &opts);
+        if (!workers[i])
+            break;
+    }
+    nWorkers = i;
+
+    initWorker(ppass);
+    for (i = 0; i < nWorkers; i++)
+        epicsThreadMustJoin(workers[i]);
+
+    epicsMutexDestroy(ppass->lock);
+    free(workers);
+}
+
+static long initPass(init_pass *ppass, int pass, recIterFunc func)
+{
+    epicsTimeStamp start, stop;
+    long ret = 0;
+    size_t i;
+
+    epicsTimeGetMonotonic(&start);
+    ppass->func = func;
+    ppass->nPar = 0;
+    for (i = 0; i < ppass->nJobs; i++) {
+        init_job *pjob = &ppass->jobs[i];
+
+        if (pjob->parallel && func == doInitRecord1)
+            ppass->par[ppass->nPar++] = pjob;
+        else
+            initJob(ppass, pjob);
+    }
+    if (ppass->nPar)
+        initParallel(ppass);
+    epicsTimeGetMonotonic(&stop);
+    initStats.elapsed[pass] = epicsTimeDiffInSeconds(&stop, &start);
+
+    for (i = 0; i < ppass->nJobs; i++) {
+        init_job *pjob = &ppass->jobs[i];
+        init_type_stats *pstats = &initStats.types[pjob->itype];
+
+        pstats->total[pass] += pjob->time;
+        if (pjob->time > pstats->max)
+            pstats->max = pjob->time;
+        if (!ret)
+            ret = pjob->status; /* latch first error */
+    }
+    return ret;
+}
+
 static long initDatabase(void)
 {
+    init_pass pass;
     long status, ret = 0;
+
     dbChannelInit();
-    status = iterateRecords(doInitRecord0, NULL);
+
+    memset(&pass, 0, sizeof(pass));
+    free(initStats.types);
+    memset(&initStats, 0, sizeof(initStats));
+    initStats.nThreads = dbInitRecordThreads;
+    initJobList(&pass);
+
+    status = initPass(&pass, 0, doInitRecord0);
     if (!ret)
         ret = status; /* latch first error */
-    status = iterateRecords(doResolveLinks, NULL);
+    status = initPass(&pass, 1, doResolveLinks);
     if (!ret)
         ret = status;
-    status = iterateRecords(doInitRecord1, NULL);
+    status = initPass(&pass, 2, doInitRecord1);
     if (!ret)
         ret = status;
+    free(pass.jobs);
+    free(pass.par);
+
     status = epicsAtExit(exitDatabase, NULL);
     if (!ret)
         ret = status;
     return ret;
 }
 
+int dbInitRecordParallel(const char *recordType, const char *dtyp)
+{
+    init_parallel_req *preq;
+
+    if (iocState != iocVoid) {
+        fprintf(stderr, "dbInitRecordParallel: IOC already initialized\n");
+        return -1;
+    }
+    if (!recordType || !*recordType) {
+        fprintf(stderr, "dbInitRecordParallel: Record type required\n");
+        return -1;
+    }
+
+    preq = dbCalloc(1, sizeof(init_parallel_req));
+    preq->recordType = epicsStrDup(recordType);
+    if (dtyp && *dtyp)
+        preq->dtyp = epicsStrDup(dtyp);
+    ellAdd(&initParallelReq, &preq->node);
+    return 0;
+}
+
+static void freeInitParallel(void)
+{
+    init_parallel_req *preq;
+
+    while ((preq = (init_parallel_req *)ellGet(&initParallelReq))) {
+        free(preq->recordType);
+        free(preq->dtyp);
+        free(preq);
+    }
+    free(initStats.types);
+    memset(&initStats, 0, sizeof(initStats));
+}
+
+long dbInitRecordReport(int level)
+{
+    int i, pass;
+
+    if (!initStats.types) {
+        printf("dbInitRecordReport: Database not initialized\n");
+        return 0;
+    }
+
+    printf("Record initialization using %d thread%s:\n",
+        initStats.nThreads > 1 ? initStats.nThreads : 1,
+        initStats.nThreads > 1 ? "s" : "");
+    for (pass = 0; pass < INIT_PASSES; pass++)
+        printf("  %-16s %10.3f s\n", initPassName[pass],
+            initStats.elapsed[pass]);
+
+    printf("\n  %-20s %8s %8s", "Record type", "Records", "Parallel");
+    for (pass = 0; pass < INIT_PASSES; pass++)
+        printf(" %14s", initPassName[pass]);
+    printf(" %12s\n", "Slowest (ms)");
+
+    for (i = 0; i < initStats.nTypes; i++) {
+        init_type_stats *pstats = &initStats.types[i];
+
+        if (!pstats->count && level < 1)
+            continue;
+        printf("  %-20s %8lu %8lu", pstats->rtyp->name, pstats->count,
+            pstats->nParallel);
+        for (pass = 0; pass < INIT_PASSES; pass++)
+            printf(" %12.3f s", pstats->total[pass]);
+        printf(" %12.3f\n", pstats->max * 1e3);
+    }
+    return 0;
+}
+
 /*
  *  Process database records at initialization ordered by phase
  *     if their pini (process at init) field is set.
@@ -767,6 +1102,7 @@ int iocShutdown(void)
 
         iterateRecords(doFreeRecord, NULL);
         dbLockCleanupRecords(pdbbase);
+        freeInitParallel();
 
         asShutdown();
         dbChannelExit();
@@ -30,6 +30,14 @@ DBCORE_API int iocRun(void);
 DBCORE_API int iocPause(void);
 DBCORE_API int iocShutdown(void);
 
+/* Threads to initialize records with, see dbInitRecordParallel() */
+DBCORE_API extern int dbInitRecordThreads;
+/* Let init_record() pass 1 run concurrently for records of this type, and
+ * optionally only those with this DTYP; call before iocInit */
+DBCORE_API int dbInitRecordParallel(const char *recordType, const char *dtyp);
+/* Print the time taken by each record initialization pass */
+DBCORE_API long dbInitRecordReport(int level);
+
 #ifdef __cplusplus
 }
 #endif
@@ -53,6 +53,33 @@ static void iocPauseCallFunc(const iocshArgBuf *args)
     iocshSetError(iocPause());
 }
 
+/* dbInitRecordParallel */
+static const iocshArg dbInitRecordParallelArg0 = { "recordType",iocshArgString};
+static const iocshArg dbInitRecordParallelArg1 = { "DTYP",iocshArgString};
+static const iocshArg * const dbInitRecordParallelArgs[2] =
+    {&dbInitRecordParallelArg0,&dbInitRecordParallelArg1};
+static const iocshFuncDef dbInitRecordParallelFuncDef = {"dbInitRecordParallel",2,dbInitRecordParallelArgs,
+             "Initialize records of a type concurrently on dbInitRecordThreads threads.\n"
+             "If DTYP is given, only records using that device support.\n"
+             "Only init_record() pass 1, which runs after the links have been resolved,\n"
+             "is run in parallel; it must be thread-safe for the record and device support.\n"
+             "Records sharing a lock set are initialized by the same thread.\n"
+             "Must be called before iocInit.\n"};
+static void dbInitRecordParallelCallFunc(const iocshArgBuf *args)
+{
+    iocshSetError(dbInitRecordParallel(args[0].sval, args[1].sval));
+}
+
+/* dbInitRecordReport */
+static const iocshArg dbInitRecordReportArg0 = { "interest level",iocshArgInt};
+static const iocshArg * const dbInitRecordReportArgs[1] = {&dbInitRecordReportArg0};
+static const iocshFuncDef dbInitRecordReportFuncDef = {"dbInitRecordReport",1,dbInitRecordReportArgs,
+             "Print the time iocInit took to initialize records, by pass and record type.\n"};
+static void dbInitRecordReportCallFunc(const iocshArgBuf *args)
+{
+    dbInitRecordReport(args[0].ival);
+}
+
 /* coreRelease */
 static const iocshFuncDef coreReleaseFuncDef = {"coreRelease",0,NULL,
              "Print release information for iocCore.\n"};
@@ -68,6 +95,8 @@ void miscIocRegister(void)
     iocshRegister(&iocBuildFuncDef,iocBuildCallFunc);
     iocshRegister(&iocRunFuncDef,iocRunCallFunc);
     iocshRegister(&iocPauseFuncDef,iocPauseCallFunc);
+    iocshRegister(&dbInitRecordParallelFuncDef,dbInitRecordParallelCallFunc);
+    iocshRegister(&dbInitRecordReportFuncDef,dbInitRecordReportCallFunc);
     iocshRegister(&coreReleaseFuncDef, coreReleaseCallFunc);
 }
 
@@ -24,6 +24,7 @@
 #include <stdarg.h>
 #include <limits.h>
 
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsStdio.h"
@@ -479,6 +480,177 @@ static void no_read_access_event ( struct client *pClient,
     }
 }
 
+/*
+ * Cache of wire encoded subscription updates.
+ *
+ * All subscriptions updated by one db_post_events() call see the same
+ * db_field_log::post_id, which is only set when a post updates more than
+ * one subscription.  Those for the same field which ask for the same
+ * DBR type and count, through the same filters, will be sent identical
+ * payloads.  The first read_reply() to encode such a payload stores it here,
+ * the others copy it instead of repeating dbChannel_get_count() and
+ * caNetConvert().
+ *
+ * A slot holds the payloads of one post, selected by its post_id, each
+ * in a buffer of its own size.  A newer post takes the slot over, so an
+ * entry lives until MON_CACHE_SLOTS later shared posts have been made.
+ */
+#define MON_CACHE_SLOTS 32u /* must be a power of 2 */
+#define MON_CACHE_WAYS 4u   /* payloads kept per post */
+
+typedef struct {
+    const void      *pfield;    /* dbAddr::compare */
+    char            *filters;   /* channel name if filtered, else NULL */
+    ca_uint32_t     reqCount;   /* requested count, 0 for autosize */
+    ca_uint32_t     itemCount;  /* elements actually encoded */
+    ca_uint32_t     size;       /* bytes of encoded data */
+    ca_uint16_t     dataType;
+    char            *buf;       /* NULL if entry is empty */
+} monCacheEntry;
+
+typedef struct {
+    epicsMutexId    lock;
+    size_t          post_id;    /* 0 if slot is empty */
+    monCacheEntry   entry[MON_CACHE_WAYS];
+} monCacheSlot;
+
+static monCacheSlot monCache[MON_CACHE_SLOTS];
+
+void rsrvMonCacheInit (void)
+{
+    unsigned i;
+
+    for ( i = 0u; i < MON_CACHE_SLOTS; i++ ) {
+        if ( ! monCache[i].lock ) {
+            monCache[i].lock = epicsMutexMustCreate ();
+        }
+    }
+}
+
+static int monCacheUsable ( const db_field_log *pfl,
+    ca_uint32_t payload_size )
+{
+    return rsrvMonitorCacheMin > 0 && pfl && pfl->post_id &&
+        payload_size >= (ca_uint32_t) rsrvMonitorCacheMin;
+}
+
+static monCacheSlot * monCacheSlotFor ( const db_field_log *pfl )
+{
+    return &monCache[pfl->post_id & ( MON_CACHE_SLOTS - 1u )];
+}
+
+static void monCacheEntryClear ( monCacheEntry *pEntry )
+{
+    free ( pEntry->buf );
+    free ( pEntry->filters );
+    pEntry->buf = NULL;
+    pEntry->filters = NULL;
+}
+
+static int monCacheMatch ( const monCacheEntry *pEntry,
+    const struct dbChannel *dbch, const struct event_ext *pevext )
+{
+    int filtered = ellCount ( &dbch->filters ) > 0;
+
+    if ( ! pEntry->buf ||
+        pEntry->pfield != dbch->addr.compare ||
+        pEntry->dataType != pevext->msg.m_dataType ||
+        pEntry->reqCount != pevext->msg.m_count ) {
+        return FALSE;
+    }
+    if ( ! filtered ) {
+        return pEntry->filters == NULL;
+    }
+    return pEntry->filters &&
+        strcmp ( pEntry->filters, dbChannelName ( dbch ) ) == 0;
+}
+
+/*
+ * Copy a cached payload into pPayload.
+ * Returns the number of bytes copied, or 0 on a miss.
+ */
+static ca_uint32_t monCacheFetch ( const struct dbChannel *dbch,
+    const struct event_ext *pevext, const db_field_log *pfl,
+    void *pPayload, ca_uint32_t maxSize, long *pItemCount )
+{
+    monCacheSlot *pSlot = monCacheSlotFor ( pfl );
+    ca_uint32_t size = 0u;
+    unsigned i;
+
+    epicsMutexMustLock ( pSlot->lock );
+    if ( pSlot->post_id == pfl->post_id ) {
+        for ( i = 0u; i < MON_CACHE_WAYS; i++ ) {
+            monCacheEntry *pEntry = &pSlot->entry[i];
+
+            if ( monCacheMatch ( pEntry, dbch, pevext ) ) {
+                if ( pEntry->size <= maxSize ) {
+                    memcpy ( pPayload, pEntry->buf, pEntry->size );
+                    size = pEntry->size;
+                    *pItemCount = pEntry->itemCount;
+                }
+                break;
+            }
+        }
+    }
+    epicsMutexUnlock ( pSlot->lock );
+
+    if ( size ) {
+        epicsAtomicIncrSizeT ( &rsrvMonCacheHits );
+    }
+    else {
+        epicsAtomicIncrSizeT ( &rsrvMonCacheMisses );
+    }
+    return size;
+}
+
+static void monCacheStore ( const struct dbChannel *dbch,
+    const struct event_ext *pevext, const db_field_log *pfl,
+    const void *pPayload, ca_uint32_t size, long itemCount )
+{
+    monCacheSlot *pSlot = monCacheSlotFor ( pfl );
+    int filtered = ellCount ( &dbch->filters ) > 0;
+    monCacheEntry *pEntry = NULL;
+    unsigned i;
+
+    epicsMutexMustLock ( pSlot->lock );
+    if ( pSlot->post_id != pfl->post_id ) {
+        /* post_id only grows, an older post is no longer worth keeping */
+        if ( pSlot->post_id > pfl->post_id ) {
+            epicsMutexUnlock ( pSlot->lock );
+            return;
+        }
+        for ( i = 0u; i < MON_CACHE_WAYS; i++ ) {
+            monCacheEntryClear ( &pSlot->entry[i] );
+        }
+        pSlot->post_id = pfl->post_id;
+    }
+    for ( i = 0u; i < MON_CACHE_WAYS; i++ ) {
+        if ( monCacheMatch ( &pSlot->entry[i], dbch, pevext ) ) {
+            break;  /* another subscriber stored it first */
+        }
+        if ( ! pEntry && ! pSlot->entry[i].buf ) {
+            pEntry = &pSlot->entry[i];
+        }
+    }
+    if ( i == MON_CACHE_WAYS && pEntry ) {
+        pEntry->buf = malloc ( size );
+        pEntry->filters = filtered ?
+            epicsStrDup ( dbChannelName ( dbch ) ) : NULL;
+        if ( pEntry->buf ) {
+            memcpy ( pEntry->buf, pPayload, size );
+            pEntry->pfield = dbch->addr.compare;
+            pEntry->dataType = pevext->msg.m_dataType;
+            pEntry->reqCount = pevext->msg.m_count;
+            pEntry->itemCount = (ca_uint32_t) itemCount;
+            pEntry->size = size;
+        }
+        else {
+            monCacheEntryClear ( pEntry );
+        }
+    }
+    epicsMutexUnlock ( pSlot->lock );
+}
+
 /*
  *  read_reply()
  */
@@ -493,8 +665,10 @@ static void read_reply ( void *pArg, struct dbChannel *dbch,
     const int readAccess = asCheckGet ( pciu->asClientPVT );
     int status;
     int autosize;
+    int useCache;
     long item_count;
     ca_uint32_t payload_size;
+    ca_uint32_t cached_size = 0u;
     dbAddr *paddr=&dbch->addr;
 
     SEND_LOCK ( pClient );
@@ -534,10 +708,24 @@ static void read_reply ( void *pArg, struct dbChannel *dbch,
         return;
     }
 
-    status = dbChannel_get_count ( dbch, pevext->msg.m_dataType,
-                  pPayload, &item_count, pfl);
+    useCache = monCacheUsable ( pfl, payload_size );
+    if ( useCache ) {
+        cached_size = monCacheFetch ( dbch, pevext, pfl,
+            pPayload, payload_size, &item_count );
+    }
 
-    if ( status < 0 ) {
+    if ( cached_size ) {
+        if (autosize) {
+            payload_size = cached_size;
+            cas_set_header_count(pClient, item_count);
+        }
+        else if (payload_size > cached_size)
+            memset(
+                (char *) pPayload + cached_size, 0, payload_size - cached_size);
+        cas_commit_msg ( pClient, payload_size );
+    }
+    else if ( ( status = dbChannel_get_count ( dbch, pevext->msg.m_dataType,
+                  pPayload, &item_count, pfl) ) < 0 ) {
         /* Clients recv the status of the operation directly to the
          * event/put/get callback.  (from CA_V41())
          *
@@ -562,6 +750,10 @@ static void read_reply ( void *pArg, struct dbChannel *dbch,
         if ( cacStatus == ECA_NORMAL ) {
             ca_uint32_t data_size =
                 dbr_size_n(pevext->msg.m_dataType, item_count);
+            if ( useCache ) {
+                monCacheStore ( dbch, pevext, pfl,
+                    pPayload, data_size, item_count );
+            }
             if (autosize) {
                 payload_size = data_size;
                 cas_set_header_count(pClient, item_count);
@@ -1504,8 +1696,8 @@ static void putNotifyErrorReply ( struct client *client, caHdrLargeArray *mp, in
 void initializePutNotifyFreeList (void)
 {
     if ( ! rsrvPutNotifyFreeList ) {
-        freeListInitPvt ( &rsrvPutNotifyFreeList,
-            sizeof(struct rsrv_put_notify), 512 );
+        freeListInitFlags ( &rsrvPutNotifyFreeList,
+            sizeof(struct rsrv_put_notify), 512, FREELIST_THREAD_CACHE );
         assert ( rsrvPutNotifyFreeList );
     }
 }
@@ -2392,6 +2584,12 @@ int camessage ( struct client *client )
         caHdr *mp;
         void *pBody;
 
+        /* an I/O thread leaves the rest until the replies can be sent */
+        if ( cas_send_backlog ( client ) ) {
+            status = RSRV_OK;
+            break;
+        }
+
         /* wait for at least a complete caHdr */
         bytes_left = client->recv.cnt - client->recv.stk;
         if ( bytes_left < sizeof(*mp) ) {
@@ -34,122 +34,175 @@
 #include "server.h"
 
 /*
- *  camsgtask()
+ *  casRecvAndProcess()
  *
- *  CA server TCP client task (one spawned for each client)
+ *  Receive whatever is available from a TCP client, and process
+ *  all complete messages.  Returns RSRV_ERROR if the circuit
+ *  should be closed.
  */
-void camsgtask ( void *pParm )
+int casRecvAndProcess ( struct client *client )
 {
-    struct client *client = (struct client *) pParm;
+    long nchars;
 
-    casAttachThreadToClient ( client );
+    client->recv.stk = 0;
+    assert ( client->recv.maxstk >= client->recv.cnt );
+    if ( client->recv.cnt == client->recv.maxstk ) {
+        /* filled with requests an I/O thread left unprocessed */
+        return casProcessInput ( client );
+    }
+    nchars = recv ( client->sock, &client->recv.buf[client->recv.cnt],
+            (int) ( client->recv.maxstk - client->recv.cnt ), 0 );
+    if ( nchars == 0 ){
+        if ( CASDEBUG > 0 ) {
+            /* convert to u long so that %lu works on both 32 and 64 bit archs */
+            unsigned long cnt = sizeof ( client->recv.buf ) - client->recv.cnt;
+            errlogPrintf ( "CAS: nill message disconnect ( %lu bytes request )\n",
+                cnt );
+        }
+        return RSRV_ERROR;
+    }
+    else if ( nchars < 0 ) {
+        int anerrno = SOCKERRNO;
 
-    while (castcp_ctl == ctlRun && !client->disconnect) {
-        osiSockIoctl_t check_nchars;
-        long nchars;
-        int status;
+        /* SOCK_EWOULDBLOCK only with multiplexed circuits */
+        if ( anerrno == SOCK_EINTR || anerrno == SOCK_EWOULDBLOCK ) {
+            return RSRV_OK;
+        }
+
+        if ( anerrno == SOCK_ENOBUFS ) {
+            if ( rsrvMuxOnIoThread ( client ) ) {
+                SEND_LOCK ( client );
+                rsrvMuxRetry ( client );
+                SEND_UNLOCK ( client );
+                return RSRV_OK;
+            }
+            errlogPrintf (
+                "CAS: Out of network buffers, retring receive in 15 seconds\n" );
+            epicsThreadSleep ( 15.0 );
+            return RSRV_OK;
+        }
 
         /*
-         * allow message to batch up if more are coming
+         * normal conn lost conditions
          */
-        status = socket_ioctl (client->sock, FIONREAD, &check_nchars);
-        if (status < 0) {
+        if (    ( anerrno != SOCK_ECONNABORTED &&
+            anerrno != SOCK_ECONNRESET &&
+            anerrno != SOCK_ETIMEDOUT ) ||
+            CASDEBUG > 2 ) {
             char sockErrBuf[64];
 
-            epicsSocketConvertErrnoToString (
-                sockErrBuf, sizeof ( sockErrBuf ) );
-            errlogPrintf("CAS: FIONREAD " ERL_ERROR ": %s\n",
-                sockErrBuf);
-            cas_send_bs_msg(client, TRUE);
-        }
-        else if (check_nchars == 0){
-            cas_send_bs_msg(client, TRUE);
+            epicsSocketConvertErrorToString(
+                sockErrBuf, sizeof ( sockErrBuf ), anerrno);
+            errlogPrintf ( "CAS: Client disconnected - %s\n",
+                sockErrBuf );
         }
+        return RSRV_ERROR;
+    }
 
-        client->recv.stk = 0;
-        assert ( client->recv.maxstk >= client->recv.cnt );
-        nchars = recv ( client->sock, &client->recv.buf[client->recv.cnt],
-                (int) ( client->recv.maxstk - client->recv.cnt ), 0 );
-        if ( nchars == 0 ){
-            if ( CASDEBUG > 0 ) {
-                /* convert to u long so that %lu works on both 32 and 64 bit archs */
-                unsigned long cnt = sizeof ( client->recv.buf ) - client->recv.cnt;
-                errlogPrintf ( "CAS: nill message disconnect ( %lu bytes request )\n",
-                    cnt );
-            }
-            break;
-        }
-        else if ( nchars < 0 ) {
-            int anerrno = SOCKERRNO;
+    epicsTimeGetCurrent ( &client->time_at_last_recv );
+    client->recv.cnt += ( unsigned ) nchars;
 
-            if ( anerrno == SOCK_EINTR ) {
-                continue;
-            }
+    return casProcessInput ( client );
+}
 
-            if ( anerrno == SOCK_ENOBUFS ) {
-                errlogPrintf (
-                    "CAS: Out of network buffers, retring receive in 15 seconds\n" );
-                epicsThreadSleep ( 15.0 );
-                continue;
-            }
+/*
+ *  casProcessInput()
+ *
+ *  Process the complete messages received from a TCP client, keeping
+ *  the rest for later.  Returns RSRV_ERROR if the circuit should be
+ *  closed.
+ */
+int casProcessInput ( struct client *client )
+{
+    int status;
 
-            /*
-             * normal conn lost conditions
-             */
-            if (    ( anerrno != SOCK_ECONNABORTED &&
-                anerrno != SOCK_ECONNRESET &&
-                anerrno != SOCK_ETIMEDOUT ) ||
-                CASDEBUG > 2 ) {
-                char sockErrBuf[64];
-
-                epicsSocketConvertErrorToString(
-                    sockErrBuf, sizeof ( sockErrBuf ), anerrno);
-                errlogPrintf ( "CAS: Client disconnected - %s\n",
-                    sockErrBuf );
-            }
-            break;
-        }
+    client->recv.stk = 0;
+    status = camessage ( client );
+    if (status == 0) {
+        /*
+         * if there is a partial message
+         * align it with the start of the buffer
+         */
+        if (client->recv.cnt > client->recv.stk) {
+            unsigned bytes_left;
 
-        epicsTimeGetCurrent ( &client->time_at_last_recv );
-        client->recv.cnt += ( unsigned ) nchars;
+            bytes_left = client->recv.cnt - client->recv.stk;
 
-        status = camessage ( client );
-        if (status == 0) {
             /*
-             * if there is a partial message
-             * align it with the start of the buffer
+             * overlapping regions handled
+             * properly by memmove
              */
-            if (client->recv.cnt > client->recv.stk) {
-                unsigned bytes_left;
-
-                bytes_left = client->recv.cnt - client->recv.stk;
-
-                /*
-                 * overlapping regions handled
-                 * properly by memmove
-                 */
-                memmove (client->recv.buf,
-                    &client->recv.buf[client->recv.stk], bytes_left);
-                client->recv.cnt = bytes_left;
-            }
-            else {
-                client->recv.cnt = 0ul;
-            }
+            memmove (client->recv.buf,
+                &client->recv.buf[client->recv.stk], bytes_left);
+            client->recv.cnt = bytes_left;
         }
         else {
-            char buf[64];
+            client->recv.cnt = 0ul;
+        }
+    }
+    else {
+        char buf[64];
 
-            /* flush any queued messages before shutdown */
-            cas_send_bs_msg(client, 1);
+        /* flush any queued messages before shutdown */
+        cas_send_bs_msg(client, 1);
 
-            client->recv.cnt = 0ul;
+        client->recv.cnt = 0ul;
 
-            /*
-             * disconnect when there are severe message errors
-             */
-            ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
-            epicsPrintf ("CAS: forcing disconnect from %s\n", buf);
-                break;
+        /*
+         * disconnect when there are severe message errors
+         */
+        ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
+        epicsPrintf ("CAS: forcing disconnect from %s\n", buf);
+        return RSRV_ERROR;
+    }
+    return RSRV_OK;
+}
+
+/*
+ *  casRecvPending()
+ *
+ *  Returns true if more input is waiting, so that replies
+ *  can be allowed to batch up.
+ */
+int casRecvPending ( struct client *client )
+{
+    osiSockIoctl_t check_nchars;
+    int status;
+
+    status = socket_ioctl (client->sock, FIONREAD, &check_nchars);
+    if (status < 0) {
+        char sockErrBuf[64];
+
+        epicsSocketConvertErrnoToString (
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf("CAS: FIONREAD " ERL_ERROR ": %s\n",
+            sockErrBuf);
+        return FALSE;
+    }
+    return check_nchars != 0;
+}
+
+/*
+ *  camsgtask()
+ *
+ *  CA server TCP client task (one spawned for each client)
+ */
+void camsgtask ( void *pParm )
+{
+    struct client *client = (struct client *) pParm;
+
+    casAttachThreadToClient ( client );
+
+    while (castcp_ctl == ctlRun && !client->disconnect) {
+        /*
+         * allow message to batch up if more are coming
+         */
+        if ( ! casRecvPending ( client ) ) {
+            cas_send_bs_msg(client, TRUE);
+        }
+
+        if ( casRecvAndProcess ( client ) != RSRV_OK ) {
+            break;
         }
     }
 
@@ -0,0 +1,452 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS Base is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/*
+ *  Multiplexed TCP circuits.
+ *
+ *  Instead of a receive thread for each client, a small fixed pool of
+ *  I/O threads each wait with epoll() on the sockets of the circuits
+ *  assigned to them.  Client sockets are non-blocking and the I/O threads
+ *  never wait for one.  A reply which can not be sent immediately is left
+ *  in the send buffer and the circuit stops reading requests until the
+ *  socket becomes writable again.  A circuit which is closed is handed
+ *  to a reaper thread, which waits for its event task to exit.
+ *
+ *  Each circuit still has its own event task (cf. db_start_events()),
+ *  which will wait for the socket to become writable when a monitor
+ *  update does not fit in the send buffer.  This is the same flow control
+ *  behavior as with blocking sockets.  It doesn't hold SEND_LOCK() while
+ *  waiting, so the I/O thread can still use the circuit.
+ *
+ *  Enabled by setting EPICS_CAS_IO_THREADS to the number of I/O threads.
+ *  Only available on Linux.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+#  include <fcntl.h>
+#  include <poll.h>
+#  include <sys/epoll.h>
+#  include <unistd.h>
+#endif
+
+#include "dbDefs.h"
+#include "ellLib.h"
+#include "epicsAtomic.h"
+#include "epicsEvent.h"
+#include "epicsMutex.h"
+#include "epicsSignal.h"
+#include "epicsStdio.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "osiSock.h"
+#include "taskwd.h"
+
+#include "rsrv.h"
+#include "server.h"
+
+#ifdef __linux__
+
+#define RSRV_MUX_MAX_EVENTS 64
+
+/* How long a circuit which ran out of network buffers is put off */
+#define RSRV_MUX_RETRY_DELAY 1.0
+
+struct rsrv_io_thread {
+    int             epfd;
+    epicsThreadId   tid;
+    size_t          nClients;   /* epicsAtomic */
+    /* circuits waiting to retry a send, and since when */
+    struct client   *retryList;
+    epicsTimeStamp  retryTime;
+};
+
+static struct rsrv_io_thread *ioThreads;
+static unsigned nIoThreads;
+static size_t nextIoThread; /* epicsAtomic, round robin assignment */
+
+/* closed circuits waiting for the reaper thread */
+static ELLLIST reapList = ELLLIST_INIT;
+static epicsMutexId reapLock;
+static epicsEventId reapWakeup;
+
+static int muxSetEvents ( struct client *pClient, int op, unsigned events )
+{
+    struct epoll_event evt;
+
+    memset ( &evt, 0, sizeof ( evt ) );
+    evt.events = events;
+    evt.data.ptr = pClient;
+    return epoll_ctl ( pClient->ioThread->epfd, op, pClient->sock, &evt );
+}
+
+/*
+ * Destroying a circuit waits for its event task, so it is not done
+ * by the I/O threads.
+ */
+static void muxReaper ( void *pParm )
+{
+    taskwdInsert ( epicsThreadGetIdSelf (), NULL, NULL );
+
+    while ( TRUE ) {
+        struct client *pClient;
+
+        epicsEventMustWait ( reapWakeup );
+
+        while ( TRUE ) {
+            epicsMutexMustLock ( reapLock );
+            pClient = (struct client *) ellGet ( &reapList );
+            epicsMutexUnlock ( reapLock );
+            if ( ! pClient ) {
+                break;
+            }
+            destroy_tcp_client ( pClient );
+        }
+    }
+}
+
+static void muxClose ( struct client *pClient )
+{
+    struct rsrv_io_thread *pThread = pClient->ioThread;
+
+    if ( pClient->sendRetry ) {
+        struct client **ppNext = &pThread->retryList;
+        while ( *ppNext != pClient ) {
+            ppNext = &( *ppNext )->nextRetry;
+        }
+        *ppNext = pClient->nextRetry;
+        pClient->sendRetry = FALSE;
+    }
+
+    SEND_LOCK ( pClient );
+    pClient->disconnect = TRUE;
+    SEND_UNLOCK ( pClient );
+
+    if ( pClient->sock != INVALID_SOCKET ) {
+        (void) epoll_ctl ( pThread->epfd, EPOLL_CTL_DEL, pClient->sock, NULL );
+        /* fail any send by the event task */
+        (void) shutdown ( pClient->sock, SHUT_RDWR );
+    }
+
+    LOCK_CLIENTQ;
+    ellDelete ( &clientQ, &pClient->node );
+    UNLOCK_CLIENTQ;
+
+    epicsAtomicDecrSizeT ( &pThread->nClients );
+
+    epicsMutexMustLock ( reapLock );
+    ellAdd ( &reapList, &pClient->node );
+    epicsMutexUnlock ( reapLock );
+    epicsEventMustTrigger ( reapWakeup );
+}
+
+/*
+ * Wait for the socket to become writable again, to try once more
+ */
+static void muxRetry ( struct rsrv_io_thread *pThread )
+{
+    epicsTimeStamp now;
+    struct client *pClient;
+
+    epicsTimeGetCurrent ( &now );
+    if ( epicsTimeDiffInSeconds ( &now, &pThread->retryTime ) <
+            RSRV_MUX_RETRY_DELAY ) {
+        return;
+    }
+
+    while ( ( pClient = pThread->retryList ) ) {
+        pThread->retryList = pClient->nextRetry;
+        SEND_LOCK ( pClient );
+        pClient->sendRetry = FALSE;
+        rsrvMuxSendBlocked ( pClient, TRUE );
+        SEND_UNLOCK ( pClient );
+    }
+}
+
+static void muxThread ( void *pParm )
+{
+    struct rsrv_io_thread *pThread = pParm;
+    struct epoll_event events[RSRV_MUX_MAX_EVENTS];
+
+    epicsSignalInstallSigPipeIgnore ();
+    taskwdInsert ( epicsThreadGetIdSelf (), NULL, NULL );
+
+    while ( TRUE ) {
+        int i, nevents;
+
+        nevents = epoll_wait ( pThread->epfd, events, RSRV_MUX_MAX_EVENTS,
+            pThread->retryList ? (int) ( RSRV_MUX_RETRY_DELAY * 1000 ) : -1 );
+        if ( pThread->retryList ) {
+            muxRetry ( pThread );
+        }
+        if ( nevents < 0 ) {
+            if ( errno != EINTR ) {
+                char sockErrBuf[64];
+                epicsSocketConvertErrnoToString (
+                    sockErrBuf, sizeof ( sockErrBuf ) );
+                errlogPrintf ( "CAS: epoll_wait " ERL_ERROR ": %s\n",
+                    sockErrBuf );
+                epicsThreadSleep ( 1.0 );
+            }
+            continue;
+        }
+
+        for ( i = 0; i < nevents; i++ ) {
+            struct client *pClient = events[i].data.ptr;
+            int ok = castcp_ctl == ctlRun && ! pClient->disconnect;
+
+            epicsThreadPrivateSet ( rsrvCurrentClient, pClient );
+
+            if ( ok && ( events[i].events & EPOLLOUT ) ) {
+                /* re-enables input once the send buffer drains, then
+                 * the requests left unprocessed are taken up again */
+                if ( cas_try_send_bs_msg ( pClient ) &&
+                        pClient->recv.cnt ) {
+                    ok = casProcessInput ( pClient ) == RSRV_OK;
+                    if ( ok && ! casRecvPending ( pClient ) ) {
+                        cas_try_send_bs_msg ( pClient );
+                    }
+                }
+            }
+
+            if ( ok && ( events[i].events & ( EPOLLIN | EPOLLERR | EPOLLHUP ) ) ) {
+                ok = casRecvAndProcess ( pClient ) == RSRV_OK;
+
+                /*
+                 * allow replies to batch up if more requests are coming
+                 */
+                if ( ok && ! casRecvPending ( pClient ) ) {
+                    cas_try_send_bs_msg ( pClient );
+                }
+            }
+
+            epicsThreadPrivateSet ( rsrvCurrentClient, NULL );
+
+            if ( ! ok || pClient->disconnect ) {
+                muxClose ( pClient );
+            }
+        }
+    }
+}
+
+unsigned rsrvMuxInit ( unsigned nThreads )
+{
+    unsigned i;
+
+    if ( nThreads == 0u || ioThreads ) {
+        return nIoThreads;
+    }
+
+    ioThreads = calloc ( nThreads, sizeof ( *ioThreads ) );
+    if ( ! ioThreads ) {
+        return 0u;
+    }
+
+    reapLock = epicsMutexMustCreate ();
+    reapWakeup = epicsEventMustCreate ( epicsEventEmpty );
+    epicsThreadMustCreate ( "CAS-reaper", threadPrios[0],
+        epicsThreadGetStackSize ( epicsThreadStackBig ),
+        muxReaper, NULL );
+
+    for ( i = 0u; i < nThreads; i++ ) {
+        char name[32];
+
+        ioThreads[i].epfd = epoll_create1 ( EPOLL_CLOEXEC );
+        if ( ioThreads[i].epfd < 0 ) {
+            char sockErrBuf[64];
+            epicsSocketConvertErrnoToString (
+                sockErrBuf, sizeof ( sockErrBuf ) );
+            errlogPrintf ( "CAS: epoll_create " ERL_ERROR ": %s\n",
+                sockErrBuf );
+            break;
+        }
+
+        epicsSnprintf ( name, sizeof ( name ), "CAS-io%u", i );
+        ioThreads[i].tid = epicsThreadCreate ( name, threadPrios[0],
+            epicsThreadGetStackSize ( epicsThreadStackBig ),
+            muxThread, &ioThreads[i] );
+        if ( ! ioThreads[i].tid ) {
+            close ( ioThreads[i].epfd );
+            errlogPrintf ( "CAS: unable to start I/O thread\n" );
+            break;
+        }
+    }
+
+    if ( i == 0u ) {
+        free ( ioThreads );
+        ioThreads = NULL;
+    }
+    nIoThreads = i;
+    return nIoThreads;
+}
+
+int rsrvMuxAddClient ( struct client *pClient )
+{
+    struct rsrv_io_thread *pThread;
+    int flags;
+
+    if ( ! nIoThreads ) {
+        return RSRV_ERROR;
+    }
+
+    flags = fcntl ( pClient->sock, F_GETFL, 0 );
+    if ( flags < 0 ||
+        fcntl ( pClient->sock, F_SETFL, flags | O_NONBLOCK ) < 0 ) {
+        errlogPrintf ( "CAS: unable to make client socket non-blocking\n" );
+        return RSRV_ERROR;
+    }
+
+    pThread = &ioThreads[
+        epicsAtomicIncrSizeT ( &nextIoThread ) % nIoThreads];
+    pClient->ioThread = pThread;
+    pClient->sendBlocked = FALSE;
+    pClient->sendRetry = FALSE;
+    epicsAtomicIncrSizeT ( &pThread->nClients );
+
+    /* version reply queued by create_tcp_client() is sent on first input */
+    if ( muxSetEvents ( pClient, EPOLL_CTL_ADD, EPOLLIN ) ) {
+        char sockErrBuf[64];
+        epicsSocketConvertErrnoToString (
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAS: epoll_ctl " ERL_ERROR ": %s\n",
+            sockErrBuf );
+        epicsAtomicDecrSizeT ( &pThread->nClients );
+        pClient->ioThread = NULL;
+        return RSRV_ERROR;
+    }
+    return RSRV_OK;
+}
+
+int rsrvMuxOnIoThread ( struct client *pClient )
+{
+    return pClient->ioThread &&
+        pClient->ioThread->tid == epicsThreadGetIdSelf ();
+}
+
+/*
+ * SEND_LOCK() must be held
+ */
+void rsrvMuxSendBlocked ( struct client *pClient, int blocked )
+{
+    pClient->sendBlocked = blocked;
+    /* failure means the I/O thread has already removed this circuit */
+    (void) muxSetEvents ( pClient, EPOLL_CTL_MOD,
+        blocked ? EPOLLOUT : EPOLLIN );
+}
+
+/*
+ * Called by the I/O thread with SEND_LOCK() held when a send or receive
+ * ran out of network buffers.  Unsent bytes are kept, and the circuit
+ * neither sends nor receives until it is retried, cf. muxRetry().
+ */
+void rsrvMuxRetry ( struct client *pClient )
+{
+    struct rsrv_io_thread *pThread = pClient->ioThread;
+
+    if ( pClient->sendRetry ) {
+        return;
+    }
+    errlogPrintf ( "CAS: Out of network buffers, retrying in %g seconds\n",
+        RSRV_MUX_RETRY_DELAY );
+    if ( ! pThread->retryList ) {
+        epicsTimeGetCurrent ( &pThread->retryTime );
+    }
+    pClient->sendRetry = TRUE;
+    pClient->sendBlocked = TRUE;
+    pClient->nextRetry = pThread->retryList;
+    pThread->retryList = pClient;
+    (void) muxSetEvents ( pClient, EPOLL_CTL_MOD, 0u );
+}
+
+/*
+ * Called by a thread other than the I/O thread, with SEND_LOCK() held,
+ * when a send would block.  The lock is released while waiting.
+ * Returns false if the caller should give up on this client.
+ */
+int rsrvMuxWaitWritable ( struct client *pClient )
+{
+    int writable = FALSE;
+
+    SEND_UNLOCK ( pClient );
+    while ( ! pClient->disconnect ) {
+        struct pollfd pfd;
+        int status;
+
+        pfd.fd = pClient->sock;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+
+        status = poll ( &pfd, 1, 1000 );
+        if ( status > 0 ) {
+            writable = TRUE;
+            break;
+        }
+        else if ( status < 0 && errno != EINTR ) {
+            break;
+        }
+    }
+    SEND_LOCK ( pClient );
+    return writable;
+}
+
+void rsrvMuxShow ( unsigned level )
+{
+    unsigned i;
+
+    if ( ! nIoThreads ) {
+        return;
+    }
+
+    printf ( "%u I/O thread%s serving TCP circuits\n",
+        nIoThreads, nIoThreads == 1 ? "" : "s" );
+    if ( level >= 2u ) {
+        for ( i = 0u; i < nIoThreads; i++ ) {
+            printf ( "    I/O thread %u: %u circuit(s)\n", i,
+                (unsigned) epicsAtomicGetSizeT ( &ioThreads[i].nClients ) );
+        }
+    }
+}
+
+#else /* __linux__ */
+
+unsigned rsrvMuxInit ( unsigned nThreads )
+{
+    if ( nThreads ) {
+        errlogPrintf ( "CAS: EPICS_CAS_IO_THREADS is not supported on "
+            "this target, using a thread per client\n" );
+    }
+    return 0u;
+}
+
+int rsrvMuxAddClient ( struct client *pClient )
+{
+    return RSRV_ERROR;
+}
+
+int rsrvMuxOnIoThread ( struct client *pClient )
+{
+    return FALSE;
+}
+
+void rsrvMuxSendBlocked ( struct client *pClient, int blocked )
+{
+    pClient->sendBlocked = blocked;
+}
+
+void rsrvMuxRetry ( struct client *pClient ) {}
+
+int rsrvMuxWaitWritable ( struct client *pClient )
+{
+    return FALSE;
+}
+
+void rsrvMuxShow ( unsigned level ) {}
+
+#endif /* __linux__ */
@@ -22,6 +22,7 @@
 #include <limits.h>
 
 #include "dbDefs.h"
+#include "epicsAtomic.h"
 #include "epicsSignal.h"
 #include "epicsTime.h"
 #include "errlog.h"
@@ -32,24 +33,137 @@
 
 #include "server.h"
 
+#if !defined(_WIN32) && !defined(vxWorks)
+#  include <sys/uio.h>
+#  define RSRV_USE_SENDMSG
+#endif
+
+#ifdef __linux__
+#  include <sys/socket.h>
+#endif
+
 /*
- *  cas_send_bs_msg()
+ *  cas_send_pending()
  *
- *  (channel access server send message)
+ *  Bytes waiting to be sent on a TCP circuit
+ */
+unsigned cas_send_pending ( struct client *pclient )
+{
+    return pclient->sendQueueBytes + pclient->send.stk - pclient->send.cnt;
+}
+
+/*
+ *  cas_send_discard()
  *
+ *  Drop everything waiting to be sent.  SEND_LOCK() must be held.
+ */
+void cas_send_discard ( struct client *pclient )
+{
+    while ( pclient->sendQueue ) {
+        struct send_segment *pseg = pclient->sendQueue;
+        pclient->sendQueue = pseg->next;
+        casFreeBuffer ( &pseg->buf );
+        free ( pseg );
+    }
+    pclient->sendQueueCount = 0u;
+    pclient->sendQueueBytes = 0u;
+    pclient->send.stk = 0u;
+    pclient->send.cnt = 0u;
+}
+
+/*
+ *  send_segments()
  *
- * Set lock_needed=1 unless SEND_LOCK() is held by caller
+ *  Send as much as possible of the queued blocks followed by send.buf
  */
-void cas_send_bs_msg ( struct client *pclient, int lock_needed )
+static int send_segments ( struct client *pclient )
 {
-    int status;
+#ifdef RSRV_USE_SENDMSG
+    struct iovec iov[RSRV_MAX_SEND_SEGMENTS + 1u];
+    struct send_segment *pseg = pclient->sendQueue;
+    struct msghdr msg;
+    unsigned n = 0u;
+
+    for ( ; pseg && n < RSRV_MAX_SEND_SEGMENTS; pseg = pseg->next ) {
+        iov[n].iov_base = pseg->buf.buf + pseg->buf.cnt;
+        iov[n].iov_len = pseg->buf.stk - pseg->buf.cnt;
+        n++;
+    }
+    if ( ! pseg && pclient->send.stk > pclient->send.cnt ) {
+        iov[n].iov_base = pclient->send.buf + pclient->send.cnt;
+        iov[n].iov_len = pclient->send.stk - pclient->send.cnt;
+        n++;
+    }
 
-    if ( lock_needed ) {
-        SEND_LOCK ( pclient );
+    memset ( &msg, 0, sizeof ( msg ) );
+    msg.msg_iov = iov;
+    msg.msg_iovlen = n;
+    return sendmsg ( pclient->sock, &msg, 0 );
+#else
+    /* one block at a time */
+    struct message_buffer *pbuf = pclient->sendQueue ?
+        &pclient->sendQueue->buf : &pclient->send;
+
+    return send ( pclient->sock, pbuf->buf + pbuf->cnt,
+        pbuf->stk - pbuf->cnt, 0 );
+#endif
+}
+
+/*
+ *  send_advance()
+ *
+ *  Account for nbytes sent, releasing blocks which are done with.
+ */
+static void send_advance ( struct client *pclient, unsigned nbytes )
+{
+    while ( pclient->sendQueue ) {
+        struct send_segment *pseg = pclient->sendQueue;
+        unsigned left = pseg->buf.stk - pseg->buf.cnt;
+
+        if ( nbytes < left ) {
+            pseg->buf.cnt += nbytes;
+            pclient->sendQueueBytes -= nbytes;
+            return;
+        }
+        nbytes -= left;
+        pclient->sendQueueBytes -= left;
+        pclient->sendQueue = pseg->next;
+        pclient->sendQueueCount--;
+        casFreeBuffer ( &pseg->buf );
+        free ( pseg );
     }
 
-    if ( CASDEBUG > 2 && pclient->send.stk ) {
-        errlogPrintf ( "CAS: Sending a message of %d bytes\n", pclient->send.stk );
+    pclient->send.cnt += nbytes;
+    if ( pclient->send.cnt >= pclient->send.stk ) {
+        pclient->send.stk = 0u;
+        pclient->send.cnt = 0u;
+
+        /* don't hold on to a jumbo buffer once it has been sent */
+        if ( pclient->send.type == mbtLargeTCP ) {
+            struct message_buffer small;
+            if ( ! casAllocBuffer ( &small, 0u ) ) {
+                casFreeBuffer ( &pclient->send );
+                pclient->send = small;
+            }
+        }
+    }
+}
+
+/*
+ *  send_bs_msg()
+ *
+ *  SEND_LOCK() must be held.  With a multiplexed circuit, if the socket
+ *  is not writable either wait for it (mayWait=1) or leave the remaining
+ *  bytes to be sent when the I/O thread sees it become writable.  The
+ *  I/O thread itself never waits.
+ */
+static void send_bs_msg ( struct client *pclient, int mayWait )
+{
+    int status;
+
+    if ( CASDEBUG > 2 && cas_send_pending ( pclient ) ) {
+        errlogPrintf ( "CAS: Sending a message of %u bytes\n",
+            cas_send_pending ( pclient ) );
     }
 
     if ( pclient->disconnect ) {
@@ -57,27 +171,18 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
             errlogPrintf ( "CAS: msg Discard for sock %d addr %x\n",
                 (int)pclient->sock, (unsigned) pclient->addr.sin_addr.s_addr );
         }
-        pclient->send.stk = 0u;
-        if(lock_needed)
-            SEND_UNLOCK(pclient);
+        cas_send_discard ( pclient );
         return;
     }
 
-    while ( pclient->send.stk && ! pclient->disconnect ) {
-        status = send ( pclient->sock, pclient->send.buf, pclient->send.stk, 0 );
+    while ( cas_send_pending ( pclient ) && ! pclient->disconnect ) {
+        status = send_segments ( pclient );
         if ( status >= 0 ) {
-            unsigned transferSize = (unsigned) status;
-            if ( transferSize >= pclient->send.stk ) {
-                pclient->send.stk = 0;
+            send_advance ( pclient, (unsigned) status );
+            if ( ! cas_send_pending ( pclient ) ) {
                 epicsTimeGetCurrent ( &pclient->time_at_last_send );
                 break;
             }
-            else {
-                unsigned bytesLeft = pclient->send.stk - transferSize;
-                memmove ( pclient->send.buf, &pclient->send.buf[transferSize],
-                    bytesLeft );
-                pclient->send.stk = bytesLeft;
-            }
         }
         else {
             int causeWasSocketHangup = 0;
@@ -85,7 +190,7 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
             char buf[64];
 
             if ( pclient->disconnect ) {
-                pclient->send.stk = 0u;
+                cas_send_discard ( pclient );
                 break;
             }
 
@@ -94,12 +199,35 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
             }
 
             if ( anerrno == SOCK_ENOBUFS ) {
+                if ( rsrvMuxOnIoThread ( pclient ) ) {
+                    rsrvMuxRetry ( pclient );
+                    break;
+                }
                 errlogPrintf (
                     "CAS: Out of network buffers, retrying send in 15 seconds\n" );
-                epicsThreadSleep ( 15.0 );
+                if ( pclient->ioThread ) {
+                    /* let the I/O thread serve this circuit meanwhile */
+                    SEND_UNLOCK ( pclient );
+                    epicsThreadSleep ( 15.0 );
+                    SEND_LOCK ( pclient );
+                }
+                else {
+                    epicsThreadSleep ( 15.0 );
+                }
                 continue;
             }
 
+            /* only multiplexed circuits use non-blocking sockets */
+            if ( anerrno == SOCK_EWOULDBLOCK ) {
+                if ( ! mayWait || rsrvMuxOnIoThread ( pclient ) ) {
+                    break;
+                }
+                if ( rsrvMuxWaitWritable ( pclient ) ) {
+                    continue;
+                }
+                anerrno = SOCK_ETIMEDOUT;
+            }
+
             ipAddrToDottedIP ( &pclient->addr, buf, sizeof(buf) );
 
             if (
@@ -117,7 +245,7 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
                     buf, sockErrBuf);
             }
             pclient->disconnect = TRUE;
-            pclient->send.stk = 0u;
+            cas_send_discard ( pclient );
 
             /*
              * wakeup the receive thread
@@ -155,19 +283,173 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
         }
     }
 
+    /*
+     * only the I/O thread re-enables input, it first takes up the
+     * requests left unprocessed, cf. camessage()
+     */
+    if ( pclient->ioThread && ! pclient->disconnect && ! pclient->sendRetry ) {
+        int blocked = cas_send_pending ( pclient ) != 0u;
+        if ( blocked != pclient->sendBlocked &&
+                ( blocked || rsrvMuxOnIoThread ( pclient ) ) ) {
+            rsrvMuxSendBlocked ( pclient, blocked );
+        }
+    }
+
+    DLOG ( 3, ( "------------------------------\n\n" ) );
+}
+
+/*
+ *  cas_send_bs_msg()
+ *
+ *  (channel access server send message)
+ *
+ *
+ * Set lock_needed=1 unless SEND_LOCK() is held by caller
+ */
+void cas_send_bs_msg ( struct client *pclient, int lock_needed )
+{
+    if ( lock_needed ) {
+        SEND_LOCK ( pclient );
+    }
+
+    send_bs_msg ( pclient, TRUE );
+
     if ( lock_needed ) {
         SEND_UNLOCK(pclient);
     }
+}
 
-    DLOG ( 3, ( "------------------------------\n\n" ) );
+/*
+ *  cas_try_send_bs_msg()
+ *
+ *  Send as much as the socket will accept without waiting.
+ *  Returns true if nothing remains to be sent.
+ */
+int cas_try_send_bs_msg ( struct client *pclient )
+{
+    int done;
 
-    return;
+    SEND_LOCK ( pclient );
+    send_bs_msg ( pclient, FALSE );
+    done = cas_send_pending ( pclient ) == 0u;
+    SEND_UNLOCK ( pclient );
+
+    return done;
+}
+
+/*
+ *  cas_send_backlog()
+ *
+ *  True if the I/O thread should stop processing the requests of
+ *  a multiplexed circuit until its replies can be sent.  A full send
+ *  queue is first sent as far as the socket will accept.
+ */
+int cas_send_backlog ( struct client *pclient )
+{
+    int backlog;
+
+    if ( ! pclient->ioThread ) {
+        return FALSE;
+    }
+
+    SEND_LOCK ( pclient );
+    if ( ! pclient->sendBlocked &&
+            pclient->sendQueueCount >= RSRV_MAX_SEND_SEGMENTS ) {
+        send_bs_msg ( pclient, FALSE );
+    }
+    backlog = pclient->sendBlocked;
+    SEND_UNLOCK ( pclient );
+
+    return backlog;
+}
+
+/*
+ *  dg_send_status()
+ *
+ *  Check the result of sending one reply datagram
+ */
+static void dg_send_status ( struct client * pclient,
+    const struct sockaddr_in * pAddr, int status, int sizeDG )
+{
+    if ( status >= 0 ) {
+        if ( status >= sizeDG ) {
+            epicsTimeGetCurrent ( &pclient->time_at_last_send );
+        }
+        else {
+            errlogPrintf (
+                "CAS: System failed to send entire udp frame?\n" );
+        }
+    }
+    else {
+        char sockErrBuf[64];
+        char buf[128];
+        epicsSocketConvertErrnoToString (
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        ipAddrToDottedIP ( pAddr, buf, sizeof(buf) );
+        errlogPrintf( "CAS: UDP send to %s failed: %s\n",
+            buf, sockErrBuf);
+    }
+}
+
+/*
+ *  cas_send_dg_batch()
+ *
+ *  Send the queued reply datagrams with as few sendmmsg() calls as
+ *  possible. A reply which can not be sent is reported and dropped.
+ */
+void cas_send_dg_batch ( struct client * pclient )
+{
+#ifdef __linux__
+    struct rsrv_dg_batch * pBatch = pclient->dgBatch;
+    struct mmsghdr msgs[RSRV_UDP_BATCH];
+    struct iovec iov[RSRV_UDP_BATCH];
+    unsigned i, next = 0u;
+
+    if ( ! pBatch || pBatch->nReplies == 0u ) {
+        return;
+    }
+
+    memset ( msgs, 0, sizeof ( msgs[0] ) * pBatch->nReplies );
+    for ( i = 0u; i < pBatch->nReplies; i++ ) {
+        iov[i].iov_base = pBatch->replyBuf[i];
+        iov[i].iov_len = pBatch->replySize[i];
+        msgs[i].msg_hdr.msg_name = &pBatch->replyAddr[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof ( pBatch->replyAddr[i] );
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    while ( next < pBatch->nReplies ) {
+        int status = sendmmsg ( pclient->sock, &msgs[next],
+            pBatch->nReplies - next, 0 );
+        if ( status > 0 ) {
+            epicsAtomicIncrSizeT ( &rsrvUdpSendCalls );
+            epicsAtomicAddSizeT ( &rsrvUdpSendDatagrams, (size_t) status );
+            for ( i = next; i < next + (unsigned) status; i++ ) {
+                dg_send_status ( pclient, &pBatch->replyAddr[i],
+                    (int) msgs[i].msg_len, (int) pBatch->replySize[i] );
+            }
+            next += (unsigned) status;
+        }
+        else {
+            /* the first reply of the remainder failed */
+            dg_send_status ( pclient, &pBatch->replyAddr[next],
+                -1, (int) pBatch->replySize[next] );
+            next++;
+        }
+    }
+
+    pBatch->nReplies = 0u;
+#endif
 }
 
 /*
  *  cas_send_dg_msg()
  *
  *  (channel access server send udp message)
+ *
+ *  When the client has a datagram batch the reply is queued there,
+ *  and sent by cas_send_dg_batch().
  */
 void cas_send_dg_msg ( struct client * pclient )
 {
@@ -200,25 +482,27 @@ void cas_send_dg_msg ( struct client * pclient )
         sizeDG -= sizeof (caHdr);
     }
 
-    status = sendto ( pclient->sock, pDG, sizeDG, 0,
-       (struct sockaddr *)&pclient->addr, sizeof(pclient->addr) );
-    if ( status >= 0 ) {
-        if ( status >= sizeDG ) {
-            epicsTimeGetCurrent ( &pclient->time_at_last_send );
-        }
-        else {
-            errlogPrintf (
-                "CAS: System failed to send entire udp frame?\n" );
+    if ( pclient->dgBatch ) {
+        struct rsrv_dg_batch * pBatch = pclient->dgBatch;
+        unsigned n = pBatch->nReplies;
+
+        assert ( sizeDG <= MAX_UDP_SEND );
+        memcpy ( pBatch->replyBuf[n], pDG, sizeDG );
+        pBatch->replyAddr[n] = pclient->addr;
+        pBatch->replySize[n] = (unsigned) sizeDG;
+        pBatch->nReplies = n + 1u;
+        if ( pBatch->nReplies >= RSRV_UDP_BATCH ) {
+            cas_send_dg_batch ( pclient );
         }
     }
     else {
-        char sockErrBuf[64];
-        char buf[128];
-        epicsSocketConvertErrnoToString (
-            sockErrBuf, sizeof ( sockErrBuf ) );
-        ipAddrToDottedIP ( &pclient->addr, buf, sizeof(buf) );
-        errlogPrintf( "CAS: UDP send to %s failed: %s\n",
-            buf, sockErrBuf);
+        status = sendto ( pclient->sock, pDG, sizeDG, 0,
+           (struct sockaddr *)&pclient->addr, sizeof(pclient->addr) );
+        if ( status >= 0 ) {
+            epicsAtomicIncrSizeT ( &rsrvUdpSendCalls );
+            epicsAtomicIncrSizeT ( &rsrvUdpSendDatagrams );
+        }
+        dg_send_status ( pclient, &pclient->addr, status, sizeDG );
     }
 
     pclient->send.stk = 0u;
@@ -235,6 +519,91 @@ void cas_send_dg_msg ( struct client * pclient )
     return;
 }
 
+/*
+ *  cas_new_send_block()
+ *
+ *  Make room for a message of msgSize bytes on a TCP circuit.  The current
+ *  block is queued to be sent along with the next one, so replies are
+ *  never moved and only a message too large for a small block needs a
+ *  jumbo buffer.  The sender waits for the socket if enough is queued,
+ *  except for an I/O thread, which instead stops processing requests
+ *  from the circuit, cf. cas_send_backlog().  So the queue is bounded by
+ *  the replies to one request beyond RSRV_MAX_SEND_SEGMENTS.
+ *
+ *  SEND_LOCK() must be held
+ */
+static int cas_new_send_block ( struct client *pclient, unsigned msgSize )
+{
+    struct message_buffer newbuf;
+    struct send_segment *pseg = NULL;
+
+    if ( pclient->disconnect ) {
+        cas_send_discard ( pclient );
+    }
+    else if ( pclient->sendQueueCount >= RSRV_MAX_SEND_SEGMENTS ||
+            pclient->send.type == mbtLargeTCP ) {
+        send_bs_msg ( pclient, TRUE );
+    }
+
+    if ( pclient->send.stk == pclient->send.cnt ) {
+        /* current block is empty */
+        pclient->send.stk = 0u;
+        pclient->send.cnt = 0u;
+        if ( msgSize <= pclient->send.maxstk ) {
+            return ECA_NORMAL;
+        }
+        if ( casAllocBuffer ( &newbuf, msgSize ) ) {
+            return ECA_TOLARGE;
+        }
+        casFreeBuffer ( &pclient->send );
+        pclient->send = newbuf;
+        return ECA_NORMAL;
+    }
+
+    if ( casAllocBuffer ( &newbuf, msgSize ) ||
+            ! ( pseg = malloc ( sizeof ( *pseg ) ) ) ) {
+        /* no memory, fall back to sending and reusing the current block */
+        casFreeBuffer ( &newbuf );
+        if ( msgSize > pclient->send.maxstk ) {
+            return ECA_TOLARGE;
+        }
+        send_bs_msg ( pclient, TRUE );
+        if ( pclient->send.stk != pclient->send.cnt ) {
+            /* an I/O thread can't wait for it to be sent, and replies
+             * must not be lost, so the circuit is closed */
+            if ( ! pclient->disconnect ) {
+                char buf[64];
+                ipAddrToDottedIP ( &pclient->addr, buf, sizeof(buf) );
+                errlogPrintf ( "CAS: Out of memory for replies to %s, "
+                    "disconnecting\n", buf );
+                pclient->disconnect = TRUE;
+            }
+            cas_send_discard ( pclient );
+            return ECA_ALLOCMEM;
+        }
+        pclient->send.stk = 0u;
+        pclient->send.cnt = 0u;
+        return ECA_NORMAL;
+    }
+
+    pseg->next = NULL;
+    pseg->buf = pclient->send;
+    if ( pclient->sendQueue ) {
+        struct send_segment *plast = pclient->sendQueue;
+        while ( plast->next ) {
+            plast = plast->next;
+        }
+        plast->next = pseg;
+    }
+    else {
+        pclient->sendQueue = pseg;
+    }
+    pclient->sendQueueCount++;
+    pclient->sendQueueBytes += pseg->buf.stk - pseg->buf.cnt;
+    pclient->send = newbuf;
+    return ECA_NORMAL;
+}
+
 /*
  *
  *  cas_copy_in_header()
@@ -270,29 +639,30 @@ int cas_copy_in_header (
         msgSize += 2 * sizeof ( ca_uint32_t );
     }
 
-    if ( msgSize > pclient->send.maxstk ) {
-        casExpandSendBuffer ( pclient, msgSize );
-        if ( msgSize > pclient->send.maxstk ) {
-            return ECA_TOLARGE;
+    if ( pclient->proto == IPPROTO_TCP ) {
+        if ( msgSize > pclient->send.maxstk - pclient->send.stk ) {
+            int status = cas_new_send_block ( pclient, msgSize );
+            if ( status != ECA_NORMAL ) {
+                return status;
+            }
         }
     }
-
-    if ( pclient->send.stk > pclient->send.maxstk - msgSize ) {
-        if ( pclient->disconnect ) {
-            pclient->send.stk = 0;
+    else if ( pclient->proto == IPPROTO_UDP ) {
+        if ( msgSize > pclient->send.maxstk ) {
+            return ECA_TOLARGE;
         }
-        else{
-            if ( pclient->proto == IPPROTO_TCP) {
-                cas_send_bs_msg ( pclient, FALSE );
-            }
-            else if ( pclient->proto == IPPROTO_UDP ) {
-                cas_send_dg_msg ( pclient );
+        if ( pclient->send.stk > pclient->send.maxstk - msgSize ) {
+            if ( pclient->disconnect ) {
+                pclient->send.stk = 0;
             }
             else {
-                return ECA_INTERNAL;
+                cas_send_dg_msg ( pclient );
             }
         }
     }
+    else {
+        return ECA_INTERNAL;
+    }
 
     pMsg = (caHdr *) &pclient->send.buf[pclient->send.stk];
     pMsg->m_cmmd = htons(response);
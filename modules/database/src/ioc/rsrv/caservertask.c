@@ -23,6 +23,7 @@
 #include <errno.h>
 
 #include "addrList.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsSignal.h"
@@ -106,6 +107,17 @@ static void req_server (void *pParm)
             ellAdd ( &clientQ, &pClient->node );
             UNLOCK_CLIENTQ;
 
+            if ( rsrvIoThreads ) {
+                if ( rsrvMuxAddClient ( pClient ) != RSRV_OK ) {
+                    LOCK_CLIENTQ;
+                    ellDelete ( &clientQ, &pClient->node );
+                    UNLOCK_CLIENTQ;
+                    destroy_tcp_client ( pClient );
+                    epicsThreadSleep ( 15.0 );
+                }
+                continue;
+            }
+
             id = epicsThreadCreate ( "CAS-client", epicsThreadPriorityCAServerLow,
                     epicsThreadGetStackSize ( epicsThreadStackBig ),
                     camsgtask, pClient );
@@ -475,10 +487,13 @@ void rsrv_init (void)
     clientQlock = epicsMutexMustCreate();
 
     freeListInitPvt ( &rsrvClientFreeList, sizeof(struct client), 8 );
-    freeListInitPvt ( &rsrvChanFreeList, sizeof(struct channel_in_use), 512 );
-    freeListInitPvt ( &rsrvEventFreeList, sizeof(struct event_ext), 512 );
+    freeListInitFlags ( &rsrvChanFreeList, sizeof(struct channel_in_use),
+        512, FREELIST_THREAD_CACHE );
+    freeListInitFlags ( &rsrvEventFreeList, sizeof(struct event_ext),
+        512, FREELIST_THREAD_CACHE );
     freeListInitPvt ( &rsrvSmallBufFreeListTCP, MAX_TCP, 16 );
     initializePutNotifyFreeList ();
+    rsrvMonCacheInit ();
 
     epicsSignalInstallSigPipeIgnore ();
 
@@ -503,6 +518,18 @@ void rsrv_init (void)
             (unsigned short) CA_REPEATER_PORT );
     }
 
+    if ( envGetConfigParamPtr ( &EPICS_CAS_IO_THREADS ) ) {
+        long nThreads;
+
+        status = envGetLongConfigParam ( &EPICS_CAS_IO_THREADS, &nThreads );
+        if ( status || nThreads < 0 ) {
+            errlogPrintf ( "CAS: EPICS_CAS_IO_THREADS was not a positive integer\n" );
+        }
+        else {
+            rsrvIoThreads = rsrvMuxInit ( (unsigned) nThreads );
+        }
+    }
+
     status =  envGetLongConfigParam ( &EPICS_CA_MAX_ARRAY_BYTES, &maxBytesAsALong );
     if ( status || maxBytesAsALong < 0 ) {
         errlogPrintf ( "CAS: EPICS_CA_MAX_ARRAY_BYTES was not a positive integer\n" );
@@ -862,7 +889,7 @@ static void log_one_client (struct client *client, unsigned level)
         printf(
         "\tUnprocessed request bytes = %u, Undelivered response bytes = %u\n",
             client->recv.cnt - client->recv.stk,
-            client->send.stk );
+            cas_send_pending ( client ) );
         printf(
         "\tState = %s%s%s\n",
             state[client->disconnect?1:0],
@@ -964,6 +991,18 @@ void casr (unsigned level)
 
             iface = (rsrv_iface_config *) ellNext(&iface->node);
         }
+
+        rsrvMuxShow(level);
+
+        printf("Monitor update cache: %lu hits, %lu misses\n",
+            (unsigned long) epicsAtomicGetSizeT(&rsrvMonCacheHits),
+            (unsigned long) epicsAtomicGetSizeT(&rsrvMonCacheMisses));
+        printf("Name server: %lu datagrams received by %lu calls, "
+            "%lu sent by %lu calls\n",
+            (unsigned long) epicsAtomicGetSizeT(&rsrvUdpRecvDatagrams),
+            (unsigned long) epicsAtomicGetSizeT(&rsrvUdpRecvCalls),
+            (unsigned long) epicsAtomicGetSizeT(&rsrvUdpSendDatagrams),
+            (unsigned long) epicsAtomicGetSizeT(&rsrvUdpSendCalls));
     }
 
     if (level>=1) {
@@ -1064,36 +1103,9 @@ void destroy_client ( struct client *client )
     }
 
     if ( client->proto == IPPROTO_TCP ) {
-        if ( client->send.buf ) {
-            if ( client->send.type == mbtSmallTCP ) {
-                freeListFree ( rsrvSmallBufFreeListTCP,  client->send.buf );
-            }
-            else if ( client->send.type == mbtLargeTCP ) {
-                if(rsrvLargeBufFreeListTCP)
-                    freeListFree ( rsrvLargeBufFreeListTCP,  client->send.buf );
-                else
-                    free(client->send.buf);
-            }
-            else {
-                errlogPrintf ( "CAS: Corrupt send buffer free list type code=%u during client cleanup?\n",
-                    client->send.type );
-            }
-        }
-        if ( client->recv.buf ) {
-            if ( client->recv.type == mbtSmallTCP ) {
-                freeListFree ( rsrvSmallBufFreeListTCP,  client->recv.buf );
-            }
-            else if ( client->recv.type == mbtLargeTCP ) {
-                if(rsrvLargeBufFreeListTCP)
-                    freeListFree ( rsrvLargeBufFreeListTCP,  client->recv.buf );
-                else
-                    free(client->recv.buf);
-            }
-            else {
-                errlogPrintf ( "CAS: Corrupt recv buffer free list type code=%u during client cleanup?\n",
-                    client->send.type );
-            }
-        }
+        cas_send_discard ( client );
+        casFreeBuffer ( &client->send );
+        casFreeBuffer ( &client->recv );
     }
     else if ( client->proto == IPPROTO_UDP ) {
         if ( client->send.buf ) {
@@ -1102,6 +1114,7 @@ void destroy_client ( struct client *client )
         if ( client->recv.buf ) {
             free ( client->recv.buf );
         }
+        rsrvDgBatchDestroy ( client->dgBatch );
     }
 
     if ( client->eventqLock ) {
@@ -1319,7 +1332,7 @@ void casAttachThreadToClient ( struct client *pClient )
 }
 
 static
-void casExpandBuffer ( struct message_buffer *buf, ca_uint32_t size, int sendbuf )
+void casExpandBuffer ( struct message_buffer *buf, ca_uint32_t size )
 {
     char *newbuf = NULL;
     unsigned newsize;
@@ -1354,27 +1367,16 @@ void casExpandBuffer ( struct message_buffer *buf, ca_uint32_t size, int sendbuf
     }
 
     if (newbuf) {
-        /* copy existing buffer */
-        if (sendbuf) {
-            /* send buffer uses [0, stk) */
-            if (!rsrvLargeBufFreeListTCP && buf->type==mbtLargeTCP) {
-                /* realloc already copied */
-            } else {
-                memcpy ( newbuf, buf->buf, buf->stk );
-            }
-        } else {
-            /* recv buffer uses [stk, cnt) */
-            unsigned used;
-            assert ( buf->cnt >= buf->stk );
-            used = buf->cnt - buf->stk;
-
-            /* buf->buf may be the same as newbuf if realloc() used */
-            memmove ( newbuf, &buf->buf[buf->stk], used );
+        /* copy existing buffer, recv buffer uses [stk, cnt) */
+        unsigned used;
+        assert ( buf->cnt >= buf->stk );
+        used = buf->cnt - buf->stk;
 
-            buf->cnt = used;
-            buf->stk = 0;
+        /* buf->buf may be the same as newbuf if realloc() used */
+        memmove ( newbuf, &buf->buf[buf->stk], used );
 
-        }
+        buf->cnt = used;
+        buf->stk = 0;
 
         /* free existing buffer */
         if(buf->type==mbtSmallTCP) {
@@ -1391,14 +1393,65 @@ void casExpandBuffer ( struct message_buffer *buf, ca_uint32_t size, int sendbuf
     }
 }
 
-void casExpandSendBuffer ( struct client *pClient, ca_uint32_t size )
+void casExpandRecvBuffer ( struct client *pClient, ca_uint32_t size )
 {
-    casExpandBuffer (&pClient->send, size, 1);
+    casExpandBuffer (&pClient->recv, size);
 }
 
-void casExpandRecvBuffer ( struct client *pClient, ca_uint32_t size )
+/*
+ * Allocate a TCP buffer able to hold size bytes, small if possible.
+ * Returns non-zero if size is too large or there is no memory.
+ */
+int casAllocBuffer ( struct message_buffer *buf, ca_uint32_t size )
 {
-    casExpandBuffer (&pClient->recv, size, 0);
+    memset ( buf, 0, sizeof ( *buf ) );
+
+    if ( size <= MAX_TCP ) {
+        buf->buf = (char *) freeListMalloc ( rsrvSmallBufFreeListTCP );
+        buf->maxstk = MAX_TCP;
+        buf->type = mbtSmallTCP;
+    }
+    else if ( ! rsrvLargeBufFreeListTCP ) {
+        /* round up to multiple of 4K */
+        size = ( ( size - 1 ) | 0xfff ) + 1;
+        buf->buf = malloc ( size );
+        buf->maxstk = size;
+        buf->type = mbtLargeTCP;
+    }
+    else if ( size <= rsrvSizeofLargeBufTCP ) {
+        buf->buf = (char *) freeListMalloc ( rsrvLargeBufFreeListTCP );
+        buf->maxstk = rsrvSizeofLargeBufTCP;
+        buf->type = mbtLargeTCP;
+    }
+    if ( ! buf->buf ) {
+        buf->maxstk = 0u;
+        return -1;
+    }
+    return 0;
+}
+
+void casFreeBuffer ( struct message_buffer *buf )
+{
+    if ( ! buf->buf ) {
+        return;
+    }
+    if ( buf->type == mbtSmallTCP ) {
+        freeListFree ( rsrvSmallBufFreeListTCP,  buf->buf );
+    }
+    else if ( buf->type == mbtLargeTCP ) {
+        if(rsrvLargeBufFreeListTCP)
+            freeListFree ( rsrvLargeBufFreeListTCP,  buf->buf );
+        else
+            free(buf->buf);
+    }
+    else if ( buf->type == mbtUDP ) {
+        free ( buf->buf );
+    }
+    else {
+        errlogPrintf ( "CAS: Corrupt buffer free list type code=%u during client cleanup?\n",
+            buf->type );
+    }
+    buf->buf = NULL;
 }
 
 /*
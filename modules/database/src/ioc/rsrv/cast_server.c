@@ -39,6 +39,7 @@
 
 #include "dbDefs.h"
 #include "envDefs.h"
+#include "epicsAtomic.h"
 #include "epicsMutex.h"
 #include "epicsTime.h"
 #include "errlog.h"
@@ -46,6 +47,11 @@
 #include "osiSock.h"
 #include "taskwd.h"
 
+#ifdef __linux__
+#  include <sys/mman.h>
+#  include <sys/socket.h>
+#endif
+
 #include "rsrv.h"
 #include "server.h"
 
@@ -107,25 +113,154 @@ static void clean_addrq(struct client *client)
 
 }
 
+/*
+ * cast_message
+ *
+ * process one request datagram which is already in client->recv.buf
+ */
+static void cast_message(struct client *client,
+    const struct sockaddr_in *pAddr, unsigned nBytes)
+{
+    int status;
+    int count=0;
+
+    client->recv.cnt = nBytes;
+    client->recv.stk = 0ul;
+    epicsTimeGetCurrent(&client->time_at_last_recv);
+
+    client->minor_version_number = CA_UKN_MINOR_VERSION;
+    client->seqNoOfReq = 0;
+
+    /*
+     * If we are talking to a new client flush to the old one
+     * in case we are holding UDP messages waiting to
+     * see if the next message is for this same client.
+     */
+    if (client->send.stk>sizeof(caHdr)) {
+        status = memcmp(&client->addr, pAddr, sizeof(*pAddr));
+        if(status){
+            /*
+             * if the address is different
+             */
+            cas_send_dg_msg(client);
+            client->addr = *pAddr;
+        }
+    }
+    else {
+        client->addr = *pAddr;
+    }
+
+    if (CASDEBUG>1) {
+        char    buf[40];
+
+        ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
+        errlogPrintf ("CAS: cast server msg of %d bytes from addr %s\n",
+            client->recv.cnt, buf);
+    }
+
+    if (CASDEBUG>2)
+        count = ellCount (&client->chanList);
+
+    status = camessage ( client );
+    if(status == RSRV_OK){
+        if(client->recv.cnt !=
+            client->recv.stk){
+            char buf[40];
+
+            ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
+
+            epicsPrintf ("CAS: partial (damaged?) UDP msg of %d bytes from %s ?\n",
+                client->recv.cnt - client->recv.stk, buf);
+
+            epicsTimeToStrftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S",
+                &client->time_at_last_recv);
+            epicsPrintf ("CAS: message received at %s\n", buf);
+        }
+    }
+    else if (CASDEBUG>0){
+        char buf[40];
+
+        ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
+
+        epicsPrintf ("CAS: invalid (damaged?) UDP request from %s ?\n", buf);
+
+        epicsTimeToStrftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S",
+            &client->time_at_last_recv);
+        epicsPrintf ("CAS: message received at %s\n", buf);
+    }
+
+    if (CASDEBUG>2) {
+        if ( ellCount (&client->chanList) ) {
+            errlogPrintf ("CAS: Fnd %d name matches (%d tot)\n",
+                ellCount(&client->chanList)-count,
+                ellCount(&client->chanList));
+        }
+    }
+}
+
+#define RSRV_DG_BATCH_RECV_SIZE ( ( RSRV_UDP_BATCH - 1 ) * MAX_UDP_RECV )
+
+/*
+ * The receive slots of a datagram batch are mapped rather than allocated,
+ * so only the pages which requests are actually received into take up
+ * memory.  Returns NULL if batches can't be used.
+ */
+struct rsrv_dg_batch *rsrvDgBatchCreate ( void )
+{
+#ifdef __linux__
+    struct rsrv_dg_batch *pBatch = calloc ( 1, sizeof ( *pBatch ) );
+    void *pRecv;
+
+    if ( ! pBatch ) {
+        return NULL;
+    }
+    pRecv = mmap ( NULL, RSRV_DG_BATCH_RECV_SIZE, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if ( pRecv == MAP_FAILED ) {
+        free ( pBatch );
+        return NULL;
+    }
+    pBatch->recvBuf = pRecv;
+    return pBatch;
+#else
+    return NULL;
+#endif
+}
+
+void rsrvDgBatchDestroy ( struct rsrv_dg_batch *pBatch )
+{
+#ifdef __linux__
+    if ( pBatch ) {
+        munmap ( pBatch->recvBuf, RSRV_DG_BATCH_RECV_SIZE );
+        free ( pBatch );
+    }
+#endif
+}
+
 /*
  * CAST_SERVER
  *
  * service UDP messages
  *
+ * On Linux the requests already queued to the socket are received
+ * by one recvmmsg() call, and the replies are sent in batches by
+ * sendmmsg() once no more requests are pending.
  */
 void cast_server(void *pParm)
 {
     rsrv_iface_config *conf = pParm;
     int                 status;
-    int                 count=0;
     int                 mysocket=0;
-    struct sockaddr_in  new_recv_addr;
+    struct sockaddr_in  new_recv_addr[RSRV_UDP_BATCH];
+    unsigned            nbytes[RSRV_UDP_BATCH];
     osiSocklen_t        recv_addr_size;
     osiSockIoctl_t      nchars;
     SOCKET              recv_sock, reply_sock;
     struct client      *client;
-
-    recv_addr_size = sizeof(new_recv_addr);
+#ifdef __linux__
+    struct mmsghdr      msgs[RSRV_UDP_BATCH];
+    struct iovec        iov[RSRV_UDP_BATCH];
+#endif
 
     reply_sock = conf->udp;
 
@@ -141,6 +276,8 @@ void cast_server(void *pParm)
         }
         epicsThreadSleep(300.0);
     }
+    /* without it requests are received and replies sent one at a time */
+    client->dgBatch = rsrvDgBatchCreate ();
     if (conf->startbcast) {
         recv_sock = conf->udpbcast;
         conf->bclient = client;
@@ -164,13 +301,48 @@ void cast_server(void *pParm)
     epicsEventSignal(casudp_startStopEvent);
 
     while (TRUE) {
-        status = recvfrom (
-            recv_sock,
-            client->recv.buf,
-            client->recv.maxstk,
-            0,
-            (struct sockaddr *)&new_recv_addr,
-            &recv_addr_size);
+        unsigned i, ndg = 0u;
+
+#ifdef __linux__
+        if (client->dgBatch) {
+            memset(msgs, 0, sizeof(msgs));
+            for (i = 0u; i < RSRV_UDP_BATCH; i++) {
+                if (i == 0u) {
+                    iov[i].iov_base = client->recv.buf;
+                    iov[i].iov_len = client->recv.maxstk;
+                }
+                else {
+                    iov[i].iov_base = client->dgBatch->recvBuf +
+                        (i-1u) * MAX_UDP_RECV;
+                    iov[i].iov_len = MAX_UDP_RECV;
+                }
+                msgs[i].msg_hdr.msg_name = &new_recv_addr[i];
+                msgs[i].msg_hdr.msg_namelen = sizeof(new_recv_addr[i]);
+                msgs[i].msg_hdr.msg_iov = &iov[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            status = recvmmsg(recv_sock, msgs, RSRV_UDP_BATCH,
+                MSG_WAITFORONE, NULL);
+            for (i = 0u; status > 0 && i < (unsigned) status; i++) {
+                nbytes[i] = msgs[i].msg_len;
+            }
+        }
+        else
+#endif
+        {
+            recv_addr_size = sizeof(new_recv_addr[0]);
+            status = recvfrom (
+                recv_sock,
+                client->recv.buf,
+                client->recv.maxstk,
+                0,
+                (struct sockaddr *)&new_recv_addr[0],
+                &recv_addr_size);
+            if (status >= 0) {
+                nbytes[0] = (unsigned) status;
+                status = 1;
+            }
+        }
         if (status < 0) {
             if (SOCKERRNO != SOCK_EINTR) {
                 char sockErrBuf[64];
@@ -182,90 +354,35 @@ void cast_server(void *pParm)
             }
 
         } else {
+            ndg = (unsigned) status;
+            epicsAtomicIncrSizeT(&rsrvUdpRecvCalls);
+            epicsAtomicAddSizeT(&rsrvUdpRecvDatagrams, ndg);
+        }
+
+        for (i = 0u; i < ndg && casudp_ctl == ctlRun; i++) {
             size_t idx;
             for(idx=0; casIgnoreAddrs[idx]; idx++)
             {
-                if(new_recv_addr.sin_addr.s_addr==casIgnoreAddrs[idx]) {
-                    status = -1; /* ignore */
+                if(new_recv_addr[i].sin_addr.s_addr==casIgnoreAddrs[idx]) {
                     break;
                 }
             }
-        }
-
-        if (status >= 0 && casudp_ctl == ctlRun) {
-            client->recv.cnt = (unsigned) status;
-            client->recv.stk = 0ul;
-            epicsTimeGetCurrent(&client->time_at_last_recv);
-
-            client->minor_version_number = CA_UKN_MINOR_VERSION;
-            client->seqNoOfReq = 0;
-
-            /*
-             * If we are talking to a new client flush to the old one
-             * in case we are holding UDP messages waiting to
-             * see if the next message is for this same client.
-             */
-            if (client->send.stk>sizeof(caHdr)) {
-                status = memcmp(&client->addr,
-                    &new_recv_addr, recv_addr_size);
-                if(status){
-                    /*
-                     * if the address is different
-                     */
-                    cas_send_dg_msg(client);
-                    client->addr = new_recv_addr;
-                }
-            }
-            else {
-                client->addr = new_recv_addr;
-            }
-
-            if (CASDEBUG>1) {
-                char    buf[40];
-
-                ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
-                errlogPrintf ("CAS: cast server msg of %d bytes from addr %s\n",
-                    client->recv.cnt, buf);
-            }
-
-            if (CASDEBUG>2)
-                count = ellCount (&client->chanList);
-
-            status = camessage ( client );
-            if(status == RSRV_OK){
-                if(client->recv.cnt !=
-                    client->recv.stk){
-                    char buf[40];
-
-                    ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
-
-                    epicsPrintf ("CAS: partial (damaged?) UDP msg of %d bytes from %s ?\n",
-                        client->recv.cnt - client->recv.stk, buf);
-
-                    epicsTimeToStrftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S",
-                        &client->time_at_last_recv);
-                    epicsPrintf ("CAS: message received at %s\n", buf);
-                }
-            }
-            else if (CASDEBUG>0){
-                char buf[40];
-
-                ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
-
-                epicsPrintf ("CAS: invalid (damaged?) UDP request from %s ?\n", buf);
-
-                epicsTimeToStrftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S",
-                    &client->time_at_last_recv);
-                epicsPrintf ("CAS: message received at %s\n", buf);
+            if (casIgnoreAddrs[idx]) {
+                continue; /* ignore */
             }
-
-            if (CASDEBUG>2) {
-                if ( ellCount (&client->chanList) ) {
-                    errlogPrintf ("CAS: Fnd %d name matches (%d tot)\n",
-                        ellCount(&client->chanList)-count,
-                        ellCount(&client->chanList));
-                }
+#ifdef __linux__
+            /* parsed where it was received */
+            if (i > 0u) {
+                char *pFirst = client->recv.buf;
+
+                client->recv.buf = client->dgBatch->recvBuf +
+                    (i-1u) * MAX_UDP_RECV;
+                cast_message(client, &new_recv_addr[i], nbytes[i]);
+                client->recv.buf = pFirst;
+                continue;
             }
+#endif
+            cast_message(client, &new_recv_addr[i], nbytes[i]);
         }
 
         /*
@@ -276,10 +393,12 @@ void cast_server(void *pParm)
         if (status<0) {
             errlogPrintf ("CA cast server: Unable to fetch N characters pending\n");
             cas_send_dg_msg (client);
+            cas_send_dg_batch (client);
             clean_addrq (client);
         }
         else if (nchars == 0) {
             cas_send_dg_msg (client);
+            cas_send_dg_batch (client);
             clean_addrq (client);
         }
     }
@@ -63,11 +63,38 @@ struct message_buffer {
   enum messageBufferType    type;
 };
 
+/*! A full block of the TCP send buffer waiting to be sent.
+ *  Bytes [cnt, stk) of buf remain to be sent. */
+struct send_segment {
+  struct send_segment       *next;
+  struct message_buffer     buf;
+};
+
+/*! most blocks queued before the sender must wait for the socket */
+#define RSRV_MAX_SEND_SEGMENTS 8u
+
 extern epicsThreadPrivateId rsrvCurrentClient;
 
+/* maximum datagrams moved by one recvmmsg() or sendmmsg() call */
+#define RSRV_UDP_BATCH 16
+
+/*! UDP name server datagram batches, Linux only, cf. cast_server() */
+struct rsrv_dg_batch {
+  /*! the 2nd and later requests received by one recvmmsg(), each in
+   *  a slot of MAX_UDP_RECV bytes like the first one in client::recv.
+   *  Mapped, cf. rsrvDgBatchCreate() */
+  char                  *recvBuf;
+  /*! replies waiting to be sent by one sendmmsg() */
+  unsigned              nReplies;
+  struct sockaddr_in    replyAddr[RSRV_UDP_BATCH];
+  unsigned              replySize[RSRV_UDP_BATCH];
+  char                  replyBuf[RSRV_UDP_BATCH][MAX_UDP_SEND];
+};
+
 typedef struct client {
   ELLNODE               node;
-  /*! guarded by SEND_LOCK()  aka. client::lock */
+  /*! guarded by SEND_LOCK()  aka. client::lock
+   *  With TCP, bytes [cnt, stk) remain to be sent after the queued blocks */
   struct message_buffer send;
   /*! accessed by receive thread w/o locks cf. camsgtask() */
   struct message_buffer recv;
@@ -93,6 +120,19 @@ typedef struct client {
   unsigned              recvBytesToDrain;
   unsigned              priority;
   char                  disconnect; /* disconnect detected */
+  /*! multiplexed circuits only, NULL with a receive thread per client */
+  struct rsrv_io_thread *ioThread;
+  /*! guarded by SEND_LOCK(), waiting for the socket to become writable */
+  char                  sendBlocked;
+  /*! I/O thread only, out of network buffers, cf. rsrvMuxRetry() */
+  char                  sendRetry;
+  struct client         *nextRetry;
+  /*! guarded by SEND_LOCK(), full blocks to be sent before send.buf */
+  struct send_segment   *sendQueue;
+  unsigned              sendQueueCount;
+  unsigned              sendQueueBytes;
+  /*! UDP name server only, NULL to send each reply as it is completed */
+  struct rsrv_dg_batch  *dgBatch;
 } client;
 
 /* Channel state shows which struct client list a
@@ -207,6 +247,20 @@ GLBLTYPE volatile enum ctl  castcp_ctl;
 
 GLBLTYPE unsigned int       threadPrios[5];
 
+/* number of I/O threads serving TCP circuits, 0 for a thread per client */
+GLBLTYPE unsigned           rsrvIoThreads;
+
+/* smallest monitor update payload shared between subscribers, <=0 disables */
+GLBLTYPE int                rsrvMonitorCacheMin GLBLTYPE_INIT(512);
+/* monitor update cache statistics, updated with epicsAtomic */
+GLBLTYPE size_t             rsrvMonCacheHits;
+GLBLTYPE size_t             rsrvMonCacheMisses;
+/* name server datagrams per system call statistics, updated with epicsAtomic */
+GLBLTYPE size_t             rsrvUdpRecvCalls;
+GLBLTYPE size_t             rsrvUdpRecvDatagrams;
+GLBLTYPE size_t             rsrvUdpSendCalls;
+GLBLTYPE size_t             rsrvUdpSendDatagrams;
+
 #define CAS_HASH_TABLE_SIZE 4096
 
 #define SEND_LOCK(CLIENT) epicsMutexMustLock((CLIENT)->lock)
@@ -220,8 +274,16 @@ extern "C" {
 #endif
 
 void camsgtask (void *client);
+int casRecvAndProcess ( struct client *client );
+int casProcessInput ( struct client *client );
+int casRecvPending ( struct client *client );
 void cas_send_bs_msg ( struct client *pclient, int lock_needed );
+int cas_try_send_bs_msg ( struct client *pclient );
+int cas_send_backlog ( struct client *pclient );
 void cas_send_dg_msg ( struct client *pclient );
+void cas_send_dg_batch ( struct client *pclient );
+struct rsrv_dg_batch *rsrvDgBatchCreate ( void );
+void rsrvDgBatchDestroy ( struct rsrv_dg_batch *pBatch );
 void rsrv_online_notify_task (void *);
 void cast_server (void *);
 struct client *create_client ( SOCKET sock, int proto );
@@ -230,12 +292,24 @@ struct client *create_tcp_client ( SOCKET sock, const osiSockAddr* peerAddr );
 void destroy_tcp_client ( struct client * );
 void casAttachThreadToClient ( struct client * );
 int camessage ( struct client *client );
+void rsrvMonCacheInit (void);
 void rsrv_extra_labor ( void * pArg );
 int rsrvCheckPut ( const struct channel_in_use *pciu );
 int rsrv_version_reply ( struct client *client );
 void rsrvFreePutNotify ( struct client *pClient,
                         struct rsrv_put_notify *pNotify );
 void initializePutNotifyFreeList (void);
+
+/*
+ * multiplexed TCP circuits (camuxtask.c)
+ */
+unsigned rsrvMuxInit ( unsigned nThreads );
+int rsrvMuxAddClient ( struct client *pClient );
+int rsrvMuxOnIoThread ( struct client *pClient );
+void rsrvMuxSendBlocked ( struct client *pClient, int blocked );
+void rsrvMuxRetry ( struct client *pClient );
+int rsrvMuxWaitWritable ( struct client *pClient );
+void rsrvMuxShow ( unsigned level );
 unsigned rsrvSizeOfPutNotify ( struct rsrv_put_notify *pNotify );
 
 /*
@@ -243,10 +317,14 @@ unsigned rsrvSizeOfPutNotify ( struct rsrv_put_notify *pNotify );
  */
 void casExpandRecvBuffer ( struct client *pClient, ca_uint32_t size );
 
+int casAllocBuffer ( struct message_buffer *buf, ca_uint32_t size );
+void casFreeBuffer ( struct message_buffer *buf );
+
 /*
  * outgoing protocol maintenance
  */
-void casExpandSendBuffer ( struct client *pClient, ca_uint32_t size );
+unsigned cas_send_pending ( struct client *pClient );
+void cas_send_discard ( struct client *pClient );
 int cas_copy_in_header (
     struct client *pClient, ca_uint16_t response, ca_uint32_t payloadSize,
     ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid,
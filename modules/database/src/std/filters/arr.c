@@ -15,6 +15,7 @@
 
 #include "chfPlugin.h"
 #include "dbAccessDefs.h"
+#include "dbArrayBuf.h"
 #include "dbExtractArray.h"
 #include "db_field_log.h"
 #include "dbLock.h"
@@ -109,6 +110,14 @@ static db_field_log* filter(void* pvt, dbChannel *chan, db_field_log *pfl)
         break;
 
     case dbfl_type_ref:
+        if (pfl->dtor == dbArrayBufFreeLog && my->incr == 1) {
+            /* narrow the shared snapshot instead of copying it */
+            nTarget = wrapArrayIndices(&start, my->incr, &end, nSource);
+            if (nTarget > 0)
+                pfl->u.r.field = (char *) pSource + start * pfl->field_size;
+            pfl->no_elements = nTarget;
+            break;
+        }
         must_lock = !pfl->dtor;
         if (must_lock) {
             dbScanLock(dbChannelRecord(chan));
@@ -0,0 +1,231 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Statistics filter: aggregates the value updates of a scalar channel
+ *  and sends one update with a statistic of them per window.
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#include "freeList.h"
+#include "caeventmask.h"
+#include "db_field_log.h"
+#include "chfPlugin.h"
+#include "dbAccess.h"
+#include "dbConvertFast.h"
+#include "epicsExit.h"
+#include "epicsTime.h"
+#include "epicsExport.h"
+
+typedef enum {
+    statMean, statMin, statMax, statRms, statStd, statP2p
+} statKind;
+
+typedef struct myStruct {
+    epicsInt32 n;
+    double t;
+    int kind;
+
+    /* the current window */
+    epicsInt32 count;
+    epicsTimeStamp start;
+    double shift, sum, sumsq, min, max;
+    unsigned short stat, sevr;
+} myStruct;
+
+static void *myStructFreeList;
+
+static const
+chfPluginEnumType kindEnum[] = {
+    {"mean", statMean}, {"min", statMin}, {"max", statMax},
+    {"rms", statRms}, {"std", statStd}, {"p2p", statP2p},
+    {NULL, 0}
+};
+
+static const
+chfPluginArgDef opts[] = {
+    chfInt32 (myStruct, n, "n", 0, 1),
+    chfDouble(myStruct, t, "t", 0, 1),
+    chfEnum  (myStruct, kind, "s", 0, 1, kindEnum),
+    chfPluginArgEnd
+};
+
+static void * allocPvt(void)
+{
+    myStruct *my = (myStruct*) freeListCalloc(myStructFreeList);
+    return (void *) my;
+}
+
+static void freePvt(void *pvt)
+{
+    freeListFree(myStructFreeList, pvt);
+}
+
+static int parse_ok(void *pvt)
+{
+    myStruct *my = (myStruct*) pvt;
+
+    /* a window needs a sample count or a duration, or both */
+    if (my->n < 0 || my->t < 0 || (my->n == 0 && my->t == 0))
+        return -1;
+
+    return 0;
+}
+
+static void addSample(myStruct *my, double val, const db_field_log *pfl)
+{
+    double d;
+
+    if (my->count++ == 0) {
+        my->start = pfl->time;
+        my->shift = my->min = my->max = val;
+        my->sum = my->sumsq = 0;
+        my->stat = pfl->stat;
+        my->sevr = pfl->sevr;
+    }
+    /* sums of values offset by the first sample, for an accurate std */
+    d = val - my->shift;
+    my->sum += d;
+    my->sumsq += d * d;
+    if (val < my->min)
+        my->min = val;
+    if (val > my->max)
+        my->max = val;
+    if (pfl->sevr > my->sevr) {
+        my->stat = pfl->stat;
+        my->sevr = pfl->sevr;
+    }
+}
+
+static int windowDone(const myStruct *my, const db_field_log *pfl)
+{
+    if (my->n > 0 && my->count >= my->n)
+        return 1;
+    return my->t > 0 &&
+        epicsTimeDiffInSeconds(&pfl->time, &my->start) >= my->t;
+}
+
+static double statistic(const myStruct *my)
+{
+    double mean = my->sum / my->count;
+    double var;
+
+    switch (my->kind) {
+    case statMin:
+        return my->min;
+    case statMax:
+        return my->max;
+    case statRms:
+        /* mean of squares from the offset sums */
+        var = my->sumsq / my->count + my->shift * (2 * mean + my->shift);
+        return var > 0 ? sqrt(var) : 0;
+    case statStd:
+        var = my->sumsq / my->count - mean * mean;
+        return var > 0 ? sqrt(var) : 0;
+    case statP2p:
+        return my->max - my->min;
+    case statMean:
+    default:
+        return my->shift + mean;
+    }
+}
+
+static db_field_log* filter(void* pvt, dbChannel *chan, db_field_log *pfl) {
+    myStruct *my = (myStruct*) pvt;
+    DBADDR localAddr;
+    double val;
+
+    /* Reads, property and alarm-only updates are passed on unchanged, and
+     * so are values which can't be converted.
+     */
+    if (pfl->ctx == dbfl_context_read || (pfl->mask & DBE_PROPERTY) ||
+        !(pfl->mask & (DBE_VALUE | DBE_LOG)) || pfl->type != dbfl_type_val)
+        return pfl;
+
+    localAddr = chan->addr; /* Structure copy */
+    localAddr.field_type = pfl->field_type;
+    localAddr.field_size = pfl->field_size;
+    localAddr.no_elements = pfl->no_elements;
+    localAddr.pfield = (char *) &pfl->u.v.field;
+    if (dbFastGetConvertRoutine[pfl->field_type][DBR_DOUBLE]
+            (localAddr.pfield, (void*) &val, &localAddr))
+        return pfl;
+
+    addSample(my, val, pfl);
+    if (!windowDone(my, pfl)) {
+        db_delete_field_log(pfl);
+        return NULL;
+    }
+
+    /* The last update of the window carries the result, with the highest
+     * alarm severity seen during the window.
+     */
+    pfl->field_type = DBF_DOUBLE;
+    pfl->field_size = sizeof(epicsFloat64);
+    pfl->u.v.field.dbf_double = statistic(my);
+    pfl->stat = my->stat;
+    pfl->sevr = my->sevr;
+    /* the value no longer matches the posted one */
+    pfl->post_id = 0;
+    my->count = 0;
+    return pfl;
+}
+
+static void channelRegisterPre(dbChannel *chan, void *pvt,
+                               chPostEventFunc **cb_out, void **arg_out, db_field_log *probe)
+{
+    /* numeric scalars only */
+    if (probe->no_elements != 1 || probe->field_type < DBF_CHAR ||
+        probe->field_type > DBF_DOUBLE)
+        return;
+
+    *cb_out = filter;
+    *arg_out = pvt;
+    probe->field_type = DBF_DOUBLE;
+    probe->field_size = sizeof(epicsFloat64);
+}
+
+static void channel_report(dbChannel *chan, void *pvt, int level, const unsigned short indent)
+{
+    myStruct *my = (myStruct*) pvt;
+    printf("%*sStatistics (stat): s=%s, n=%d, t=%g, count=%d\n", indent, "",
+           chfPluginEnumString(kindEnum, my->kind, "n/a"), my->n, my->t,
+           my->count);
+}
+
+static chfPluginIf pif = {
+    allocPvt,
+    freePvt,
+
+    NULL, /* parse_error, */
+    parse_ok,
+
+    NULL, /* channel_open, */
+    channelRegisterPre,
+    NULL, /* channelRegisterPost, */
+    channel_report,
+    NULL /* channel_close */
+};
+
+static void statShutdown(void *ignore)
+{
+    if (myStructFreeList)
+        freeListCleanup(myStructFreeList);
+    myStructFreeList = NULL;
+}
+
+static void statInitialize(void)
+{
+    if (!myStructFreeList)
+        freeListInitPvt(&myStructFreeList, sizeof(myStruct), 64);
+
+    chfPluginRegister("stat", &pif, opts);
+    epicsAtExit(statShutdown, NULL);
+}
+
+epicsExportRegistrar(statInitialize);
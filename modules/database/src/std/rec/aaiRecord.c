@@ -34,6 +34,7 @@
 #include "alarm.h"
 #include "callback.h"
 #include "dbAccess.h"
+#include "dbArrayBuf.h"
 #include "dbEvent.h"
 #include "dbFldTypes.h"
 #include "dbScan.h"
@@ -130,6 +131,8 @@ static long init_record(struct dbCommon *pcommon, int pass)
             /* device support did not allocate memory so we must do it */
             prec->bptr = callocMustSucceed(prec->nelm, dbValueSize(prec->ftvl),
                 "aai: buffer calloc failed");
+            dbArrayBufAttach(pcommon, &prec->bptr,
+                prec->nelm * dbValueSize(prec->ftvl));
         }
         return 0;
     }
@@ -165,6 +168,8 @@ static long process(struct dbCommon *pcommon)
         return S_dev_missingSup;
     }
 
+    if (!pact)
+        dbArrayBufPrepareWrite(pcommon, prec->nord * dbValueSize(prec->ftvl));
     status = readValue(prec); /* read the new value */
     if (!pact && prec->pact)
         return 0;
@@ -318,7 +323,7 @@ static void monitor(aaiRecord *prec)
     /* Calculate hash if we are interested in OnChange events. */
     if ((prec->mpst == aaiPOST_OnChange) ||
         (prec->apst == aaiPOST_OnChange)) {
-        hash = epicsMemHash(prec->bptr,
+        hash = epicsMemHashWide(prec->bptr,
             prec->nord * dbValueSize(prec->ftvl), 0);
 
         /* Only post OnChange values if the hash is different. */
@@ -34,6 +34,7 @@
 #include "alarm.h"
 #include "callback.h"
 #include "dbAccess.h"
+#include "dbArrayBuf.h"
 #include "dbEvent.h"
 #include "dbFldTypes.h"
 #include "dbScan.h"
@@ -133,6 +134,8 @@ static long init_record(struct dbCommon *pcommon, int pass)
             /* device support did not allocate memory so we must do it */
             prec->bptr = callocMustSucceed(prec->nelm, dbValueSize(prec->ftvl),
                 "aao: buffer calloc failed");
+            dbArrayBufAttach(pcommon, &prec->bptr,
+                prec->nelm * dbValueSize(prec->ftvl));
         }
         return 0;
     }
@@ -323,7 +326,7 @@ static void monitor(aaoRecord *prec)
     /* Calculate hash if we are interested in OnChange events. */
     if ((prec->mpst == aaoPOST_OnChange) ||
         (prec->apst == aaoPOST_OnChange)) {
-        hash = epicsMemHash(prec->bptr,
+        hash = epicsMemHashWide(prec->bptr,
             prec->nord * dbValueSize(prec->ftvl), 0);
 
         /* Only post OnChange values if the hash is different. */
@@ -359,6 +362,8 @@ static long fetchValue(aaoRecord *prec, int init)
         status = dbLoadLinkArray(&prec->dol, prec->ftvl, prec->bptr, &nReq);
 
     } else if(!init && !isConst) {
+        dbArrayBufPrepareWrite((dbCommon *) prec,
+            prec->nord * dbValueSize(prec->ftvl));
         status = dbGetLink(&prec->dol, prec->ftvl, prec->bptr, 0, &nReq);
 
     } else {
@@ -25,6 +25,7 @@
 #include "alarm.h"
 #include "dbStaticLib.h"
 #include "dbAccess.h"
+#include "dbArrayBuf.h"
 #include "dbEvent.h"
 #include "dbFldTypes.h"
 #include "errMdef.h"
@@ -88,14 +89,17 @@ static void reset(compressRecord *prec)
     prec->off = 0;
     prec->inx = 0;
     prec->cvb = 0.0;
+    prec->cvx = 0.0;
     prec->res = 0;
     /* allocate memory for the summing buffer for conversions requiring it */
     if (prec->alg == compressALG_Average && prec->sptr == NULL) {
         prec->sptr = calloc(prec->nsam, sizeof(double));
     }
 
-    if (prec->bptr && prec->nsam)
+    if (prec->bptr && prec->nsam) {
+        dbArrayBufPrepareWrite((dbCommon *) prec, 0);
         memset(prec->bptr, 0, prec->nsam * sizeof(double));
+    }
 }
 
 static void monitor(compressRecord *prec)
@@ -121,6 +125,8 @@ static void put_value(compressRecord *prec, double *psource, int n)
     if (nuse > nsam)
         nuse = nsam;
 
+    dbArrayBufPrepareWrite((dbCommon *) prec, nsam * sizeof(double));
+
     while (n--) {
         /* for LIFO, pre-decrement modulo nsam */
         if (!fifo)
@@ -138,24 +144,167 @@ static void put_value(compressRecord *prec, double *psource, int n)
 }
 
 
-/* qsort comparison function (for median calculation) */
-static int compare(const void *arg1, const void *arg2)
+/* The N to 1 reductions keep LANES independent partial results, updated
+ * a block of LANES samples at a time.  Each block update is a plain
+ * element by element loop which the compiler can vectorize; the lanes
+ * are only combined at the end.  Compilers unroll much shorter blocks
+ * into scalar code instead.
+ */
+#define LANES 32
+
+static void laneLow(double *lo, const double *psource)
+{
+    int k;
+
+    for (k = 0; k < LANES; k++)
+        lo[k] = (psource[k] < lo[k]) ? psource[k] : lo[k];
+}
+
+static void laneHigh(double *hi, const double *psource)
+{
+    int k;
+
+    for (k = 0; k < LANES; k++)
+        hi[k] = (psource[k] > hi[k]) ? psource[k] : hi[k];
+}
+
+static void laneSum(double *sum, const double *psource)
 {
-    double a = *(double *)arg1;
-    double b = *(double *)arg2;
+    int k;
+
+    for (k = 0; k < LANES; k++)
+        sum[k] += psource[k];
+}
 
-    if      ( a <  b ) return -1;
-    else if ( a == b ) return  0;
-    else               return  1;
+static void laneSquares(double *sum, double *sumsq, const double *psource,
+    double shift)
+{
+    int k;
+
+    for (k = 0; k < LANES; k++) {
+        double d = psource[k] - shift;
+
+        sum[k] += d;
+        sumsq[k] += d * d;
+    }
+}
+
+/* Lowest and highest of n > 0 samples, in one pass */
+static void limits(const double *psource, epicsInt32 n,
+    double *plow, double *phigh)
+{
+    double lo[LANES], hi[LANES];
+    epicsInt32 i;
+    int k;
+
+    for (k = 0; k < LANES; k++)
+        lo[k] = hi[k] = psource[0];
+    for (i = 0; i + LANES <= n; i += LANES) {
+        laneLow(lo, psource + i);
+        laneHigh(hi, psource + i);
+    }
+    for (; i < n; i++) {
+        lo[0] = (psource[i] < lo[0]) ? psource[i] : lo[0];
+        hi[0] = (psource[i] > hi[0]) ? psource[i] : hi[0];
+    }
+    for (k = 1; k < LANES; k++) {
+        lo[0] = (lo[k] < lo[0]) ? lo[k] : lo[0];
+        hi[0] = (hi[k] > hi[0]) ? hi[k] : hi[0];
+    }
+    if (plow)
+        *plow = lo[0];
+    if (phigh)
+        *phigh = hi[0];
+}
+
+static double sumValues(const double *psource, epicsInt32 n)
+{
+    double sum[LANES] = {0};
+    epicsInt32 i;
+    int k;
+
+    for (i = 0; i + LANES <= n; i += LANES)
+        laneSum(sum, psource + i);
+    for (; i < n; i++)
+        sum[0] += psource[i];
+    for (k = 1; k < LANES; k++)
+        sum[0] += sum[k];
+    return sum[0];
+}
+
+/* Sum of (x - shift)^2 over n samples, and of (x - shift) in *psum */
+static double sumSquares(const double *psource, epicsInt32 n, double shift,
+    double *psum)
+{
+    double sum[LANES] = {0}, sumsq[LANES] = {0};
+    epicsInt32 i;
+    int k;
+
+    for (i = 0; i + LANES <= n; i += LANES)
+        laneSquares(sum, sumsq, psource + i, shift);
+    for (; i < n; i++) {
+        double d = psource[i] - shift;
+
+        sum[0] += d;
+        sumsq[0] += d * d;
+    }
+    for (k = 1; k < LANES; k++) {
+        sum[0] += sum[k];
+        sumsq[0] += sumsq[k];
+    }
+    *psum = sum[0];
+    return sumsq[0];
+}
+
+/* Population standard deviation, from sums of samples offset by one of
+ * them which keeps the single pass accurate when the mean is large.
+ */
+static double stdDev(const double *psource, epicsInt32 n)
+{
+    double s;
+    double var = (sumSquares(psource, n, psource[0], &s) - s * s / n) / n;
+
+    return var > 0 ? sqrt(var) : 0;
+}
+
+/* Reorder n samples so that psource[k] holds the value a full sort would
+ * put there (Hoare's FIND), in linear average time.
+ */
+static double select_kth(double *psource, epicsInt32 n, epicsInt32 k)
+{
+    epicsInt32 left = 0, right = n - 1;
+
+    while (left < right) {
+        double pivot = psource[k];
+        epicsInt32 i = left, j = right;
+
+        do {
+            while (psource[i] < pivot)
+                i++;
+            while (pivot < psource[j])
+                j--;
+            if (i <= j) {
+                double tmp = psource[i];
+
+                psource[i++] = psource[j];
+                psource[j--] = tmp;
+            }
+        } while (i <= j);
+        if (j < k)
+            left = i;
+        if (k < i)
+            right = j;
+    }
+    return psource[k];
 }
 
 static int compress_array(compressRecord *prec,
     double *psource, int no_elements)
 {
-    epicsInt32 i,j;
+    epicsInt32 i;
     epicsInt32 n, nnew;
     epicsInt32 nsam = prec->nsam;
-    double value;
+    double value, low, high, total;
 
     /* skip out of limit data */
     if (prec->ilil < prec->ihil) {
@@ -176,50 +325,36 @@ static int compress_array(compressRecord *prec,
         nnew = (no_elements / n);
     else nnew = nsam;
 
-    /* compress according to specified algorithm */
-    switch (prec->alg){
-    case compressALG_N_to_1_Low_Value:
-        /* compress N to 1 keeping the lowest value */
-        for (i = 0; i < nnew; i++) {
-            value = *psource++;
-            for (j = 1; j < n; j++, psource++) {
-                if (value > *psource)
-                    value = *psource;
-            }
-            put_value(prec, &value, 1);
-        }
-        break;
-    case compressALG_N_to_1_High_Value:
-        /* compress N to 1 keeping the highest value */
-        for (i = 0; i < nnew; i++){
-            value = *psource++;
-            for (j = 1; j < n; j++, psource++) {
-                if (value < *psource)
-                    value = *psource;
-            }
-            put_value(prec, &value, 1);
-        }
-        break;
-    case compressALG_N_to_1_Average:
-        /* compress N to 1 keeping the average value */
-        for (i = 0; i < nnew; i++) {
-            value = 0;
-            for (j = 0; j < n; j++, psource++)
-                value += *psource;
-            value /= n;
-            put_value(prec, &value, 1);
-        }
-        break;
-
-    case compressALG_N_to_1_Median:
-        /* compress N to 1 keeping the median value */
-        /* note: sorts source array (OK; it's a work pointer) */
-        for (i = 0; i < nnew; i++, psource += nnew) {
-            qsort(psource, n, sizeof(double), compare);
-            value = psource[n / 2];
-            put_value(prec, &value, 1);
+    /* compress N to 1 according to specified algorithm */
+    for (i = 0; i < nnew; i++, psource += n) {
+        switch (prec->alg) {
+        case compressALG_N_to_1_Low_Value:
+            limits(psource, n, &value, NULL);
+            break;
+        case compressALG_N_to_1_High_Value:
+            limits(psource, n, NULL, &value);
+            break;
+        case compressALG_N_to_1_Average:
+            value = sumValues(psource, n) / n;
+            break;
+        case compressALG_N_to_1_Median:
+            /* note: reorders source array (OK; it's a work pointer) */
+            value = select_kth(psource, n, n / 2);
+            break;
+        case compressALG_N_to_1_RMS:
+            value = sqrt(sumSquares(psource, n, 0.0, &total) / n);
+            break;
+        case compressALG_N_to_1_Std_Deviation:
+            value = stdDev(psource, n);
+            break;
+        case compressALG_N_to_1_Peak_to_Peak:
+            limits(psource, n, &low, &high);
+            value = high - low;
+            break;
+        default:
+            return 1;
         }
-        break;
+        put_value(prec, &value, 1);
     }
     return 0;
 }
@@ -278,6 +413,8 @@ static int compress_scalar(struct compressRecord *prec,double *psource)
 {
     double value = *psource;
     double *pdest=&prec->cvb;
+    double *pextra=&prec->cvx;
+    double result;
     epicsInt32 inx = prec->inx;
 
     /* compress according to specified algorithm */
@@ -285,20 +422,50 @@ static int compress_scalar(struct compressRecord *prec,double *psource)
     case (compressALG_N_to_1_Low_Value):
         if ((value < *pdest) || (inx == 0))
             *pdest = value;
+        result = *pdest;
         break;
     case (compressALG_N_to_1_High_Value):
         if ((value > *pdest) || (inx == 0))
             *pdest = value;
+        result = *pdest;
         break;
     /* for scalars, Median not implemented => use average */
     case (compressALG_N_to_1_Average):
     case (compressALG_N_to_1_Median):
         *pdest = (inx * (*pdest) + value) / (inx + 1);
+        result = *pdest;
         break;
+    /* running mean of the squares */
+    case (compressALG_N_to_1_RMS):
+        *pdest = (inx * (*pdest) + value * value) / (inx + 1);
+        result = sqrt(*pdest);
+        break;
+    /* Welford's update of the mean and of the sum of squared deviations */
+    case (compressALG_N_to_1_Std_Deviation):
+        if (inx == 0)
+            *pdest = *pextra = 0;
+        {
+            double delta = value - *pdest;
+
+            *pdest += delta / (inx + 1);
+            *pextra += delta * (value - *pdest);
+        }
+        result = *pextra > 0 ? sqrt(*pextra / (inx + 1)) : 0;
+        break;
+    /* lowest and highest values */
+    case (compressALG_N_to_1_Peak_to_Peak):
+        if ((value < *pdest) || (inx == 0))
+            *pdest = value;
+        if ((value > *pextra) || (inx == 0))
+            *pextra = value;
+        result = *pextra - *pdest;
+        break;
+    default:
+        return 1;
     }
     inx++;
     if ((inx >= prec->n) || (prec->pbuf == menuYesNoYES)) {
-        put_value(prec,pdest,1);
+        put_value(prec,&result,1);
         prec->inx = (inx >= prec->n) ? 0 : inx;
         return 0;
     } else {
@@ -315,6 +482,8 @@ static long init_record(struct dbCommon *pcommon, int pass)
         if (prec->nsam < 1)
             prec->nsam = 1;
         prec->bptr = calloc(prec->nsam, sizeof(double));
+        dbArrayBufAttach(pcommon, (void **) &prec->bptr,
+            prec->nsam * sizeof(double));
         reset(prec);
     }
 
@@ -28,6 +28,7 @@
 #include "epicsPrint.h"
 #include "alarm.h"
 #include "dbAccess.h"
+#include "dbArrayBuf.h"
 #include "dbEvent.h"
 #include "dbFldTypes.h"
 #include "dbScan.h"
@@ -99,6 +100,8 @@ static long init_record(struct dbCommon *pcommon, int pass)
             prec->ftvl = DBF_UCHAR;
         prec->bptr = callocMustSucceed(prec->malm, dbValueSize(prec->ftvl),
             "subArrayRecord calloc failed");
+        dbArrayBufAttach(pcommon, &prec->bptr,
+            prec->malm * dbValueSize(prec->ftvl));
         prec->nord = 0;
         if (prec->nelm > prec->malm)
             prec->nelm = prec->malm;
@@ -138,6 +141,8 @@ static long process(struct dbCommon *pcommon)
 
     if (pact && prec->busy) return 0;
 
+    if (!pact)
+        dbArrayBufPrepareWrite(pcommon, prec->nord * dbValueSize(prec->ftvl));
     status=readValue(prec); /* read the new value */
     if (!pact && prec->pact) return 0;
     prec->pact = TRUE;
@@ -26,6 +26,7 @@
 #include "alarm.h"
 #include "callback.h"
 #include "dbAccess.h"
+#include "dbArrayBuf.h"
 #include "dbEvent.h"
 #include "dbFldTypes.h"
 #include "dbScan.h"
@@ -97,6 +98,8 @@ static long init_record(struct dbCommon *pcommon, int pass)
             prec->ftvl = DBF_UCHAR;
         prec->bptr = callocMustSucceed(prec->nelm, dbValueSize(prec->ftvl),
             "waveform calloc failed");
+        dbArrayBufAttach(pcommon, &prec->bptr,
+            prec->nelm * dbValueSize(prec->ftvl));
         prec->nord = (prec->nelm == 1);
         return 0;
     }
@@ -136,6 +139,8 @@ static long process(struct dbCommon *pcommon)
     if (pact && prec->busy)
         return 0;
 
+    if (!pact)
+        dbArrayBufPrepareWrite(pcommon, nord * dbValueSize(prec->ftvl));
     status = readValue(prec); /* read the new value */
     if (!pact && prec->pact)
         return 0;
@@ -303,7 +308,7 @@ static void monitor(waveformRecord *prec)
     /* Calculate hash if we are interested in OnChange events. */
     if ((prec->mpst == waveformPOST_OnChange) ||
         (prec->apst == waveformPOST_OnChange)) {
-        hash = epicsMemHash((char *)prec->bptr,
+        hash = epicsMemHashWide(prec->bptr,
             prec->nord * dbValueSize(prec->ftvl), 0);
 
         /* Only post OnChange values if the hash is different. */
@@ -62,8 +62,13 @@ void usage(const char *arg0, const std::string& base_dbd) {
                "[-m macro=value,macro2=value2] [-d file.db]\n"
                "[-x prefix] [st.cmd]\n"
                "\n"
-               "    -D <dbd>  If used, must come first. Specify the path to the softIoc.dbdfile."
-               "        The compile-time install location is saved in the binary as a default.\n"
+               "    -D <dbd>  If used, must come first. Specify the path to the softIoc.dbd file.\n"
+               "        This file is loaded exactly as given, as a binary DBD image if its\n"
+               "        name ends in .dbdi.  Without -D the installed softIoc.dbd is used,\n"
+               "        found relative to this executable or else at the compile-time install\n"
+               "        location saved in the binary.  If a softIoc.dbdi image was installed\n"
+               "        next to it, that image is loaded instead.  If neither can be read\n"
+               "        the copy of softIoc.dbd built into the executable is used.\n"
                "\n"
                "    -h  Print this mesage and exit.\n"
                "\n"
@@ -94,7 +99,7 @@ void usage(const char *arg0, const std::string& base_dbd) {
                "loading must be performed by the script itself, or by the user from the\n"
                "interactive IOC shell.\n"
                "\n"
-               "Compiled-in path to softIoc.dbd is:\n"
+               "DBD file to be loaded, softIoc.dbd or its image:\n"
                "\t"<<base_dbd.c_str()<<std::endl;
 }
 
@@ -161,6 +166,10 @@ int main(int argc, char *argv[])
             exit_file = prefix + EXIT_FILE_REL;
         }
 
+        // the binary image of softIoc.dbd loads faster, if it was installed
+        if(isReadableFile((dbd_file + "i").c_str()))
+            dbd_file += "i";
+
         if(epicsMemMount(softIoc_imf, EPICS_MEM_MOUNT_VERBOSE)) {
             fprintf(stderr, "Warning: Unable to mount app:// .  Default to %s\n",
                     dbd_file.c_str());
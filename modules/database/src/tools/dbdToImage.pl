@@ -0,0 +1,161 @@
+#!/usr/bin/env perl
+
+#*************************************************************************
+# SPDX-License-Identifier: EPICS
+# EPICS BASE is distributed subject to a Software License Agreement found
+# in file LICENSE that is included with this distribution.
+#*************************************************************************
+
+# Convert DBD files into a binary image that dbLoadDatabase() can restore
+# without parsing.  See dbDbdImage.c for the loader.
+#
+# The image starts with the magic string "DBDIMAGE", a format version and
+# the size of the string table, followed by the string table and then the
+# definitions.  All numbers are 32-bit little-endian, strings are offsets
+# into the string table or NONE.  Definitions appear in the same order as
+# dbdExpand.pl writes them.
+
+use strict;
+
+use FindBin qw($Bin);
+use lib ("$Bin/../../lib/perl");
+
+use DBD;
+use DBD::Parser;
+use EPICS::Getopts;
+use EPICS::Readfile;
+use EPICS::macLib;
+
+my $tool = 'dbdToImage.pl';
+my $version = 1;
+my $NONE = 0xFFFFFFFF;
+
+our (@opt_I, @opt_S, $opt_o);
+
+getopts('I@S@o:') or
+    die "Usage: $tool [-I dir] [-S macro=val] -o out.dbdi in.dbd ...\n";
+
+die "$tool: No output file given\n" unless $opt_o;
+die "$tool: No input files for $opt_o\n" if !@ARGV;
+
+my $macros = EPICS::macLib->new(@opt_S);
+my $dbd = DBD->new();
+
+$macros->suppressWarning(1);
+
+my $errors = 0;
+
+while (@ARGV) {
+    my $file = shift @ARGV;
+    eval {
+        ParseDBD($dbd, Readfile($file, $macros, \@opt_I));
+    };
+    if ($@) {
+        warn "$tool: $@";
+        warn "  while reading '$file' to create '$opt_o'\n";
+        ++$errors;
+    }
+}
+
+die "$tool: Exiting due to errors\n" if $errors;
+
+die "$tool: Record instances can't be stored in a DBD image\n"
+    if $dbd->record_names;
+
+my %strings;
+my $strtab = '';
+my @words;
+
+sub str {
+    my ($s) = @_;
+    return $NONE unless defined $s;
+    if (!exists $strings{$s}) {
+        $strings{$s} = length $strtab;
+        $strtab .= "$s\0";
+    }
+    return $strings{$s};
+}
+
+sub yesno {
+    my ($val, @yes) = @_;
+    return 0 unless defined $val;
+    return scalar grep { $val eq $_ } @yes;
+}
+
+my $menus = $dbd->menus;
+push @words, scalar keys %{$menus};
+foreach my $name (sort keys %{$menus}) {
+    my @choices = $menus->{$name}->choices;
+    push @words, str($name), scalar @choices;
+    push @words, str($_->[0]), str($_->[1])
+        foreach @choices;
+}
+
+my $recordtypes = $dbd->recordtypes;
+push @words, scalar keys %{$recordtypes};
+foreach my $name (sort keys %{$recordtypes}) {
+    my $recordtype = $recordtypes->{$name};
+    my @fields = $recordtype->fields;
+    my @devices = $recordtype->devices;
+
+    push @words, str($name), scalar @fields;
+    foreach my $field (@fields) {
+        my $asl = $field->attribute('asl');
+        push @words,
+            str($field->name),
+            str($field->dbf_type),
+            str($field->attribute('prompt')),
+            str($field->attribute('promptgroup')),
+            str($field->attribute('special')),
+            str($field->attribute('extra')),
+            str($field->attribute('menu')),
+            str($field->attribute('initial')),
+            yesno($field->attribute('pp'), 'YES', 'TRUE'),
+            yesno($field->attribute('base'), 'HEX'),
+            (defined $asl && $asl eq 'ASL0') ? 0 : 1,
+            yesno($field->attribute('prop'), 'YES'),
+            $field->attribute('interest') || 0,
+            $field->attribute('size') || 0;
+    }
+    # Field indices in name order, as dbRecordtypeBody() sorts them
+    push @words, sort { $fields[$a]->name cmp $fields[$b]->name }
+        0 .. $#fields;
+
+    push @words, scalar @devices;
+    push @words, str($_->link_type), str($_->name), str($_->choice)
+        foreach @devices;
+}
+
+foreach my $list ($dbd->drivers, $dbd->registrars, $dbd->functions) {
+    push @words, scalar keys %{$list};
+    push @words, map { str($_) } sort keys %{$list};
+}
+
+my $links = $dbd->links;
+push @words, scalar keys %{$links};
+push @words, str($links->{$_}->key), str($_)
+    foreach sort keys %{$links};
+
+my $variables = $dbd->variables;
+push @words, scalar keys %{$variables};
+push @words, str($_), str($variables->{$_}->var_type)
+    foreach sort keys %{$variables};
+
+my $breaktables = $dbd->breaktables;
+push @words, scalar keys %{$breaktables};
+foreach my $name (sort keys %{$breaktables}) {
+    my @points = $breaktables->{$name}->points;
+    push @words, str($name), scalar @points;
+    push @words, str($_->[0]), str($_->[1])
+        foreach @points;
+}
+
+# Pad the string table so the definitions are aligned
+$strtab .= "\0" x (-length($strtab) % 4);
+
+open my $out, '>', $opt_o or die "$tool: Can't create $opt_o: $!\n";
+binmode $out;
+print $out 'DBDIMAGE', pack('VV', $version, length $strtab), $strtab,
+    pack('V*', @words);
+close $out or die "$tool: Closing $opt_o failed: $!\n";
+exit 0;
@@ -5,6 +5,7 @@
 * EPICS BASE is distributed subject to a Software License Agreement found
 * in file LICENSE that is included with this distribution.
 \*************************************************************************/
+#include <stdio.h>
 #include "string.h"
 
 #include "cantProceed.h"
@@ -112,6 +113,103 @@ done:
     free(tdat.output);
 }
 
+/* Conversions between all numeric types, in millions of elements per
+ * second.  The wrapped get starts half way into the field.
+ */
+#define PAIR_NELEM 100000
+#define PAIR_NITER 200
+
+static const struct {
+    const char *name;
+    int type;
+    size_t size;
+} numTypes[] = {
+    {"CHAR",   DBF_CHAR,   sizeof(epicsInt8)},
+    {"UCHAR",  DBF_UCHAR,  sizeof(epicsUInt8)},
+    {"SHORT",  DBF_SHORT,  sizeof(epicsInt16)},
+    {"USHORT", DBF_USHORT, sizeof(epicsUInt16)},
+    {"LONG",   DBF_LONG,   sizeof(epicsInt32)},
+    {"ULONG",  DBF_ULONG,  sizeof(epicsUInt32)},
+    {"INT64",  DBF_INT64,  sizeof(epicsInt64)},
+    {"UINT64", DBF_UINT64, sizeof(epicsUInt64)},
+    {"FLOAT",  DBF_FLOAT,  sizeof(epicsFloat32)},
+    {"DOUBLE", DBF_DOUBLE, sizeof(epicsFloat64)},
+};
+#define NTYPES NELEMENTS(numTypes)
+
+enum pairOp {pairGet, pairGetWrap, pairPut};
+
+static double timePair(enum pairOp op, int from, int to,
+                       void *field, void *buf)
+{
+    DBADDR addr;
+    epicsTimeStamp start, stop;
+    long offset = op==pairGetWrap ? PAIR_NELEM/2 : 0;
+    size_t i;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.pfield = field;
+    addr.no_elements = PAIR_NELEM;
+
+    epicsTimeGetCurrent(&start);
+    if (op==pairPut) {
+        PUTCONVERTFUNC putter = dbPutConvertRoutine[from][to];
+
+        addr.field_type = to;
+        for (i=0; i<PAIR_NITER; i++)
+            putter(&addr, buf, PAIR_NELEM, PAIR_NELEM, 0);
+    } else {
+        GETCONVERTFUNC getter = dbGetConvertRoutine[from][to];
+
+        addr.field_type = from;
+        for (i=0; i<PAIR_NITER; i++)
+            getter(&addr, buf, PAIR_NELEM, PAIR_NELEM, offset);
+    }
+    epicsTimeGetCurrent(&stop);
+
+    return (double)PAIR_NELEM*PAIR_NITER/epicsTimeDiffInSeconds(&stop, &start)/1e6;
+}
+
+static void runPairBench(enum pairOp op)
+{
+    static const char *titles[] = {"dbGet", "dbGet with wrap", "dbPut"};
+    char line[16 + 8*NTYPES];
+    void *field, *buf;
+    size_t from, to;
+
+    testDiag("%s Melements/s, %d elements, field type down, request type across",
+             titles[op], PAIR_NELEM);
+
+    field = callocMustSucceed(PAIR_NELEM, sizeof(epicsFloat64), "runPairBench");
+    buf = callocMustSucceed(PAIR_NELEM, sizeof(epicsFloat64), "runPairBench");
+
+    strcpy(line, "       ");
+    for (to=0; to<NTYPES; to++)
+        sprintf(line + strlen(line), " %7s", numTypes[to].name);
+    testDiag("%s", line);
+
+    for (from=0; from<NTYPES; from++) {
+        sprintf(line, "%-7s", numTypes[from].name);
+        for (to=0; to<NTYPES; to++) {
+            double rate;
+
+            /* zeros are valid in every type, unlike left over bytes */
+            memset(field, 0, PAIR_NELEM*sizeof(epicsFloat64));
+            memset(buf, 0, PAIR_NELEM*sizeof(epicsFloat64));
+            /* dbPut converts request type 'to' into field type 'from' */
+            rate = op==pairPut ?
+                timePair(op, numTypes[to].type, numTypes[from].type, field, buf) :
+                timePair(op, numTypes[from].type, numTypes[to].type, field, buf);
+
+            sprintf(line + strlen(line), " %7.0f", rate);
+        }
+        testDiag("%s", line);
+    }
+
+    free(field);
+    free(buf);
+}
+
 MAIN(benchdbConvert)
 {
     testPlan(0);
@@ -123,5 +221,8 @@ MAIN(benchdbConvert)
     runBench(100000, 100, 10);
     runBench(1000000, 10, 10);
     runBench(10000000, 1, 10);
+    runPairBench(pairGet);
+    runPairBench(pairGetWrap);
+    runPairBench(pairPut);
     return testDone();
 }
@@ -0,0 +1,150 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Measure the cost of db_post_events() for one field
+ * as the number of subscriptions on other fields grows.
+ * VAL has a single subscriber, OTST has none.
+ */
+#include <string.h>
+
+#include "cantProceed.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "epicsMath.h"
+#include "dbAccess.h"
+#include "dbChannel.h"
+#include "dbEvent.h"
+#include "dbLock.h"
+#include "dbUnitTest.h"
+#include "caeventmask.h"
+#include "xRecord.h"
+
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+/* fields other than VAL to spread subscriptions over */
+static const char * const otherFields[] = {
+    "x.C8", "x.U8", "x.I16", "x.U16", "x.I32", "x.U32",
+    "x.I64", "x.U64", "x.F32", "x.F64", "x.SEVR", "x.STAT",
+};
+#define NOTHER NELEMENTS(otherFields)
+
+static void noopEvent(void *user_arg, struct dbChannel *chan,
+                      int eventsRemaining, struct db_field_log *pfl)
+{
+}
+
+static void timePosts(xRecord *prec, void *pfield, const char *fname,
+                      double *reptimes, size_t niter, size_t nrep)
+{
+    size_t i;
+
+    for(i=0; i<nrep; i++) {
+        epicsTimeStamp start, stop;
+        size_t n;
+
+        epicsTimeGetCurrent(&start);
+        dbScanLock((dbCommon*)prec);
+        for(n=0; n<niter; n++)
+            db_post_events(prec, pfield, DBE_VALUE);
+        dbScanUnlock((dbCommon*)prec);
+        epicsTimeGetCurrent(&stop);
+
+        reptimes[i] = epicsTimeDiffInSeconds(&stop, &start);
+    }
+
+    {
+        double sum=0, sum2=0, mean;
+        for(i=0; i<nrep; i++) {
+            sum += reptimes[i];
+            sum2 += reptimes[i]*reptimes[i];
+        }
+
+        mean = sum/nrep;
+        testDiag("Post %s: %.1f ns +- %.1f ns per post",
+                 fname,
+                 mean/niter*1e9,
+                 sqrt(sum2/nrep - mean*mean)/niter*1e9);
+    }
+}
+
+static void runBench(dbEventCtx evtctx, xRecord *prec,
+                     size_t nsubs, size_t niter, size_t nrep)
+{
+    dbChannel **chans;
+    dbEventSubscription *subs;
+    double *reptimes;
+    size_t i;
+
+    testDiag("1 subscriber on VAL, %lu on other fields",
+             (unsigned long)nsubs);
+
+    chans = callocMustSucceed(nsubs+1, sizeof(*chans), "runBench");
+    subs = callocMustSucceed(nsubs+1, sizeof(*subs), "runBench");
+    reptimes = callocMustSucceed(nrep, sizeof(*reptimes), "runBench");
+
+    for(i=0; i<=nsubs; i++) {
+        const char *name = i==0 ? "x.VAL" : otherFields[i%NOTHER];
+
+        chans[i] = dbChannelCreate(name);
+        if(!chans[i] || dbChannelOpen(chans[i])) {
+            testAbort("Failed to open %s", name);
+        }
+        subs[i] = db_add_event(evtctx, chans[i], noopEvent, NULL, DBE_VALUE);
+        if(!subs[i])
+            testAbort("Failed to subscribe to %s", name);
+        db_event_enable(subs[i]);
+    }
+
+    timePosts(prec, &prec->val, "VAL", reptimes, niter, nrep);
+    timePosts(prec, &prec->otst, "OTST", reptimes, niter, nrep);
+
+    for(i=0; i<=nsubs; i++) {
+        db_cancel_event(subs[i]);
+        dbChannelDelete(chans[i]);
+    }
+
+    free(reptimes);
+    free(subs);
+    free(chans);
+}
+
+MAIN(benchdbEvent)
+{
+    dbEventCtx evtctx;
+    xRecord *prec;
+
+    testPlan(0);
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("xRecord.db", NULL, NULL);
+
+    testIocInitOk();
+
+    prec = (xRecord*)testdbRecordPtr("x");
+
+    evtctx = db_init_events();
+    if(!evtctx || db_start_events(evtctx, "benchdbEvent", NULL, NULL,
+                                  epicsThreadPriorityLow))
+        testAbort("Failed to start event task");
+
+    runBench(evtctx, prec, 0, 100000, 10);
+    runBench(evtctx, prec, 10, 100000, 10);
+    runBench(evtctx, prec, 100, 100000, 10);
+    runBench(evtctx, prec, 1000, 100000, 10);
+
+    db_close_events(evtctx);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+
+    return testDone();
+}
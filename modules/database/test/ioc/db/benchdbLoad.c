@@ -0,0 +1,137 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Measure the time to load a synthetic database of 100k records from
+ * many macro-expanded instances of a template, as an IOC's startup
+ * script would, with and without dbLoadRecordsThreads.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dbDefs.h"
+#include "epicsStdio.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "dbAccess.h"
+#include "dbStaticLib.h"
+#include "dbUnitTest.h"
+
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define TEMPLATE "benchdbLoad.db"
+#define RECS_PER_INSTANCE 10
+#define NINSTANCE 10000
+#define SUBSLEN 40
+
+static char (*subs)[SUBSLEN];
+static dbReadListItem *items;
+
+static void writeTemplate(void)
+{
+    FILE *fp = fopen(TEMPLATE, "w");
+    int i;
+
+    if (!fp)
+        testAbort("Can't create " TEMPLATE);
+    fprintf(fp, "# Synthetic template for benchdbLoad\n");
+    for (i = 0; i < RECS_PER_INSTANCE; i++) {
+        fprintf(fp,
+            "record(x, \"$(P):$(N):rec%d\") {\n"
+            "    field(DESC, \"Synthetic record %d of $(N)\")\n"
+            "    field(SCAN, \"Passive\")\n"
+            "    field(PHAS, \"%d\")\n"
+            "    field(VAL, \"%d\")\n"
+            "    field(F64, \"1.5e3\")\n"
+            "    field(INP, \"$(P):$(N):rec%d NPP\")\n"
+            "    field(FLNK, \"$(P):$(N):rec%d\")\n"
+            "    info(autosaveFields, \"VAL\")\n"
+            "}\n",
+            i, i, i % 3, i, (i + 1) % RECS_PER_INSTANCE,
+            (i + 1) % RECS_PER_INSTANCE);
+    }
+    fclose(fp);
+}
+
+static void startIoc(void)
+{
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+}
+
+static double timeSerial(void)
+{
+    epicsTimeStamp start, stop;
+    unsigned int i;
+
+    startIoc();
+    epicsTimeGetMonotonic(&start);
+    for (i = 0; i < NINSTANCE; i++) {
+        if (dbReadDatabase(&pdbbase, TEMPLATE, ".", subs[i]))
+            testAbort("Failed to load %s", subs[i]);
+    }
+    epicsTimeGetMonotonic(&stop);
+    testdbCleanup();
+    return epicsTimeDiffInSeconds(&stop, &start);
+}
+
+static double timeList(int nThreads)
+{
+    epicsTimeStamp start, stop;
+
+    startIoc();
+    dbLoadRecordsThreads = nThreads;
+    epicsTimeGetMonotonic(&start);
+    if (dbReadDatabaseList(&pdbbase, items, NINSTANCE, ".", NULL))
+        testAbort("Failed to load list with %d threads", nThreads);
+    epicsTimeGetMonotonic(&stop);
+    dbLoadRecordsThreads = 0;
+    testdbCleanup();
+    return epicsTimeDiffInSeconds(&stop, &start);
+}
+
+static void report(const char *what, double elapsed)
+{
+    testDiag("  %-24s %7.3f s, %6.0f k records/s", what, elapsed,
+        RECS_PER_INSTANCE * NINSTANCE / elapsed * 1e-3);
+}
+
+MAIN(benchdbLoad)
+{
+    static const int threads[] = {1, 2, 4, 8};
+    unsigned int i;
+
+    testPlan(0);
+
+    subs = calloc(NINSTANCE, SUBSLEN);
+    items = calloc(NINSTANCE, sizeof(*items));
+    if (!subs || !items)
+        testAbort("Out of memory");
+    for (i = 0; i < NINSTANCE; i++) {
+        epicsSnprintf(subs[i], SUBSLEN, "P=BENCH,N=%05u", i);
+        items[i].filename = TEMPLATE;
+        items[i].substitutions = subs[i];
+    }
+    writeTemplate();
+
+    testDiag("%u records from %u instances, %d CPUs",
+        RECS_PER_INSTANCE * NINSTANCE, NINSTANCE, epicsThreadGetCPUs());
+    report("dbReadDatabase()", timeSerial());
+    for (i = 0; i < NELEMENTS(threads); i++) {
+        char what[40];
+
+        epicsSnprintf(what, sizeof(what), "dbReadDatabaseList() x%d",
+            threads[i]);
+        report(what, timeList(threads[i]));
+    }
+
+    remove(TEMPLATE);
+    free(items);
+    free(subs);
+    return testDone();
+}
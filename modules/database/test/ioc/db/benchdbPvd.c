@@ -0,0 +1,139 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Measure record name lookups per second as the number of records
+ * in the process variable directory grows.  The records are aliases
+ * of a single x record, which is enough to populate the directory.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbDefs.h"
+#include "epicsStdio.h"
+#include "epicsTime.h"
+#include "dbAccess.h"
+#include "dbChannel.h"
+#include "dbStaticLib.h"
+#include "dbUnitTest.h"
+
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NLOOKUP 100000
+#define NAMELEN 32
+
+static char (*names)[NAMELEN];
+
+static void recName(char *buf, unsigned int i)
+{
+    epicsSnprintf(buf, NAMELEN, "BENCH:%07u:rec", i);
+}
+
+static void addRecords(DBENTRY *pentry, unsigned int from, unsigned int to)
+{
+    char name[NAMELEN];
+
+    for (; from < to; from++) {
+        recName(name, from);
+        if (dbCreateAlias(pentry, name))
+            testAbort("Failed to create %s", name);
+    }
+}
+
+/* pick names at random, with miss names from outside [0, nrec) */
+static void pickNames(unsigned int nrec, int miss)
+{
+    unsigned int i;
+
+    for (i = 0; i < NLOOKUP; i++) {
+        unsigned int n = (unsigned int) (rand() % nrec);
+
+        recName(names[i], miss ? nrec + n : n);
+        if (miss)
+            names[i][0] = 'b';
+    }
+}
+
+static double timeLookups(const char *what, int useChannel)
+{
+    DBENTRY entry;
+    epicsTimeStamp start, stop;
+    unsigned int i, found = 0;
+    double elapsed;
+
+    dbInitEntry(pdbbase, &entry);
+    epicsTimeGetMonotonic(&start);
+    for (i = 0; i < NLOOKUP; i++) {
+        if (useChannel)
+            found += !dbChannelTest(names[i]);
+        else
+            found += !dbFindRecord(&entry, names[i]);
+    }
+    epicsTimeGetMonotonic(&stop);
+    dbFinishEntry(&entry);
+
+    elapsed = epicsTimeDiffInSeconds(&stop, &start);
+    testDiag("  %-18s %6.2f M lookups/s (%u found)", what,
+        NLOOKUP / elapsed * 1e-6, found);
+    return elapsed;
+}
+
+static void runBench(unsigned int nrec)
+{
+    testDiag("%u records", nrec);
+
+    pickNames(nrec, 0);
+    timeLookups("dbFindRecord hit", 0);
+    timeLookups("dbChannelTest hit", 1);
+
+    pickNames(nrec, 1);
+    timeLookups("dbFindRecord miss", 0);
+    timeLookups("dbChannelTest miss", 1);
+}
+
+MAIN(benchdbPvd)
+{
+    static const unsigned int sizes[] = {10000, 100000, 1000000};
+    DBENTRY entry;
+    unsigned int i, nrec = 0;
+
+    testPlan(0);
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("xRecord.db", NULL, NULL);
+
+    names = calloc(NLOOKUP, NAMELEN);
+    if (!names)
+        testAbort("Out of memory");
+    srand(42);
+
+    dbInitEntry(pdbbase, &entry);
+    if (dbFindRecord(&entry, "x"))
+        testAbort("No record x");
+
+    for (i = 0; i < NELEMENTS(sizes); i++) {
+        epicsTimeStamp start, stop;
+
+        epicsTimeGetMonotonic(&start);
+        addRecords(&entry, nrec, sizes[i]);
+        epicsTimeGetMonotonic(&stop);
+        testDiag("Added %u records in %.3f s", sizes[i] - nrec,
+            epicsTimeDiffInSeconds(&stop, &start));
+        nrec = sizes[i];
+
+        runBench(nrec);
+    }
+    dbFinishEntry(&entry);
+
+    free(names);
+    testdbCleanup();
+
+    return testDone();
+}
@@ -23,6 +23,7 @@
 #include "epicsThread.h"
 #include "epicsEvent.h"
 #include "epicsTime.h"
+#include "epicsAtomic.h"
 #include "epicsUnitTest.h"
 #include "testMain.h"
 
@@ -37,6 +38,10 @@
  * the immediate callbacks, and the actual delay of the delayed callback.
  *
  * Slow callbacks no longer fail the test, they just emit a diagnostic.
+ *
+ * A final stress step has several threads queue callbacks concurrently
+ * while the parallel callback threads run them, and checks that each
+ * callback ran exactly once.
  */
 
 #define NCALLBACKS 169
@@ -81,6 +86,77 @@ static void finalCallback(epicsCallback *pCallback)
     epicsEventSignal(finished);
 }
 
+#define NPRODUCERS 4
+#define NSTRESS 5000
+
+typedef struct stressPvt {
+    epicsCallback cb;
+    int count;
+} stressPvt;
+
+static stressPvt *stressCbs;
+static int stressDone;
+static epicsEventId stressFinished;
+
+static void stressCallback(epicsCallback *pCallback)
+{
+    stressPvt *pvt;
+
+    callbackGetUser(pvt, pCallback);
+    epicsAtomicIncrIntT(&pvt->count);
+    if (epicsAtomicIncrIntT(&stressDone) == NPRODUCERS * NSTRESS)
+        epicsEventSignal(stressFinished);
+}
+
+static void stressProducer(void *arg)
+{
+    stressPvt *pvt = (stressPvt *) arg;
+    int i;
+
+    for (i = 0; i < NSTRESS; i++)
+        callbackRequest(&pvt[i].cb);
+}
+
+static void testStress(void)
+{
+    int i, missed = 0, repeated = 0;
+
+    testDiag("Queueing %d callbacks from %d threads",
+        NPRODUCERS * NSTRESS, NPRODUCERS);
+
+    stressFinished = epicsEventMustCreate(epicsEventEmpty);
+    stressCbs = callocMustSucceed(NPRODUCERS * NSTRESS, sizeof(stressPvt),
+        "stressCbs");
+    for (i = 0; i < NPRODUCERS * NSTRESS; i++) {
+        callbackSetCallback(stressCallback, &stressCbs[i].cb);
+        callbackSetUser(&stressCbs[i], &stressCbs[i].cb);
+        callbackSetPriority(priorityMedium, &stressCbs[i].cb);
+    }
+
+    for (i = 0; i < NPRODUCERS; i++)
+        epicsThreadMustCreate("stress", epicsThreadPriorityMedium,
+            epicsThreadGetStackSize(epicsThreadStackSmall),
+            stressProducer, &stressCbs[i * NSTRESS]);
+
+    testOk(epicsEventWaitWithTimeout(stressFinished, 30.0) == epicsEventOK,
+        "All stress callbacks were run");
+    epicsThreadSleep(0.1);
+
+    for (i = 0; i < NPRODUCERS * NSTRESS; i++) {
+        int count = epicsAtomicGetIntT(&stressCbs[i].count);
+
+        if (count < 1)
+            missed++;
+        else if (count > 1)
+            repeated++;
+    }
+    testOk(missed == 0 && repeated == 0,
+        "Each callback ran exactly once (%d missed, %d repeated)",
+        missed, repeated);
+
+    epicsEventDestroy(stressFinished);
+}
+
 static void updateStats(double *stats, double val)
 {
     if (stats[0] > val) stats[0] = val;
@@ -111,10 +187,15 @@ MAIN(callbackParallelTest)
         for (j = 0; j < 5; j++)
             setupError[i][j] = timeError[i][j] = defaultError[j];
 
-    testPlan(2);
+    testPlan(4);
 
+    /* at least two consumers per queue for the stress step */
+    if (noCpus < 2)
+        noCpus = 2;
     testDiag("Starting %d parallel callback threads", noCpus);
 
+    /* room for all of the stress callbacks */
+    callbackSetQueueSize(NPRODUCERS * NSTRESS);
     callbackParallelThreads(noCpus, "");
     callbackInit();
     epicsThreadSleep(1.0);
@@ -203,8 +284,11 @@ MAIN(callbackParallelTest)
         free(pcbt[i]);
     }
 
+    testStress();
+
     callbackStop();
     callbackCleanup();
+    free(stressCbs);
 
     return testDone();
 }
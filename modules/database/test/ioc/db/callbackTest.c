@@ -97,6 +97,58 @@ static void printStats(double *stats, const char* tag) {
             sqrt(stats[4]*stats[3]-pow(stats[2], 2.0))/stats[4]);
 }
 
+#define QSIZE 5
+
+static epicsEventId blockerRunning;
+static epicsEventId blockerRelease;
+
+static void blockerCallback(epicsCallback *pCallback)
+{
+    epicsEventMustTrigger(blockerRunning);
+    epicsEventMustWait(blockerRelease);
+}
+
+static void nullCallback(epicsCallback *pCallback) {}
+
+/* A queue size which is not a power of 2 is reported and enforced as is */
+static void testQueueSize(void)
+{
+    epicsCallback blocker, cbs[QSIZE + 1];
+    callbackQueueStats stats;
+    int i, nOk = 0, status;
+
+    testDiag("Queue size %d", QSIZE);
+    blockerRunning = epicsEventMustCreate(epicsEventEmpty);
+    blockerRelease = epicsEventMustCreate(epicsEventEmpty);
+    callbackSetQueueSize(QSIZE);
+    callbackInit();
+
+    callbackSetCallback(blockerCallback, &blocker);
+    callbackSetPriority(priorityLow, &blocker);
+    callbackRequest(&blocker);
+    epicsEventMustWait(blockerRunning);
+
+    for (i = 0; i < QSIZE + 1; i++) {
+        callbackSetCallback(nullCallback, &cbs[i]);
+        callbackSetPriority(priorityLow, &cbs[i]);
+        if (callbackRequest(&cbs[i]) == 0)
+            nOk++;
+    }
+    testOk(nOk == QSIZE, "%d of %d requests queued", nOk, QSIZE + 1);
+    status = callbackQueueStatus(0, &stats);
+    testOk(status == 0 && stats.size == QSIZE &&
+        stats.numUsed[priorityLow] == QSIZE &&
+        stats.numOverflow[priorityLow] == 1,
+        "reported size %d, %d used, %d overflows", stats.size,
+        stats.numUsed[priorityLow], stats.numOverflow[priorityLow]);
+
+    epicsEventMustTrigger(blockerRelease);
+    callbackStop();
+    callbackCleanup();
+    epicsEventDestroy(blockerRunning);
+    epicsEventDestroy(blockerRelease);
+}
+
 MAIN(callbackTest)
 {
     myPvt *pcbt[NCALLBACKS];
@@ -111,7 +163,7 @@ MAIN(callbackTest)
         for (j = 0; j < 5; j++)
             setupError[i][j] = timeError[i][j] = defaultError[j];
 
-    testPlan(2);
+    testPlan(4);
 
     callbackInit();
     epicsThreadSleep(1.0);
@@ -203,5 +255,7 @@ MAIN(callbackTest)
     callbackStop();
     callbackCleanup();
 
+    testQueueSize();
+
     return testDone();
 }
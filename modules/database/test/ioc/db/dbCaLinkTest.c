@@ -610,9 +610,83 @@ static void testCAC(void)
     free(buftarg2);
 }
 
+#define NSHARDLINKS 8
+
+static void testShards(void)
+{
+    struct ca_client_context *context;
+    int i, queued, nchans, total = 0, used = 0, written = 0;
+
+    testDiag("Links spread over 3 worker threads");
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    for (i = 0; i < NSHARDLINKS; i++) {
+        char macros[8];
+
+        epicsSnprintf(macros, sizeof(macros), "N=%d", i);
+        testdbReadDatabase("dbCaLinkTest4.db", NULL, macros);
+    }
+
+    dbCaLinkThreads = 3;
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    for (i = 0; i < NSHARDLINKS; i++) {
+        char name[16];
+        xRecord *psrc;
+
+        epicsSnprintf(name, sizeof(name), "source%d", i);
+        psrc = (xRecord*)testdbRecordPtr(name);
+        testdbCaWaitForConnect(&psrc->lnk);
+    }
+
+    for (i = 0; dbCaWorkerStatus(i, &queued, &nchans, &context) == 0; i++) {
+        testDiag("Worker %d has %d channels, %d queued", i, nchans, queued);
+        total += nchans;
+        if (nchans)
+            used++;
+    }
+    testOp("%d", i, ==, 3);
+    testOp("%d", total, ==, NSHARDLINKS);
+    testOk(used > 1, "Links use %d workers", used);
+
+    for (i = 0; i < NSHARDLINKS; i++) {
+        char name[16];
+        xRecord *psrc, *ptarg;
+        epicsInt32 val = 100 + i;
+
+        epicsSnprintf(name, sizeof(name), "source%d", i);
+        psrc = (xRecord*)testdbRecordPtr(name);
+        epicsSnprintf(name, sizeof(name), "target%d", i);
+        ptarg = (xRecord*)testdbRecordPtr(name);
+
+        dbScanLock((dbCommon*)psrc);
+        if (dbPutLink(&psrc->lnk, DBR_LONG, &val, 1))
+            testAbort("putLink fails for source%d", i);
+        dbScanUnlock((dbCommon*)psrc);
+        dbCaSync();
+
+        dbScanLock((dbCommon*)ptarg);
+        if (ptarg->val == val)
+            written++;
+        dbScanUnlock((dbCommon*)ptarg);
+    }
+    testOp("%d", written, ==, NSHARDLINKS);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+    dbCaLinkThreads = 1;
+}
+
 MAIN(dbCaLinkTest)
 {
-    testPlan(101);
+    testPlan(105);
     testNativeLink();
     testStringLink();
     testCP();
@@ -622,5 +696,6 @@ MAIN(dbCaLinkTest)
     testArrayLink(10,10);
     testreTargetTypeChange();
     testCAC();
+    testShards();
     return testDone();
 }
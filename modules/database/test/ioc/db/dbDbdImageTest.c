@@ -0,0 +1,282 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Tests of DBD images made by dbdToImage.pl, which must restore the
+ * same definitions as parsing the DBD file they were made from.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dbBase.h"
+#include "dbStaticLib.h"
+#include "dbStaticPvt.h"
+#include "epicsString.h"
+#include "epicsTime.h"
+#include "epicsUnitTest.h"
+#include "osiFileName.h"
+#include "testMain.h"
+
+#define DBD_FILE "dbDbdImageTest.dbd"
+#define IMAGE_FILE "dbDbdImageTest.dbdi"
+#define BAD_FILE "dbDbdImageTestBad.dbdi"
+#define PATH "." OSI_PATH_LIST_SEPARATOR ".." OSI_PATH_LIST_SEPARATOR \
+    "../O.Common" OSI_PATH_LIST_SEPARATOR "O.Common"
+
+static const char *mismatch;
+
+static int sameStr(const char *a, const char *b)
+{
+    if (!a || !b)
+        return a == b;
+    return strcmp(a, b) == 0;
+}
+
+#define CHECK(cond, what) if (!(cond)) { mismatch = what; return 0; } else
+
+static int sameMenus(dbBase *pa, dbBase *pb)
+{
+    dbMenu *ma = (dbMenu *) ellFirst(&pa->menuList);
+    dbMenu *mb = (dbMenu *) ellFirst(&pb->menuList);
+
+    for (; ma && mb; ma = (dbMenu *) ellNext(&ma->node),
+                     mb = (dbMenu *) ellNext(&mb->node)) {
+        int i;
+
+        CHECK(sameStr(ma->name, mb->name), "menu name");
+        CHECK(ma->nChoice == mb->nChoice, "menu nChoice");
+        for (i = 0; i < ma->nChoice; i++) {
+            CHECK(sameStr(ma->papChoiceName[i], mb->papChoiceName[i]),
+                "menu choice name");
+            CHECK(sameStr(ma->papChoiceValue[i], mb->papChoiceValue[i]),
+                "menu choice value");
+        }
+    }
+    CHECK(!ma && !mb, "number of menus");
+    return 1;
+}
+
+static int sameField(dbBase *pa, dbBase *pb, dbFldDes *fa, dbFldDes *fb)
+{
+    CHECK(sameStr(fa->name, fb->name), "field name");
+    CHECK(sameStr(fa->prompt, fb->prompt), "field prompt");
+    CHECK(sameStr(fa->extra, fb->extra), "field extra");
+    CHECK(sameStr(fa->initial, fb->initial), "field initial");
+    CHECK(fa->indRecordType == fb->indRecordType, "field index");
+    CHECK(fa->special == fb->special, "field special");
+    CHECK(fa->field_type == fb->field_type, "field type");
+    CHECK(fa->process_passive == fb->process_passive, "field pp");
+    CHECK(fa->prop == fb->prop, "field prop");
+    CHECK(fa->isDevLink == fb->isDevLink, "field isDevLink");
+    CHECK(fa->base == fb->base, "field base");
+    CHECK(sameStr(dbGetPromptGroupNameFromKey(pa, fa->promptgroup),
+        dbGetPromptGroupNameFromKey(pb, fb->promptgroup)),
+        "field promptgroup");
+    CHECK(fa->interest == fb->interest, "field interest");
+    CHECK(fa->as_level == fb->as_level, "field asl");
+    CHECK(fa->size == fb->size, "field size");
+    if (fa->field_type == DBF_MENU) {
+        CHECK(fa->ftPvt && fb->ftPvt &&
+            sameStr(((dbMenu *) fa->ftPvt)->name,
+                ((dbMenu *) fb->ftPvt)->name), "field menu");
+    }
+    return 1;
+}
+
+static int sameRecordtypes(dbBase *pa, dbBase *pb)
+{
+    dbRecordType *ra = (dbRecordType *) ellFirst(&pa->recordTypeList);
+    dbRecordType *rb = (dbRecordType *) ellFirst(&pb->recordTypeList);
+
+    for (; ra && rb; ra = (dbRecordType *) ellNext(&ra->node),
+                     rb = (dbRecordType *) ellNext(&rb->node)) {
+        devSup *da, *db;
+        int i;
+
+        CHECK(sameStr(ra->name, rb->name), "recordtype name");
+        CHECK(ra->no_fields == rb->no_fields, "recordtype no_fields");
+        CHECK(ra->no_prompt == rb->no_prompt, "recordtype no_prompt");
+        CHECK(ra->no_links == rb->no_links, "recordtype no_links");
+        CHECK(ra->indvalFlddes == rb->indvalFlddes, "recordtype VAL");
+        CHECK(ellCount(&ra->attributeList) == ellCount(&rb->attributeList),
+            "recordtype attributes");
+        for (i = 0; i < ra->no_links; i++)
+            CHECK(ra->link_ind[i] == rb->link_ind[i], "recordtype link_ind");
+        for (i = 0; i < ra->no_fields; i++) {
+            CHECK(ra->sortFldInd[i] == rb->sortFldInd[i],
+                "recordtype sortFldInd");
+            CHECK(sameStr(ra->papsortFldName[i], rb->papsortFldName[i]),
+                "recordtype papsortFldName");
+            if (!sameField(pa, pb, ra->papFldDes[i], rb->papFldDes[i]))
+                return 0;
+        }
+
+        da = (devSup *) ellFirst(&ra->devList);
+        db = (devSup *) ellFirst(&rb->devList);
+        for (; da && db; da = (devSup *) ellNext(&da->node),
+                         db = (devSup *) ellNext(&db->node)) {
+            CHECK(sameStr(da->name, db->name), "device dset");
+            CHECK(sameStr(da->choice, db->choice), "device choice");
+            CHECK(da->link_type == db->link_type, "device link type");
+        }
+        CHECK(!da && !db, "number of devices");
+    }
+    CHECK(!ra && !rb, "number of record types");
+    return 1;
+}
+
+static int sameTexts(ELLLIST *la, ELLLIST *lb)
+{
+    dbText *ta = (dbText *) ellFirst(la);
+    dbText *tb = (dbText *) ellFirst(lb);
+
+    for (; ta && tb; ta = (dbText *) ellNext(&ta->node),
+                     tb = (dbText *) ellNext(&tb->node))
+        CHECK(sameStr(ta->text, tb->text), "text");
+    CHECK(!ta && !tb, "number of texts");
+    return 1;
+}
+
+static int sameOthers(dbBase *pa, dbBase *pb)
+{
+    linkSup *la = (linkSup *) ellFirst(&pa->linkList);
+    linkSup *lb = (linkSup *) ellFirst(&pb->linkList);
+    dbVariableDef *va = (dbVariableDef *) ellFirst(&pa->variableList);
+    dbVariableDef *vb = (dbVariableDef *) ellFirst(&pb->variableList);
+    brkTable *ba = (brkTable *) ellFirst(&pa->bptList);
+    brkTable *bb = (brkTable *) ellFirst(&pb->bptList);
+
+    CHECK(ellCount(&pa->drvList) == ellCount(&pb->drvList), "drivers");
+    if (!sameTexts(&pa->registrarList, &pb->registrarList) ||
+        !sameTexts(&pa->functionList, &pb->functionList))
+        return 0;
+
+    for (; la && lb; la = (linkSup *) ellNext(&la->node),
+                     lb = (linkSup *) ellNext(&lb->node)) {
+        CHECK(sameStr(la->name, lb->name), "link name");
+        CHECK(sameStr(la->jlif_name, lb->jlif_name), "link jlif");
+    }
+    CHECK(!la && !lb, "number of links");
+
+    for (; va && vb; va = (dbVariableDef *) ellNext(&va->node),
+                     vb = (dbVariableDef *) ellNext(&vb->node)) {
+        CHECK(sameStr(va->name, vb->name), "variable name");
+        CHECK(sameStr(va->type, vb->type), "variable type");
+    }
+    CHECK(!va && !vb, "number of variables");
+
+    for (; ba && bb; ba = (brkTable *) ellNext(&ba->node),
+                     bb = (brkTable *) ellNext(&bb->node)) {
+        long i;
+
+        CHECK(sameStr(ba->name, bb->name), "breaktable name");
+        CHECK(ba->number == bb->number, "breaktable size");
+        for (i = 0; i < ba->number; i++) {
+            CHECK(ba->paBrkInt[i].raw == bb->paBrkInt[i].raw &&
+                ba->paBrkInt[i].eng == bb->paBrkInt[i].eng &&
+                ba->paBrkInt[i].slope == bb->paBrkInt[i].slope,
+                "breaktable point");
+        }
+    }
+    CHECK(!ba && !bb, "number of breaktables");
+
+    CHECK(ellCount(&pa->guiGroupList) == ellCount(&pb->guiGroupList),
+        "gui groups");
+    return 1;
+}
+
+static double timeLoad(dbBase **ppbase, const char *file, long *pstatus)
+{
+    epicsTimeStamp start, end;
+
+    epicsTimeGetMonotonic(&start);
+    *pstatus = dbReadDatabase(ppbase, file, PATH, NULL);
+    epicsTimeGetMonotonic(&end);
+    return epicsTimeDiffInSeconds(&end, &start);
+}
+
+static void testImage(void)
+{
+    dbBase *pparsed = NULL, *pimage = NULL;
+    double tParse, tImage;
+    long status;
+    int nTypes;
+
+    testDiag("testImage");
+
+    tParse = timeLoad(&pparsed, DBD_FILE, &status);
+    testOk(status == 0, "Parsed " DBD_FILE);
+    tImage = timeLoad(&pimage, IMAGE_FILE, &status);
+    testOk(status == 0, "Restored " IMAGE_FILE);
+    testDiag("Parsing took %.3f ms, restoring %.3f ms",
+        tParse * 1e3, tImage * 1e3);
+    if (!pparsed || !pimage)
+        testAbort("Can't compare");
+
+    testOk(ellCount(&pparsed->recordTypeList) > 0 &&
+        ellCount(&pparsed->bptList) > 0, "Loaded record types and tables");
+
+    if (!testOk1(sameMenus(pparsed, pimage)))
+        testDiag("First difference in %s", mismatch);
+    if (!testOk1(sameRecordtypes(pparsed, pimage)))
+        testDiag("First difference in %s", mismatch);
+    if (!testOk1(sameOthers(pparsed, pimage)))
+        testDiag("First difference in %s", mismatch);
+
+    /* Loading again keeps the existing definitions */
+    nTypes = ellCount(&pimage->recordTypeList);
+    testOk(dbReadDatabase(&pimage, IMAGE_FILE, PATH, NULL) == 0,
+        "Restored " IMAGE_FILE " again");
+    testOk(ellCount(&pimage->recordTypeList) == nTypes,
+        "No new record types");
+    if (!testOk(sameRecordtypes(pparsed, pimage) &&
+            sameOthers(pparsed, pimage), "Definitions unchanged"))
+        testDiag("First difference in %s", mismatch);
+
+    dbFreeBase(pparsed);
+    dbFreeBase(pimage);
+}
+
+static long readBad(const char *content, size_t size)
+{
+    dbBase *pbase = NULL;
+    FILE *out = fopen(BAD_FILE, "wb");
+    long status;
+
+    if (!out)
+        testAbort("Can't create " BAD_FILE);
+    fwrite(content, 1, size, out);
+    fclose(out);
+
+    status = dbReadDatabase(&pbase, BAD_FILE, ".", NULL);
+    dbFreeBase(pbase);
+    remove(BAD_FILE);
+    return status;
+}
+
+static void testBadImage(void)
+{
+    /* One menu with more choices than the image holds */
+    static const char badCount[] =
+        "DBDIMAGE\1\0\0\0\4\0\0\0ab\0\0"
+        "\1\0\0\0\0\0\0\0\5\0\0\0";
+    static const char text[] = "menu(junk) {\n}\n";
+
+    testDiag("testBadImage");
+
+    testOk(readBad(badCount, 8) != 0, "Truncated header is rejected");
+    testOk(readBad(badCount, sizeof(badCount) - 1) != 0,
+        "Bad item count is rejected");
+    testOk(readBad(text, sizeof(text) - 1) != 0,
+        "Text file named like an image is rejected");
+}
+
+MAIN(dbDbdImageTest)
+{
+    testPlan(12);
+    testImage();
+    testBadImage();
+    return testDone();
+}
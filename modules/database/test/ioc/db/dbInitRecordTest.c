@@ -0,0 +1,105 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Tests of dbInitRecordParallel(), which runs init_record() pass 1 on
+ * several threads while keeping the records of a lock set on one of them.
+ * The device init_record() of the x record is called in pass 1.
+ */
+
+#include <string.h>
+
+#include "dbAccess.h"
+#include "dbUnitTest.h"
+#include "epicsThread.h"
+#include "errlog.h"
+#include "iocInit.h"
+#include "testMain.h"
+
+#include "xRecord.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NIND 6
+
+static epicsUInt64 initThread(const char *name)
+{
+    xRecord *prec = (xRecord *)testdbRecordPtr(name);
+
+    return prec->u64;
+}
+
+static void startIoc(void)
+{
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbInitRecordTest.db", NULL, NULL);
+}
+
+static void testParallel(void)
+{
+    epicsUInt64 self = (epicsUInt64)(size_t)epicsThreadGetIdSelf();
+    epicsUInt64 threads[NIND];
+    int i, nDistinct = 0, allSet = 1;
+
+    testDiag("testParallel");
+
+    startIoc();
+    dbInitRecordThreads = 4;
+    eltc(0);
+    testOk(dbInitRecordParallel(NULL, NULL) != 0, "Record type is required");
+    eltc(1);
+    testOk(dbInitRecordParallel("x", "Init Thread") == 0,
+        "Initialize DTYP=\"Init Thread\" in parallel");
+
+    testIocInitOk();
+
+    for (i = 0; i < NIND; i++) {
+        char name[8];
+        int j;
+
+        sprintf(name, "ind%d", i + 1);
+        threads[i] = initThread(name);
+        if (!threads[i])
+            allSet = 0;
+        for (j = 0; j < i && threads[j] != threads[i]; j++);
+        if (j == i)
+            nDistinct++;
+    }
+    testOk(allSet, "All records were initialized");
+    testOk(nDistinct > 1, "Used %d threads", nDistinct);
+
+    testOk(initThread("chain1") != 0 &&
+        initThread("chain1") == initThread("chain2") &&
+        initThread("chain2") == initThread("chain3"),
+        "One thread for the lock set");
+    testOk(initThread("soft") == 0, "Other device not touched");
+    testdbGetFieldEqual("soft", DBR_LONG, 42);
+
+    eltc(0);
+    testOk(dbInitRecordParallel("x", NULL) != 0, "Too late after iocInit");
+    eltc(1);
+    dbInitRecordReport(0);
+
+    testIocShutdownOk();
+    testdbCleanup();
+
+    /* Requests are forgotten, records are initialized serially */
+    startIoc();
+    testIocInitOk();
+    testOk(initThread("ind1") == self && initThread("ind6") == self &&
+        initThread("chain2") == self, "Serial without a request");
+    testIocShutdownOk();
+    testdbCleanup();
+
+    dbInitRecordThreads = 0;
+}
+
+MAIN(dbInitRecordTest)
+{
+    testPlan(9);
+    testParallel();
+    return testDone();
+}
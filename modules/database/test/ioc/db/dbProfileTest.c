@@ -0,0 +1,141 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Tests of the record processing time profiler */
+
+#include <string.h>
+
+#include "dbAccess.h"
+#include "dbLock.h"
+#include "dbProfile.h"
+#include "dbUnitTest.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "testMain.h"
+
+#include "xRecord.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NPROC 5
+#define SLEEP 0.002 /* sec, in prob */
+#define LOCKED 0.05 /* sec, that another thread waits for the lock */
+
+static void slowProcess(xRecord *prec)
+{
+    epicsThreadSleep(SLEEP);
+}
+
+static void processA(void)
+{
+    int i;
+
+    for (i = 0; i < NPROC; i++)
+        testdbPutFieldOk("proa.PROC", DBF_LONG, 1);
+}
+
+static void testCounts(void)
+{
+    dbProfileData a, b;
+
+    testDiag("testCounts");
+
+    testOk(dbProfileGet("proa", &a) != 0, "No counters before enabling");
+    testOk(dbProfileReport(0) != 0, "No report before enabling");
+
+    testOk1(dbProfileEnable(1) == 0);
+    processA();
+
+    testOk1(dbProfileGet("proa", &a) == 0);
+    testOk1(dbProfileGet("prob", &b) == 0);
+    testOk(a.count == NPROC, "proa processed %u times",
+        (unsigned) a.count);
+    testOk(b.count == NPROC, "prob processed %u times",
+        (unsigned) b.count);
+    testOk(b.min >= SLEEP * 0.5e9, "prob min %.3f ms", b.min * 1e-6);
+    testOk(b.min <= b.max, "prob min <= max");
+    testOk(b.self == b.total, "prob self == total, has no children");
+    testOk(a.total >= b.total, "proa total %.3f ms includes prob %.3f ms",
+        a.total * 1e-6, b.total * 1e-6);
+    testOk(a.self < b.self, "proa self %.3f ms excludes prob",
+        a.self * 1e-6);
+    testOk(a.lockCount == 0, "No lock waits");
+
+    testOk1(dbProfileReport(3) == 0);
+
+    testOk1(dbProfileReset() == 0);
+    testOk1(dbProfileGet("proa", &a) == 0);
+    testOk(a.count == 0 && a.total == 0, "proa cleared");
+
+    testOk1(dbProfileEnable(0) == 0);
+    processA();
+    testOk1(dbProfileGet("proa", &a) == 0);
+    testOk(a.count == 0, "Not counted while stopped");
+}
+
+static epicsEventId putDone;
+
+static void putThread(void *arg)
+{
+    epicsInt32 val = 1;
+
+    dbPutField(arg, DBF_LONG, &val, 1);
+    epicsEventMustTrigger(putDone);
+}
+
+static void testLockWait(void)
+{
+    DBADDR addr;
+    dbCommon *prec = testdbRecordPtr("proa");
+    dbProfileData a;
+
+    testDiag("testLockWait");
+
+    testOk1(dbProfileEnable(1) == 0);
+    testOk1(dbProfileReset() == 0);
+
+    if (dbNameToAddr("proa.PROC", &addr))
+        testAbort("No proa.PROC");
+    putDone = epicsEventMustCreate(epicsEventEmpty);
+
+    dbScanLock(prec);
+    epicsThreadMustCreate("profilePut", epicsThreadPriorityMedium,
+        epicsThreadGetStackSize(epicsThreadStackSmall), putThread, &addr);
+    epicsThreadSleep(LOCKED);
+    dbScanUnlock(prec);
+    epicsEventMustWait(putDone);
+
+    testOk1(dbProfileGet("proa", &a) == 0);
+    testOk(a.count == 1, "proa processed %u times", (unsigned) a.count);
+    testOk(a.lockCount == 1, "proa waited %u times for the lock",
+        (unsigned) a.lockCount);
+    testOk(a.lockWait >= LOCKED * 0.5e9, "proa waited %.3f ms",
+        a.lockWait * 1e-6);
+
+    epicsEventDestroy(putDone);
+    testOk1(dbProfileEnable(0) == 0);
+}
+
+MAIN(dbProfileTest)
+{
+    testPlan(37);
+
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbProfileTest.db", NULL, NULL);
+
+    testIocInitOk();
+
+    ((xRecord *) testdbRecordPtr("prob"))->clbk = slowProcess;
+
+    testCounts();
+    testLockWait();
+
+    testIocShutdownOk();
+    testdbCleanup();
+
+    return testDone();
+}
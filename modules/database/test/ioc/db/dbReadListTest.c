@@ -0,0 +1,228 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Tests of dbReadDatabaseList(), which must give the same database with
+ * and without dbLoadRecordsThreads.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbAccess.h"
+#include "dbStaticLib.h"
+#include "dbUnitTest.h"
+#include "errlog.h"
+#include "osiFileName.h"
+#include "testMain.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define PATH "." OSI_PATH_LIST_SEPARATOR ".." OSI_PATH_LIST_SEPARATOR \
+    "../O.Common" OSI_PATH_LIST_SEPARATOR "O.Common"
+#define DUMP_FILE "dbReadListTest.out"
+
+static void startIoc(void)
+{
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+}
+
+static long readListDone(dbReadListItem *items, size_t count, int nThreads,
+    DB_READ_LIST_DONE done)
+{
+    dbLoadRecordsThreads = nThreads;
+    return dbReadDatabaseList(&pdbbase, items, count, PATH, done);
+}
+
+static long readList(dbReadListItem *items, size_t count, int nThreads)
+{
+    return readListDone(items, count, nThreads, NULL);
+}
+
+/* All records and aliases as dbWriteRecord() writes them */
+static char *dumpRecords(void)
+{
+    FILE *fp = fopen(DUMP_FILE, "w+");
+    char *text;
+    long size;
+
+    if (!fp)
+        testAbort("Can't create " DUMP_FILE);
+    dbWriteRecordFP(pdbbase, fp, NULL, 0);
+    size = ftell(fp);
+    text = calloc(1, size + 1);
+    if (!text)
+        testAbort("Out of memory");
+    rewind(fp);
+    if (fread(text, 1, size, fp) != (size_t) size)
+        testAbort("Can't read " DUMP_FILE);
+    fclose(fp);
+    remove(DUMP_FILE);
+    return text;
+}
+
+static int recordExists(const char *name)
+{
+    DBENTRY entry;
+    long status;
+
+    dbInitEntry(pdbbase, &entry);
+    status = dbFindRecord(&entry, name);
+    dbFinishEntry(&entry);
+    return !status;
+}
+
+static void testString(const char *pv, const char *expect)
+{
+    DBENTRY entry;
+    const char *value = NULL;
+
+    dbInitEntry(pdbbase, &entry);
+    if (!dbFindRecord(&entry, pv))
+        value = dbGetString(&entry);
+    testOk(value && !strcmp(value, expect), "%s is \"%s\" (\"%s\")",
+        pv, expect, value ? value : "not found");
+    dbFinishEntry(&entry);
+}
+
+static void testSameResult(void)
+{
+    dbReadListItem items[] = {
+        {"dbReadListTest.db", "N=one"},
+        {"dbReadListTest.db", "N=two"},
+        {"dbReadListTestMore.db", NULL},
+        {"dbReadListTest.db", "N=three"},
+    };
+    char *serial, *parallel;
+    DBENTRY entry;
+    size_t i;
+
+    testDiag("testSameResult");
+
+    startIoc();
+    testOk(readList(items, NELEMENTS(items), 0) == 0, "Read files in turn");
+    serial = dumpRecords();
+    testdbCleanup();
+
+    startIoc();
+    testOk(readList(items, NELEMENTS(items), 3) == 0, "Read with 3 threads");
+    for (i = 0; i < NELEMENTS(items); i++)
+        testOk(items[i].status == 0, "Status of file %u", (unsigned) i);
+    parallel = dumpRecords();
+
+    testOk(!strcmp(serial, parallel), "Same records both ways");
+    free(serial);
+    free(parallel);
+
+    testString("one:a.DESC", "changed");
+    testString("two:a.DESC", "first two");
+    testString("one:b.VAL", "7");
+    testString("three:b.DESC", "tab\there");
+    testString("two:a.INP", "two:b NPP");
+    testOk1(recordExists("three:a:alias"));
+    testOk1(recordExists("two:b:alias"));
+    testOk1(recordExists("one:c"));
+    testOk1(recordExists("more:json"));
+
+    dbInitEntry(pdbbase, &entry);
+    testOk(!dbFindRecord(&entry, "one:a") && !dbFindInfo(&entry, "note") &&
+        !strcmp(dbGetInfoString(&entry), "single \"quoted\""),
+        "Info item of one:a");
+    dbFinishEntry(&entry);
+
+    testdbCleanup();
+}
+
+static void testFailure(void)
+{
+    dbReadListItem items[] = {
+        {"dbReadListTest.db", "N=first"},
+        {"dbReadListTestBad.db", NULL},
+        {"dbReadListTest.db", "N=last"},
+    };
+
+    testDiag("testFailure");
+
+    startIoc();
+    eltc(0);
+    testOk(readList(items, NELEMENTS(items), 2) != 0, "Reading fails");
+    eltc(1);
+    testOk(items[0].status == 0, "First file was read");
+    testOk(items[1].status != 0, "Second file failed");
+    testOk(items[2].status == -1, "Last file wasn't read");
+    testOk1(recordExists("first:c"));
+    testOk1(!recordExists("last:a"));
+    testdbCleanup();
+}
+
+static const char *doneNames[] = {"one:a", "two:a", "three:a"};
+static unsigned doneCount, doneOrdered;
+
+/* Each file must be done after its records were added, and before the
+ * records of the next file.
+ */
+static void checkDone(const dbReadListItem *pitem)
+{
+    unsigned n = doneCount++;
+
+    if (n < NELEMENTS(doneNames) && pitem->status == 0 &&
+        recordExists(doneNames[n]) &&
+        (n + 1 == NELEMENTS(doneNames) || !recordExists(doneNames[n + 1])))
+        doneOrdered++;
+}
+
+static void testDoneOrder(int nThreads)
+{
+    dbReadListItem items[] = {
+        {"dbReadListTest.db", "N=one"},
+        {"dbReadListTest.db", "N=two"},
+        {"dbReadListTest.db", "N=three"},
+    };
+
+    testDiag("testDoneOrder with %d threads", nThreads);
+
+    doneCount = doneOrdered = 0;
+    startIoc();
+    testOk(readListDone(items, NELEMENTS(items), nThreads, checkDone) == 0,
+        "Read files");
+    testOk(doneCount == NELEMENTS(items) && doneOrdered == doneCount,
+        "Each file was done in turn (%u of %u)", doneOrdered, doneCount);
+    testdbCleanup();
+}
+
+static void testRedefined(int nThreads)
+{
+    dbReadListItem items[] = {
+        {"dbReadListTest.db", "N=dup"},
+        {"dbReadListTestType.db", "N=dup"},
+    };
+
+    testDiag("testRedefined with %d threads", nThreads);
+
+    startIoc();
+    eltc(0);
+    testOk(readList(items, NELEMENTS(items), nThreads) != 0,
+        "Redefining a record with another type fails");
+    eltc(1);
+    testOk(items[0].status == 0 && items[1].status != 0,
+        "Second file failed");
+    testString("dup:a.RTYP", "x");
+    testdbCleanup();
+}
+
+MAIN(dbReadListTest)
+{
+    testPlan(33);
+    testSameResult();
+    testFailure();
+    testDoneOrder(0);
+    testDoneOrder(3);
+    testRedefined(0);
+    testRedefined(2);
+    dbLoadRecordsThreads = 0;
+    return testDone();
+}
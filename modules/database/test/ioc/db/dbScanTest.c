@@ -13,7 +13,11 @@
 #include <string.h>
 
 #include "dbScan.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
+#include "epicsThread.h"
+#include "dbLock.h"
+#include "xRecord.h"
 
 #include "dbUnitTest.h"
 #include "testMain.h"
@@ -66,9 +70,104 @@ static void testOnce(void)
     epicsEventDestroy(waiter);
 }
 
+#define NPAR 8
+
+static const char * const parNames[NPAR] = {
+    "par0", "par1", "par2", "par3", "par4", "par5", "par6", "par7"
+};
+
+static epicsThreadId parThread[NPAR+1];
+static int parCount[NPAR+1];
+static int parMismatch;
+static int parSeq;
+static int parLastSeq[NPAR+1];
+static int lateEarly;
+
+static void parProcess(xRecord *prec)
+{
+    int i = prec->val;
+
+    if (!parThread[i])
+        parThread[i] = epicsThreadGetIdSelf();
+    else if (parThread[i] != epicsThreadGetIdSelf())
+        parMismatch = 1;
+    parLastSeq[i] = epicsAtomicIncrIntT(&parSeq);
+    if (i == NPAR) {
+        /* PHAS=1 must come after all PHAS=0 records of this period */
+        int j;
+        for (j = 0; j < NPAR; j++)
+            if (parLastSeq[j] > parLastSeq[NPAR])
+                lateEarly = 1;
+    }
+    epicsAtomicIncrIntT(&parCount[i]);
+}
+
+static void testPeriodicThreads(void)
+{
+    xRecord *precs[NPAR+1];
+    int i, j, nthreads = 0, ok = 1;
+
+    testDiag("check scanPeriodicThreads()");
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbScanTest.db", NULL, NULL);
+
+    testOk1(scanPeriodicThreads(3, 0.1)==0);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    testOk1(scanPeriodicThreads(3, 0.1)!=0);
+
+    for (i = 0; i <= NPAR; i++) {
+        precs[i] = (xRecord*)testdbRecordPtr(i < NPAR ? parNames[i] : "late");
+        dbScanLock((dbCommon*)precs[i]);
+        precs[i]->val = i;
+        precs[i]->clbk = parProcess;
+        dbScanUnlock((dbCommon*)precs[i]);
+    }
+    testOk1(dbLockGetLockId((dbCommon*)precs[6])==dbLockGetLockId((dbCommon*)precs[7]));
+
+    epicsThreadSleep(1.0);
+
+    for (i = 0; i <= NPAR; i++) {
+        dbScanLock((dbCommon*)precs[i]);
+        precs[i]->clbk = NULL;
+        dbScanUnlock((dbCommon*)precs[i]);
+    }
+
+    for (i = 0; i <= NPAR; i++) {
+        int seen = 0;
+
+        if (!epicsAtomicGetIntT(&parCount[i])) {
+            testDiag("%s not processed", precs[i]->name);
+            ok = 0;
+        }
+        for (j = 0; j < i; j++)
+            if (parThread[j] == parThread[i])
+                seen = 1;
+        if (!seen)
+            nthreads++;
+    }
+    testOk1(ok);
+    testOk(nthreads == 3, "processed by %d threads", nthreads);
+    testOk1(parThread[6] == parThread[7]);
+    testOk1(!parMismatch);
+    testOk1(!lateEarly);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+}
+
 MAIN(dbScanTest)
 {
-    testPlan(3);
+    testPlan(11);
     testOnce();
+    testPeriodicThreads();
     return testDone();
 }
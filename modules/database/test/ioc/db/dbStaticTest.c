@@ -13,6 +13,7 @@
 #include <dbStaticPvt.h>
 #include <dbUnitTest.h>
 #include <epicsMath.h>
+#include <epicsStdio.h>
 #include <testMain.h>
 
 static void testEntry(const char *pv)
@@ -340,6 +341,96 @@ static void testSimilarName(const char *input,
     }
 }
 
+static void testPvdGrow(unsigned int n)
+{
+    DBENTRY entry;
+    char name[32];
+    unsigned int i, found;
+    long status = 0;
+
+    testDiag("testPvdGrow(%u)", n);
+
+    dbInitEntry(pdbbase, &entry);
+    if (dbFindRecordType(&entry, "x"))
+        testAbort("No record type x");
+    for (i = 0; i < n && !status; i++) {
+        epicsSnprintf(name, sizeof(name), "pvdrec%u", i);
+        status = dbCreateRecord(&entry, name);
+    }
+    testOk(!status, "Created %u records", i);
+
+    for (i = 0, found = 0; i < n; i++) {
+        epicsSnprintf(name, sizeof(name), "pvdrec%u", i);
+        found += !dbFindRecord(&entry, name);
+    }
+    testOk(found == n, "Found %u of %u records", found, n);
+    testOk(dbFindRecord(&entry, "pvdrec") != 0, "No record pvdrec");
+    testOk(dbFindRecord(&entry, "pvdrec00") != 0, "No record pvdrec00");
+
+    for (i = 0; i < n; i += 2) {
+        epicsSnprintf(name, sizeof(name), "pvdrec%u", i);
+        if (!dbFindRecord(&entry, name))
+            dbDeleteRecord(&entry);
+    }
+    for (i = 0, found = 0; i < n; i++) {
+        epicsSnprintf(name, sizeof(name), "pvdrec%u", i);
+        found += (dbFindRecord(&entry, name) == 0) == (i & 1);
+    }
+    testOk(found == n, "Found only odd records after delete");
+
+    for (i = 0; i < n; i++) {
+        epicsSnprintf(name, sizeof(name), "pvdrec%u", i);
+        if (!dbFindRecord(&entry, name))
+            dbDeleteRecord(&entry);
+    }
+    for (i = 0, found = 0; i < n; i++) {
+        epicsSnprintf(name, sizeof(name), "pvdrec%u", i);
+        found += !dbFindRecord(&entry, name);
+    }
+    testOk(found == 0, "Found %u records after deleting all", found);
+    testOk(!dbFindRecord(&entry, "testrec"), "Found testrec");
+
+    dbFinishEntry(&entry);
+}
+
+/* Names which were looked up before they existed must be found once
+ * they are added, also while the directory grows. */
+static void testPvdLateAlias(unsigned int n)
+{
+    DBENTRY entry, lookup;
+    char name[32];
+    unsigned int i, missed, found;
+    long status = 0;
+
+    testDiag("testPvdLateAlias(%u)", n);
+
+    dbInitEntry(pdbbase, &entry);
+    dbInitEntry(pdbbase, &lookup);
+    for (i = 0, missed = 0; i < n; i++) {
+        epicsSnprintf(name, sizeof(name), "latealias%u", i);
+        missed += dbFindRecord(&lookup, name) != 0;
+    }
+    testOk(missed == n, "%u of %u aliases not found before they exist",
+        missed, n);
+
+    if (dbFindRecord(&entry, "testrec"))
+        testAbort("No record testrec");
+    for (i = 0; i < n && !status; i++) {
+        epicsSnprintf(name, sizeof(name), "latealias%u", i);
+        status = dbCreateAlias(&entry, name);
+    }
+    testOk(!status, "Created %u aliases", i);
+
+    for (i = 0, found = 0; i < n; i++) {
+        epicsSnprintf(name, sizeof(name), "latealias%u.VAL", i);
+        found += !dbFindRecord(&lookup, name);
+    }
+    testOk(found == n, "Found %u of %u aliases", found, n);
+
+    dbFinishEntry(&lookup);
+    dbFinishEntry(&entry);
+}
+
 void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
 
 MAIN(dbStaticTest)
@@ -347,7 +438,7 @@ MAIN(dbStaticTest)
     const char *ldir;
     FILE *fp = NULL;
 
-    testPlan(320);
+    testPlan(330);
     testdbPrepare();
 
     testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
@@ -378,6 +469,10 @@ MAIN(dbStaticTest)
     testRec2Entry("testalias2");
     testRec2Entry("testalias3");
 
+    /* far more than the initial directory size */
+    testPvdGrow(5000);
+    testPvdLateAlias(5000);
+
     eltc(0);
     testIocInitOk();
     eltc(1);
@@ -10,6 +10,7 @@
 #include <stdio.h>
 
 #include <epicsAssert.h>
+#include <epicsThread.h>
 #include <cantProceed.h>
 #include <ellLib.h>
 #include <dbDefs.h>
@@ -160,3 +161,24 @@ static struct xdset devxSoft = {
     &xsoft_read
 };
 epicsExportAddress(dset, devxSoft);
+
+/* DTYP="Init Thread"
+ *
+ * init_record() sleeps for F64 seconds, then saves the id of the
+ * thread it ran on in U64.
+ */
+static long xthread_init_record(xRecord *prec)
+{
+    if (prec->f64 > 0.0)
+        epicsThreadSleep(prec->f64);
+    prec->u64 = (epicsUInt64)(size_t)epicsThreadGetIdSelf();
+    return 0;
+}
+
+static struct xdset devxInitThread = {
+    5, NULL, NULL,
+    &xthread_init_record,
+    NULL,
+    NULL
+};
+epicsExportAddress(dset, devxInitThread);
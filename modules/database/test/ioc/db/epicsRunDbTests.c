@@ -27,8 +27,12 @@ int dbShutdownTest(void);
 int dbScanTest(void);
 int scanIoTest(void);
 int dbLockTest(void);
+int dbProfileTest(void);
+int dbInitRecordTest(void);
 int dbPutLinkTest(void);
 int dbStaticTest(void);
+int dbDbdImageTest(void);
+int dbReadListTest(void);
 int dbCaLinkTest(void);
 int dbDbLinkTest(void);
 int testDbChannel(void);
@@ -50,8 +54,12 @@ void epicsRunDbTests(void)
     runTest(dbScanTest);
     runTest(scanIoTest);
     runTest(dbLockTest);
+    runTest(dbProfileTest);
+    runTest(dbInitRecordTest);
     runTest(dbPutLinkTest);
     runTest(dbStaticTest);
+    runTest(dbDbdImageTest);
+    runTest(dbReadListTest);
     runTest(dbCaLinkTest);
     runTest(dbDbLinkTest);
     runTest(testDbChannel);
@@ -6,11 +6,14 @@
 * in file LICENSE that is included with this distribution.
 \*************************************************************************/
 #include "string.h"
+#include <float.h>
 
 #include "cantProceed.h"
 #include "dbConvert.h"
 #include "dbDefs.h"
 #include "epicsAssert.h"
+#include "epicsConvert.h"
+#include "epicsMath.h"
 
 #include "epicsUnitTest.h"
 #include "testMain.h"
@@ -149,10 +152,97 @@ static void testBasicPut(void)
     free(scratch);
 }
 
+static void testConvertWrap(void)
+{
+    double dbuf[NELEMENTS(s_input)+1];
+    short sbuf[NELEMENTS(s_input)];
+    DBADDR addr;
+    GETCONVERTFUNC getter = dbGetConvertRoutine[DBF_SHORT][DBF_DOUBLE];
+    PUTCONVERTFUNC putter = dbPutConvertRoutine[DBF_DOUBLE][DBF_SHORT];
+    long i;
+    int ok;
+
+    testDiag("Test conversions with wrap, DBF_SHORT <-> DBR_DOUBLE");
+
+    memset(&addr, 0, sizeof(addr));
+    addr.field_type = DBF_SHORT;
+    addr.field_size = sizeof(short);
+    addr.no_elements = s_input_len;
+    addr.pfield = (void*)s_input;
+
+    for (i=0; i<=s_input_len; i++)
+        dbuf[i] = 42.0;
+    getter(&addr, dbuf, s_input_len, s_input_len, 0);
+    for (ok=1, i=0; i<s_input_len; i++)
+        ok &= dbuf[i] == s_input[i];
+    testOk(ok && dbuf[s_input_len]==42.0, "Get entire array");
+
+    getter(&addr, dbuf, s_input_len, s_input_len, 3);
+    for (ok=1, i=0; i<s_input_len; i++)
+        ok &= dbuf[i] == s_input[(i+3) % s_input_len];
+    testOk(ok && dbuf[s_input_len]==42.0, "Get entire array with wrap");
+
+    dbuf[2] = 42.0;
+    getter(&addr, dbuf, 2, s_input_len, s_input_len-1);
+    testOk(dbuf[0]==s_input[6] && dbuf[1]==s_input[0] && dbuf[2]==42.0,
+           "Get across the end");
+
+    addr.pfield = (void*)sbuf;
+    for (i=0; i<s_input_len; i++)
+        dbuf[i] = s_input[i];
+
+    memset(sbuf, 0x42, sizeof(sbuf));
+    putter(&addr, dbuf, s_input_len, s_input_len, 0);
+    testOk1(memcmp(sbuf, s_input, sizeof(sbuf))==0);
+
+    memset(sbuf, 0x42, sizeof(sbuf));
+    putter(&addr, dbuf, 3, s_input_len, s_input_len-1);
+    testOk(sbuf[6]==s_input[0] && sbuf[0]==s_input[1] &&
+           sbuf[1]==s_input[2] && sbuf[2]==0x4242, "Put across the end");
+}
+
+static void testDoubleToFloat(void)
+{
+    static const double input[] = {0.0, -0.0, 1.5, -2.5, 1e300, -1e300,
+                                   1e-300, -1e-300, FLT_MAX, -FLT_MIN};
+    double in[NELEMENTS(input)+3];
+    float expect[NELEMENTS(in)], got[NELEMENTS(in)];
+    const long n = NELEMENTS(in);
+    DBADDR addr;
+    long i;
+
+    testDiag("Test DBF_DOUBLE <-> DBR_FLOAT clamps like epicsConvertDoubleToFloat()");
+
+    memcpy(in, input, sizeof(input));
+    in[n-3] = epicsINF;
+    in[n-2] = -epicsINF;
+    in[n-1] = epicsNAN;
+    for (i=0; i<n; i++)
+        expect[i] = epicsConvertDoubleToFloat(in[i]);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.field_type = DBF_DOUBLE;
+    addr.field_size = sizeof(double);
+    addr.no_elements = n;
+    addr.pfield = (void*)in;
+
+    dbGetConvertRoutine[DBF_DOUBLE][DBF_FLOAT](&addr, got, n, n, 0);
+    testOk1(memcmp(got, expect, sizeof(got))==0);
+
+    addr.field_type = DBF_FLOAT;
+    addr.field_size = sizeof(float);
+    addr.pfield = (void*)got;
+    memset(got, 0, sizeof(got));
+    dbPutConvertRoutine[DBF_DOUBLE][DBF_FLOAT](&addr, in, n, n, 0);
+    testOk1(memcmp(got, expect, sizeof(got))==0);
+}
+
 MAIN(testdbConvert)
 {
-    testPlan(15);
+    testPlan(22);
     testBasicGet();
     testBasicPut();
+    testConvertWrap();
+    testDoubleToFloat();
     return testDone();
 }
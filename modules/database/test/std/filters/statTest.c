@@ -0,0 +1,312 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Tests of the statistics filter "stat".
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "dbStaticLib.h"
+#include "dbAccessDefs.h"
+#include "db_field_log.h"
+#include "dbCommon.h"
+#include "dbChannel.h"
+#include "registry.h"
+#include "chfPlugin.h"
+#include "errlog.h"
+#include "dbmf.h"
+#include "alarm.h"
+#include "caeventmask.h"
+#include "epicsUnitTest.h"
+#include "dbUnitTest.h"
+#include "epicsTime.h"
+#include "epicsStdio.h"
+#include "testMain.h"
+#include "osiFileName.h"
+
+void filterTest_registerRecordDeviceDriver(struct dbBase *);
+
+static epicsTimeStamp start;
+
+static void fl_setup(dbChannel *chan, db_field_log *pfl, long val,
+                     double dt) {
+    struct dbCommon  *prec = dbChannelRecord(chan);
+
+    memset(pfl, 0, sizeof(db_field_log));
+    pfl->ctx  = dbfl_context_event;
+    pfl->type = dbfl_type_val;
+    pfl->mask = DBE_VALUE | DBE_LOG;
+    pfl->stat = prec->stat;
+    pfl->sevr = prec->sevr;
+    pfl->time = start;
+    epicsTimeAddSeconds(&pfl->time, dt);
+    pfl->field_type  = DBF_LONG;
+    pfl->field_size  = sizeof(epicsInt32);
+    pfl->no_elements = 1;
+    pfl->u.v.field.dbf_long = val;
+    pfl->post_id = 1 + val;
+}
+
+static void testHead (char* title) {
+    testDiag("--------------------------------------------------------");
+    testDiag("%s", title);
+    testDiag("--------------------------------------------------------");
+}
+
+static void mustDrop(dbChannel *pch, db_field_log *pfl, char* m) {
+    int oldFree = db_available_logs();
+    db_field_log *pfl2 = dbChannelRunPreChain(pch, pfl);
+    int newFree = db_available_logs();
+
+    testOk(NULL == pfl2, "filter drops field_log (%s)", m);
+    testOk(newFree == oldFree + 1, "field_log was freed - %d+1 => %d",
+        oldFree, newFree);
+
+    db_delete_field_log(pfl2);
+}
+
+static void mustPass(dbChannel *pch, db_field_log *pfl, char* m) {
+    int oldFree = db_available_logs();
+    db_field_log *pfl2 = dbChannelRunPreChain(pch, pfl);
+    int newFree = db_available_logs();
+
+    testOk(pfl == pfl2 && pfl2->field_type == DBF_LONG,
+        "filter passes field_log unchanged (%s)", m);
+    testOk(newFree == oldFree, "field_log was not freed - %d => %d",
+        oldFree, newFree);
+
+    db_delete_field_log(pfl2);
+}
+
+static void mustSend(dbChannel *pch, db_field_log *pfl, double expect,
+                     char* m) {
+    db_field_log *pfl2 = dbChannelRunPreChain(pch, pfl);
+
+    testOk(pfl == pfl2, "filter sends field_log (%s)", m);
+    if (pfl2) {
+        testOk(pfl2->field_type == DBF_DOUBLE &&
+            fabs(pfl2->u.v.field.dbf_double - expect) < 1e-4,
+            "value is a double %g (expected %g)",
+            pfl2->u.v.field.dbf_double, expect);
+        testOk(pfl2->post_id == 0, "post_id was cleared");
+    } else {
+        testFail("no value");
+        testFail("no post_id");
+    }
+
+    db_delete_field_log(pfl2);
+}
+
+static void checkAndOpenChannel(dbChannel *pch, const chFilterPlugin *plug) {
+    ELLNODE *node;
+    chFilter *filter;
+    chPostEventFunc *cb_out = NULL;
+    void *arg_out = NULL;
+    db_field_log fl;
+
+    testDiag("Test filter structure and open channel");
+
+    testOk((ellCount(&pch->filters) == 1), "channel has one plugin");
+
+    fl_setup(pch, &fl, 1, 0);
+    node = ellFirst(&pch->filters);
+    filter = CONTAINER(node, chFilter, list_node);
+    plug->fif->channel_register_pre(filter, &cb_out, &arg_out, &fl);
+    testOk(cb_out && arg_out,
+        "register_pre registers one filter with argument");
+    testOk(fl.field_type == DBF_DOUBLE && fl.field_size == sizeof(double),
+        "register_pre changes field_log data type to double");
+
+    testOk(!(dbChannelOpen(pch)), "dbChannel with plugin stat opened");
+    node = ellFirst(&pch->pre_chain);
+    filter = CONTAINER(node, chFilter, pre_node);
+    testOk((ellCount(&pch->pre_chain) == 1 && filter->pre_arg != NULL),
+        "stat has one filter with argument in pre chain");
+    testOk((ellCount(&pch->post_chain) == 0),
+        "stat has no filter in post chain");
+    testOk(dbChannelFinalFieldType(pch) == DBF_DOUBLE,
+        "channel has type DBF_DOUBLE");
+}
+
+/* Send 1, 2, 3, 6 through a window of 4 samples */
+static void testStatistic(const chFilterPlugin *plug, const char *kind,
+                          double expect) {
+    char name[80];
+    dbChannel *pch;
+    db_field_log *pfl[4];
+    int i;
+
+    epicsSnprintf(name, sizeof(name), "x.VAL{stat:{n:4,s:\"%s\"}}", kind);
+    testHead(name);
+    testOk(!!(pch = dbChannelCreate(name)),
+           "dbChannel with plugin stat (s=%s) created", kind);
+    if (!pch)
+        return;
+
+    checkAndOpenChannel(pch, plug);
+
+    for (i = 0; i < 4; i++) {
+        pfl[i] = db_create_read_log(pch);
+        fl_setup(pch, pfl[i], i < 3 ? i + 1 : 6, i);
+    }
+
+    mustDrop(pch, pfl[0], "i=0");
+    mustDrop(pch, pfl[1], "i=1");
+    mustDrop(pch, pfl[2], "i=2");
+    mustSend(pch, pfl[3], expect, "i=3");
+
+    dbChannelDelete(pch);
+}
+
+MAIN(statTest)
+{
+    dbChannel *pch;
+    const chFilterPlugin *plug;
+    char myname[] = "stat";
+    db_field_log *pfl[10];
+    int i, logsFree, logsFinal;
+    dbEventCtx evtctx;
+
+    testPlan(164);
+
+    testdbPrepare();
+
+    testdbReadDatabase("filterTest.dbd", NULL, NULL);
+
+    filterTest_registerRecordDeviceDriver(pdbbase);
+
+    testdbReadDatabase("xRecord.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    evtctx = db_init_events();
+    epicsTimeGetCurrent(&start);
+
+    plug = dbFindFilter(myname, strlen(myname));
+    if (!plug)
+        testAbort("Plugin '%s' not registered", myname);
+    testPass("plugin '%s' registered correctly", myname);
+
+    /* Bad parms */
+    testOk(!(pch = dbChannelCreate("x.VAL{stat:{}}")),
+           "dbChannel with stat (no parm) failed");
+    testOk(!(pch = dbChannelCreate("x.VAL{stat:{n:-1}}")),
+           "dbChannel with stat (n=-1) failed");
+    testOk(!(pch = dbChannelCreate("x.VAL{stat:{t:-1}}")),
+           "dbChannel with stat (t=-1) failed");
+    testOk(!(pch = dbChannelCreate("x.VAL{stat:{n:4,s:\"median\"}}")),
+           "dbChannel with stat (s=median) failed");
+
+    /* Default statistic is the mean */
+
+    testHead("Mean of 2 samples (n=2)");
+    testOk(!!(pch = dbChannelCreate("x.VAL{stat:{n:2}}")),
+           "dbChannel with plugin stat (n=2) created");
+
+    /* Start the free-list */
+    db_delete_field_log(db_create_read_log(pch));
+    logsFree = db_available_logs();
+    testDiag("%d field_logs on free-list", logsFree);
+
+    checkAndOpenChannel(pch, plug);
+
+    for (i = 0; i < 6; i++) {
+        pfl[i] = db_create_read_log(pch);
+        fl_setup(pch, pfl[i], 10 + 3 * i, i);
+    }
+
+    testDiag("Test event stream");
+
+    mustDrop(pch, pfl[0], "i=0");
+    mustSend(pch, pfl[1], 11.5, "i=1");
+    mustDrop(pch, pfl[2], "i=2");
+    mustSend(pch, pfl[3], 17.5, "i=3");
+
+    testDiag("Reads and property updates pass unchanged");
+    pfl[4]->ctx = dbfl_context_read;
+    mustPass(pch, pfl[4], "read");
+    pfl[5]->mask = DBE_PROPERTY;
+    mustPass(pch, pfl[5], "property");
+
+    dbChannelDelete(pch);
+
+    testDiag("%d field_logs on free-list", db_available_logs());
+
+    testStatistic(plug, "mean", 3.0);
+    testStatistic(plug, "min", 1.0);
+    testStatistic(plug, "max", 6.0);
+    testStatistic(plug, "rms", sqrt(12.5));
+    testStatistic(plug, "std", sqrt(3.5));
+    testStatistic(plug, "p2p", 5.0);
+
+    /* Time window */
+
+    testHead("Time window (t=1)");
+    testOk(!!(pch = dbChannelCreate("x.VAL{stat:{t:1,s:\"max\"}}")),
+           "dbChannel with plugin stat (t=1) created");
+
+    checkAndOpenChannel(pch, plug);
+
+    for (i = 0; i < 6; i++) {
+        pfl[i] = db_create_read_log(pch);
+        fl_setup(pch, pfl[i], 100 - i, 0.4 * i);
+    }
+
+    testDiag("Test event stream");
+
+    mustDrop(pch, pfl[0], "t=0.0");
+    mustDrop(pch, pfl[1], "t=0.4");
+    mustDrop(pch, pfl[2], "t=0.8");
+    mustSend(pch, pfl[3], 100.0, "t=1.2");
+    mustDrop(pch, pfl[4], "t=1.6");
+    mustDrop(pch, pfl[5], "t=2.0");
+
+    dbChannelDelete(pch);
+
+    /* Severity */
+
+    testHead("Highest severity of the window (n=3)");
+    testOk(!!(pch = dbChannelCreate("x.VAL{stat:{n:3}}")),
+           "dbChannel with plugin stat (n=3) created");
+
+    checkAndOpenChannel(pch, plug);
+
+    for (i = 0; i < 3; i++) {
+        pfl[i] = db_create_read_log(pch);
+        fl_setup(pch, pfl[i], 1, i);
+        pfl[i]->stat = NO_ALARM;
+        pfl[i]->sevr = NO_ALARM;
+    }
+    pfl[1]->stat = HIHI_ALARM;
+    pfl[1]->sevr = MAJOR_ALARM;
+
+    mustDrop(pch, pfl[0], "i=0");
+    mustDrop(pch, pfl[1], "i=1 MAJOR");
+    {
+        db_field_log *pfl2 = dbChannelRunPreChain(pch, pfl[2]);
+
+        testOk(pfl2 && pfl2->sevr == MAJOR_ALARM && pfl2->stat == HIHI_ALARM,
+               "window result has MAJOR severity");
+        db_delete_field_log(pfl2);
+    }
+
+    dbChannelDelete(pch);
+
+    logsFinal = db_available_logs();
+    testOk(logsFree == logsFinal, "%d field_logs on free-list", logsFinal);
+
+    db_close_events(evtctx);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+
+    return testDone();
+}
@@ -6,10 +6,12 @@
 * in file LICENSE that is included with this distribution.
  \*************************************************************************/
 
+#include <stdio.h>
 #include <string.h>
 
 #include "dbAccess.h"
 #include "dbTest.h"
+#include "caeventmask.h"
 
 #include "dbUnitTest.h"
 #include "errlog.h"
@@ -142,9 +144,69 @@ static void testGetPutArray(void)
     testdbCleanup();
 }
 
+/* Put a value and check whether the record posted it */
+static void putCheckPost(testMonitor *mon, const char *pv, unsigned long count,
+                         const epicsInt32 *val, int post)
+{
+    testdbPutArrFieldOk(pv, DBF_LONG, count, val);
+    if (post)
+        testMonitorWait(mon);
+    testOk(testMonitorCount(mon, 1) == !!post, "%s %s", pv,
+           post ? "posted" : "didn't post");
+}
+
+static void testOnChange(const char *rec)
+{
+    static const epicsInt32 abc[] = {1, 2, 3}, abd[] = {1, 2, 4};
+    char pv[40];
+    testMonitor *mon;
+
+    testDiag("Test On Change posting of %s", rec);
+
+    sprintf(pv, "%s.VAL", rec);
+    mon = testMonitorCreate(pv, DBE_VALUE | DBE_LOG, 0);
+
+    sprintf(pv, "%s.PROC", rec);
+    testdbPutFieldOk(pv, DBF_LONG, 1);
+    testOk(testMonitorCount(mon, 1) == 0, "Empty array not posted");
+
+    sprintf(pv, "%s.VAL", rec);
+    putCheckPost(mon, pv, 3, abc, 1);
+    putCheckPost(mon, pv, 3, abc, 0);
+    putCheckPost(mon, pv, 3, abd, 1);
+    putCheckPost(mon, pv, 2, abd, 1);
+    putCheckPost(mon, pv, 2, abc, 0);
+
+    testMonitorDestroy(mon);
+}
+
+static void testOnChangePosting(void)
+{
+    testdbPrepare();
+
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    testdbReadDatabase("arrayOpTest.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    testOnChange("wfchg");
+    testOnChange("aaichg");
+    testOnChange("aaochg");
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+}
+
 MAIN(arrayOpTest)
 {
-    testPlan(15);
+    testPlan(51);
     testGetPutArray();
+    testOnChangePosting();
     return testDone();
 }
@@ -0,0 +1,197 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Tests of array snapshots, which let the monitors of an array record
+ * share one immutable copy of each posted value.
+ */
+
+#include <string.h>
+
+#include "epicsEvent.h"
+#include "dbAccess.h"
+#include "dbArrayBuf.h"
+#include "dbChannel.h"
+#include "dbEvent.h"
+#include "db_field_log.h"
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+#include "waveformRecord.h"
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NUPD 5
+#define NELM 8
+
+typedef struct update {
+    void *field;
+    int snapshot;
+    size_t post_id;
+    long n;
+    epicsInt32 val[NELM];
+} update;
+
+typedef struct sub {
+    const char *name;
+    dbChannel *chan;
+    dbEventSubscription es;
+    int count;
+    update upd[NUPD];
+} sub;
+
+static sub subs[] = {
+    {"src"}, {"src"},
+    {"wf"}, {"wf"},
+    {"sa"}, {"sa"},
+    {"aai"}, {"aai"},
+    {"cmp"},
+    {"wf.VAL{\"arr\":{\"s\":1,\"e\":2}}"},
+};
+#define NSUBS NELEMENTS(subs)
+#define SUB_CMP 8
+#define SUB_ARR 9
+
+static epicsEventId allDone;
+static int expected;
+static int received;
+
+static void gotUpdate(void *user_arg, struct dbChannel *chan,
+                      int eventsRemaining, struct db_field_log *pfl)
+{
+    sub *psub = (sub *) user_arg;
+
+    if (psub->count < NUPD && pfl) {
+        update *pupd = &psub->upd[psub->count];
+
+        pupd->field = pfl->u.r.field;
+        pupd->snapshot = pfl->dtor == dbArrayBufFreeLog;
+        pupd->post_id = pfl->post_id;
+        pupd->n = NELM;
+        if (dbChannelGet(chan, DBR_LONG, pupd->val, NULL, &pupd->n, pfl))
+            pupd->n = -1;
+    }
+    psub->count++;
+    if (++received == expected)
+        epicsEventMustTrigger(allDone);
+}
+
+static void checkValue(const sub *psub, int i, long n, const epicsInt32 *val)
+{
+    const update *pupd = &psub->upd[i];
+
+    testOk(pupd->n == n && !memcmp(pupd->val, val, n * sizeof(*val)),
+        "%s update %d has %ld elements %d...", psub->name, i, n, val[0]);
+}
+
+static void putArray(const char *pv, epicsInt32 first)
+{
+    epicsInt32 val[3];
+
+    val[0] = first;
+    val[1] = first + 1;
+    val[2] = first + 2;
+    testdbPutArrFieldOk(pv, DBF_LONG, 3, val);
+}
+
+MAIN(arraySnapshotTest)
+{
+    static const epicsInt32 first[] = {1, 2, 3}, second[] = {4, 5, 6};
+    dbEventCtx evtctx;
+    waveformRecord *pwf;
+    unsigned i;
+
+    testPlan(36);
+
+    testdbPrepare();
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("arraySnapshotTest.db", NULL, NULL);
+
+    dbArraySnapshots = 1;
+    testIocInitOk();
+
+    pwf = (waveformRecord *) testdbRecordPtr("wf");
+
+    /* Subscribe without running the event task, so both updates of each
+     * record are queued before any is sent.
+     */
+    allDone = epicsEventMustCreate(epicsEventEmpty);
+    evtctx = db_init_events();
+    if (!evtctx)
+        testAbort("Failed to create event context");
+    for (i = 0; i < NSUBS; i++) {
+        subs[i].chan = dbChannelCreate(subs[i].name);
+        if (!subs[i].chan || dbChannelOpen(subs[i].chan))
+            testAbort("Failed to open %s", subs[i].name);
+        subs[i].es = db_add_event(evtctx, subs[i].chan, gotUpdate, &subs[i],
+            DBE_VALUE);
+        if (!subs[i].es)
+            testAbort("Failed to subscribe to %s", subs[i].name);
+        db_event_enable(subs[i].es);
+    }
+
+    putArray("src", 1);
+    putArray("src", 4);
+    for (i = 1; i <= NUPD; i++)
+        testdbPutFieldOk("in", DBF_LONG, i);
+    expected = 2 * (NSUBS - 2) + NUPD + 2;
+
+    if (db_start_events(evtctx, "arraySnapshotTest", NULL, NULL,
+                        epicsThreadPriorityLow))
+        testAbort("Failed to start event task");
+    testOk(epicsEventWaitWithTimeout(allDone, 10.0) == epicsEventOK,
+        "Received %d updates", expected);
+
+    testDiag("Records updated by a put and by processing");
+    for (i = 0; i < SUB_CMP; i += 2) {
+        checkValue(&subs[i], 0, 3, first);
+        checkValue(&subs[i + 1], 0, 3, first);
+        checkValue(&subs[i], 1, 3, second);
+        testOk(subs[i].upd[0].snapshot &&
+            subs[i].upd[0].field == subs[i + 1].upd[0].field,
+            "%s subscribers share a snapshot", subs[i].name);
+        testOk(subs[i].upd[0].field != subs[i].upd[1].field,
+            "%s changed a copy of the snapshot", subs[i].name);
+    }
+    testOk(pwf->bptr == subs[2].upd[1].field, "wf has the last snapshot");
+    testOk(subs[0].upd[0].post_id &&
+        subs[0].upd[0].post_id == subs[1].upd[0].post_id,
+        "src subscribers share a post_id");
+
+    testDiag("Circular buffer");
+    {
+        static const epicsInt32 one[] = {1}, all[] = {2, 3, 4, 5};
+
+        checkValue(&subs[SUB_CMP], 0, 1, one);
+        checkValue(&subs[SUB_CMP], 4, 4, all);
+        testOk1(subs[SUB_CMP].upd[4].snapshot);
+        testOk(subs[SUB_CMP].upd[0].post_id == 0,
+            "cmp has one subscriber, no post_id");
+    }
+
+    testDiag("arr filter");
+    {
+        static const epicsInt32 part[] = {2, 3};
+        const sub *parr = &subs[SUB_ARR];
+
+        checkValue(parr, 0, 2, part);
+        testOk(parr->upd[0].snapshot && parr->upd[0].field ==
+            (char *) subs[2].upd[0].field + sizeof(epicsInt32),
+            "arr narrows the snapshot without copying");
+    }
+
+    for (i = 0; i < NSUBS; i++) {
+        db_cancel_event(subs[i].es);
+        dbChannelDelete(subs[i].chan);
+    }
+    db_close_events(evtctx);
+    epicsEventDestroy(allDone);
+
+    testIocShutdownOk();
+    testdbCleanup();
+    dbArraySnapshots = 0;
+
+    return testDone();
+}
@@ -0,0 +1,134 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Measure monitor updates of a 1M element waveform with 20 subscribers,
+ * each through a ts filter, which copies the array for every subscriber
+ * unless the record shares it as a snapshot (dbArraySnapshots).
+ *
+ * "keeping up" waits for all updates to be delivered after each post,
+ * "queued" posts twice before waiting, so the second write finds the
+ * first value still in use.
+ */
+#include "cantProceed.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "dbAccess.h"
+#include "dbArrayBuf.h"
+#include "dbChannel.h"
+#include "dbEvent.h"
+#include "dbLock.h"
+#include "dbUnitTest.h"
+#include "caeventmask.h"
+#include "waveformRecord.h"
+
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NELM 1000000
+#define NSUBS 20
+#define NITER 50
+
+static epicsEventId delivered;
+static int received, expected;
+
+static void countEvent(void *user_arg, struct dbChannel *chan,
+                       int eventsRemaining, struct db_field_log *pfl)
+{
+    if (++received == expected)
+        epicsEventMustTrigger(delivered);
+}
+
+/* Change the array as record support would, then post it */
+static void post(waveformRecord *prec, double value)
+{
+    dbScanLock((dbCommon *) prec);
+    dbArrayBufPrepareWrite((dbCommon *) prec, NELM * sizeof(double));
+    ((double *) prec->bptr)[0] = value;
+    db_post_events(prec, &prec->val, DBE_VALUE);
+    dbScanUnlock((dbCommon *) prec);
+}
+
+static double timeUpdates(waveformRecord *prec, int nposts)
+{
+    epicsTimeStamp start, stop;
+    int i, j;
+
+    epicsTimeGetMonotonic(&start);
+    for (i = 0; i < NITER; i++) {
+        received = 0;
+        expected = NSUBS * nposts;
+        for (j = 0; j < nposts; j++)
+            post(prec, i + j);
+        epicsEventMustWait(delivered);
+    }
+    epicsTimeGetMonotonic(&stop);
+    return epicsTimeDiffInSeconds(&stop, &start) / (NITER * nposts);
+}
+
+static void runBench(int snapshots)
+{
+    dbChannel *chans[NSUBS];
+    dbEventSubscription subs[NSUBS];
+    dbEventCtx evtctx;
+    waveformRecord *prec;
+    int i;
+
+    testdbPrepare();
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("benchdbArraySnapshot.db", NULL, NULL);
+
+    dbArraySnapshots = snapshots;
+    testIocInitOk();
+
+    prec = (waveformRecord *) testdbRecordPtr("bench");
+    prec->nord = NELM;
+
+    evtctx = db_init_events();
+    if (!evtctx || db_start_events(evtctx, "benchdbArraySnapshot", NULL,
+                                   NULL, epicsThreadPriorityLow))
+        testAbort("Failed to start event task");
+
+    for (i = 0; i < NSUBS; i++) {
+        chans[i] = dbChannelCreate("bench.VAL{\"ts\":{}}");
+        if (!chans[i] || dbChannelOpen(chans[i]))
+            testAbort("Failed to open channel");
+        subs[i] = db_add_event(evtctx, chans[i], countEvent, NULL, DBE_VALUE);
+        if (!subs[i])
+            testAbort("Failed to subscribe");
+        db_event_enable(subs[i]);
+    }
+
+    testDiag("%s, %d elements, %d subscribers",
+        snapshots ? "Snapshots" : "Copies", NELM, NSUBS);
+    testDiag("  keeping up: %8.3f ms per post", timeUpdates(prec, 1) * 1e3);
+    testDiag("  queued:     %8.3f ms per post", timeUpdates(prec, 2) * 1e3);
+
+    for (i = 0; i < NSUBS; i++) {
+        db_cancel_event(subs[i]);
+        dbChannelDelete(chans[i]);
+    }
+    db_close_events(evtctx);
+
+    testIocShutdownOk();
+    testdbCleanup();
+    dbArraySnapshots = 0;
+}
+
+MAIN(benchdbArraySnapshot)
+{
+    testPlan(0);
+
+    delivered = epicsEventMustCreate(epicsEventEmpty);
+
+    runBench(0);
+    runBench(1);
+
+    epicsEventDestroy(delivered);
+    return testDone();
+}
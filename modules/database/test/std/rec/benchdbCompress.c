@@ -0,0 +1,100 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Measure processing of a compress record reducing a 1M sample trace,
+ * for each choice of its ALG field.
+ */
+#include "cantProceed.h"
+#include "epicsTime.h"
+#include "dbAccess.h"
+#include "dbLock.h"
+#include "dbUnitTest.h"
+#include "compressRecord.h"
+#include "menuYesNo.h"
+
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NELM 1000000
+#define NITER 50
+
+static void fillTrace(void)
+{
+    double *trace = callocMustSucceed(NELM, sizeof(double), "fillTrace");
+    unsigned seed = 1;
+    long i;
+
+    /* a noisy ramp */
+    for (i = 0; i < NELM; i++) {
+        seed = seed * 1103515245 + 12345;
+        trace[i] = i * 1e-3 + (seed >> 16 & 0x7fff) / 32768.0;
+    }
+    testdbPutArrFieldOk("trace", DBF_DOUBLE, NELM, trace);
+    free(trace);
+}
+
+static double timeProcess(compressRecord *prec, epicsEnum16 alg)
+{
+    epicsTimeStamp start, stop;
+    int i;
+
+    testdbPutFieldOk("comp.ALG", DBF_USHORT, alg);
+
+    /* the first processing after a reset may allocate buffers */
+    dbScanLock((dbCommon *) prec);
+    dbProcess((dbCommon *) prec);
+    dbScanUnlock((dbCommon *) prec);
+
+    epicsTimeGetMonotonic(&start);
+    for (i = 0; i < NITER; i++) {
+        dbScanLock((dbCommon *) prec);
+        dbProcess((dbCommon *) prec);
+        dbScanUnlock((dbCommon *) prec);
+    }
+    epicsTimeGetMonotonic(&stop);
+    return epicsTimeDiffInSeconds(&stop, &start) / NITER;
+}
+
+MAIN(benchdbCompress)
+{
+    static const struct {
+        const char *name;
+        epicsEnum16 alg;
+    } algs[] = {
+        {"N to 1 Low Value",     compressALG_N_to_1_Low_Value},
+        {"N to 1 High Value",    compressALG_N_to_1_High_Value},
+        {"N to 1 Average",       compressALG_N_to_1_Average},
+        {"N to 1 Median",        compressALG_N_to_1_Median},
+        {"N to 1 RMS",           compressALG_N_to_1_RMS},
+        {"N to 1 Std Deviation", compressALG_N_to_1_Std_Deviation},
+        {"N to 1 Peak to Peak",  compressALG_N_to_1_Peak_to_Peak},
+        {"Average",              compressALG_Average},
+        {"Circular Buffer",      compressALG_Circular_Buffer},
+    };
+    compressRecord *prec;
+    unsigned i;
+
+    testPlan(0);
+
+    testdbPrepare();
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("benchdbCompress.db", NULL, NULL);
+    testIocInitOk();
+
+    prec = (compressRecord *) testdbRecordPtr("comp");
+    fillTrace();
+
+    testDiag("%d element trace, average of %d processings", NELM, NITER);
+    for (i = 0; i < NELEMENTS(algs); i++)
+        testDiag("  %-22s %8.3f ms", algs[i].name,
+            timeProcess(prec, algs[i].alg) * 1e3);
+
+    testIocShutdownOk();
+    testdbCleanup();
+    return testDone();
+}
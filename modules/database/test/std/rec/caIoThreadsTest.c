@@ -0,0 +1,212 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Tests of a CA client context which serves its circuits from a pool of
+ * I/O threads, cf. EPICS_CA_IO_THREADS.  Runs a CA server and client in
+ * this process.
+ */
+
+#include <string.h>
+
+#include "cadef.h"
+#include "db_access_routines.h"
+#include "dbUnitTest.h"
+#include "envDefs.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "iocInit.h"
+#include "testMain.h"
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define TIMEOUT 5.0
+/* more circuits than I/O threads */
+#define NCIRCUITS 3
+
+typedef struct circuit {
+    chid chan;
+    evid ev;
+    epicsEventId wakeup;
+    epicsEventId putWakeup;
+    int putDone;
+    double last;
+} circuit;
+
+static void putCB(struct event_handler_args args)
+{
+    circuit *pcir = (circuit *) args.usr;
+
+    pcir->putDone = args.status == ECA_NORMAL;
+    epicsEventMustTrigger(pcir->putWakeup);
+}
+
+static void monitorCB(struct event_handler_args args)
+{
+    circuit *pcir = (circuit *) args.usr;
+
+    if (args.status == ECA_NORMAL)
+        pcir->last = *(const double *) args.dbr;
+    epicsEventMustTrigger(pcir->wakeup);
+}
+
+/* Wait for a monitor update with the given value */
+static int monitorWait(circuit *pcir, double value)
+{
+    while (pcir->last != value) {
+        if (epicsEventWaitWithTimeout(pcir->wakeup, TIMEOUT) != epicsEventOK)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+/* Each CA priority gets a circuit of its own */
+static void testCircuits(void)
+{
+    circuit cirs[NCIRCUITS];
+    int i;
+
+    testDiag("testCircuits");
+
+    memset(cirs, 0, sizeof(cirs));
+    for (i = 0; i < NCIRCUITS; i++) {
+        cirs[i].wakeup = epicsEventMustCreate(epicsEventEmpty);
+        cirs[i].putWakeup = epicsEventMustCreate(epicsEventEmpty);
+        cirs[i].last = -1;
+        if (ca_create_channel("io:ai", NULL, NULL,
+                i * CA_PRIORITY_DB_LINKS / NCIRCUITS, &cirs[i].chan) !=
+                ECA_NORMAL)
+            testAbort("Can't create channel %d", i);
+    }
+    testOk(ca_pend_io(TIMEOUT) == ECA_NORMAL, "Channels connected");
+
+#ifdef __linux__
+    testOk(epicsThreadGetId("CAC-TCP-io") != NULL,
+        "Circuits are served by I/O threads");
+    testOk(epicsThreadGetId("CAC-TCP-recv") == NULL,
+        "No circuit has a receive thread of its own");
+#else
+    testSkip(2, "I/O threads are only used on Linux");
+#endif
+
+    for (i = 0; i < NCIRCUITS; i++) {
+        if (ca_create_subscription(DBR_DOUBLE, 1, cirs[i].chan, DBE_VALUE,
+                monitorCB, &cirs[i], &cirs[i].ev) != ECA_NORMAL)
+            testAbort("Can't subscribe on circuit %d", i);
+    }
+    ca_flush_io();
+
+    for (i = 0; i < NCIRCUITS; i++) {
+        double value = 10. * (i + 1), got = 0;
+        int j, ok;
+
+        ok = ca_put_callback(DBR_DOUBLE, cirs[i].chan, &value, putCB,
+            &cirs[i]) == ECA_NORMAL && ca_flush_io() == ECA_NORMAL &&
+            epicsEventWaitWithTimeout(cirs[i].putWakeup, TIMEOUT) ==
+                epicsEventOK;
+        testOk(ok && cirs[i].putDone, "Put %g on circuit %d completed",
+            value, i);
+
+        ok = ca_get(DBR_DOUBLE, cirs[i].chan, &got) == ECA_NORMAL &&
+            ca_pend_io(TIMEOUT) == ECA_NORMAL;
+        testOk(ok && got == value, "Get on circuit %d read %g", i, got);
+
+        ok = TRUE;
+        for (j = 0; j < NCIRCUITS; j++)
+            ok &= monitorWait(&cirs[j], value);
+        testOk(ok, "Update %g reached all circuits", value);
+    }
+
+    for (i = 0; i < NCIRCUITS; i++) {
+        ca_clear_subscription(cirs[i].ev);
+        ca_clear_channel(cirs[i].chan);
+    }
+    ca_flush_io();
+    for (i = 0; i < NCIRCUITS; i++) {
+        epicsEventDestroy(cirs[i].wakeup);
+        epicsEventDestroy(cirs[i].putWakeup);
+    }
+}
+
+/* A context with preemptive callback disabled keeps its own threads */
+static epicsEventId npReady, npGo, npDone;
+
+static void nonPreemptive(void *arg)
+{
+    chid chan;
+    double got = 0;
+    int ok;
+
+    /* also created before iocInit */
+    if (ca_context_create(ca_disable_preemptive_callback) != ECA_NORMAL)
+        testAbort("Can't create CA client context");
+    epicsEventMustTrigger(npReady);
+    epicsEventMustWait(npGo);
+
+    testOk(ca_create_channel("io:ai", NULL, NULL, 0, &chan) == ECA_NORMAL &&
+        ca_pend_io(TIMEOUT) == ECA_NORMAL, "Channel connected");
+    ok = ca_get(DBR_DOUBLE, chan, &got) == ECA_NORMAL &&
+        ca_pend_io(TIMEOUT) == ECA_NORMAL;
+    testOk(ok && got == 10. * NCIRCUITS, "Get read %g", got);
+#ifdef __linux__
+    testOk(epicsThreadGetId("CAC-TCP-recv") != NULL,
+        "The circuit has a receive thread of its own");
+#else
+    testSkip(1, "I/O threads are only used on Linux");
+#endif
+    ca_clear_channel(chan);
+    ca_context_destroy();
+    epicsEventMustTrigger(npDone);
+}
+
+static void testNonPreemptive(void)
+{
+    testDiag("testNonPreemptive");
+
+    epicsEventMustTrigger(npGo);
+    if (epicsEventWaitWithTimeout(npDone, 4 * TIMEOUT) != epicsEventOK)
+        testAbort("Context without preemptive callback hangs");
+}
+
+MAIN(caIoThreadsTest)
+{
+    testPlan(16);
+
+    /* Keep traffic local, on ports of our own */
+    epicsEnvSet("EPICS_CA_AUTO_ADDR_LIST", "NO");
+    epicsEnvSet("EPICS_CA_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CAS_INTF_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CA_SERVER_PORT", "55088");
+    epicsEnvSet("EPICS_CA_REPEATER_PORT", "55089");
+    epicsEnvSet("EPICS_CAS_BEACON_PORT", "55089");
+    epicsEnvSet("EPICS_CA_IO_THREADS", "2");
+
+    testdbPrepare();
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("caIoThreadsTest.db", NULL, NULL);
+
+    /* Created before iocInit installs the database service for clients,
+     * so this context connects through the server. */
+    if (ca_context_create(ca_enable_preemptive_callback) != ECA_NORMAL)
+        testAbort("Can't create CA client context");
+    npReady = epicsEventMustCreate(epicsEventEmpty);
+    npGo = epicsEventMustCreate(epicsEventEmpty);
+    npDone = epicsEventMustCreate(epicsEventEmpty);
+    epicsThreadMustCreate("nonPreemptive", epicsThreadPriorityMedium,
+        epicsThreadGetStackSize(epicsThreadStackMedium), nonPreemptive,
+        NULL);
+    epicsEventMustWait(npReady);
+
+    testOk(iocInit() == 0, "iocInit with the CA server");
+
+    testCircuits();
+
+    ca_context_destroy();
+
+    testNonPreemptive();
+
+    /* The CA server can't be stopped, so the database is left in place */
+    return testDone();
+}
@@ -6,6 +6,7 @@
 \*************************************************************************/
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "cantProceed.h"
 #include "dbUnitTest.h"
@@ -14,6 +15,7 @@
 #include "errlog.h"
 #include "dbAccess.h"
 #include "epicsMath.h"
+#include "epicsStdio.h"
 #include "menuYesNo.h"
 
 #include "aiRecord.h"
@@ -632,9 +634,244 @@ testAIAveragePartial(void) {
     testdbCleanup();
 }
 
+void
+testNto1Stats(void) {
+    static const struct {
+        const char *alg;
+        double expected;
+    } cases[] = {
+        {"N to 1 Low Value",     1.0},
+        {"N to 1 High Value",    9.0},
+        {"N to 1 Average",       4.0},
+        {"N to 1 Median",        4.0},
+        {"N to 1 RMS",           4.7610},
+        {"N to 1 Std Deviation", 2.5820},
+        {"N to 1 Peak to Peak",  8.0},
+    };
+    char macros[80];
+    DBADDR wfaddr, caddr;
+    unsigned i;
+
+    testDiag("Test 'N to 1' algorithms with a 6 element array");
+
+    for (i = 0; i < NELEMENTS(cases); i++) {
+        testDiag("ALG=%s", cases[i].alg);
+
+        testdbPrepare();
+        testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+        recTestIoc_registerRecordDeviceDriver(pdbbase);
+        epicsSnprintf(macros, sizeof(macros),
+            "INP=wf,ALG=%s,BALG=FIFO Buffer,NSAM=1,NELM=6", cases[i].alg);
+        testdbReadDatabase("compressTest.db", NULL, macros);
+
+        eltc(0);
+        testIocInitOk();
+        eltc(1);
+
+        fetchRecordOrDie("wf", wfaddr);
+        fetchRecordOrDie("comp", caddr);
+
+        writeToWaveform(&wfaddr, 6, 5., 1., 3., 2., 9., 4.);
+
+        dbScanLock(caddr.precord);
+        dbProcess(caddr.precord);
+        dbScanUnlock(caddr.precord);
+
+        checkArrD("comp", 1, cases[i].expected, 0, 0, 0);
+
+        testIocShutdownOk();
+        testdbCleanup();
+    }
+}
+
+/* An array input is reduced as a whole, whatever N and NSAM are, so
+ * there is only ever one median per processing.  The loop over several
+ * groups, whose stride was wrong before the reductions were rewritten,
+ * never runs more than once.
+ */
+void
+testNto1MedianSamples(void) {
+    DBADDR wfaddr, caddr;
+
+    testDiag("Test 'N to 1 Median' with N=2 and NSAM=3");
+
+    testdbPrepare();
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("compressTest.db", NULL,
+        "INP=wf,ALG=N to 1 Median,BALG=FIFO Buffer,NSAM=3,N=2,NELM=6");
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    fetchRecordOrDie("wf", wfaddr);
+    fetchRecordOrDie("comp", caddr);
+
+    writeToWaveform(&wfaddr, 6, 5., 1., 3., 2., 9., 4.);
+
+    dbScanLock(caddr.precord);
+    dbProcess(caddr.precord);
+    dbScanUnlock(caddr.precord);
+
+    checkArrD("comp", 1, 4., 0, 0, 0);
+
+    testIocShutdownOk();
+    testdbCleanup();
+}
+
+static
+int cmpDouble(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+/* Arrays longer than the blocks of the vectorized reductions, with a
+ * partial block at the end.  The expected values are computed here the
+ * straightforward way.
+ */
+void
+testNto1StatsLong(void) {
+    static const char *algs[] = {
+        "N to 1 Low Value", "N to 1 High Value", "N to 1 Average",
+        "N to 1 Median", "N to 1 RMS", "N to 1 Std Deviation",
+        "N to 1 Peak to Peak",
+    };
+    static const long lengths[] = {67, 101};
+    double data[101], sorted[101], expected[NELEMENTS(algs)];
+    char macros[100];
+    DBADDR wfaddr, caddr;
+    unsigned i, l;
+
+    for (l = 0; l < NELEMENTS(lengths); l++) {
+        long j, n = lengths[l];
+        double sum = 0., sumsq = 0., var = 0.;
+
+        /* many duplicates, the maximum in a full block and the minimum
+         * in the partial one */
+        for (j = 0; j < n; j++)
+            data[j] = 1000. + (j * 37) % 23;
+        data[40] = 1100.;
+        data[n - 1] = 900.;
+
+        memcpy(sorted, data, n * sizeof(double));
+        qsort(sorted, n, sizeof(double), cmpDouble);
+        for (j = 0; j < n; j++) {
+            sum += data[j];
+            sumsq += data[j] * data[j];
+        }
+        for (j = 0; j < n; j++)
+            var += (data[j] - sum / n) * (data[j] - sum / n);
+
+        expected[0] = sorted[0];
+        expected[1] = sorted[n - 1];
+        expected[2] = sum / n;
+        expected[3] = sorted[n / 2];
+        expected[4] = sqrt(sumsq / n);
+        expected[5] = sqrt(var / n);
+        expected[6] = sorted[n - 1] - sorted[0];
+
+        testDiag("Test 'N to 1' algorithms with a %ld element array", n);
+
+        for (i = 0; i < NELEMENTS(algs); i++) {
+            testdbPrepare();
+            testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+            recTestIoc_registerRecordDeviceDriver(pdbbase);
+            epicsSnprintf(macros, sizeof(macros),
+                "INP=wf,ALG=%s,BALG=FIFO Buffer,NSAM=1,NELM=%ld", algs[i], n);
+            testdbReadDatabase("compressTest.db", NULL, macros);
+
+            eltc(0);
+            testIocInitOk();
+            eltc(1);
+
+            fetchRecordOrDie("wf", wfaddr);
+            fetchRecordOrDie("comp", caddr);
+
+            dbScanLock(wfaddr.precord);
+            dbPut(&wfaddr, DBR_DOUBLE, data, n);
+            dbScanUnlock(wfaddr.precord);
+
+            dbScanLock(caddr.precord);
+            dbProcess(caddr.precord);
+            dbScanUnlock(caddr.precord);
+
+            testDiag("ALG=%s", algs[i]);
+            checkArrD("comp", 1, expected[i], 0, 0, 0);
+
+            testIocShutdownOk();
+            testdbCleanup();
+        }
+    }
+}
+
+void
+testAIStats(void) {
+    static const struct {
+        const char *alg;
+        double offset;
+        double expected;
+    } cases[] = {
+        {"N to 1 RMS",           0.,  2.7386},
+        {"N to 1 Std Deviation", 0.,  1.1180},
+        {"N to 1 Std Deviation", 1e9, 1.1180},
+        {"N to 1 Peak to Peak",  0.,  3.0},
+    };
+    char macros[80];
+    DBADDR aiaddr, caddr;
+    double buf = 0.;
+    long nReq = 1;
+    unsigned i;
+    int j;
+
+    testDiag("Test 'N to 1' statistics with analog in");
+
+    for (i = 0; i < NELEMENTS(cases); i++) {
+        testdbPrepare();
+        testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+        recTestIoc_registerRecordDeviceDriver(pdbbase);
+        epicsSnprintf(macros, sizeof(macros),
+            "INP=ai,ALG=%s,BALG=FIFO Buffer,NSAM=1,N=4", cases[i].alg);
+        testdbReadDatabase("compressTest.db", NULL, macros);
+
+        eltc(0);
+        testIocInitOk();
+        eltc(1);
+
+        fetchRecordOrDie("ai", aiaddr);
+        fetchRecordOrDie("comp", caddr);
+
+        for (j = 1; j <= 4; j++) {
+            double value = cases[i].offset + j;
+
+            dbScanLock(aiaddr.precord);
+            dbPut(&aiaddr, DBR_DOUBLE, &value, 1);
+            dbScanUnlock(aiaddr.precord);
+
+            dbScanLock(caddr.precord);
+            dbProcess(caddr.precord);
+            dbScanUnlock(caddr.precord);
+        }
+
+        dbScanLock(caddr.precord);
+        if (dbGet(&caddr, DBR_DOUBLE, &buf, NULL, &nReq, NULL))
+            testAbort("dbGet failed on compress record");
+        dbScanUnlock(caddr.precord);
+
+        testOk(fabs(buf - cases[i].expected) < 0.01,
+            "%s of %g + 1, 2, 3, 4 is %f (expected %f)", cases[i].alg,
+            cases[i].offset, buf, cases[i].expected);
+
+        testIocShutdownOk();
+        testdbCleanup();
+    }
+}
+
 MAIN(compressTest)
 {
-    testPlan(132);
+    testPlan(158);
     testFIFOCirc();
     testLIFOCirc();
     testArrayAverage();
@@ -642,5 +879,9 @@ MAIN(compressTest)
     testNto1AveragePartial();
     testAIAveragePartial();
     testNto1LowValue();
+    testNto1Stats();
+    testNto1StatsLong();
+    testNto1MedianSamples();
+    testAIStats();
     return testDone();
 }
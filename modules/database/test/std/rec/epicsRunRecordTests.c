@@ -14,6 +14,7 @@
 #include "epicsExit.h"
 
 int analogMonitorTest(void);
+int arraySnapshotTest(void);
 int compressTest(void);
 int recMiscTest(void);
 int arrayOpTest(void);
@@ -35,6 +36,7 @@ void epicsRunRecordTests(void)
 
     runTest(analogMonitorTest);
 
+    runTest(arraySnapshotTest);
     runTest(compressTest);
 
     runTest(recMiscTest);
@@ -0,0 +1,244 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Tests of the RSRV cache of wire encoded subscription updates, which
+ * must only share a payload between subscriptions that would be sent the
+ * same data.  Runs a CA server and client in this process.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "cadef.h"
+#include "db_access_routines.h"
+#include "dbUnitTest.h"
+#include "envDefs.h"
+#include "epicsEvent.h"
+#include "epicsMutex.h"
+#include "epicsThread.h"
+#include "iocInit.h"
+#include "iocsh.h"
+#include "testMain.h"
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define TIMEOUT 5.0
+#define MAXCOUNT 3
+
+typedef struct monitor {
+    const char *name;
+    unsigned long count;
+    chid chan;
+    evid ev;
+    epicsMutexId lock;
+    epicsEventId wakeup;
+    int nUpdates;
+    double last[MAXCOUNT];
+} monitor;
+
+static void monitorCB(struct event_handler_args args)
+{
+    monitor *pmon = (monitor *) args.usr;
+
+    if (args.status != ECA_NORMAL || args.count != (long) pmon->count)
+        return;
+    epicsMutexMustLock(pmon->lock);
+    memcpy(pmon->last, args.dbr, pmon->count * sizeof(double));
+    pmon->nUpdates++;
+    epicsMutexUnlock(pmon->lock);
+    epicsEventMustTrigger(pmon->wakeup);
+}
+
+static void monitorStart(monitor *pmon)
+{
+    pmon->lock = epicsMutexMustCreate();
+    pmon->wakeup = epicsEventMustCreate(epicsEventEmpty);
+    if (ca_create_channel(pmon->name, NULL, NULL, 0, &pmon->chan) !=
+            ECA_NORMAL ||
+        ca_pend_io(TIMEOUT) != ECA_NORMAL)
+        testAbort("Can't connect to %s", pmon->name);
+    if (ca_create_subscription(DBR_DOUBLE, pmon->count, pmon->chan,
+            DBE_VALUE, monitorCB, pmon, &pmon->ev) != ECA_NORMAL)
+        testAbort("Can't subscribe to %s", pmon->name);
+    ca_flush_io();
+}
+
+static void monitorStop(monitor *pmon)
+{
+    ca_clear_subscription(pmon->ev);
+    ca_clear_channel(pmon->chan);
+    ca_flush_io();
+    epicsEventDestroy(pmon->wakeup);
+    epicsMutexDestroy(pmon->lock);
+}
+
+static void caPut(monitor *pmon, unsigned long count, const double *pvalue)
+{
+    testOk(ca_array_put(DBR_DOUBLE, count, pmon->chan, pvalue) ==
+        ECA_NORMAL && ca_flush_io() == ECA_NORMAL,
+        "Put %lu element(s) to %s", count, pmon->name);
+}
+
+/* Wait for the n'th update, return FALSE on timeout */
+static int monitorWait(monitor *pmon, int n)
+{
+    for (;;) {
+        int done;
+
+        epicsMutexMustLock(pmon->lock);
+        done = pmon->nUpdates >= n;
+        epicsMutexUnlock(pmon->lock);
+        if (done)
+            return TRUE;
+        if (epicsEventWaitWithTimeout(pmon->wakeup, TIMEOUT) != epicsEventOK)
+            return FALSE;
+    }
+}
+
+static int monitorMatch(monitor *pmon, const double *expect)
+{
+    unsigned long i;
+    int match = TRUE;
+
+    epicsMutexMustLock(pmon->lock);
+    for (i = 0; i < pmon->count; i++) {
+        if (pmon->last[i] != expect[i]) {
+            testDiag("%s[%lu] is %g, expected %g", pmon->name, i,
+                pmon->last[i], expect[i]);
+            match = FALSE;
+        }
+    }
+    epicsMutexUnlock(pmon->lock);
+    return match;
+}
+
+/* Subscriptions which only differ by their filter get the same post_id,
+ * field, DBR type and count, but different data.
+ */
+static void testFiltered(void)
+{
+    monitor mons[] = {
+        {"wf", 3},
+        {"wf", 3},
+        {"wf.[2:4]", 3},
+    };
+    static const double put1[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    static const double put2[] = {11, 12, 13, 14, 15, 16, 17, 18};
+    const double *puts[] = {put1, put2};
+    int i, j;
+
+    testDiag("testFiltered");
+
+    for (i = 0; i < 3; i++)
+        monitorStart(&mons[i]);
+    for (i = 0; i < 3; i++)
+        if (!monitorWait(&mons[i], 1))
+            testAbort("No initial update for %s", mons[i].name);
+
+    for (j = 0; j < 2; j++) {
+        int ok = TRUE;
+
+        caPut(&mons[0], 8, puts[j]);
+        for (i = 0; i < 3; i++)
+            ok &= monitorWait(&mons[i], 2 + j);
+        testOk(ok, "Update %d reached all subscriptions", j + 1);
+        testOk(monitorMatch(&mons[0], puts[j]), "wf has the first elements");
+        testOk(monitorMatch(&mons[1], puts[j]),
+            "Second wf subscription has the first elements");
+        testOk(monitorMatch(&mons[2], puts[j] + 2),
+            "wf.[2:4] has the filtered elements");
+    }
+
+    for (i = 0; i < 3; i++)
+        monitorStop(&mons[i]);
+}
+
+/* The stat filter replaces the value and clears the post_id.  Values
+ * posted are multiples of 10, the means of two of them end in 5.
+ */
+static void testClearedPostId(void)
+{
+    monitor mons[] = {
+        {"ai", 1},
+        {"ai.{stat:{n:2}}", 1},
+        {"ai.{stat:{n:2}}", 1},
+    };
+    int i, j, rawOk = TRUE, meanOk = TRUE;
+
+    testDiag("testClearedPostId");
+
+    monitorStart(&mons[0]);
+    monitorStart(&mons[1]);
+    if (!monitorWait(&mons[0], 1))
+        testAbort("No initial update for ai");
+
+    for (j = 1; j <= 6; j++) {
+        double value = 10. * j;
+        int k;
+
+        /* the second stat window is one update behind the first */
+        if (j == 2)
+            monitorStart(&mons[2]);
+
+        caPut(&mons[0], 1, &value);
+        rawOk &= monitorWait(&mons[0], 1 + j) &&
+            monitorMatch(&mons[0], &value);
+
+        for (k = 1; k < 3 && mons[k].lock; k++) {
+            double v;
+
+            epicsMutexMustLock(mons[k].lock);
+            v = mons[k].last[0];
+            if (mons[k].nUpdates && fmod(v, 10.) != 5.) {
+                testDiag("%s got %g, not a mean", mons[k].name, v);
+                meanOk = FALSE;
+            }
+            epicsMutexUnlock(mons[k].lock);
+        }
+    }
+    testOk(rawOk, "ai got each value posted");
+    testOk(monitorWait(&mons[1], 2) && monitorWait(&mons[2], 2),
+        "Both stat subscriptions were updated");
+    testOk(meanOk, "stat subscriptions only got means");
+
+    for (i = 0; i < 3; i++)
+        monitorStop(&mons[i]);
+}
+
+MAIN(rsrvMonitorCacheTest)
+{
+    testPlan(20);
+
+    /* Keep traffic local, on ports of our own */
+    epicsEnvSet("EPICS_CA_AUTO_ADDR_LIST", "NO");
+    epicsEnvSet("EPICS_CA_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CAS_INTF_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CA_SERVER_PORT", "55084");
+    epicsEnvSet("EPICS_CA_REPEATER_PORT", "55085");
+    epicsEnvSet("EPICS_CAS_BEACON_PORT", "55085");
+
+    testdbPrepare();
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("rsrvMonitorCacheTest.db", NULL, NULL);
+
+    /* cache even the smallest payloads */
+    iocshCmd("var rsrvMonitorCacheMin 1");
+
+    /* Created before iocInit installs the database service for clients,
+     * so this context connects through the server. */
+    if (ca_context_create(ca_enable_preemptive_callback) != ECA_NORMAL)
+        testAbort("Can't create CA client context");
+
+    testOk(iocInit() == 0, "iocInit with the CA server");
+
+    testFiltered();
+    testClearedPostId();
+
+    ca_context_destroy();
+
+    /* The CA server can't be stopped, so the database is left in place */
+    return testDone();
+}
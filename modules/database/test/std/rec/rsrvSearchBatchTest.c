@@ -0,0 +1,237 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Tests of the RSRV name server receiving several UDP search requests
+ * at once, some larger than an Ethernet frame.  Runs a CA server in this
+ * process and sends it raw UDP datagrams.
+ */
+
+#include <string.h>
+
+#include "caProto.h"
+#include "db_access_routines.h"
+#include "dbUnitTest.h"
+#include "envDefs.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "iocInit.h"
+#include "osiSock.h"
+#include "testMain.h"
+
+#ifdef __linux__
+#  include <pthread.h>
+#  include <sched.h>
+#  include <sys/socket.h>
+#endif
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define TIMEOUT 5.0
+#define SERVER_PORT 55086
+/* more datagrams than one recvmmsg() call takes */
+#define NDG 20
+#define NROUNDS 5
+/* requests padded to this size don't fit in an Ethernet frame */
+#define LARGE_SIZE (3 * ETHERNET_MAX_UDP)
+/* the first request keeps the server busy while the others are queued */
+#define FIRST_SIZE 60000u
+#define CA_MINOR 13u
+
+static char dgFirst[FIRST_SIZE];
+static char dgBuf[NDG][LARGE_SIZE];
+static char *dgPtr[NDG];
+static unsigned dgSize[NDG];
+
+static unsigned addMsg(char *pbuf, unsigned pos, unsigned cmmd,
+    unsigned dataType, ca_uint32_t id, const char *name)
+{
+    caHdr hdr;
+    unsigned postsize = name ? CA_MESSAGE_ALIGN(strlen(name) + 1) : 0u;
+
+    hdr.m_cmmd = htons(cmmd);
+    hdr.m_postsize = htons(postsize);
+    hdr.m_dataType = htons(dataType);
+    hdr.m_count = htons(CA_MINOR);
+    hdr.m_cid = htonl(id);
+    hdr.m_available = htonl(id);
+    memcpy(pbuf + pos, &hdr, sizeof(hdr));
+    pos += sizeof(hdr);
+    if (name) {
+        memset(pbuf + pos, 0, postsize);
+        strcpy(pbuf + pos, name);
+        pos += postsize;
+    }
+    return pos;
+}
+
+/* The first and every odd datagram are padded with searches for a PV
+ * which doesn't exist, the last search in each is for the one which does.
+ */
+static void makeRequests(ca_uint32_t firstId)
+{
+    unsigned i;
+
+    for (i = 0; i < NDG; i++) {
+        unsigned size = i == 0 ? FIRST_SIZE : (i & 1u) ? LARGE_SIZE : 0u;
+        unsigned pos;
+
+        dgPtr[i] = i == 0 ? dgFirst : dgBuf[i];
+        pos = addMsg(dgPtr[i], 0u, CA_PROTO_VERSION, 0u, 0u, NULL);
+        while (pos + 64u < size)
+            pos = addMsg(dgPtr[i], pos, CA_PROTO_SEARCH, DONTREPLY,
+                0u, "batch:nonesuch");
+        dgSize[i] = addMsg(dgPtr[i], pos, CA_PROTO_SEARCH, DONTREPLY,
+            firstId + i, "batch:ai");
+    }
+}
+
+/* Collect the search replies, return the number of requests answered */
+static unsigned collectReplies(SOCKET sock, ca_uint32_t firstId)
+{
+    int found[NDG];
+    unsigned nFound = 0u;
+    epicsTimeStamp start, now;
+
+    memset(found, 0, sizeof(found));
+    epicsTimeGetCurrent(&start);
+    while (nFound < NDG) {
+        static char reply[MAX_UDP_RECV];
+        struct timeval tmo;
+        fd_set fds;
+        double left;
+        int n, pos = 0;
+
+        epicsTimeGetCurrent(&now);
+        left = TIMEOUT - epicsTimeDiffInSeconds(&now, &start);
+        if (left <= 0)
+            break;
+        tmo.tv_sec = (long) left;
+        tmo.tv_usec = (long) ((left - tmo.tv_sec) * 1e6);
+        FD_ZERO(&fds);
+        FD_SET(sock, &fds);
+        if (select((int) sock + 1, &fds, NULL, NULL, &tmo) <= 0)
+            break;
+        n = recv(sock, reply, sizeof(reply), 0);
+
+        while (n - pos >= (int) sizeof(caHdr)) {
+            caHdr hdr;
+            ca_uint32_t idx;
+
+            memcpy(&hdr, reply + pos, sizeof(hdr));
+            pos += sizeof(hdr) + ntohs(hdr.m_postsize);
+            idx = ntohl(hdr.m_available) - firstId;
+            if (ntohs(hdr.m_cmmd) == CA_PROTO_SEARCH && idx < NDG &&
+                !found[idx]) {
+                found[idx] = 1;
+                nFound++;
+            }
+        }
+    }
+    return nFound;
+}
+
+#ifdef __linux__
+/* Keep the name server threads from preempting the sender, even on a
+ * single CPU, so that each burst is received by one recvmmsg() call.
+ */
+static void deferServer(const char *name)
+{
+    epicsThreadId id = epicsThreadGetId(name);
+    struct sched_param param;
+
+    memset(&param, 0, sizeof(param));
+    if (!id || pthread_setschedparam(epicsThreadGetPosixThreadId(id),
+            SCHED_BATCH, &param))
+        testDiag("Can't change the scheduling of %s", name);
+}
+#endif
+
+static void testMixedBatch(void)
+{
+    struct sockaddr_in server;
+    SOCKET sock;
+    int round;
+
+    testDiag("testMixedBatch");
+
+#ifdef __linux__
+    deferServer("CAS-UDP");
+    deferServer("CAS-UDP2");
+#endif
+
+    sock = epicsSocketCreate(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == INVALID_SOCKET)
+        testAbort("Can't create UDP socket");
+
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    server.sin_port = htons(SERVER_PORT);
+
+    for (round = 0; round < NROUNDS; round++) {
+        ca_uint32_t firstId = 1000u * (round + 1);
+        unsigned i, nSent = 0u;
+
+        makeRequests(firstId);
+#ifdef __linux__
+        /* by one call, so that they are queued together */
+        {
+            struct mmsghdr msgs[NDG];
+            struct iovec iov[NDG];
+            int status;
+
+            memset(msgs, 0, sizeof(msgs));
+            for (i = 0; i < NDG; i++) {
+                iov[i].iov_base = dgPtr[i];
+                iov[i].iov_len = dgSize[i];
+                msgs[i].msg_hdr.msg_name = &server;
+                msgs[i].msg_hdr.msg_namelen = sizeof(server);
+                msgs[i].msg_hdr.msg_iov = &iov[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            status = sendmmsg(sock, msgs, NDG, 0);
+            if (status > 0)
+                nSent = (unsigned) status;
+        }
+#else
+        for (i = 0; i < NDG; i++) {
+            if (sendto(sock, dgPtr[i], dgSize[i], 0,
+                    (struct sockaddr *) &server, sizeof(server)) ==
+                    (int) dgSize[i])
+                nSent++;
+        }
+#endif
+        testOk(nSent == NDG, "Round %d: sent %u requests", round, nSent);
+        testOk(collectReplies(sock, firstId) == NDG,
+            "Round %d: all requests were answered", round);
+    }
+
+    epicsSocketDestroy(sock);
+}
+
+MAIN(rsrvSearchBatchTest)
+{
+    testPlan(1 + 2 * NROUNDS);
+
+    /* Keep traffic local, on ports of our own */
+    epicsEnvSet("EPICS_CA_AUTO_ADDR_LIST", "NO");
+    epicsEnvSet("EPICS_CA_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CAS_INTF_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CA_SERVER_PORT", "55086");
+    epicsEnvSet("EPICS_CA_REPEATER_PORT", "55087");
+    epicsEnvSet("EPICS_CAS_BEACON_PORT", "55087");
+
+    testdbPrepare();
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("rsrvSearchBatchTest.db", NULL, NULL);
+
+    testOk(iocInit() == 0, "iocInit with the CA server");
+
+    testMixedBatch();
+
+    /* The CA server can't be stopped, so the database is left in place */
+    return testDone();
+}
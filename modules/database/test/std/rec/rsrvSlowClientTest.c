@@ -0,0 +1,327 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* Tests of RSRV serving a client which doesn't read its replies on the
+ * same I/O thread as a normal client, cf. EPICS_CAS_IO_THREADS.  Runs a
+ * CA server and client in this process, the slow client uses a raw socket.
+ */
+
+#include <string.h>
+
+#include "cadef.h"
+#include "caProto.h"
+#include "db_access_routines.h"
+#include "dbUnitTest.h"
+#include "envDefs.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "iocInit.h"
+#include "osiSock.h"
+#include "rsrv.h"
+#include "testMain.h"
+
+#ifdef __linux__
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define TIMEOUT 5.0
+#define SERVER_PORT 55090
+#define CA_MINOR 13u
+/* elements of slow:wf, and reads of it by the slow client */
+#define NELM 1500u
+#define NREADS 2000u
+/* reads which fill the receive buffer of a circuit */
+#define FILL_READS (MAX_TCP / sizeof(caHdr))
+
+static ca_uint32_t slowSid;
+
+static int sendMsg(SOCKET sock, unsigned cmmd, unsigned dataType,
+    unsigned count, ca_uint32_t cid, ca_uint32_t available,
+    const void *payload, unsigned size)
+{
+    char buf[sizeof(caHdr) + 64];
+    caHdr hdr;
+    unsigned postsize = CA_MESSAGE_ALIGN(size);
+
+    hdr.m_cmmd = htons(cmmd);
+    hdr.m_postsize = htons(postsize);
+    hdr.m_dataType = htons(dataType);
+    hdr.m_count = htons(count);
+    hdr.m_cid = htonl(cid);
+    hdr.m_available = htonl(available);
+    memcpy(buf, &hdr, sizeof(hdr));
+    memset(buf + sizeof(hdr), 0, postsize);
+    if (size)
+        memcpy(buf + sizeof(hdr), payload, size);
+    return send(sock, buf, sizeof(hdr) + postsize, 0) ==
+        (int) (sizeof(hdr) + postsize);
+}
+
+static int recvAll(SOCKET sock, void *pbuf, unsigned size)
+{
+    char *p = pbuf;
+
+    while (size) {
+        struct timeval tmo;
+        fd_set fds;
+        int n;
+
+        tmo.tv_sec = (long) TIMEOUT;
+        tmo.tv_usec = 0;
+        FD_ZERO(&fds);
+        FD_SET(sock, &fds);
+        if (select((int) sock + 1, &fds, NULL, NULL, &tmo) <= 0)
+            return FALSE;
+        n = recv(sock, p, size, 0);
+        if (n <= 0)
+            return FALSE;
+        p += n;
+        size -= (unsigned) n;
+    }
+    return TRUE;
+}
+
+/* Connect and subscribe to slow:wf */
+static SOCKET slowClientStart(void)
+{
+    static const char name[] = "slow:wf";
+    struct sockaddr_in server;
+    struct mon_info mon;
+    SOCKET sock;
+    int rcvbuf = 4096;
+
+    sock = epicsSocketCreate(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET)
+        testAbort("Can't create TCP socket");
+    /* keeps the server from sending much before it must stop */
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char *) &rcvbuf,
+        sizeof(rcvbuf));
+
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    server.sin_port = htons(SERVER_PORT);
+    if (connect(sock, (struct sockaddr *) &server, sizeof(server)))
+        testAbort("Slow client can't connect");
+
+    if (!sendMsg(sock, CA_PROTO_VERSION, 0u, CA_MINOR, 0u, 0u, NULL, 0u) ||
+        !sendMsg(sock, CA_PROTO_CREATE_CHAN, 0u, 0u, 1u, CA_MINOR,
+            name, sizeof(name)))
+        testAbort("Slow client can't send");
+
+    for (;;) {
+        caHdr hdr;
+        char payload[64];
+        unsigned size;
+
+        if (!recvAll(sock, &hdr, sizeof(hdr)))
+            testAbort("Slow client got no reply");
+        size = ntohs(hdr.m_postsize);
+        if (size > sizeof(payload) || !recvAll(sock, payload, size))
+            testAbort("Slow client got a bad reply");
+        if (ntohs(hdr.m_cmmd) == CA_PROTO_CREATE_CHAN) {
+            slowSid = ntohl(hdr.m_available);
+            break;
+        }
+    }
+    testPass("Slow client connected to %s", name);
+
+    memset(&mon, 0, sizeof(mon));
+    mon.m_mask = htons(DBE_VALUE);
+    if (!sendMsg(sock, CA_PROTO_EVENT_ADD, DBR_DOUBLE, NELM, slowSid, 1u,
+            &mon, sizeof(mon)))
+        testAbort("Slow client can't subscribe");
+    return sock;
+}
+
+/* Ask for reads of slow:wf with consecutive ids */
+static void slowClientSendReads(SOCKET sock, ca_uint32_t firstId,
+    unsigned nReads)
+{
+    unsigned i;
+
+    for (i = 0; i < nReads; i++) {
+        if (!sendMsg(sock, CA_PROTO_READ_NOTIFY, DBR_DOUBLE, NELM, slowSid,
+                firstId + i, NULL, 0u))
+            testAbort("Slow client can't send read %u", i);
+    }
+}
+
+/* Read the replies to all reads, and count them */
+static unsigned slowClientRead(SOCKET sock, ca_uint32_t firstId,
+    unsigned nReads)
+{
+    static char payload[sizeof(double) * NELM + 64];
+    unsigned nFound = 0u;
+
+    while (nFound < nReads) {
+        caHdr hdr;
+        unsigned size;
+        ca_uint32_t id;
+
+        if (!recvAll(sock, &hdr, sizeof(hdr)))
+            break;
+        size = ntohs(hdr.m_postsize);
+        if (size > sizeof(payload) || !recvAll(sock, payload, size))
+            break;
+        id = ntohl(hdr.m_available);
+        if (ntohs(hdr.m_cmmd) == CA_PROTO_READ_NOTIFY &&
+            id - firstId < nReads)
+            nFound++;
+    }
+    return nFound;
+}
+
+#ifdef __linux__
+/* Keep the I/O thread from preempting the event tasks, even on a single
+ * CPU, so that these send the replies it has queued.
+ */
+static void deferServer(const char *name)
+{
+    epicsThreadId id = epicsThreadGetId(name);
+    struct sched_param param;
+
+    memset(&param, 0, sizeof(param));
+    if (!id || pthread_setschedparam(epicsThreadGetPosixThreadId(id),
+            SCHED_BATCH, &param))
+        testDiag("Can't change the scheduling of %s", name);
+}
+#endif
+
+static unsigned circuitCount(void)
+{
+    unsigned nChan, nCircuits;
+
+    casStatsFetch(&nChan, &nCircuits);
+    return nCircuits;
+}
+
+static void monitorCB(struct event_handler_args args)
+{
+    epicsEventMustTrigger((epicsEventId) args.usr);
+}
+
+/* Requests of the normal client must not wait for the slow client */
+static void testNormalClient(chid ai, chid wf, epicsEventId wakeup)
+{
+    static double wfData[NELM];
+    epicsTimeStamp start, now;
+    double elapsed;
+    int i, ok = TRUE;
+
+    epicsTimeGetCurrent(&start);
+    for (i = 1; i <= 3; i++) {
+        double value = i, got = 0;
+
+        wfData[0] = i;
+        /* also a monitor update for the slow client */
+        ok &= ca_array_put(DBR_DOUBLE, NELM, wf, wfData) == ECA_NORMAL;
+        ok &= ca_put(DBR_DOUBLE, ai, &value) == ECA_NORMAL;
+        ok &= ca_get(DBR_DOUBLE, ai, &got) == ECA_NORMAL &&
+            ca_pend_io(TIMEOUT) == ECA_NORMAL && got == value;
+        ok &= epicsEventWaitWithTimeout(wakeup, TIMEOUT) == epicsEventOK;
+    }
+    epicsTimeGetCurrent(&now);
+    elapsed = epicsTimeDiffInSeconds(&now, &start);
+    testOk(ok, "Normal client got its replies and updates");
+    testOk(elapsed < TIMEOUT, "... in %.3f seconds", elapsed);
+}
+
+static void testSlowClient(void)
+{
+    epicsEventId wakeup = epicsEventMustCreate(epicsEventEmpty);
+    chid ai, wf;
+    evid ev;
+    SOCKET sock;
+    int i;
+
+    testDiag("testSlowClient");
+
+    if (ca_create_channel("io:ai", NULL, NULL, 0, &ai) != ECA_NORMAL ||
+        ca_create_channel("slow:wf", NULL, NULL, 0, &wf) != ECA_NORMAL ||
+        ca_pend_io(TIMEOUT) != ECA_NORMAL)
+        testAbort("Normal client can't connect");
+    if (ca_create_subscription(DBR_DOUBLE, 1, ai, DBE_VALUE, monitorCB,
+            wakeup, &ev) != ECA_NORMAL ||
+        ca_flush_io() != ECA_NORMAL ||
+        epicsEventWaitWithTimeout(wakeup, TIMEOUT) != epicsEventOK)
+        testAbort("Normal client can't subscribe");
+
+    /* more than fits in the socket buffers */
+    sock = slowClientStart();
+    slowClientSendReads(sock, 2u, NREADS);
+    testOk(circuitCount() == 2, "Two circuits on the one I/O thread");
+    /* give the server time to fill the socket buffers */
+    epicsThreadSleep(0.5);
+
+    testNormalClient(ai, wf, wakeup);
+
+    testDiag("Slow client disconnects without reading");
+    epicsSocketDestroy(sock);
+    for (i = 0; i < 50 && circuitCount() != 1; i++)
+        epicsThreadSleep(0.1);
+    testOk(circuitCount() == 1, "Slow client circuit was closed");
+
+    testNormalClient(ai, wf, wakeup);
+
+    testDiag("Slow client reads after filling the receive buffer");
+    sock = slowClientStart();
+    slowClientSendReads(sock, 2u, FILL_READS);
+    epicsThreadSleep(0.5);
+#ifdef __linux__
+    deferServer("CAS-io0");
+#endif
+    /* its event task now waits with monitor updates too */
+    testNormalClient(ai, wf, wakeup);
+    testOk(slowClientRead(sock, 2u, FILL_READS) == FILL_READS,
+        "Slow client got the replies to all of its reads");
+    slowClientSendReads(sock, 2u + FILL_READS, 1u);
+    testOk(slowClientRead(sock, 2u + FILL_READS, 1u) == 1u,
+        "... and to one more");
+    epicsSocketDestroy(sock);
+
+    ca_clear_subscription(ev);
+    ca_clear_channel(wf);
+    ca_clear_channel(ai);
+    ca_flush_io();
+    epicsEventDestroy(wakeup);
+}
+
+MAIN(rsrvSlowClientTest)
+{
+    testPlan(13);
+
+    /* Keep traffic local, on ports of our own */
+    epicsEnvSet("EPICS_CA_AUTO_ADDR_LIST", "NO");
+    epicsEnvSet("EPICS_CA_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CAS_INTF_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CA_SERVER_PORT", "55090");
+    epicsEnvSet("EPICS_CA_REPEATER_PORT", "55091");
+    epicsEnvSet("EPICS_CAS_BEACON_PORT", "55091");
+    epicsEnvSet("EPICS_CAS_IO_THREADS", "1");
+
+    testdbPrepare();
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("rsrvSlowClientTest.db", NULL, NULL);
+
+    /* Created before iocInit installs the database service for clients,
+     * so this context connects through the server. */
+    if (ca_context_create(ca_enable_preemptive_callback) != ECA_NORMAL)
+        testAbort("Can't create CA client context");
+
+    testOk(iocInit() == 0, "iocInit with the CA server");
+
+    testSlowClient();
+
+    ca_context_destroy();
+
+    /* The CA server can't be stopped, so the database is left in place */
+    return testDone();
+}
@@ -41,37 +41,46 @@ static int cond_search(const char **ppinst, int match);
 /* calcPerform
  *
  * Evalutate the postfix expression
+ *
+ * The value on top of the stack is kept in the local variable top, which
+ * the compiler can hold in a register; ptop points to the slot above the
+ * values underneath it.  Pushing saves top in that slot first, binary
+ * operators combine top with the value popped from below.
  */
 LIBCOM_API long
     calcPerform(double *parg, double *presult, const char *pinst)
 {
     double stack[CALCPERFORM_STACK+1];  /* zero'th entry not used */
-    double *ptop;                       /* stack pointer */
+    double *ptop;                       /* slot above the values below top */
     double top;                         /* value from top of stack */
     epicsInt32 itop;                    /* integer from top of stack */
     int op;
     int nargs;
 
-    /* initialize */
+    /* initialize, the first push saves top into the zero'th entry */
     ptop = stack;
+    top = 0.0;
 
     /* RPN evaluation loop */
     while ((op = *pinst++) != END_EXPRESSION){
         switch (op){
 
         case LITERAL_DOUBLE:
-            memcpy(++ptop, pinst, sizeof(double));
+            *ptop++ = top;
+            memcpy(&top, pinst, sizeof(double));
             pinst += sizeof(double);
             break;
 
         case LITERAL_INT:
+            *ptop++ = top;
             memcpy(&itop, pinst, sizeof(epicsInt32));
-            *++ptop = itop;
+            top = itop;
             pinst += sizeof(epicsInt32);
             break;
 
         case FETCH_VAL:
-            *++ptop = *presult;
+            *ptop++ = top;
+            top = *presult;
             break;
 
         case FETCH_A:
@@ -86,7 +95,8 @@ LIBCOM_API long
         case FETCH_J:
         case FETCH_K:
         case FETCH_L:
-            *++ptop = parg[op - FETCH_A];
+            *ptop++ = top;
+            top = parg[op - FETCH_A];
             break;
 
         case STORE_A:
@@ -101,195 +111,193 @@ LIBCOM_API long
         case STORE_J:
         case STORE_K:
         case STORE_L:
-            parg[op - STORE_A] = *ptop--;
+            parg[op - STORE_A] = top;
+            top = *--ptop;
             break;
 
         case CONST_PI:
-            *++ptop = PI;
+            *ptop++ = top;
+            top = PI;
             break;
 
         case CONST_D2R:
-            *++ptop = PI/180.;
+            *ptop++ = top;
+            top = PI/180.;
             break;
 
         case CONST_R2D:
-            *++ptop = 180./PI;
+            *ptop++ = top;
+            top = 180./PI;
             break;
 
         case UNARY_NEG:
-            *ptop = - *ptop;
+            top = - top;
             break;
 
         case ADD:
-            top = *ptop--;
-            *ptop += top;
+            top = *--ptop + top;
             break;
 
         case SUB:
-            top = *ptop--;
-            *ptop -= top;
+            top = *--ptop - top;
             break;
 
         case MULT:
-            top = *ptop--;
-            *ptop *= top;
+            top = *--ptop * top;
             break;
 
         case DIV:
-            top = *ptop--;
-            *ptop /= top;
+            top = *--ptop / top;
             break;
 
         case MODULO:
-            itop = (epicsInt32) *ptop--;
+            itop = (epicsInt32) top;
+            top = *--ptop;
             if (itop)
-                *ptop = (epicsInt32) *ptop % itop;
+                top = (epicsInt32) top % itop;
             else
-                *ptop = epicsNAN;
+                top = epicsNAN;
             break;
 
         case POWER:
-            top = *ptop--;
-            *ptop = pow(*ptop, top);
+            top = pow(*--ptop, top);
             break;
 
         case ABS_VAL:
-            *ptop = fabs(*ptop);
+            top = fabs(top);
             break;
 
         case EXP:
-            *ptop = exp(*ptop);
+            top = exp(top);
             break;
 
         case LOG_10:
-            *ptop = log10(*ptop);
+            top = log10(top);
             break;
 
         case LOG_E:
-            *ptop = log(*ptop);
+            top = log(top);
             break;
 
         case MAX:
             nargs = *pinst++;
             while (--nargs) {
-                top = *ptop--;
-                if (*ptop < top || isnan(top))
-                    *ptop = top;
+                double below = *--ptop;
+
+                if (!(below < top || isnan(top)))
+                    top = below;
             }
             break;
 
         case MIN:
             nargs = *pinst++;
             while (--nargs) {
-                top = *ptop--;
-                if (*ptop > top || isnan(top))
-                    *ptop = top;
+                double below = *--ptop;
+
+                if (!(below > top || isnan(top)))
+                    top = below;
             }
             break;
 
         case SQU_RT:
-            *ptop = sqrt(*ptop);
+            top = sqrt(top);
             break;
 
         case ACOS:
-            *ptop = acos(*ptop);
+            top = acos(top);
             break;
 
         case ASIN:
-            *ptop = asin(*ptop);
+            top = asin(top);
             break;
 
         case ATAN:
-            *ptop = atan(*ptop);
+            top = atan(top);
             break;
 
         case ATAN2:
-            top = *ptop--;
-            *ptop = atan2(top, *ptop);  /* Ouch!: Args backwards! */
+            top = atan2(top, *--ptop);  /* Ouch!: Args backwards! */
             break;
 
         case COS:
-            *ptop = cos(*ptop);
+            top = cos(top);
             break;
 
         case SIN:
-            *ptop = sin(*ptop);
+            top = sin(top);
             break;
 
         case TAN:
-            *ptop = tan(*ptop);
+            top = tan(top);
             break;
 
         case COSH:
-            *ptop = cosh(*ptop);
+            top = cosh(top);
             break;
 
         case SINH:
-            *ptop = sinh(*ptop);
+            top = sinh(top);
             break;
 
         case TANH:
-            *ptop = tanh(*ptop);
+            top = tanh(top);
             break;
 
         case CEIL:
-            *ptop = ceil(*ptop);
+            top = ceil(top);
             break;
 
         case FLOOR:
-            *ptop = floor(*ptop);
+            top = floor(top);
             break;
 
         case FMOD:
-            top = *ptop--;
-            *ptop = fmod(*ptop, top);
+            top = fmod(*--ptop, top);
             break;
 
         case FINITE:
             nargs = *pinst++;
-            top = finite(*ptop);
+            top = finite(top);
             while (--nargs) {
-                --ptop;
-                top = top && finite(*ptop);
+                double below = *--ptop;
+
+                top = top && finite(below);
             }
-            *ptop = top;
             break;
 
         case ISINF:
-            *ptop = isinf(*ptop);
+            top = isinf(top);
             break;
 
         case ISNAN:
             nargs = *pinst++;
-            top = isnan(*ptop);
+            top = isnan(top);
             while (--nargs) {
-                --ptop;
-                top = top || isnan(*ptop);
+                double below = *--ptop;
+
+                top = top || isnan(below);
             }
-            *ptop = top;
             break;
 
         case NINT:
-            top = *ptop;
-            *ptop = (epicsInt32) (top >= 0 ? top + 0.5 : top - 0.5);
+            top = (epicsInt32) (top >= 0 ? top + 0.5 : top - 0.5);
             break;
 
         case RANDOM:
-            *++ptop = calcRandom();
+            *ptop++ = top;
+            top = calcRandom();
             break;
 
         case REL_OR:
-            top = *ptop--;
-            *ptop = *ptop || top;
+            top = *--ptop || top;
             break;
 
         case REL_AND:
-            top = *ptop--;
-            *ptop = *ptop && top;
+            top = *--ptop && top;
             break;
 
         case REL_NOT:
-            *ptop = ! *ptop;
+            top = ! top;
             break;
 
         /* Be VERY careful converting double to int in case bit 31 is set!
@@ -307,22 +315,22 @@ LIBCOM_API long
         #define d2ui(x) ((x)<0?(epicsUInt32)(epicsInt32)(x):(epicsUInt32)(x))
 
         case BIT_OR:
-            top = *ptop--;
-            *ptop = (double)(d2i(*ptop) | d2i(top));
+            --ptop;
+            top = (double)(d2i(*ptop) | d2i(top));
             break;
 
         case BIT_AND:
-            top = *ptop--;
-            *ptop = (double)(d2i(*ptop) & d2i(top));
+            --ptop;
+            top = (double)(d2i(*ptop) & d2i(top));
             break;
 
         case BIT_EXCL_OR:
-            top = *ptop--;
-            *ptop = (double)(d2i(*ptop) ^ d2i(top));
+            --ptop;
+            top = (double)(d2i(*ptop) ^ d2i(top));
             break;
 
         case BIT_NOT:
-            *ptop = (double)~d2i(*ptop);
+            top = (double)~d2i(top);
             break;
 
         /* In C the shift operators decide on an arithmetic or logical shift
@@ -334,53 +342,48 @@ LIBCOM_API long
          */
 
         case RIGHT_SHIFT_ARITH:
-            top = *ptop--;
-            *ptop = (double)(d2i(*ptop) >> (d2i(top) & 31));
+            --ptop;
+            top = (double)(d2i(*ptop) >> (d2i(top) & 31));
             break;
 
         case LEFT_SHIFT_ARITH:
-            top = *ptop--;
-            *ptop = (double)(d2i(*ptop) << (d2i(top) & 31));
+            --ptop;
+            top = (double)(d2i(*ptop) << (d2i(top) & 31));
             break;
 
         case RIGHT_SHIFT_LOGIC:
-            top = *ptop--;
-            *ptop = (double)(d2ui(*ptop) >> (d2ui(top) & 31u));
+            --ptop;
+            top = (double)(d2ui(*ptop) >> (d2ui(top) & 31u));
             break;
 
         case NOT_EQ:
-            top = *ptop--;
-            *ptop = *ptop != top;
+            top = *--ptop != top;
             break;
 
         case LESS_THAN:
-            top = *ptop--;
-            *ptop = *ptop < top;
+            top = *--ptop < top;
             break;
 
         case LESS_OR_EQ:
-            top = *ptop--;
-            *ptop = *ptop <= top;
+            top = *--ptop <= top;
             break;
 
         case EQUAL:
-            top = *ptop--;
-            *ptop = *ptop == top;
+            top = *--ptop == top;
             break;
 
         case GR_OR_EQ:
-            top = *ptop--;
-            *ptop = *ptop >= top;
+            top = *--ptop >= top;
             break;
 
         case GR_THAN:
-            top = *ptop--;
-            *ptop = *ptop > top;
+            top = *--ptop > top;
             break;
 
         case COND_IF:
-            if (*ptop-- == 0.0 &&
-                cond_search(&pinst, COND_ELSE)) return -1;
+            itop = top == 0.0;
+            top = *--ptop;
+            if (itop && cond_search(&pinst, COND_ELSE)) return -1;
             break;
 
         case COND_ELSE:
@@ -399,7 +402,7 @@ LIBCOM_API long
     /* The stack should now have one item on it, the expression value */
     if (ptop != stack + 1)
         return -1;
-    *presult = *ptop;
+    *presult = top;
     return 0;
 }
 
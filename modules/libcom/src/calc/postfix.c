@@ -15,6 +15,7 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
@@ -207,6 +208,323 @@ static int
 }
 
 
+/* Constant folding
+ *
+ * The postfix expression is rewritten so operators whose operands are all
+ * constants are replaced by their result, and conditionals with a constant
+ * condition lose the branch that can never be taken.  Constant operations
+ * are evaluated by calcPerform() itself, so the folded values are exactly
+ * those that would have been calculated at runtime.  The rewritten
+ * expression is never longer than the original.
+ */
+
+typedef struct {
+    int isConst;        /* value is known at compile time */
+    size_t start;       /* offset of the instructions that compute it */
+} fold_value;
+
+typedef enum {
+    FOLD_NONE,          /* condition not constant, both branches kept */
+    FOLD_THEN,          /* condition true, else branch dropped */
+    FOLD_ELSE           /* condition false, then branch dropped */
+} fold_type;
+
+typedef struct {
+    fold_type type;
+    int depth;          /* stack depth after popping the condition */
+    int thenDepth;      /* stack depth at the end of the then branch */
+} fold_cond;
+
+#define FOLD_MAX_COND 80
+
+static size_t
+    fold_inst_size(const char *pinst)
+{
+    switch (*pinst) {
+    case LITERAL_DOUBLE:
+        return 1 + sizeof(double);
+    case LITERAL_INT:
+        return 1 + sizeof(epicsInt32);
+    case MIN:
+    case MAX:
+    case FINITE:
+    case ISNAN:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+/* Number of operands for an operator that has no side effects,
+ * or 0 for any other instruction.
+ */
+static int
+    fold_operands(const char *pinst)
+{
+    switch (*pinst) {
+    case UNARY_NEG:
+    case ABS_VAL:
+    case EXP:
+    case LOG_10:
+    case LOG_E:
+    case SQU_RT:
+    case ACOS:
+    case ASIN:
+    case ATAN:
+    case COS:
+    case COSH:
+    case SIN:
+    case SINH:
+    case TAN:
+    case TANH:
+    case CEIL:
+    case FLOOR:
+    case ISINF:
+    case NINT:
+    case REL_NOT:
+    case BIT_NOT:
+        return 1;
+    case ADD:
+    case SUB:
+    case MULT:
+    case DIV:
+    case MODULO:
+    case POWER:
+    case ATAN2:
+    case FMOD:
+    case REL_OR:
+    case REL_AND:
+    case BIT_OR:
+    case BIT_AND:
+    case BIT_EXCL_OR:
+    case RIGHT_SHIFT_ARITH:
+    case LEFT_SHIFT_ARITH:
+    case RIGHT_SHIFT_LOGIC:
+    case NOT_EQ:
+    case LESS_THAN:
+    case LESS_OR_EQ:
+    case EQUAL:
+    case GR_OR_EQ:
+    case GR_THAN:
+        return 2;
+    case MIN:
+    case MAX:
+    case FINITE:
+    case ISNAN:
+        return pinst[1];
+    default:
+        return 0;
+    }
+}
+
+/* Skip to just after the matching conditional operator */
+static int
+    fold_skip(const char **ppinst, int match)
+{
+    const char *pinst = *ppinst;
+    int count = 1;
+    int op;
+
+    while ((op = *pinst) != END_EXPRESSION) {
+        pinst += fold_inst_size(pinst);
+        if (op == match && --count == 0) {
+            *ppinst = pinst;
+            return 0;
+        }
+        if (op == COND_IF)
+            count++;
+    }
+    return -1;
+}
+
+/* Evaluate the constant instructions from pstart up to pend,
+ * which must have room for an END_EXPRESSION.
+ */
+static int
+    fold_eval(char *pstart, char *pend, double *pvalue)
+{
+    double args[CALCPERFORM_NARGS] = {0.0};
+
+    *pend = END_EXPRESSION;
+    return calcPerform(args, pvalue, pstart) ? -1 : 0;
+}
+
+/* Encode a literal in the same way postfix() does, keeping -0.0 */
+static size_t
+    fold_literal(char *pout, double value)
+{
+    static const double zero = 0.0;
+    epicsInt32 lit_i;
+
+    if (value >= -2147483648.0 && value <= 2147483647.0 &&
+        value == (double) (lit_i = (epicsInt32) value) &&
+        (value != 0.0 || !memcmp(&value, &zero, sizeof(double)))) {
+        if (pout) {
+            *pout++ = LITERAL_INT;
+            memcpy(pout, &lit_i, sizeof(epicsInt32));
+        }
+        return 1 + sizeof(epicsInt32);
+    }
+    if (pout) {
+        *pout++ = LITERAL_DOUBLE;
+        memcpy(pout, &value, sizeof(double));
+    }
+    return 1 + sizeof(double);
+}
+
+static void
+    fold_constants(char *pinst)
+{
+    fold_value stack[CALCPERFORM_STACK + 1];
+    fold_cond conds[FOLD_MAX_COND];
+    const char *pin = pinst;
+    char *pbuf, *pout;
+    size_t len, barrier = 0;
+    int depth = 0;
+    int ncond = 0;
+
+    for (len = 0; pinst[len] != END_EXPRESSION; )
+        len += fold_inst_size(pinst + len);
+    pout = pbuf = malloc(len + 1);
+    if (!pbuf)
+        return;
+
+    while (*pin != END_EXPRESSION) {
+        size_t size = fold_inst_size(pin);
+        int op = *pin;
+        int nargs, i;
+
+        switch (op) {
+        case LITERAL_DOUBLE:
+        case LITERAL_INT:
+        case CONST_PI:
+        case CONST_D2R:
+        case CONST_R2D:
+            if (depth >= CALCPERFORM_STACK)
+                goto done;
+            stack[depth].isConst = TRUE;
+            stack[depth++].start = pout - pbuf;
+            break;
+
+        case FETCH_VAL:
+        case FETCH_A: case FETCH_B: case FETCH_C: case FETCH_D:
+        case FETCH_E: case FETCH_F: case FETCH_G: case FETCH_H:
+        case FETCH_I: case FETCH_J: case FETCH_K: case FETCH_L:
+        case RANDOM:
+            if (depth >= CALCPERFORM_STACK)
+                goto done;
+            stack[depth].isConst = FALSE;
+            stack[depth++].start = pout - pbuf;
+            break;
+
+        case STORE_A: case STORE_B: case STORE_C: case STORE_D:
+        case STORE_E: case STORE_F: case STORE_G: case STORE_H:
+        case STORE_I: case STORE_J: case STORE_K: case STORE_L:
+            if (depth < 1)
+                goto done;
+            depth--;
+            /* nothing before a store may be folded into later values */
+            barrier = pout - pbuf + size;
+            break;
+
+        case COND_IF:
+            if (depth < 1 || ncond >= FOLD_MAX_COND)
+                goto done;
+            depth--;
+            conds[ncond].depth = depth;
+            if (stack[depth].isConst && stack[depth].start >= barrier) {
+                double cond;
+
+                if (fold_eval(pbuf + stack[depth].start, pout, &cond))
+                    goto done;
+                pout = pbuf + stack[depth].start;
+                pin += size;
+                if (cond != 0.0) {
+                    conds[ncond++].type = FOLD_THEN;
+                }
+                else {
+                    conds[ncond++].type = FOLD_ELSE;
+                    if (fold_skip(&pin, COND_ELSE))
+                        goto done;
+                }
+                continue;
+            }
+            conds[ncond++].type = FOLD_NONE;
+            barrier = pout - pbuf + size;
+            break;
+
+        case COND_ELSE:
+            if (ncond < 1)
+                goto done;
+            if (conds[ncond - 1].type == FOLD_THEN) {
+                pin += size;
+                if (fold_skip(&pin, COND_END))
+                    goto done;
+                ncond--;
+                continue;
+            }
+            conds[ncond - 1].thenDepth = depth;
+            depth = conds[ncond - 1].depth;
+            barrier = pout - pbuf + size;
+            break;
+
+        case COND_END:
+            if (ncond < 1)
+                goto done;
+            ncond--;
+            if (conds[ncond].type == FOLD_ELSE) {
+                pin += size;
+                continue;
+            }
+            if (depth < 1 || depth != conds[ncond].thenDepth)
+                goto done;
+            stack[depth - 1].isConst = FALSE;
+            barrier = pout - pbuf + size;
+            break;
+
+        default:
+            nargs = fold_operands(pin);
+            if (nargs < 1 || nargs > depth)
+                goto done;
+            memcpy(pout, pin, size);
+            pout += size;
+            pin += size;
+            depth -= nargs;
+            for (i = 0; i < nargs; i++) {
+                if (!stack[depth + i].isConst)
+                    break;
+            }
+            if (i == nargs && stack[depth].start >= barrier) {
+                char *pstart = pbuf + stack[depth].start;
+                double value;
+
+                if (fold_eval(pstart, pout, &value))
+                    goto done;
+                if (fold_literal(NULL, value) <= (size_t) (pout - pstart))
+                    pout = pstart + fold_literal(pstart, value);
+            }
+            else {
+                stack[depth].isConst = FALSE;
+            }
+            depth++;
+            continue;
+        }
+        memcpy(pout, pin, size);
+        pout += size;
+        pin += size;
+    }
+
+    if (ncond == 0) {
+        /* clear the unused tail too, so the buffer contents are repeatable */
+        memset(pout, END_EXPRESSION, len + 1 - (pout - pbuf));
+        memcpy(pinst, pbuf, len + 1);
+    }
+
+done:
+    free(pbuf);
+}
+
+
 /* postfix
  *
  * convert an infix expression to a postfix expression
@@ -491,6 +809,7 @@ LIBCOM_API long
         *perror = CALC_ERR_INCOMPLETE;
         goto bad;
     }
+    fold_constants(pdest);
     return 0;
 
 bad:
@@ -579,6 +898,7 @@ LIBCOM_API void
     /* Numeric */
         "CEIL",
         "FLOOR",
+        "FMOD",
         "FINITE",
         "ISINF",
         "ISNAN",
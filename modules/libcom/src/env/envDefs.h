@@ -54,6 +54,7 @@ LIBCOM_API extern const ENV_PARAM EPICS_CA_AUTO_ARRAY_BYTES;
 LIBCOM_API extern const ENV_PARAM EPICS_CA_MAX_SEARCH_PERIOD;
 LIBCOM_API extern const ENV_PARAM EPICS_CA_NAME_SERVERS;
 LIBCOM_API extern const ENV_PARAM EPICS_CA_MCAST_TTL;
+LIBCOM_API extern const ENV_PARAM EPICS_CA_IO_THREADS;
 LIBCOM_API extern const ENV_PARAM EPICS_CAS_INTF_ADDR_LIST;
 LIBCOM_API extern const ENV_PARAM EPICS_CAS_IGNORE_ADDR_LIST;
 LIBCOM_API extern const ENV_PARAM EPICS_CAS_AUTO_BEACON_ADDR_LIST;
@@ -62,6 +63,7 @@ LIBCOM_API extern const ENV_PARAM EPICS_CAS_SERVER_PORT;
 LIBCOM_API extern const ENV_PARAM EPICS_CA_BEACON_PERIOD; /**< \brief deprecated */
 LIBCOM_API extern const ENV_PARAM EPICS_CAS_BEACON_PERIOD;
 LIBCOM_API extern const ENV_PARAM EPICS_CAS_BEACON_PORT;
+LIBCOM_API extern const ENV_PARAM EPICS_CAS_IO_THREADS;
 LIBCOM_API extern const ENV_PARAM EPICS_BUILD_COMPILER_CLASS;
 LIBCOM_API extern const ENV_PARAM EPICS_BUILD_OS_CLASS;
 LIBCOM_API extern const ENV_PARAM EPICS_BUILD_TARGET_ARCH;
@@ -31,7 +31,22 @@ extern "C" {
 
 LIBCOM_API extern int freeListBypass;
 
+/** \brief Flag for freeListInitFlags(), cache free elements per thread.
+ *
+ * Each thread which uses the list keeps a small stash of free elements,
+ * so that it rarely takes the list mutex.  This costs a thread private
+ * variable for each list, and a stash in each thread which is only
+ * released when that thread exits, so it is meant for lists which are
+ * used for the life of the process.
+ */
+#define FREELIST_THREAD_CACHE 0x1
+
 LIBCOM_API void epicsStdCall freeListInitPvt(void **ppvt, int size, int malloc);
+/** \brief Like freeListInitPvt(), with FREELIST_* flags.
+ * \since UNRELEASED
+ */
+LIBCOM_API void epicsStdCall freeListInitFlags(void **ppvt, int size,
+    int malloc, unsigned flags);
 LIBCOM_API void * epicsStdCall freeListCalloc(void *pvt);
 LIBCOM_API void * epicsStdCall freeListMalloc(void *pvt);
 LIBCOM_API void epicsStdCall freeListFree(void *pvt,void*pmem);
@@ -24,6 +24,8 @@
 
 #include "cantProceed.h"
 #include "epicsMutex.h"
+#include "epicsThread.h"
+#include "epicsExit.h"
 #include "freeList.h"
 #include "adjustment.h"
 #include "errlog.h"
@@ -31,6 +33,18 @@
 #include "epicsAtomic.h"
 #include "epicsExport.h"
 
+/* With FREELIST_THREAD_CACHE each thread keeps a small stash (magazine)
+ * of free elements for each list it uses, so most calls avoid the list
+ * mutex.  Magazines are only released when their threads exit, so short
+ * lived lists don't use them.  Elements move between
+ * a magazine and the shared list in batches of half the magazine size.
+ * Magazines are limited to both MAG_MAX elements and MAG_BYTES of memory,
+ * lists of large elements are not cached per thread at all.
+ */
+#define MAG_MAX 32
+#define MAG_MIN 4
+#define MAG_BYTES 16384
+
 /* Bypass free list and directly call malloc() every time? */
 int freeListBypass
 #ifdef EPICS_FREELIST_DEBUG
@@ -45,6 +59,7 @@ typedef struct allocMem {
     struct allocMem     *next;
     void                *memory;
 }allocMem;
+struct freeListMag;
 typedef struct {
     int         size;
     int         nmalloc;
@@ -52,10 +67,123 @@ typedef struct {
     allocMem    *mallochead;
     size_t      nBlocksAvailable;
     epicsMutexId lock;
+    /* per-thread caching, magKey is NULL if disabled */
+    epicsThreadPrivateId magKey;
+    size_t      magSize;
+    struct freeListMag *mags;
 }FREELISTPVT;
 
-LIBCOM_API void epicsStdCall 
+typedef struct freeListMag {
+    struct freeListMag *next;   /* in FREELISTPVT::mags, guarded by lock */
+    FREELISTPVT *pfl;           /* NULL after freeListCleanup(), magLock */
+    void        *head;          /* only used by the owning thread */
+    size_t      count;          /* epicsAtomic, read by freeListItemsAvail */
+}freeListMag;
+
+/* Marks a thread which can't cache elements */
+static freeListMag noMag;
+
+static epicsThreadOnceId magOnce = EPICS_THREAD_ONCE_INIT;
+static epicsMutexId magLock;
+
+static void magOnceFunc(void *unused)
+{
+    magLock = epicsMutexMustCreate();
+}
+
+/* Move up to n elements from the list of pfl onto the magazine.
+ * pfl->lock must be held.
+ */
+static void magFill(FREELISTPVT *pfl, freeListMag *pmag, size_t n)
+{
+    size_t count = epicsAtomicGetSizeT(&pmag->count);
+
+    while(n-- && pfl->head) {
+        void **ppnext = pfl->head;
+        pfl->head = *ppnext;
+        *ppnext = pmag->head;
+        pmag->head = ppnext;
+        pfl->nBlocksAvailable--;
+        count++;
+    }
+    epicsAtomicSetSizeT(&pmag->count, count);
+}
+
+/* Move up to n elements from the magazine back to the list of pfl.
+ * pfl->lock must be held.
+ */
+static void magFlush(FREELISTPVT *pfl, freeListMag *pmag, size_t n)
+{
+    size_t count = epicsAtomicGetSizeT(&pmag->count);
+
+    while(n-- && pmag->head) {
+        void **ppnext = pmag->head;
+        pmag->head = *ppnext;
+        *ppnext = pfl->head;
+        pfl->head = ppnext;
+        pfl->nBlocksAvailable++;
+        count--;
+    }
+    epicsAtomicSetSizeT(&pmag->count, count);
+}
+
+static void magThreadExit(void *arg)
+{
+    freeListMag *pmag = arg;
+    FREELISTPVT *pfl;
+
+    epicsMutexMustLock(magLock);
+    pfl = pmag->pfl;
+    if(pfl) {
+        freeListMag **pprev;
+
+        epicsMutexMustLock(pfl->lock);
+        magFlush(pfl, pmag, (size_t)-1);
+        for(pprev = &pfl->mags; *pprev != pmag; pprev = &(*pprev)->next) {}
+        *pprev = pmag->next;
+        epicsMutexUnlock(pfl->lock);
+        epicsThreadPrivateSet(pfl->magKey, NULL);
+    }
+    epicsMutexUnlock(magLock);
+    free(pmag);
+}
+
+/* Find or create the magazine of the calling thread.
+ * Returns NULL if this thread does not cache elements.
+ */
+static freeListMag * magGet(FREELISTPVT *pfl)
+{
+    freeListMag *pmag = epicsThreadPrivateGet(pfl->magKey);
+
+    if(pmag == &noMag)
+        return NULL;
+    if(pmag)
+        return pmag;
+
+    /* elements are returned to the list when the thread exits */
+    pmag = calloc(1, sizeof(*pmag));
+    if(!pmag || epicsAtThreadExit(magThreadExit, pmag)) {
+        free(pmag);
+        epicsThreadPrivateSet(pfl->magKey, &noMag);
+        return NULL;
+    }
+    pmag->pfl = pfl;
+    epicsMutexMustLock(pfl->lock);
+    pmag->next = pfl->mags;
+    pfl->mags = pmag;
+    epicsMutexUnlock(pfl->lock);
+    epicsThreadPrivateSet(pfl->magKey, pmag);
+    return pmag;
+}
+
+LIBCOM_API void epicsStdCall
     freeListInitPvt(void **ppvt,int size,int nmalloc)
+{
+    freeListInitFlags(ppvt, size, nmalloc, 0u);
+}
+
+LIBCOM_API void epicsStdCall
+    freeListInitFlags(void **ppvt,int size,int nmalloc,unsigned flags)
 {
     FREELISTPVT *pfl;
     int bypass = epicsAtomicGetIntT(&freeListBypass);
@@ -73,7 +201,7 @@ LIBCOM_API void epicsStdCall
         epicsAtomicSetIntT(&freeListBypass, bypass);
     }
 
-    pfl = callocMustSucceed(1,sizeof(FREELISTPVT), "freeListInitPvt");
+    pfl = callocMustSucceed(1,sizeof(FREELISTPVT), "freeListInitFlags");
     pfl->size = adjustToWorstCaseAlignment(size);
     if(!bypass)
         pfl->nmalloc = nmalloc; /* nmalloc==0 to bypass */
@@ -81,6 +209,15 @@ LIBCOM_API void epicsStdCall
     pfl->mallochead = NULL;
     pfl->nBlocksAvailable = 0u;
     pfl->lock = epicsMutexMustCreate();
+    pfl->magSize = MAG_BYTES / pfl->size;
+    if(pfl->magSize > MAG_MAX)
+        pfl->magSize = MAG_MAX;
+    if(pfl->magSize > (size_t)pfl->nmalloc)
+        pfl->magSize = pfl->nmalloc;
+    if((flags & FREELIST_THREAD_CACHE) && pfl->magSize >= MAG_MIN) {
+        epicsThreadOnce(&magOnce, magOnceFunc, NULL);
+        pfl->magKey = epicsThreadPrivateCreate(); /* may fail */
+    }
     *ppvt = (void *)pfl;
     VALGRIND_CREATE_MEMPOOL(pfl, REDZONE, 0);
 }
@@ -97,57 +234,84 @@ LIBCOM_API void * epicsStdCall freeListCalloc(void *pvt)
     return(ptemp);
 }
 
-LIBCOM_API void * epicsStdCall freeListMalloc(void *pvt)
+/* Add another block of nmalloc elements to the list.
+ * pfl->lock must be held.  Returns false if out of memory.
+ */
+static int freeListGrow(FREELISTPVT *pfl)
 {
-    FREELISTPVT *pfl = pvt;
     void        *ptemp;
     void        **ppnext;
     allocMem    *pallocmem;
     int         i;
 
+    /* layout of each block. nmalloc+1 REDZONEs for nmallocs.
+     * The first sizeof(void*) bytes are used to store a pointer
+     * to the next free block.
+     *
+     * | RED | size0 ------ | RED | size1 | ... | RED |
+     * |     | next | ----- |
+     */
+    ptemp = (void *)malloc(pfl->nmalloc*(pfl->size+REDZONE)+REDZONE);
+    if(ptemp==0)
+        return 0;
+    pallocmem = (allocMem *)calloc(1,sizeof(allocMem));
+    if(pallocmem==0) {
+        free(ptemp);
+        return 0;
+    }
+    pallocmem->memory = ptemp; /* real allocation */
+    ptemp = REDZONE + (char *) ptemp; /* skip first REDZONE */
+    if(pfl->mallochead)
+        pallocmem->next = pfl->mallochead;
+    pfl->mallochead = pallocmem;
+    for(i=0; i<pfl->nmalloc; i++) {
+        ppnext = ptemp;
+        VALGRIND_MEMPOOL_ALLOC(pfl, ptemp, sizeof(void*));
+        *ppnext = pfl->head;
+        pfl->head = ptemp;
+        ptemp = ((char *)ptemp) + pfl->size+REDZONE;
+    }
+    pfl->nBlocksAvailable += pfl->nmalloc;
+    return 1;
+}
+
+LIBCOM_API void * epicsStdCall freeListMalloc(void *pvt)
+{
+    FREELISTPVT *pfl = pvt;
+    freeListMag *pmag;
+    void        *ptemp;
+    void        **ppnext;
+
     if(!pfl->nmalloc)
         return malloc(pfl->size);
 
-    epicsMutexMustLock(pfl->lock);
-    ptemp = pfl->head;
-    if(ptemp==0) {
-        /* layout of each block. nmalloc+1 REDZONEs for nmallocs.
-         * The first sizeof(void*) bytes are used to store a pointer
-         * to the next free block.
-         *
-         * | RED | size0 ------ | RED | size1 | ... | RED |
-         * |     | next | ----- |
-         */
-        ptemp = (void *)malloc(pfl->nmalloc*(pfl->size+REDZONE)+REDZONE);
-        if(ptemp==0) {
+    if(pfl->magKey && !!(pmag = magGet(pfl))) {
+        if(!pmag->head) {
+            epicsMutexMustLock(pfl->lock);
+            if(!pfl->head && !freeListGrow(pfl)) {
+                epicsMutexUnlock(pfl->lock);
+                return(0);
+            }
+            magFill(pfl, pmag, pfl->magSize / 2);
             epicsMutexUnlock(pfl->lock);
-            return(0);
         }
-        pallocmem = (allocMem *)calloc(1,sizeof(allocMem));
-        if(pallocmem==0) {
+        ppnext = pmag->head;
+        pmag->head = *ppnext;
+        epicsAtomicDecrSizeT(&pmag->count);
+        ptemp = ppnext;
+    }
+    else {
+        epicsMutexMustLock(pfl->lock);
+        if(!pfl->head && !freeListGrow(pfl)) {
             epicsMutexUnlock(pfl->lock);
-            free(ptemp);
             return(0);
         }
-        pallocmem->memory = ptemp; /* real allocation */
-        ptemp = REDZONE + (char *) ptemp; /* skip first REDZONE */
-        if(pfl->mallochead)
-            pallocmem->next = pfl->mallochead;
-        pfl->mallochead = pallocmem;
-        for(i=0; i<pfl->nmalloc; i++) {
-            ppnext = ptemp;
-            VALGRIND_MEMPOOL_ALLOC(pfl, ptemp, sizeof(void*));
-            *ppnext = pfl->head;
-            pfl->head = ptemp;
-            ptemp = ((char *)ptemp) + pfl->size+REDZONE;
-        }
-        ptemp = pfl->head;
-        pfl->nBlocksAvailable += pfl->nmalloc;
+        ppnext = pfl->head;
+        pfl->head = *ppnext;
+        pfl->nBlocksAvailable--;
+        epicsMutexUnlock(pfl->lock);
+        ptemp = ppnext;
     }
-    ppnext = pfl->head;
-    pfl->head = *ppnext;
-    pfl->nBlocksAvailable--;
-    epicsMutexUnlock(pfl->lock);
     VALGRIND_MEMPOOL_FREE(pfl, ptemp);
     VALGRIND_MEMPOOL_ALLOC(pfl, ptemp, pfl->size);
     return(ptemp);
@@ -156,6 +320,7 @@ LIBCOM_API void * epicsStdCall freeListMalloc(void *pvt)
 LIBCOM_API void epicsStdCall freeListFree(void *pvt,void*pmem)
 {
     FREELISTPVT *pfl = pvt;
+    freeListMag *pmag;
     void        **ppnext;
 
     memset(pmem, 0xfe, pfl->size);
@@ -168,8 +333,20 @@ LIBCOM_API void epicsStdCall freeListFree(void *pvt,void*pmem)
     VALGRIND_MEMPOOL_FREE(pvt, pmem);
     VALGRIND_MEMPOOL_ALLOC(pvt, pmem, sizeof(void*));
 
-    epicsMutexMustLock(pfl->lock);
     ppnext = pmem;
+    if(pfl->magKey && !!(pmag = magGet(pfl))) {
+        if(epicsAtomicGetSizeT(&pmag->count) >= pfl->magSize) {
+            epicsMutexMustLock(pfl->lock);
+            magFlush(pfl, pmag, pfl->magSize / 2);
+            epicsMutexUnlock(pfl->lock);
+        }
+        *ppnext = pmag->head;
+        pmag->head = pmem;
+        epicsAtomicIncrSizeT(&pmag->count);
+        return;
+    }
+
+    epicsMutexMustLock(pfl->lock);
     *ppnext = pfl->head;
     pfl->head = pmem;
     pfl->nBlocksAvailable++;
@@ -184,6 +361,17 @@ LIBCOM_API void epicsStdCall freeListCleanup(void *pvt)
 
     VALGRIND_DESTROY_MEMPOOL(pvt);
 
+    if(pfl->magKey) {
+        freeListMag *pmag;
+
+        /* magazines are freed when their threads exit */
+        epicsMutexMustLock(magLock);
+        for(pmag = pfl->mags; pmag; pmag = pmag->next)
+            pmag->pfl = NULL;
+        epicsMutexUnlock(magLock);
+        epicsThreadPrivateDelete(pfl->magKey);
+    }
+
     phead = pfl->mallochead;
     while(phead) {
         pnext = phead->next;
@@ -199,8 +387,11 @@ LIBCOM_API size_t epicsStdCall freeListItemsAvail(void *pvt)
 {
     FREELISTPVT *pfl = pvt;
     size_t nBlocksAvailable;
+    freeListMag *pmag;
     epicsMutexMustLock(pfl->lock);
     nBlocksAvailable = pfl->nBlocksAvailable;
+    for(pmag = pfl->mags; pmag; pmag = pmag->next)
+        nBlocksAvailable += epicsAtomicGetSizeT(&pmag->count);
     epicsMutexUnlock(pfl->lock);
     return nBlocksAvailable;
 }
@@ -186,6 +186,24 @@ LIBCOM_API unsigned int epicsStrHash(const char *str, unsigned int seed);
   */    
 LIBCOM_API unsigned int epicsMemHash(const char *str, size_t length,
                                          unsigned int seed);
+
+ /** \brief Calculates a hash of a large memory buffer
+  *
+  * A faster alternative to epicsMemHash() for large buffers such as the
+  * value of an array record, which reads the buffer a 64-bit word at a
+  * time.  The result is different from epicsMemHash(), and may differ
+  * between big and little endian targets for the same bytes.  Like
+  * epicsMemHash(), it returns the seed for an empty buffer.
+  *
+  *\param buf    buffer
+  *\param length size of buffer
+  *\param seed   Optionally provide seed to combine multiple buffers in a single hash.  Otherwise
+  *              set to 0.
+  *
+  *\return Hash value for buffer
+  */
+LIBCOM_API unsigned int epicsMemHashWide(const void *buf, size_t length,
+                                         unsigned int seed);
 /** \brief Compare two strings and return a number in the range [0.0, 1.0] or -1.0 on error.
  *
  * Computes a normalized edit distance representing the similarity between two strings.
@@ -14,6 +14,7 @@
 #include <stdlib.h>
 
 #include "epicsTypes.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsMessageQueue.h"
@@ -59,11 +60,22 @@ typedef struct {
     } getInt;
 } gtProvider;
 
+/* Read-only copy of timeProviders for epicsTimeGetCurrent().
+ * Providers are never removed, and a superseded copy is never freed
+ * as a reader may still be using it.
+ */
+typedef struct {
+    int             count;
+    gtProvider      *providers[1]; /* actually count */
+} gtSnapshot;
+
 static struct {
     epicsMutexId    timeListLock;
     ELLLIST         timeProviders;
+    gtSnapshot      *timeSnapshot;  /* use atomic */
     gtProvider      *lastTimeProvider;
     epicsTimeStamp  lastProvidedTime;
+    size_t          lastProvidedPacked; /* use atomic, with 64-bit size_t */
 
     epicsMutexId    eventListLock;
     ELLLIST         eventProviders;
@@ -85,6 +97,55 @@ static int useOsdGetCurrent = 1;
 
 /* Implementation */
 
+/* A time stamp packed into 64 bits compares the same as epicsTimeStamp */
+#define PACK_TIME(pts) \
+    ((size_t)(pts)->secPastEpoch << 16 << 16 | (pts)->nsec)
+#define UNPACK_TIME(pts, packed) \
+    ((pts)->secPastEpoch = (epicsUInt32)((packed) >> 16 >> 16), \
+     (pts)->nsec = (epicsUInt32)(packed))
+
+static gtSnapshot * getTimeSnapshot(void)
+{
+    return (gtSnapshot *)epicsAtomicGetPtrT(
+        (EpicsAtomicPtrT *)&gtPvt.timeSnapshot);
+}
+
+/* timeListLock must be held */
+static void updateTimeSnapshot(void)
+{
+    int count = ellCount(&gtPvt.timeProviders);
+    gtSnapshot *psnap = callocMustSucceed(1, sizeof(gtSnapshot) +
+        count * sizeof(gtProvider *), "updateTimeSnapshot");
+    gtProvider *ptp;
+
+    for (ptp = (gtProvider *)ellFirst(&gtPvt.timeProviders);
+         ptp; ptp = (gtProvider *)ellNext(&ptp->node)) {
+        psnap->providers[psnap->count++] = ptp;
+    }
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *)&gtPvt.timeSnapshot, psnap);
+}
+
+/* Ratchet lastProvidedPacked forward to *pts, or replace *pts with it.
+ * Returns false if *pts was older.
+ */
+static int monotonicTime(epicsTimeStamp *pts)
+{
+    size_t now = PACK_TIME(pts);
+    size_t last = epicsAtomicGetSizeT(&gtPvt.lastProvidedPacked);
+
+    while (now > last) {
+        size_t prev = epicsAtomicCmpAndSwapSizeT(&gtPvt.lastProvidedPacked,
+            last, now);
+        if (prev == last)
+            return 1;
+        last = prev;
+    }
+    if (now == last)
+        return 1;
+    UNPACK_TIME(pts, last);
+    return 0;
+}
+
 static void generalTime_InitOnce(void *dummy)
 {
     ellInit(&gtPvt.timeProviders);
@@ -105,7 +166,9 @@ void generalTime_Init(void)
 
 int generalTimeGetExceptPriority(epicsTimeStamp *pDest, int *pPrio, int ignore)
 {
+    gtSnapshot *psnap;
     gtProvider *ptp;
+    int i;
     int status = S_time_noProvider;
 
     if(useOsdGetCurrent)
@@ -116,9 +179,9 @@ int generalTimeGetExceptPriority(epicsTimeStamp *pDest, int *pPrio, int ignore)
     IFDEBUG(2)
         printf("generalTimeGetExceptPriority(ignore=%d)\n", ignore);
 
-    epicsMutexMustLock(gtPvt.timeListLock);
-    for (ptp = (gtProvider *)ellFirst(&gtPvt.timeProviders);
-         ptp; ptp = (gtProvider *)ellNext(&ptp->node)) {
+    psnap = getTimeSnapshot();
+    for (i = 0, ptp = NULL; psnap && i < psnap->count; i++) {
+        ptp = psnap->providers[i];
         if ((ignore > 0 && ptp->priority == ignore) ||
             (ignore < 0 && ptp->priority != -ignore))
             continue;
@@ -133,7 +196,6 @@ int generalTimeGetExceptPriority(epicsTimeStamp *pDest, int *pPrio, int ignore)
         else IFDEBUG(2)
             printf("gTGExP provider '%s' returned error\n", ptp->name);
     }
-    epicsMutexUnlock(gtPvt.timeListLock);
 
     IFDEBUG(2) {
         if (ptp && status == epicsTimeOK) {
@@ -164,6 +226,44 @@ int epicsStdCall epicsTimeGetCurrent(epicsTimeStamp *pDest)
     IFDEBUG(20)
         printf("epicsTimeGetCurrent()\n");
 
+    /* With a 64-bit size_t the ratchet is a compare-and-swap,
+     * so no lock is needed.
+     */
+    if (sizeof(size_t) >= 8) {
+        gtSnapshot *psnap = getTimeSnapshot();
+        int i;
+
+        for (i = 0, ptp = NULL; psnap && i < psnap->count; i++) {
+            ptp = psnap->providers[i];
+
+            status = ptp->get.Time(&ts);
+            if (status == epicsTimeOK) {
+                *pDest = ts;
+                if (!monotonicTime(pDest)) {
+                    int key = epicsInterruptLock();
+                    gtPvt.ErrorCounts++;
+                    epicsInterruptUnlock(key);
+
+                    IFDEBUG(10) {
+                        char last[40], buff[40];
+
+                        epicsTimeToStrftime(last, sizeof(last), tsfmt, pDest);
+                        epicsTimeToStrftime(buff, sizeof(buff), tsfmt, &ts);
+                        printf("eTGC provider '%s' returned older time\n"
+                            "    %s, using %s instead\n", ptp->name, buff, last);
+                    }
+                }
+                /* avoid dirtying a shared cache line on every call */
+                if (gtPvt.lastTimeProvider != ptp)
+                    gtPvt.lastTimeProvider = ptp;
+                break;
+            }
+        }
+        if (status && gtPvt.lastTimeProvider)
+            gtPvt.lastTimeProvider = NULL;
+        goto done;
+    }
+
     epicsMutexMustLock(gtPvt.timeListLock);
     for (ptp = (gtProvider *)ellFirst(&gtPvt.timeProviders);
          ptp; ptp = (gtProvider *)ellNext(&ptp->node)) {
@@ -200,6 +300,7 @@ int epicsStdCall epicsTimeGetCurrent(epicsTimeStamp *pDest)
         gtPvt.lastTimeProvider = NULL;
     epicsMutexUnlock(gtPvt.timeListLock);
 
+done:
     IFDEBUG(20) {
         if (ptp && status == epicsTimeOK) {
             char buff[40];
@@ -389,9 +490,12 @@ static void insertProvider(gtProvider *ptp, ELLLIST *plist, epicsMutexId lock)
         ellAdd(plist, &ptp->node);
     }
 
-    /* Check to see if we have more than just the OS default time source */
-    if(plist==&gtPvt.timeProviders && (ellCount(plist)!=1 || ptp->get.Time!=&osdTimeGetCurrent)) {
-        useOsdGetCurrent = 0;
+    if (plist == &gtPvt.timeProviders) {
+        updateTimeSnapshot();
+
+        /* Check to see if we have more than just the OS default time source */
+        if (ellCount(plist)!=1 || ptp->get.Time!=&osdTimeGetCurrent)
+            useOsdGetCurrent = 0;
     }
 
     epicsMutexUnlock(lock);
@@ -35,13 +35,16 @@ template class tsFreeList < timer, 0x20 >;
 #endif
 
 timer::timer ( timerQueue & queueIn ) :
-    queue ( queueIn ), curState ( stateLimbo ), pNotify ( 0 )
+    queue ( queueIn ), heapIndex ( 0u ),
+    curState ( stateLimbo ), pNotify ( 0 )
 {
+    this->queue.reserve ();
 }
 
 timer::~timer ()
 {
     this->cancel ();
+    this->queue.release ();
 }
 
 void timer::destroy ()
@@ -67,57 +70,22 @@ void timer::privateStart ( epicsTimerNotify & notify, const epicsTime & expire )
     this->pNotify = & notify;
     this->exp = expire;
 
-    bool reschedualNeeded = false;
     if ( this->curState == stateActive ) {
         // above expire time and notify will override any restart parameters
         // that may be returned from the timer expire callback
         return;
     }
     else if ( this->curState == statePending ) {
-        this->queue.timerList.remove ( *this );
-        if ( this->queue.timerList.first() == this &&
-                this->queue.timerList.count() > 0 ) {
-            reschedualNeeded = true;
-        }
+        this->queue.remove ( *this );
     }
 
-#   ifdef DEBUG
-        unsigned preemptCount=0u;
-#   endif
-
     //
     // insert into the pending queue
     //
-    // Finds proper time sorted location using a linear search.
-    //
-    // **** this should use a binary tree ????
-    //
-    tsDLIter < timer > pTmr = this->queue.timerList.lastIter ();
-    while ( true ) {
-        if ( ! pTmr.valid () ) {
-            //
-            // add to the beginning of the list
-            //
-            this->queue.timerList.push ( *this );
-            reschedualNeeded = true;
-            break;
-        }
-        if ( pTmr->exp <= this->exp ) {
-            //
-            // add after the item found that expires earlier
-            //
-            this->queue.timerList.insertAfter ( *this, *pTmr );
-            break;
-        }
-#       ifdef DEBUG
-            preemptCount++;
-#       endif
-        --pTmr;
-    }
-
+    this->queue.insert ( *this );
     this->curState = timer::statePending;
 
-    if ( reschedualNeeded ) {
+    if ( this->queue.first () == this ) {
         this->queue.notify.reschedule ();
     }
 
@@ -126,26 +94,21 @@ void timer::privateStart ( epicsTimerNotify & notify, const epicsTime & expire )
         this->queue.show ( 10u );
 #   endif
 
-    debugPrintf ( ("Start of \"%s\" with delay %f at %p preempting %u\n",
+    debugPrintf ( ("Start of \"%s\" with delay %f at %p\n",
         typeid ( this->pNotify ).name (),
-        expire - epicsTime::getCurrent (), 
-        this, preemptCount ) );
+        expire - epicsTime::getCurrent (),
+        this ) );
 }
 
 void timer::cancel ()
 {
-    bool reschedual = false;
     bool wakeupCancelBlockingThreads = false;
     {
         epicsGuard < epicsMutex > locker ( this->queue.mutex );
         this->pNotify = 0;
         if ( this->curState == statePending ) {
-            this->queue.timerList.remove ( *this );
+            this->queue.remove ( *this );
             this->curState = stateLimbo;
-            if ( this->queue.timerList.first() == this &&
-                    this->queue.timerList.count() > 0 ) {
-                reschedual = true;
-            }
         }
         else if ( this->curState == stateActive ) {
             this->queue.cancelPending = true;
@@ -163,9 +126,6 @@ void timer::cancel ()
             }
         }
     }
-    if ( reschedual ) {
-        this->queue.notify.reschedule ();
-    }
     if ( wakeupCancelBlockingThreads ) {
         this->queue.cancelBlockingEvent.signal ();
     }
@@ -18,6 +18,7 @@
 
 #include <typeinfo>
 
+#include "epicsTypes.h"
 #include "tsFreeList.h"
 #include "epicsSingleton.h"
 #include "tsDLList.h"
@@ -37,7 +38,7 @@
 
 template < class T > class epicsGuard;
 
-class timer : public epicsTimer, public tsDLNode < timer > {
+class timer : public epicsTimer {
 public:
     void destroy () override;
     void start ( class epicsTimerNotify &, const epicsTime & ) override final;
@@ -54,6 +55,7 @@ protected:
 private:
     enum state { statePending = 45, stateActive = 56, stateLimbo = 78 };
     epicsTime exp; // expiration time
+    unsigned heapIndex; // position in the pending heap
     state curState; // current state
     epicsTimerNotify * pNotify; // callback
     void privateStart ( epicsTimerNotify & notify, const epicsTime & );
@@ -91,6 +93,18 @@ private:
 
 using std :: type_info;
 
+// An entry in the pending timer heap.  The sort key is kept next to
+// the timer pointer so that maintaining the heap doesn't touch timers.
+struct timerHeapEntry {
+    epicsUInt64 expire; // seconds past epoch << 32 | nanoseconds
+    epicsUInt64 seq; // start order, for timers with the same expiration time
+    class timer * pTmr;
+    bool operator < ( const timerHeapEntry & other ) const {
+        return this->expire < other.expire ||
+            ( this->expire == other.expire && this->seq < other.seq );
+    }
+};
+
 class timerQueue : public epicsTimerQueue {
 public:
     timerQueue ( epicsTimerQueueNotify &notify );
@@ -104,7 +118,13 @@ private:
     tsFreeList < epicsTimerForC, 0x20 > timerForCFreeList;
     mutable epicsMutex mutex;
     epicsEvent cancelBlockingEvent;
-    tsDLList < timer > timerList;
+    // 4-ary heap of pending timers ordered by expiration time,
+    // with one slot reserved for each timer created
+    timerHeapEntry * heap;
+    unsigned heapCount;
+    unsigned heapSize;
+    unsigned timerCount;
+    epicsUInt64 startCount;
     epicsTimerQueueNotify & notify;
     timer * pExpireTmr;
     epicsThreadId processThread;
@@ -113,6 +133,14 @@ private:
     static const double exceptMsgMinPeriod;
     void printExceptMsg ( const char * pName,
                 const type_info & type );
+    timer * first () const;
+    void insert ( timer & );
+    void remove ( timer & );
+    void reserve ();
+    void release ();
+    void place ( const timerHeapEntry &, unsigned index );
+    void siftUp ( const timerHeapEntry &, unsigned index );
+    void siftDown ( const timerHeapEntry &, unsigned index );
     timerQueue ( const timerQueue & );
     timerQueue & operator = ( const timerQueue & );
     friend class timer;
@@ -231,6 +259,11 @@ private:
     epicsTimerQueueActiveForC & operator = ( const epicsTimerQueueActiveForC & );
 };
 
+inline timer * timerQueue::first () const
+{
+    return this->heapCount ? this->heap[0].pTmr : 0;
+}
+
 inline bool timerQueueActive::sharingOK () const
 {
     return this->okToShare;
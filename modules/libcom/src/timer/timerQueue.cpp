@@ -26,6 +26,11 @@ epicsTimerQueue::~epicsTimerQueue () {}
 
 timerQueue::timerQueue ( epicsTimerQueueNotify & notifyIn ) :
     mutex(__FILE__, __LINE__),
+    heap ( 0 ),
+    heapCount ( 0u ),
+    heapSize ( 0u ),
+    timerCount ( 0u ),
+    startCount ( 0u ),
     notify ( notifyIn ),
     pExpireTmr ( 0 ),
     processThread ( 0 ),
@@ -37,9 +42,105 @@ timerQueue::timerQueue ( epicsTimerQueueNotify & notifyIn ) :
 
 timerQueue::~timerQueue ()
 {
-    timer *pTmr;
-    while ( ( pTmr = this->timerList.get () ) ) {
-        pTmr->curState = timer::stateLimbo;
+    for ( unsigned i = 0u; i < this->heapCount; i++ ) {
+        this->heap[i].pTmr->curState = timer::stateLimbo;
+    }
+    delete [] this->heap;
+}
+
+//
+// Each timer reserves a heap slot when it is created so that
+// starting a timer never needs to allocate.
+//
+void timerQueue::reserve ()
+{
+    epicsGuard < epicsMutex > locker ( this->mutex );
+    if ( this->timerCount == this->heapSize ) {
+        unsigned newSize = this->heapSize ? 2u * this->heapSize : 16u;
+        timerHeapEntry * pNewHeap = new timerHeapEntry [newSize];
+        for ( unsigned i = 0u; i < this->heapCount; i++ ) {
+            pNewHeap[i] = this->heap[i];
+        }
+        delete [] this->heap;
+        this->heap = pNewHeap;
+        this->heapSize = newSize;
+    }
+    this->timerCount++;
+}
+
+void timerQueue::release ()
+{
+    epicsGuard < epicsMutex > locker ( this->mutex );
+    this->timerCount--;
+}
+
+void timerQueue::place ( const timerHeapEntry & entry, unsigned index )
+{
+    this->heap[index] = entry;
+    entry.pTmr->heapIndex = index;
+}
+
+void timerQueue::siftUp ( const timerHeapEntry & entry, unsigned index )
+{
+    while ( index > 0u ) {
+        unsigned parent = ( index - 1u ) / 4u;
+        if ( ! ( entry < this->heap[parent] ) ) {
+            break;
+        }
+        this->place ( this->heap[parent], index );
+        index = parent;
+    }
+    this->place ( entry, index );
+}
+
+void timerQueue::siftDown ( const timerHeapEntry & entry, unsigned index )
+{
+    while ( true ) {
+        unsigned child = 4u * index + 1u;
+        if ( child >= this->heapCount ) {
+            break;
+        }
+        unsigned end = child + 4u;
+        if ( end > this->heapCount ) {
+            end = this->heapCount;
+        }
+        unsigned least = child;
+        for ( child++; child < end; child++ ) {
+            if ( this->heap[child] < this->heap[least] ) {
+                least = child;
+            }
+        }
+        if ( ! ( this->heap[least] < entry ) ) {
+            break;
+        }
+        this->place ( this->heap[least], index );
+        index = least;
+    }
+    this->place ( entry, index );
+}
+
+void timerQueue::insert ( timer & tmr )
+{
+    const epicsTimeStamp & ts = tmr.exp;
+    timerHeapEntry entry;
+    entry.expire = ( static_cast < epicsUInt64 > ( ts.secPastEpoch ) << 32 )
+        | ts.nsec;
+    entry.seq = this->startCount++;
+    entry.pTmr = & tmr;
+    this->siftUp ( entry, this->heapCount++ );
+}
+
+void timerQueue::remove ( timer & tmr )
+{
+    unsigned index = tmr.heapIndex;
+    timerHeapEntry last = this->heap[--this->heapCount];
+    if ( index < this->heapCount ) {
+        if ( index > 0u && last < this->heap[( index - 1u ) / 4u] ) {
+            this->siftUp ( last, index );
+        }
+        else {
+            this->siftDown ( last, index );
+        }
     }
 }
 
@@ -83,7 +184,7 @@ double timerQueue::process ( const epicsTime & currentTime )
     if ( this->pExpireTmr ) {
         // if some other thread is processing the queue
         // (or if this is a recursive call)
-        timer * pTmr = this->timerList.first ();
+        timer * pTmr = this->first ();
         if ( pTmr ) {
             double delay = pTmr->exp - currentTime;
             if ( delay < 0.0 ) {
@@ -100,10 +201,10 @@ double timerQueue::process ( const epicsTime & currentTime )
     // Tag current expired tmr so that we can detect if call back
     // is in progress when canceling the timer.
     //
-    if ( this->timerList.first () ) {
-        if ( currentTime >= this->timerList.first ()->exp ) {
-            this->pExpireTmr = this->timerList.first ();
-            this->timerList.remove ( *this->pExpireTmr );
+    if ( this->first () ) {
+        if ( currentTime >= this->first ()->exp ) {
+            this->pExpireTmr = this->first ();
+            this->remove ( *this->pExpireTmr );
             this->pExpireTmr->curState = timer::stateActive;
             this->processThread = epicsThreadGetIdSelf ();
 #           ifdef DEBUG
@@ -111,7 +212,7 @@ double timerQueue::process ( const epicsTime & currentTime )
 #           endif
         }
         else {
-            double delay = this->timerList.first ()->exp - currentTime;
+            double delay = this->first ()->exp - currentTime;
             debugPrintf ( ( "no activity process %f to next\n", delay ) );
             return delay;
         }
@@ -178,17 +279,17 @@ double timerQueue::process ( const epicsTime & currentTime )
         }
         this->pExpireTmr = 0;
 
-        if ( this->timerList.first () ) {
-            if ( currentTime >= this->timerList.first ()->exp ) {
-                this->pExpireTmr = this->timerList.first ();
-                this->timerList.remove ( *this->pExpireTmr );
+        if ( this->first () ) {
+            if ( currentTime >= this->first ()->exp ) {
+                this->pExpireTmr = this->first ();
+                this->remove ( *this->pExpireTmr );
                 this->pExpireTmr->curState = timer::stateActive;
 #               ifdef DEBUG
                     this->pExpireTmr->show ( 0u );
 #               endif
             }
             else {
-                delay = this->timerList.first ()->exp - currentTime;
+                delay = this->first ()->exp - currentTime;
                 this->processThread = 0;
                 break;
             }
@@ -215,12 +316,10 @@ epicsTimerForC & timerQueue::createTimerForC ( epicsTimerCallback pCallback, voi
 void timerQueue::show ( unsigned level ) const
 {
     epicsGuard < epicsMutex > locker ( this->mutex );
-    printf ( "epicsTimerQueue with %u items pending\n", this->timerList.count () );
+    printf ( "epicsTimerQueue with %u items pending\n", this->heapCount );
     if ( level >= 1u ) {
-        tsDLIterConst < timer > iter = this->timerList.firstIter ();
-        while ( iter.valid () ) {
-            iter->show ( level - 1u );
-            ++iter;
+        for ( unsigned i = 0u; i < this->heapCount; i++ ) {
+            this->heap[i].pTmr->show ( level - 1u );
         }
     }
 }
@@ -0,0 +1,76 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/* Measure calcPerform() evaluations per second for some expressions
+ * typical of calc and calcout records.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "epicsTime.h"
+#include "postfix.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define RUN_TIME 0.5
+
+static const char * const exprs[] = {
+    "A+B",
+    "(A-B)/C*100",
+    "A>B?A:B",
+    "SQRT(A*A+B*B)",
+    "(A>>8)&0xff",
+    "A*(2*PI/360)+B",
+    "VAL+1>=10?0:VAL+1",
+    "ABS(A-B)>0.5*(1-C/100)",
+    "A&&B||!C",
+    "MAX(A,B,C,D)-MIN(A,B,C,D)",
+};
+
+static void runBench(const char *expr)
+{
+    double args[CALCPERFORM_NARGS] = {
+        1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0, 12.0
+    };
+    char rpn[MAX_POSTFIX_SIZE];
+    epicsTimeStamp begin, end;
+    double elapsed, val = 0.0;
+    unsigned long n = 0;
+    short err;
+
+    if (strlen(expr) >= MAX_INFIX_SIZE || postfix(expr, rpn, &err)) {
+        testDiag("Can't compile '%s'", expr);
+        return;
+    }
+
+    epicsTimeGetMonotonic(&begin);
+    do {
+        int i;
+
+        for (i = 0; i < 10000; i++) {
+            args[0] = i;
+            calcPerform(args, &val, rpn);
+        }
+        n += 10000;
+        epicsTimeGetMonotonic(&end);
+        elapsed = epicsTimeDiffInSeconds(&end, &begin);
+    } while (elapsed < RUN_TIME);
+
+    testDiag("%-28s %7.2f M evaluations/s", expr, n / elapsed * 1e-6);
+}
+
+MAIN(epicsCalcPerform)
+{
+    unsigned i;
+
+    testPlan(0);
+
+    for (i = 0; i < sizeof(exprs) / sizeof(exprs[0]); i++)
+        runBench(exprs[i]);
+
+    return testDone();
+}
@@ -139,6 +139,29 @@ void testArgs(const char *expr, unsigned long einp, unsigned long eout) {
     free(rpn);
 }
 
+void testFold(const char *expr, const char *folded) {
+    /* Compile both expressions, the results should be identical */
+    size_t size = INFIX_TO_POSTFIX_SIZE(strlen(expr)+1);
+    char *rpn = (char*)calloc(1, size);
+    char *frpn = (char*)calloc(1, size);
+    short err = 0;
+
+    if(!rpn || !frpn) {
+        testFail("postfix: %s no memory", expr);
+        return;
+    }
+
+    if (postfix(expr, rpn, &err) || postfix(folded, frpn, &err)) {
+        testFail("postfix: %s in expression '%s'", calcErrorStr(err), expr);
+    }
+    else if (!testOk(!memcmp(rpn, frpn, size), "'%s' folds to '%s'",
+        expr, folded)) {
+        calcExprDump(rpn);
+    }
+    free(frpn);
+    free(rpn);
+}
+
 void testBadExpr(const char *expr, short expected_err) {
     /* Parse an invalid expression, test against expected error code */
     char *rpn = (char*)malloc(INFIX_TO_POSTFIX_SIZE(strlen(expr)+1));
@@ -298,7 +321,7 @@ MAIN(epicsCalcTest)
     const double a=1.0, b=2.0, c=3.0, d=4.0, e=5.0, f=6.0,
                  g=7.0, h=8.0, i=9.0, j=10.0, k=11.0, l=12.0;
 
-    testPlan(637);
+    testPlan(655);
 
     /* LITERAL_OPERAND elements */
     testExpr(0);
@@ -938,6 +961,26 @@ MAIN(epicsCalcTest)
     testArgs("12.1;A:=0;B:=A;C:=B;D:=C", 0, A_A|A_B|A_C|A_D);
     testArgs("13.1;B:=A;A:=B;C:=D;D:=C", A_A|A_D, A_A|A_B|A_C|A_D);
 
+    // Constant folding
+    testFold("1+2*3", "7");
+    testFold("1.5*2", "3");
+    testFold("SIN(0)+MAX(1,2,3)", "3");
+    testFold("A+(2*3)", "A+6");
+    testFold("A+2*3-B", "A+6-B");
+    testFold("A:=1+2;A", "A:=3;A");
+    testFold("A ? 1+1 : 2+2", "A ? 2 : 4");
+    testFold("0 ? A : B", "B");
+    testFold("1 ? A : B", "A");
+    testFold("(2>1) ? A+1 : B", "A+1");
+    testFold("0 ? A : 1 ? B : C", "B");
+    testFold("1 ? (0 ? A : B) : C", "B");
+    testFold("(1 ? 2 : A) + 3", "5");
+    testFold("NaN ? A : B", "A");
+    testCalc("1/(0*-1)", -Inf);
+    testCalc("1/(0 ? 1 : -(0*1))", -Inf);
+    testArgs("0 ? A : B", A_B, 0);
+    testArgs("1 ? B : C", A_B, 0);
+
     // Malformed expressions
     testBadExpr("0x0.1", CALC_ERR_SYNTAX);
     testBadExpr("1*", CALC_ERR_INCOMPLETE);
@@ -0,0 +1,75 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/* Compare the speed of epicsMemHash() and epicsMemHashWide() for buffers
+ * of the sizes array records hash for their On Change posting.
+ */
+
+#include <stdlib.h>
+
+#include "epicsTime.h"
+#include "epicsString.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define RUN_TIME 0.5
+#define MAX_SIZE (8 * 1024 * 1024)
+
+typedef unsigned int hashFunc(const void *buf, size_t length,
+    unsigned int seed);
+
+static unsigned int memHash(const void *buf, size_t length, unsigned int seed)
+{
+    return epicsMemHash((const char *) buf, length, seed);
+}
+
+static volatile unsigned int sink;
+
+/* Returns MB/s */
+static double runBench(hashFunc *func, const void *buf, size_t size)
+{
+    epicsTimeStamp begin, end;
+    double elapsed;
+    unsigned long n = 0;
+
+    epicsTimeGetMonotonic(&begin);
+    do {
+        sink = func(buf, size, sink);
+        n++;
+        epicsTimeGetMonotonic(&end);
+        elapsed = epicsTimeDiffInSeconds(&end, &begin);
+    } while (elapsed < RUN_TIME);
+
+    return (double) size * n / elapsed * 1e-6;
+}
+
+MAIN(epicsMemHashPerform)
+{
+    static const size_t sizes[] = {64, 1024, 65536, MAX_SIZE};
+    unsigned char *buf;
+    unsigned i;
+
+    testPlan(0);
+
+    buf = malloc(MAX_SIZE);
+    if (!buf)
+        testAbort("Out of memory");
+    for (i = 0; i < MAX_SIZE; i++)
+        buf[i] = (unsigned char) (i * 7 + 3);
+
+    testDiag("%10s %16s %16s %8s", "bytes", "epicsMemHash", "MemHashWide",
+             "speedup");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        double slow = runBench(memHash, buf, sizes[i]);
+        double fast = runBench(epicsMemHashWide, buf, sizes[i]);
+
+        testDiag("%10u %11.0f MB/s %11.0f MB/s %7.1fx", (unsigned) sizes[i],
+                 slow, fast, fast / slow);
+    }
+
+    free(buf);
+    return testDone();
+}
@@ -244,6 +244,60 @@ void testEpicsStrPrintEscaped(void)
     remove(filename);
 }
 
+static
+void testMemHashWide(void)
+{
+    unsigned char buf[136], copy[136];
+    unsigned int hash;
+    size_t len, i, bit;
+    int ok;
+
+    testDiag("testMemHashWide()");
+
+    for (i = 0; i < sizeof(buf); i++)
+        buf[i] = (unsigned char) (i * 7 + 3);
+
+    testOk1(epicsMemHashWide(buf, 0, 0) == 0);
+    testOk1(epicsMemHashWide(buf, 0, 42) == 42);
+    testOk1(epicsMemHashWide(buf, 100, 0) != epicsMemHashWide(buf, 100, 1));
+
+    /* the same bytes at any alignment */
+    ok = 1;
+    for (len = 1; len <= 100; len++) {
+        hash = epicsMemHashWide(buf, len, 0);
+        for (i = 1; i < 8; i++) {
+            memcpy(copy + i, buf, len);
+            ok &= epicsMemHashWide(copy + i, len, 0) == hash;
+        }
+    }
+    testOk(ok, "Same hash for any alignment");
+
+    /* a single changed bit anywhere, for each code path */
+    ok = 1;
+    for (len = 1; len <= 70; len++) {
+        hash = epicsMemHashWide(buf, len, 0);
+        for (i = 0; i < len; i++) {
+            for (bit = 0; bit < 8; bit++) {
+                buf[i] ^= 1u << bit;
+                if (epicsMemHashWide(buf, len, 0) == hash) {
+                    testDiag("No change for length %u bit %u",
+                             (unsigned) len, (unsigned) (i * 8 + bit));
+                    ok = 0;
+                }
+                buf[i] ^= 1u << bit;
+            }
+        }
+    }
+    testOk(ok, "Any changed bit changes the hash");
+
+    /* a longer run of zeros */
+    memset(buf, 0, sizeof(buf));
+    ok = 1;
+    for (len = 1; len < sizeof(buf); len++)
+        ok &= epicsMemHashWide(buf, len, 0) != epicsMemHashWide(buf, len + 1, 0);
+    testOk(ok, "Longer zero buffers change the hash");
+}
+
 MAIN(epicsStringTest)
 {
     const char * const empty = "";
@@ -258,7 +312,7 @@ MAIN(epicsStringTest)
     char *s;
     int status;
 
-    testPlan(446);
+    testPlan(452);
 
     testChars();
 
@@ -293,6 +347,8 @@ MAIN(epicsStringTest)
     testOk1(epicsStrHash(abcd, 0) == epicsMemHash(abcde, 4, 0));
     testOk1(epicsStrHash(abcd, 0) != epicsMemHash("abcd\0", 5, 0));
 
+    testMemHashWide();
+
     testOk1(epicsStrnLen("abcd", 5)==4);
     testOk1(epicsStrnLen("abcd", 4)==4);
     testOk1(epicsStrnLen("abcd", 3)==3);
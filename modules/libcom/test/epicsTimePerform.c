@@ -0,0 +1,122 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/* Measure epicsTimeGetCurrent() calls per second from 1 to N threads,
+ * with only the OS clock, and with an additional time provider which
+ * makes every call go through the general time provider list.
+ */
+
+#include <stdio.h>
+
+#include "epicsAtomic.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "generalTimeSup.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define TEST_PRIORITY 50
+#define RUN_TIME 1.0
+
+typedef struct {
+    epicsEventId start;
+    epicsEventId done;
+    int stop;           /* use atomic */
+    size_t calls;       /* use atomic */
+    int running;        /* use atomic */
+} benchCtx;
+
+static int benchProvider(epicsTimeStamp *pDest)
+{
+    /* defer to the next provider in the list */
+    return generalTimeGetExceptPriority(pDest, NULL, TEST_PRIORITY);
+}
+
+static void benchThread(void *arg)
+{
+    benchCtx *ctx = (benchCtx *)arg;
+    size_t n = 0;
+
+    epicsEventMustWait(ctx->start);
+    epicsEventMustTrigger(ctx->start);  /* wake the next thread */
+
+    while (!epicsAtomicGetIntT(&ctx->stop)) {
+        epicsTimeStamp ts;
+        int i;
+
+        for (i = 0; i < 1000; i++)
+            epicsTimeGetCurrent(&ts);
+        n += 1000;
+    }
+
+    epicsAtomicAddSizeT(&ctx->calls, n);
+    if (!epicsAtomicDecrIntT(&ctx->running))
+        epicsEventMustTrigger(ctx->done);
+}
+
+static void runBench(const char *what, int nthreads)
+{
+    benchCtx ctx;
+    epicsTimeStamp begin, end;
+    double elapsed;
+    int i;
+
+    ctx.start = epicsEventMustCreate(epicsEventEmpty);
+    ctx.done = epicsEventMustCreate(epicsEventEmpty);
+    ctx.stop = 0;
+    ctx.calls = 0;
+    ctx.running = nthreads;
+
+    for (i = 0; i < nthreads; i++) {
+        epicsThreadMustCreate("benchTime", epicsThreadPriorityMedium,
+            epicsThreadGetStackSize(epicsThreadStackSmall),
+            benchThread, &ctx);
+    }
+
+    epicsTimeGetMonotonic(&begin);
+    epicsEventMustTrigger(ctx.start);
+    epicsThreadSleep(RUN_TIME);
+    epicsAtomicSetIntT(&ctx.stop, 1);
+    epicsEventMustWait(ctx.done);
+    epicsTimeGetMonotonic(&end);
+
+    elapsed = epicsTimeDiffInSeconds(&end, &begin);
+    testDiag("%s, %2d thread%s: %6.2f M calls/s total",
+        what, nthreads, nthreads == 1 ? " " : "s",
+        epicsAtomicGetSizeT(&ctx.calls) / elapsed * 1e-6);
+
+    epicsEventDestroy(ctx.start);
+    epicsEventDestroy(ctx.done);
+}
+
+static void runAll(const char *what)
+{
+    int ncpus = epicsThreadGetCPUs();
+    int n;
+
+    for (n = 1; n < ncpus; n *= 2)
+        runBench(what, n);
+    runBench(what, ncpus);
+    if (ncpus < 4)
+        runBench(what, 4);
+}
+
+MAIN(epicsTimePerform)
+{
+    testPlan(0);
+
+    testDiag("%d CPUs", epicsThreadGetCPUs());
+
+    runAll("OS clock only");
+
+    generalTimeRegisterCurrentProvider("Bench Clock", TEST_PRIORITY,
+        benchProvider);
+
+    runAll("Provider list");
+
+    return testDone();
+}
@@ -0,0 +1,121 @@
+/*************************************************************************\
+* SPDX-License-Identifier: EPICS
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/* Measure timer start, cancel and expire throughput of a passive
+ * timer queue with 10^3 to 10^6 timers, each with a random
+ * expiration time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "epicsTime.h"
+#include "epicsTimer.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+static size_t nExpired;
+
+static void expireCallback(void *arg)
+{
+    nExpired++;
+}
+
+static void noopReschedule(void *arg) {}
+
+static double noopQuantum(void *arg)
+{
+    return 0.0;
+}
+
+/* random times within the last 1000 seconds, so all are expired */
+static void startAll(epicsTimerId *timers, epicsTimeStamp *times, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        epicsTimerStartTime(timers[i], &times[i]);
+}
+
+static double rate(size_t n, const epicsTimeStamp *begin)
+{
+    epicsTimeStamp end;
+
+    epicsTimeGetMonotonic(&end);
+    return n / epicsTimeDiffInSeconds(&end, begin) * 1e-6;
+}
+
+static void runBench(size_t n)
+{
+    epicsTimerQueuePassiveId queue;
+    epicsTimerId *timers = calloc(n, sizeof(*timers));
+    epicsTimeStamp *times = calloc(n, sizeof(*times));
+    epicsTimeStamp now, begin;
+    double start, restart, cancel, expire;
+    size_t i;
+
+    if (!timers || !times)
+        testAbort("Out of memory");
+
+    queue = epicsTimerQueuePassiveCreate(noopReschedule, noopQuantum, NULL);
+    if (!queue)
+        testAbort("Failed to create timer queue");
+
+    epicsTimeGetCurrent(&now);
+    for (i = 0; i < n; i++) {
+        timers[i] = epicsTimerQueuePassiveCreateTimer(queue,
+            expireCallback, NULL);
+        times[i] = now;
+        epicsTimeAddSeconds(&times[i], -1.0 - rand() % 1000000 * 1e-3);
+    }
+
+    epicsTimeGetMonotonic(&begin);
+    startAll(timers, times, n);
+    start = rate(n, &begin);
+
+    /* move every pending timer to a new position */
+    for (i = 0; i < n; i++)
+        epicsTimeAddSeconds(&times[i], -1e-3 * (rand() % 1000));
+    epicsTimeGetMonotonic(&begin);
+    startAll(timers, times, n);
+    restart = rate(n, &begin);
+
+    epicsTimeGetMonotonic(&begin);
+    for (i = 0; i < n; i++)
+        epicsTimerCancel(timers[i]);
+    cancel = rate(n, &begin);
+
+    startAll(timers, times, n);
+    nExpired = 0;
+    epicsTimeGetMonotonic(&begin);
+    epicsTimerQueuePassiveProcess(queue);
+    expire = rate(n, &begin);
+
+    testDiag("%8u timers: start %6.2f, restart %6.2f, cancel %6.2f, "
+        "expire %6.2f M/s", (unsigned) n, start, restart, cancel, expire);
+    if (nExpired != n)
+        testDiag("only %u of %u timers expired",
+            (unsigned) nExpired, (unsigned) n);
+
+    for (i = 0; i < n; i++)
+        epicsTimerQueuePassiveDestroyTimer(queue, timers[i]);
+    epicsTimerQueuePassiveDestroy(queue);
+    free(times);
+    free(timers);
+}
+
+MAIN(epicsTimerPerform)
+{
+    size_t n;
+
+    testPlan(0);
+
+    srand(42);
+    for (n = 1000; n <= 1000000; n *= 10)
+        runBench(n);
+
+    return testDone();
+}